@@ -11,8 +11,10 @@ LOCAL_SRC_FILES := \
 	app/DecorView.cpp \
 	app/Window.cpp \
 	content/Context.cpp \
+	content/res/AssetPack.cpp \
 	content/res/ColorStateList.cpp \
 	content/res/Configuration.cpp \
+	content/res/ResourceTable.cpp \
 	content/res/Resources.cpp \
 	graphics/Bitmap.cpp \
 	graphics/Canvas.cpp \
@@ -24,6 +26,8 @@ LOCAL_SRC_FILES := \
 	graphics/NinePatch.cpp \
 	graphics/Paint.cpp \
 	graphics/Path.cpp \
+	graphics/PixelKernels.cpp \
+	graphics/RenderThread.cpp \
 	graphics/TextLayout.cpp \
 	graphics/TextLayoutCache.cpp \
 	graphics/Typeface.cpp \
@@ -39,10 +43,13 @@ LOCAL_SRC_FILES := \
 	internal/R.cpp \
 	text/BoringLayout.cpp \
 	text/Directions.cpp \
+	text/DynamicLayout.cpp \
 	text/Editable.cpp \
 	text/InputFilter.cpp \
 	text/Layout.cpp \
 	text/MeasuredText.cpp \
+	text/PackedIntVector.cpp \
+	text/PrecomputedText.cpp \
 	text/Selection.cpp \
 	text/Spannable.cpp \
 	text/SpannableString.cpp \
@@ -64,6 +71,7 @@ LOCAL_SRC_FILES := \
 	view/AttachInfo.cpp \
 	view/GLES20DisplayList.cpp \
 	view/Gravity.cpp \
+	view/InputConsumer.cpp \
 	view/KeyEvent.cpp \
 	view/LayoutInflater.cpp \
 	view/MotionEvent.cpp \
@@ -17,9 +17,13 @@ Activity::Activity(Context *context) : Context(context->m_resources) {
 
     mContext = context;
     m_window = new Window(this);
+
+    registerComponentCallbacks(this);
 }
 
 Activity::~Activity() {
+    unscheduleConsumeBatchedInput();
+    unregisterComponentCallbacks(this);
 }
 
 View *Activity::findViewById(std::string id) {
@@ -109,10 +113,7 @@ bool Activity::ccTouchBegan(CCTouch *pTouch, CCEvent *pEvent)
 {
     CCSet set;
     set.addObject(pTouch);
-    MotionEvent event;
-    event.init(&set, MotionEvent::ACTION_DOWN);
-    
-    dispatchTouchEvent(&event);
+    dispatchImmediately(&set, MotionEvent::ACTION_DOWN);
     
     CC_UNUSED_PARAM(pTouch);
     CC_UNUSED_PARAM(pEvent);
@@ -124,10 +125,7 @@ void Activity::ccTouchMoved(CCTouch *pTouch, CCEvent *pEvent)
 {
     CCSet set;
     set.addObject(pTouch);
-    MotionEvent event;
-    event.init(&set, MotionEvent::ACTION_MOVE);
-    
-    dispatchTouchEvent(&event);
+    enqueueMove(&set);
     
     CC_UNUSED_PARAM(pTouch);
     CC_UNUSED_PARAM(pEvent);
@@ -137,10 +135,7 @@ void Activity::ccTouchEnded(CCTouch *pTouch, CCEvent *pEvent)
 {
     CCSet set;
     set.addObject(pTouch);
-    MotionEvent event;
-    event.init(&set, MotionEvent::ACTION_UP);
-    
-    dispatchTouchEvent(&event);
+    dispatchImmediately(&set, MotionEvent::ACTION_UP);
     
     CC_UNUSED_PARAM(pTouch);
     CC_UNUSED_PARAM(pEvent);
@@ -150,10 +145,7 @@ void Activity::ccTouchCancelled(CCTouch *pTouch, CCEvent *pEvent)
 {
     CCSet set;
     set.addObject(pTouch);
-    MotionEvent event;
-    event.init(&set, MotionEvent::ACTION_CANCEL);
-    
-    dispatchTouchEvent(&event);
+    dispatchImmediately(&set, MotionEvent::ACTION_CANCEL);
     
     CC_UNUSED_PARAM(pTouch);
     CC_UNUSED_PARAM(pEvent);
@@ -161,46 +153,92 @@ void Activity::ccTouchCancelled(CCTouch *pTouch, CCEvent *pEvent)
 
 void Activity::ccTouchesBegan(CCSet *pTouches, CCEvent *pEvent)
 {
-    MotionEvent event;
-    event.init(pTouches, MotionEvent::ACTION_DOWN);
-    
-    dispatchTouchEvent(&event);
+    dispatchImmediately(pTouches, MotionEvent::ACTION_DOWN);
     
-    CC_UNUSED_PARAM(pTouches);
     CC_UNUSED_PARAM(pEvent);
 }
 
 void Activity::ccTouchesMoved(CCSet *pTouches, CCEvent *pEvent)
 {
-    MotionEvent event;
-    event.init(pTouches, MotionEvent::ACTION_MOVE);
-    
-    dispatchTouchEvent(&event);
+    enqueueMove(pTouches);
     
-    CC_UNUSED_PARAM(pTouches);
     CC_UNUSED_PARAM(pEvent);
 }
 
 void Activity::ccTouchesEnded(CCSet *pTouches, CCEvent *pEvent)
 {
-    MotionEvent event;
-    event.init(pTouches, MotionEvent::ACTION_UP);
-    
-    dispatchTouchEvent(&event);
+    dispatchImmediately(pTouches, MotionEvent::ACTION_UP);
     
-    CC_UNUSED_PARAM(pTouches);
     CC_UNUSED_PARAM(pEvent);
 }
 
 void Activity::ccTouchesCancelled(CCSet *pTouches, CCEvent *pEvent)
 {
+    dispatchImmediately(pTouches, MotionEvent::ACTION_CANCEL);
+    
+    CC_UNUSED_PARAM(pEvent);
+}
+
+/// Batched input
+
+void Activity::enqueueMove(CCSet *touches) {
+    
+    // The platform reports every touch sample, the views only need the moves
+    // once per frame
+    MotionEvent event;
+    event.init(touches, MotionEvent::ACTION_MOVE);
+    
+    m_inputConsumer.addMove(event);
+    scheduleConsumeBatchedInput();
+}
+
+void Activity::dispatchImmediately(CCSet *touches, int32_t action) {
+    
+    // The moves before a down or an up are delivered first, as they happened
+    unscheduleConsumeBatchedInput();
+    consumeBatchedInput(-1);
+    m_inputConsumer.reset();
+    
     MotionEvent event;
-    event.init(pTouches, MotionEvent::ACTION_CANCEL);
+    event.init(touches, action);
     
     dispatchTouchEvent(&event);
+}
+
+void Activity::consumeBatchedInput(nsecs_t frameTime) {
+    MotionEvent event;
+    while (m_inputConsumer.consumeBatch(frameTime, event)) {
+        dispatchTouchEvent(&event);
+    }
+}
+
+void Activity::doConsumeBatchedInput() {
+    m_consumeBatchedInputScheduled = false;
     
-    CC_UNUSED_PARAM(pTouches);
-    CC_UNUSED_PARAM(pEvent);
+    // Run by the looper at the start of the frame, before the traversal and
+    // the drawing, so now is the frame time
+    consumeBatchedInput(mindroid::Clock::monotonicTime());
+    
+    // Moves too recent for this frame
+    scheduleConsumeBatchedInput();
+}
+
+void Activity::scheduleConsumeBatchedInput() {
+    if (!m_consumeBatchedInputScheduled && m_inputConsumer.hasPendingBatch()) {
+        m_consumeBatchedInputScheduled = true;
+        
+        // Not due before the oldest move can be consumed, the next frames
+        // would find nothing to do otherwise
+        m_handler->postAtTime(m_consumeBatchedInputRunnable,
+                m_inputConsumer.getPendingBatchTime() + InputConsumer::RESAMPLE_LATENCY);
+    }
+}
+
+void Activity::unscheduleConsumeBatchedInput() {
+    if (m_consumeBatchedInputScheduled) {
+        m_consumeBatchedInputScheduled = false;
+        m_handler->removeCallbacks(m_consumeBatchedInputRunnable);
+    }
 }
 
 ANDROID_END
\ No newline at end of file
@@ -10,10 +10,15 @@
 
 #include "AndroidMacros.h"
 
+#include "Android/content/ComponentCallbacks2.h"
 #include "Android/content/Context.h"
+#include "Android/view/InputConsumer.h"
 
 #include "cocos2d.h"
 
+#include <mindroid/os/Handler.h>
+#include <mindroid/os/Runnable.h>
+
 #include <memory>
 #include <string>
 
@@ -26,7 +31,8 @@ class Window;
 class LayoutInflater;
 class MotionEvent;
 
-class Activity : public cocos2d::CCScene, public CCTouchDelegate, public Context {
+class Activity : public cocos2d::CCScene, public CCTouchDelegate, public Context,
+        public ComponentCallbacks2 {
 
     friend class Window;
 
@@ -61,6 +67,7 @@ public:
     
     virtual void onPause() {}
     virtual void onResume() {}
+    virtual void onTrimMemory(int level) {}
     virtual bool onTouchEvent(MotionEvent *ev);
     virtual bool visit(void);
     
@@ -69,9 +76,34 @@ public:
 
     static Activity *create(Context *context);
 private:
+    
+    class ConsumeBatchedInputRunnable : public mindroid::Runnable {
+    public:
+        
+        ConsumeBatchedInputRunnable(Activity *activity) { mActivity = activity; }
+        
+        virtual void run() {
+            mActivity->doConsumeBatchedInput();
+        }
+    private:
+        Activity *mActivity;
+    };
+    
+    void consumeBatchedInput(nsecs_t frameTime);
+    void doConsumeBatchedInput();
+    void enqueueMove(CCSet *touches);
+    void dispatchImmediately(CCSet *touches, int32_t action);
+    void scheduleConsumeBatchedInput();
+    void unscheduleConsumeBatchedInput();
+    
     Context *mContext = NULL;
     Window *m_window = NULL;
     bool m_called = false;
+    
+    InputConsumer m_inputConsumer;
+    mindroid::sp<mindroid::Handler> m_handler = new mindroid::Handler();
+    mindroid::sp<ConsumeBatchedInputRunnable> m_consumeBatchedInputRunnable = new ConsumeBatchedInputRunnable(this);
+    bool m_consumeBatchedInputScheduled = false;
 };
 
 ANDROID_END
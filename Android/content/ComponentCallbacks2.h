@@ -0,0 +1,103 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __Androidpp__ComponentCallbacks2__
+#define __Androidpp__ComponentCallbacks2__
+
+#include "AndroidMacros.h"
+
+#include <stddef.h>
+#include <vector>
+
+using namespace std;
+
+ANDROID_BEGIN
+
+/**
+ * Implemented by components that hold memory they can release when the app
+ * goes to the background or the system runs low on memory. Components are
+ * registered with {@link Context#registerComponentCallbacks} and called by
+ * {@link Context#dispatchTrimMemory}.
+ */
+class ComponentCallbacks2 {
+public:
+
+    /**
+     * Level for {@link #onTrimMemory(int)}: the process is near the end of
+     * the background LRU list and will be killed first if memory is needed.
+     */
+    static const int TRIM_MEMORY_COMPLETE = 80;
+
+    /**
+     * Level for {@link #onTrimMemory(int)}: the process is around the middle
+     * of the background LRU list.
+     */
+    static const int TRIM_MEMORY_MODERATE = 60;
+
+    /**
+     * Level for {@link #onTrimMemory(int)}: the process has gone on to the
+     * LRU list of background processes.
+     */
+    static const int TRIM_MEMORY_BACKGROUND = 40;
+
+    /**
+     * Level for {@link #onTrimMemory(int)}: the process had been showing a
+     * user interface, and is no longer doing so.
+     */
+    static const int TRIM_MEMORY_UI_HIDDEN = 20;
+
+    /**
+     * Level for {@link #onTrimMemory(int)}: the process is running but the
+     * system is extremely low on memory and about to kill background processes.
+     */
+    static const int TRIM_MEMORY_RUNNING_CRITICAL = 15;
+
+    /**
+     * Level for {@link #onTrimMemory(int)}: the process is running but the
+     * system is running low on memory.
+     */
+    static const int TRIM_MEMORY_RUNNING_LOW = 10;
+
+    /**
+     * Level for {@link #onTrimMemory(int)}: the process is running but the
+     * system is beginning to run low on memory.
+     */
+    static const int TRIM_MEMORY_RUNNING_MODERATE = 5;
+
+    /**
+     * Memory held by one cache, as reported by {@link #getMemoryUsage}.
+     */
+    struct MemoryUsage {
+        const char *name;
+        size_t bytes;
+    };
+
+    virtual ~ComponentCallbacks2() {}
+
+    /**
+     * Called when it is a good time to release memory. The level tells how
+     * much should go: the higher the level, the more should be released.
+     */
+    virtual void onTrimMemory(int level) = 0;
+
+    /**
+     * Appends the memory held by this component, in bytes, one entry per
+     * cache. Components that cannot measure what they hold report nothing.
+     */
+    virtual void getMemoryUsage(vector<MemoryUsage> &usage) {}
+};
+
+ANDROID_END
+
+#endif /* defined(__Androidpp__ComponentCallbacks2__) */
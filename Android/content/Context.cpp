@@ -11,8 +11,22 @@
 
 #include "Android/view/View.h"
 
+#include <algorithm>
+#include <mutex>
+
 ANDROID_BEGIN
 
+// Function statics so that caches can register from static initializers
+static mutex &callbacksLock() {
+    static mutex lock;
+    return lock;
+}
+
+static vector<ComponentCallbacks2*> &componentCallbacks() {
+    static vector<ComponentCallbacks2*> callbacks;
+    return callbacks;
+}
+
 Context::~Context() {
 }
 
@@ -20,4 +34,54 @@ Resources *Context::getResources() {
     return &m_resources;
 }
 
+void Context::registerComponentCallbacks(ComponentCallbacks2 *callback) {
+    unique_lock<mutex> lock(callbacksLock());
+    vector<ComponentCallbacks2*> &callbacks = componentCallbacks();
+    if (find(callbacks.begin(), callbacks.end(), callback) == callbacks.end()) {
+        callbacks.push_back(callback);
+    }
+}
+
+void Context::unregisterComponentCallbacks(ComponentCallbacks2 *callback) {
+    unique_lock<mutex> lock(callbacksLock());
+    vector<ComponentCallbacks2*> &callbacks = componentCallbacks();
+    callbacks.erase(remove(callbacks.begin(), callbacks.end(), callback), callbacks.end());
+}
+
+void Context::dispatchTrimMemory(int level) {
+    vector<ComponentCallbacks2*> callbacks;
+    {
+        unique_lock<mutex> lock(callbacksLock());
+        callbacks = componentCallbacks();
+    }
+
+    // Called without the lock, components may unregister while trimming
+    for (size_t i = 0; i < callbacks.size(); i++) {
+        callbacks[i]->onTrimMemory(level);
+    }
+}
+
+vector<ComponentCallbacks2::MemoryUsage> Context::getMemoryUsage() {
+    vector<ComponentCallbacks2*> callbacks;
+    {
+        unique_lock<mutex> lock(callbacksLock());
+        callbacks = componentCallbacks();
+    }
+
+    vector<ComponentCallbacks2::MemoryUsage> usage;
+    for (size_t i = 0; i < callbacks.size(); i++) {
+        callbacks[i]->getMemoryUsage(usage);
+    }
+    return usage;
+}
+
+size_t Context::getTotalMemoryUsage() {
+    vector<ComponentCallbacks2::MemoryUsage> usage = getMemoryUsage();
+    size_t total = 0;
+    for (size_t i = 0; i < usage.size(); i++) {
+        total += usage[i].bytes;
+    }
+    return total;
+}
+
 ANDROID_END
\ No newline at end of file
@@ -10,8 +10,11 @@
 
 #include "AndroidMacros.h"
 
+#include "Android/content/ComponentCallbacks2.h"
 #include "Android/content/res/Resources.h"
 
+#include <vector>
+
 ANDROID_BEGIN
 
 class View;
@@ -30,6 +33,29 @@ public:
 
     Resources *getResources();
 
+    /**
+     * Adds a component to be called by dispatchTrimMemory(). Components are
+     * shared by the whole process, not by this context only.
+     */
+    static void registerComponentCallbacks(ComponentCallbacks2 *callback);
+    static void unregisterComponentCallbacks(ComponentCallbacks2 *callback);
+
+    /**
+     * Asks every registered component to release memory. To be called by the
+     * platform when the app goes to the background or gets a memory warning.
+     */
+    static void dispatchTrimMemory(int level);
+
+    /**
+     * Returns the memory held by the caches of every registered component.
+     */
+    static vector<ComponentCallbacks2::MemoryUsage> getMemoryUsage();
+
+    /**
+     * Returns the sum of getMemoryUsage(), in bytes.
+     */
+    static size_t getTotalMemoryUsage();
+
 private:
     
     Resources m_resources;
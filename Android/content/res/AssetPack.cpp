@@ -0,0 +1,181 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AssetPack.h"
+
+#include "cocos2d.h"
+
+#include <utils/Compat.h>
+#include <utils/Errors.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+ANDROID_BEGIN
+
+const char *AssetPack::DEFAULT_PACK_NAME = "res.pack";
+
+mutex AssetPack::s_lock;
+shared_ptr<AssetPack> AssetPack::s_default;
+bool AssetPack::s_defaultSet = false;
+
+AssetPack::Asset::Asset(shared_ptr<const AssetPack> pack, const void *data, size_t length) :
+        mPack(pack), mData(data), mLength(length), mBuffer(NULL) {
+}
+
+AssetPack::Asset::Asset(char *buffer, size_t length) :
+        mData(buffer), mLength(length), mBuffer(buffer) {
+}
+
+AssetPack::Asset::~Asset() {
+    delete[] mBuffer;
+}
+
+AssetPack::AssetPack(const char *path, const char *prefix) : mPath(path), mPrefix(prefix), mMap(NULL) {
+}
+
+AssetPack::~AssetPack() {
+    if (mMap) {
+        mMap->release();
+    }
+}
+
+shared_ptr<AssetPack> AssetPack::open(const char *path, const char *prefix) {
+
+    shared_ptr<AssetPack> pack(new AssetPack(path, prefix));
+
+    if (pack->mZip.open(path) != android::NO_ERROR) {
+        return NULL;
+    }
+
+    // Map the whole archive once rather than every entry on its own, entries
+    // are then read without any system call
+    int fd = ::open(path, O_RDONLY);
+    if (fd >= 0) {
+        off64_t length = lseek64(fd, 0, SEEK_END);
+
+        android::FileMap *map = new android::FileMap();
+        if (length > 0 && map->create(path, fd, 0, length, true)) {
+            map->advise(android::FileMap::RANDOM);
+            pack->mMap = map;
+        } else {
+            map->release();
+        }
+
+        close(fd);
+    }
+
+    if (!pack->mMap) {
+        CCLOG("Could not map %s, its resources will be copied", path);
+    }
+
+    return pack;
+}
+
+void AssetPack::setDefault(shared_ptr<AssetPack> pack) {
+    unique_lock<mutex> lock(s_lock);
+    s_default = pack;
+    s_defaultSet = true;
+}
+
+shared_ptr<AssetPack> AssetPack::getDefault() {
+    unique_lock<mutex> lock(s_lock);
+
+    if (!s_defaultSet) {
+        s_defaultSet = true;
+
+        // A path that is not absolute means the pack was not found
+        cocos2d::CCFileUtils *fileUtils = cocos2d::CCFileUtils::sharedFileUtils();
+        string path = fileUtils->fullPathForFilename(DEFAULT_PACK_NAME);
+        if (fileUtils->isAbsolutePath(path)) {
+            s_default = open(path.c_str());
+        }
+    }
+
+    return s_default;
+}
+
+bool AssetPack::isFileExist(const string &path) {
+
+    shared_ptr<AssetPack> pack = getDefault();
+    if (pack != NULL) {
+        return pack->hasFile(path);
+    }
+
+    return cocos2d::CCFileUtils::sharedFileUtils()->isFileExist(path);
+}
+
+shared_ptr<AssetPack::Asset> AssetPack::getFileData(const string &path) {
+
+    shared_ptr<AssetPack> pack = getDefault();
+    if (pack != NULL) {
+        return pack->openAsset(path);
+    }
+
+    cocos2d::CCFileUtils *fileUtils = cocos2d::CCFileUtils::sharedFileUtils();
+    if (!fileUtils->isFileExist(path)) {
+        return NULL;
+    }
+
+    unsigned long size = 0;
+    char *buffer = (char*) fileUtils->getFileData(path.c_str(), "rb", &size);
+    if (buffer == NULL) {
+        return NULL;
+    }
+
+    return make_shared<Asset>(buffer, size);
+}
+
+android::ZipEntryRO AssetPack::findEntry(const string &path) const {
+    if (mPrefix.empty()) {
+        return mZip.findEntryByName(path.c_str());
+    }
+
+    return mZip.findEntryByName((mPrefix + path).c_str());
+}
+
+bool AssetPack::hasFile(const string &path) const {
+    return findEntry(path) != NULL;
+}
+
+shared_ptr<AssetPack::Asset> AssetPack::openAsset(const string &path) const {
+
+    android::ZipEntryRO entry = findEntry(path);
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    int method;
+    size_t length;
+    off64_t offset;
+    if (!mZip.getEntryInfo(entry, &method, &length, NULL, &offset, NULL, NULL)) {
+        return NULL;
+    }
+
+    if (method == android::ZipFileRO::kCompressStored && mMap &&
+            offset + (off64_t) length <= (off64_t) mMap->getDataLength()) {
+        const char *data = (const char*) mMap->getDataPtr() + offset;
+        return make_shared<Asset>(shared_from_this(), data, length);
+    }
+
+    char *buffer = new char[length];
+    if (!mZip.uncompressEntry(entry, buffer)) {
+        delete[] buffer;
+        return NULL;
+    }
+
+    return make_shared<Asset>(buffer, length);
+}
+
+ANDROID_END
@@ -0,0 +1,138 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __Androidpp__AssetPack__
+#define __Androidpp__AssetPack__
+
+#include "AndroidMacros.h"
+
+#include <utils/FileMap.h>
+#include <utils/ZipFileRO.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+using namespace std;
+
+ANDROID_BEGIN
+
+/**
+ * Read only access to the resources packed in a single archive by
+ * tools/respack.py. The archive is a zip whose entries are stored and aligned,
+ * so they are read straight from one mapping of the whole file, and whose
+ * central directory is hashed when the pack is opened: looking a resource up
+ * costs no system call.
+ *
+ * Any zip can be used as a pack, entries are then found under a prefix. On
+ * Android the application package itself is a pack of its assets:
+ *
+ *     AssetPack::setDefault(AssetPack::open(apkPath, "assets/"));
+ *
+ * Compressed entries are inflated when they are opened.
+ */
+class AssetPack : public enable_shared_from_this<AssetPack> {
+
+public:
+
+    /**
+     * The content of a file. Content read from a pack keeps the pack open.
+     */
+    class Asset {
+
+    public:
+
+        Asset(shared_ptr<const AssetPack> pack, const void *data, size_t length);
+        Asset(char *buffer, size_t length);
+        ~Asset();
+
+        const char *getBuffer() const { return (const char*) mData; }
+        size_t getLength() const { return mLength; }
+
+    private:
+
+        Asset(const Asset &asset);
+        Asset &operator=(const Asset &asset);
+
+        shared_ptr<const AssetPack> mPack;
+        const void *mData;
+        size_t mLength;
+        // Owned when the content was read rather than mapped
+        char *mBuffer;
+    };
+
+    /**
+     * The name of the pack opened by getDefault() when none was set. It is
+     * looked for with CCFileUtils, next to the res directory.
+     */
+    static const char *DEFAULT_PACK_NAME;
+
+    ~AssetPack();
+
+    /**
+     * Opens and maps an archive. Entry names are prefix followed by the
+     * path of the resource, e.g. "res/drawable-hdpi/icon.png". Returns NULL
+     * if the file is not a zip archive.
+     */
+    static shared_ptr<AssetPack> open(const char *path, const char *prefix = "");
+
+    /**
+     * Sets the pack resources are read from. Must be called before the first
+     * resource is loaded; NULL reads resources from the file system.
+     */
+    static void setDefault(shared_ptr<AssetPack> pack);
+
+    /**
+     * Returns the pack resources are read from, opening DEFAULT_PACK_NAME the
+     * first time if no pack was set. Returns NULL if there is none.
+     */
+    static shared_ptr<AssetPack> getDefault();
+
+    /**
+     * Returns true if the file is in the default pack or, without one, on the
+     * file system.
+     */
+    static bool isFileExist(const string &path);
+
+    /**
+     * Returns the content of a file of the default pack or, without one, of
+     * the file system. Returns NULL if the file does not exist.
+     */
+    static shared_ptr<Asset> getFileData(const string &path);
+
+    bool hasFile(const string &path) const;
+    shared_ptr<Asset> openAsset(const string &path) const;
+
+    const char *getPath() const { return mPath.c_str(); }
+
+private:
+
+    AssetPack(const char *path, const char *prefix);
+
+    android::ZipEntryRO findEntry(const string &path) const;
+
+    string mPath;
+    string mPrefix;
+    android::ZipFileRO mZip;
+    // The whole archive, stored entries point into it
+    android::FileMap *mMap;
+
+    static mutex s_lock;
+    static shared_ptr<AssetPack> s_default;
+    static bool s_defaultSet;
+};
+
+ANDROID_END
+
+#endif /* defined(__Androidpp__AssetPack__) */
@@ -22,7 +22,7 @@
 ANDROID_BEGIN
 
 vector<vector<int>> ColorStateList::EMPTY = vector<vector<int>> { vector<int>(0) };
-map<int, shared_ptr<ColorStateList>> ColorStateList::sCache = map<int, shared_ptr<ColorStateList>>();
+HashMap<int, shared_ptr<ColorStateList>> ColorStateList::sCache = HashMap<int, shared_ptr<ColorStateList>>();
 
 ColorStateList::ColorStateList(vector<vector<int>> states, vector<int> colors) {
     mStateSpecs = states;
@@ -11,6 +11,8 @@
 
 #include "AndroidMacros.h"
 
+#include "Android/utils/HashMap.h"
+
 #include <vector>
 #include <map>
 #include <string>
@@ -60,7 +62,7 @@ private:
     int mDefaultColor = 0xffff0000;
     
     static vector<vector<int>> EMPTY;
-    static map<int, shared_ptr<ColorStateList>> sCache;
+    static HashMap<int, shared_ptr<ColorStateList>> sCache;
     
 public:
     
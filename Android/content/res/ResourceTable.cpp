@@ -0,0 +1,223 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "ResourceTable.h"
+
+#include "cocos2d.h"
+
+#include <string.h>
+
+ANDROID_BEGIN
+
+const char *ResourceTable::TABLE_PATH = "res/resources.table";
+
+ResourceTable::ResourceTable(shared_ptr<AssetPack::Asset> asset) : mAsset(asset),
+        mData(asset->getBuffer()), mLength(asset->getLength()) {
+}
+
+shared_ptr<ResourceTable> ResourceTable::load(const char *path) {
+
+    shared_ptr<AssetPack::Asset> asset = AssetPack::getFileData(path);
+    if (asset == NULL) {
+        return NULL;
+    }
+
+    shared_ptr<ResourceTable> table(new ResourceTable(asset));
+    if (!table->validate()) {
+        CCLOG("Ignoring invalid resource table %s", path);
+        return NULL;
+    }
+
+    return table;
+}
+
+bool ResourceTable::validate() const {
+
+    // Checked once so that lookups can trust every offset
+    const size_t typesOffset = sizeof(Header);
+    if (mLength < typesOffset + TYPE_COUNT * sizeof(Type) || ((uintptr_t) mData & 3) != 0) {
+        return false;
+    }
+
+    const Header *header = at<Header>(0);
+    if (header->magic != MAGIC || header->version != VERSION) {
+        return false;
+    }
+
+    if (header->stringPoolOffset > mLength ||
+            header->stringCount > (mLength - header->stringPoolOffset) / sizeof(StringEntry)) {
+        return false;
+    }
+
+    const StringEntry *strings = at<StringEntry>(header->stringPoolOffset);
+    for (uint32_t i = 0; i < header->stringCount; i++) {
+        if ((strings[i].offset & 1) != 0 || strings[i].offset > mLength ||
+                strings[i].length >= (mLength - strings[i].offset) / sizeof(UChar)) {
+            return false;
+        }
+    }
+
+    static const size_t valueSizes[TYPE_COUNT] = {
+        sizeof(uint32_t), sizeof(uint32_t), sizeof(Dimension), 0
+    };
+
+    for (int i = 0; i < TYPE_COUNT; i++) {
+        const Type *type = at<Type>(typesOffset + i * sizeof(Type));
+
+        if ((type->namesOffset & 3) != 0 || type->namesOffset > mLength ||
+                type->count > (mLength - type->namesOffset) / sizeof(uint32_t)) {
+            return false;
+        }
+
+        const uint32_t *names = at<uint32_t>(type->namesOffset);
+        for (uint32_t j = 0; j < type->count; j++) {
+            if (names[j] >= mLength || !memchr(mData + names[j], '\0', mLength - names[j])) {
+                return false;
+            }
+        }
+
+        if (valueSizes[i] == 0) continue;
+
+        if ((type->valuesOffset & 3) != 0 || type->valuesOffset > mLength ||
+                type->count > (mLength - type->valuesOffset) / valueSizes[i]) {
+            return false;
+        }
+
+        if (i + 1 == TYPE_STRING) {
+            const uint32_t *values = at<uint32_t>(type->valuesOffset);
+            for (uint32_t j = 0; j < type->count; j++) {
+                if (values[j] >= header->stringCount) {
+                    return false;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+const ResourceTable::Type *ResourceTable::getTypeEntry(int id) const {
+
+    const int type = getType(id);
+    if (((id >> 24) & 0xFF) != PACKAGE_ID || type < 1 || type > TYPE_COUNT) {
+        return NULL;
+    }
+
+    const Type *entry = at<Type>(sizeof(Header) + (type - 1) * sizeof(Type));
+    if ((uint32_t) getIndex(id) >= entry->count) {
+        return NULL;
+    }
+
+    return entry;
+}
+
+int ResourceTable::getCount(int type) const {
+    if (type < 1 || type > TYPE_COUNT) {
+        return 0;
+    }
+
+    return at<Type>(sizeof(Header) + (type - 1) * sizeof(Type))->count;
+}
+
+int ResourceTable::getIdentifier(int type, const char *name, size_t length) const {
+
+    if (type < 1 || type > TYPE_COUNT) {
+        return 0;
+    }
+
+    const Type *entry = at<Type>(sizeof(Header) + (type - 1) * sizeof(Type));
+    const uint32_t *names = at<uint32_t>(entry->namesOffset);
+
+    // The names are sorted by the compiler
+    int low = 0;
+    int high = (int) entry->count - 1;
+
+    while (low <= high) {
+        const int mid = (low + high) >> 1;
+        const char *candidate = mData + names[mid];
+
+        int cmp = strncmp(candidate, name, length);
+        if (cmp == 0 && candidate[length] != '\0') {
+            cmp = 1;
+        }
+
+        if (cmp < 0) {
+            low = mid + 1;
+        } else if (cmp > 0) {
+            high = mid - 1;
+        } else {
+            return makeId(type, mid);
+        }
+    }
+
+    return 0;
+}
+
+const char *ResourceTable::getName(int id) const {
+    const Type *entry = getTypeEntry(id);
+    if (!entry) {
+        return NULL;
+    }
+
+    return mData + at<uint32_t>(entry->namesOffset)[getIndex(id)];
+}
+
+bool ResourceTable::getColor(int id, int &color) const {
+    if (getType(id) != TYPE_COLOR) {
+        return false;
+    }
+
+    const Type *entry = getTypeEntry(id);
+    if (!entry) {
+        return false;
+    }
+
+    color = (int) at<uint32_t>(entry->valuesOffset)[getIndex(id)];
+    return true;
+}
+
+bool ResourceTable::getDimension(int id, float &value, int &unit) const {
+    if (getType(id) != TYPE_DIMEN) {
+        return false;
+    }
+
+    const Type *entry = getTypeEntry(id);
+    if (!entry) {
+        return false;
+    }
+
+    const Dimension &dimension = at<Dimension>(entry->valuesOffset)[getIndex(id)];
+    value = dimension.value;
+    unit = dimension.unit;
+    return true;
+}
+
+const UChar *ResourceTable::getString(int id, int32_t &length) const {
+    if (getType(id) != TYPE_STRING) {
+        return NULL;
+    }
+
+    const Type *entry = getTypeEntry(id);
+    if (!entry) {
+        return NULL;
+    }
+
+    const uint32_t index = at<uint32_t>(entry->valuesOffset)[getIndex(id)];
+    const StringEntry &string = at<StringEntry>(at<Header>(0)->stringPoolOffset)[index];
+
+    length = string.length;
+    return at<UChar>(string.offset);
+}
+
+ANDROID_END
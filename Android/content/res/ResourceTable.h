@@ -0,0 +1,139 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __Androidpp__ResourceTable__
+#define __Androidpp__ResourceTable__
+
+#include "AndroidMacros.h"
+
+#include "Android/content/res/AssetPack.h"
+
+#include <unicode/utypes.h>
+
+#include <memory>
+#include <stdint.h>
+
+using namespace std;
+
+ANDROID_BEGIN
+
+/**
+ * The values compiled by tools/rescompile.py: strings, colors, dimensions and
+ * drawable names, found by the integer ids of the generated R header. Values
+ * are parsed when the table is compiled and read in place, from the resource
+ * pack when there is one.
+ *
+ * An id is 0x7fTTIIII: TT is the type and IIII the index of the name among
+ * the sorted names of the type.
+ */
+class ResourceTable {
+
+public:
+
+    static const int TYPE_STRING = 1;
+    static const int TYPE_COLOR = 2;
+    static const int TYPE_DIMEN = 3;
+    static const int TYPE_DRAWABLE = 4;
+
+    static const int PACKAGE_ID = 0x7f;
+
+    /**
+     * Where Resources looks for the table.
+     */
+    static const char *TABLE_PATH;
+
+    /**
+     * Loads a table with AssetPack. Returns NULL if there is none or if it
+     * is not a valid table.
+     */
+    static shared_ptr<ResourceTable> load(const char *path);
+
+    static int getType(int id) { return (id >> 16) & 0xFF; }
+    static int getIndex(int id) { return id & 0xFFFF; }
+    static int makeId(int type, int index) { return (PACKAGE_ID << 24) | (type << 16) | index; }
+
+    /**
+     * Returns the number of resources of a type; ids of the type are
+     * 0x7fTT0000 to 0x7fTT0000 + count - 1.
+     */
+    int getCount(int type) const;
+
+    /**
+     * Returns the id of a resource, 0 if there is none.
+     */
+    int getIdentifier(int type, const char *name, size_t length) const;
+
+    /**
+     * Returns the name of a resource, NULL if the id is not valid.
+     */
+    const char *getName(int id) const;
+
+    bool getColor(int id, int &color) const;
+    bool getDimension(int id, float &value, int &unit) const;
+
+    /**
+     * Returns a NUL terminated UTF-16 string of length UTF-16 units, NULL
+     * if the id is not valid. The string lives as long as the table.
+     */
+    const UChar *getString(int id, int32_t &length) const;
+
+private:
+
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t stringPoolOffset;
+        uint32_t stringCount;
+    };
+
+    struct Type {
+        uint32_t count;
+        // Offsets of the names, sorted
+        uint32_t namesOffset;
+        // Parsed values, in the order of the names
+        uint32_t valuesOffset;
+    };
+
+    struct StringEntry {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct Dimension {
+        float value;
+        uint32_t unit;
+    };
+
+    static const int TYPE_COUNT = 4;
+    static const uint32_t MAGIC = 0x4C425452;
+    static const uint32_t VERSION = 1;
+
+    ResourceTable(shared_ptr<AssetPack::Asset> asset);
+
+    bool validate() const;
+    const Type *getTypeEntry(int id) const;
+
+    template<typename T>
+    const T *at(uint32_t offset) const {
+        return (const T*) (mData + offset);
+    }
+
+    shared_ptr<AssetPack::Asset> mAsset;
+    const char *mData;
+    size_t mLength;
+};
+
+ANDROID_END
+
+#endif /* defined(__Androidpp__ResourceTable__) */
@@ -8,6 +8,9 @@
 
 #include "Resources.h"
 
+#include "Android/content/Context.h"
+#include "Android/content/res/AssetPack.h"
+#include "Android/content/res/ResourceTable.h"
 #include "Android/content/res/ColorStateList.h"
 #include "Android/utils/CCPullParser.h"
 #include "Android/graphics/drawable/BitmapDrawable.h"
@@ -16,6 +19,7 @@
 #include "Android/text/String.h"
 #include "Android/utils/AttributeSet.h"
 #include "Android/utils/System.h"
+#include "Android/utils/TypedValue.h"
 
 #include <unicode/unistr.h>
 
@@ -33,10 +37,28 @@ map<int, string> Resources::s_resolutions = {
     {480, "-xxhdpi"}
 };
 
-map<string, string> Resources::s_drawables = map<string, string>();
-map<string, string> Resources::s_strings = map<string, string>();
-map<string, string> Resources::s_colors = map<string, string>();
-map<string, shared_ptr<ColorStateList>> Resources::s_colorStateLists = map<string, shared_ptr<ColorStateList>>();
+HashMap<string, string> Resources::s_drawables = HashMap<string, string>();
+HashMap<string, string> Resources::s_strings = HashMap<string, string>();
+HashMap<string, string> Resources::s_colors = HashMap<string, string>();
+HashMap<string, shared_ptr<ColorStateList>> Resources::s_colorStateLists = HashMap<string, shared_ptr<ColorStateList>>();
+shared_ptr<ResourceTable> Resources::s_table;
+bool Resources::s_tableLoaded = false;
+
+/**
+ * Forwards trim requests to the lookups shared by every Resources object.
+ */
+class ResourcesCallbacks : public ComponentCallbacks2 {
+public:
+    virtual void onTrimMemory(int level) {
+        Resources::trimMemory(level);
+    }
+    
+    virtual void getMemoryUsage(vector<MemoryUsage> &usage) {
+        Resources::getMemoryUsage(usage);
+    }
+};
+
+static ResourcesCallbacks s_callbacks;
 
 Resources::Resources(int width, int height, int densityDpi) : m_displayMetrics() {
     m_displayMetrics.widthPixels = width;
@@ -48,8 +70,15 @@ Resources::Resources(int width, int height, int densityDpi) : m_displayMetrics()
     m_displayMetrics.ydpi = densityDpi;
     mConfiguration.setToDefaults();
     
-    loadStrings();
-    loadColors();
+    loadTable();
+    
+    // Without a compiled table the values are parsed from their XML
+    if (s_table == NULL) {
+        loadStrings();
+        loadColors();
+    }
+    
+    Context::registerComponentCallbacks(&s_callbacks);
 }
 
 Resources::~Resources() {
@@ -58,7 +87,7 @@ Resources::~Resources() {
 
 shared_ptr<ColorStateList> Resources::getCachedColorStateList(string key) {
     // Check our cache first
-    map<string, shared_ptr<ColorStateList>>::iterator cached = s_colorStateLists.find(key);
+    HashMap<string, shared_ptr<ColorStateList>>::iterator cached = s_colorStateLists.find(key);
     if (cached != s_colorStateLists.end()) {
         return cached->second;
     }
@@ -68,8 +97,14 @@ shared_ptr<ColorStateList> Resources::getCachedColorStateList(string key) {
 
 int Resources::getColor(string colorId) {
     
+    if (s_table != NULL) {
+        int id = colorId.compare(0, 7, "@color/") == 0 ? getIdentifier(colorId) :
+                s_table->getIdentifier(ResourceTable::TYPE_COLOR, colorId.c_str(), colorId.size());
+        return getColor(id);
+    }
+    
     // Check our cache first
-    map<string, string>::iterator cached = s_colors.find(colorId);
+    HashMap<string, string>::iterator cached = s_colors.find(colorId);
     if (cached != s_colors.end()) {
         return Color::parseColor(cached->second);
     }
@@ -134,12 +169,10 @@ shared_ptr<Drawable> Resources::getDrawable(string name) {
         
         name = name.substr(10, name.size());
         
-        cocos2d::CCFileUtils *fileUtils = cocos2d::CCFileUtils::sharedFileUtils();
-        
         string tempPath("res/drawable/" + name + ".xml");
         
         // TODO: deal with xml drawables
-        if (fileUtils->isFileExist(tempPath)) {
+        if (AssetPack::isFileExist(tempPath)) {
             
             CCPullParser parser = CCPullParser();
             
@@ -167,10 +200,9 @@ shared_ptr<Drawable> Resources::getDrawable(string name) {
 string Resources::getBitmapPath(string name) {
     
     int dpi = getDisplayMetrics().densityDpi;
-    cocos2d::CCFileUtils *fileUtils = cocos2d::CCFileUtils::sharedFileUtils();
     
     // Check our cache first
-    map<string, string>::iterator cached = s_drawables.find(name);
+    HashMap<string, string>::iterator cached = s_drawables.find(name);
     if (cached != s_drawables.end()) {
         return cached->second;
     }
@@ -179,13 +211,14 @@ string Resources::getBitmapPath(string name) {
     string path;
     typedef map<int, string>::iterator it_type;
     
-    // Find the highest resolution resource we have
+    // Find the highest resolution resource we have, with a pack each probe
+    // is a lookup in its hashed index rather than a stat
     for (it_type iterator = s_resolutions.begin(); iterator != s_resolutions.end(); iterator++) {
         
         int distance = abs(iterator->first - dpi);
         string tempPath("res/drawable" + iterator->second + "/" + name + ".png");
         
-        if (closest > distance && fileUtils->isFileExist(tempPath)) {
+        if (closest > distance && AssetPack::isFileExist(tempPath)) {
             closest = distance;
             path = tempPath;
         }
@@ -202,10 +235,47 @@ Configuration Resources::getConfiguration() {
     return mConfiguration;
 }
 
+void Resources::trimMemory(int level) {
+    // Color state lists are also held by the views using them
+    if (level >= ComponentCallbacks2::TRIM_MEMORY_BACKGROUND) {
+        s_colorStateLists.clear();
+    }
+    
+    // Rebuilding the drawable paths means probing the file system again
+    if (level >= ComponentCallbacks2::TRIM_MEMORY_MODERATE) {
+        s_drawables.clear();
+    }
+}
+
+void Resources::getMemoryUsage(vector<ComponentCallbacks2::MemoryUsage> &usage) {
+    // Every slot of a table holds an entry and its hash, used or not
+    size_t drawables = s_drawables.capacity() * (sizeof(HashMap<string, string>::Entry) + sizeof(uint32_t));
+    for (HashMap<string, string>::iterator it = s_drawables.begin(); it != s_drawables.end(); ++it) {
+        drawables += it->first.capacity() + it->second.capacity();
+    }
+    ComponentCallbacks2::MemoryUsage drawablesUsage = { "Resources drawables", drawables };
+    usage.push_back(drawablesUsage);
+    
+    size_t colorStateLists = s_colorStateLists.capacity() *
+            (sizeof(HashMap<string, shared_ptr<ColorStateList>>::Entry) + sizeof(uint32_t));
+    for (HashMap<string, shared_ptr<ColorStateList>>::iterator it = s_colorStateLists.begin();
+            it != s_colorStateLists.end(); ++it) {
+        colorStateLists += it->first.capacity() + sizeof(ColorStateList);
+    }
+    ComponentCallbacks2::MemoryUsage colorStateListsUsage = { "Resources color state lists", colorStateLists };
+    usage.push_back(colorStateListsUsage);
+}
+
 string Resources::getString(string stringId) {
     
+    if (s_table != NULL) {
+        int id = stringId.compare(0, 8, "@string/") == 0 ? getIdentifier(stringId) :
+                s_table->getIdentifier(ResourceTable::TYPE_STRING, stringId.c_str(), stringId.size());
+        return getString(id);
+    }
+    
     // Check our cache first
-    map<string, string>::iterator cached = s_strings.find(stringId);
+    HashMap<string, string>::iterator cached = s_strings.find(stringId);
     if (cached != s_strings.end()) {
         return cached->second;
     }
@@ -214,6 +284,13 @@ string Resources::getString(string stringId) {
 }
 
 shared_ptr<CharSequence> Resources::getText(string resId) {
+    
+    if (s_table != NULL) {
+        int id = resId.compare(0, 8, "@string/") == 0 ? getIdentifier(resId) :
+                s_table->getIdentifier(ResourceTable::TYPE_STRING, resId.c_str(), resId.size());
+        return getText(id);
+    }
+    
     string value = getString(resId);
     
     UnicodeString val = System::convert(value);
@@ -221,6 +298,102 @@ shared_ptr<CharSequence> Resources::getText(string resId) {
     return make_shared<String>(val);
 }
 
+int Resources::getIdentifier(const string &name) {
+    
+    if (s_table == NULL) return 0;
+    
+    size_t start = name.compare(0, 1, "@") == 0 ? 1 : 0;
+    size_t slash = name.find('/', start);
+    if (slash == string::npos) return 0;
+    
+    int type;
+    size_t length = slash - start;
+    if (name.compare(start, length, "string") == 0) {
+        type = ResourceTable::TYPE_STRING;
+    } else if (name.compare(start, length, "color") == 0) {
+        type = ResourceTable::TYPE_COLOR;
+    } else if (name.compare(start, length, "dimen") == 0) {
+        type = ResourceTable::TYPE_DIMEN;
+    } else if (name.compare(start, length, "drawable") == 0) {
+        type = ResourceTable::TYPE_DRAWABLE;
+    } else {
+        return 0;
+    }
+    
+    return s_table->getIdentifier(type, name.c_str() + slash + 1, name.size() - slash - 1);
+}
+
+int Resources::getColor(int id) {
+    int color;
+    if (s_table != NULL && s_table->getColor(id, color)) {
+        return color;
+    }
+    
+    return -1;
+}
+
+string Resources::getString(int id) {
+    int32_t length;
+    const UChar *chars = s_table != NULL ? s_table->getString(id, length) : NULL;
+    if (!chars) return string();
+    
+    return System::convert(chars, length);
+}
+
+shared_ptr<CharSequence> Resources::getText(int id) {
+    int32_t length;
+    const UChar *chars = s_table != NULL ? s_table->getString(id, length) : NULL;
+    if (!chars) return make_shared<String>();
+    
+    return make_shared<String>(UnicodeString(chars, length));
+}
+
+shared_ptr<Drawable> Resources::getDrawable(int id) {
+    if (s_table == NULL || ResourceTable::getType(id) != ResourceTable::TYPE_DRAWABLE) return NULL;
+    
+    const char *name = s_table->getName(id);
+    if (!name) return NULL;
+    
+    return getDrawable(string("@drawable/") + name);
+}
+
+float Resources::getDimension(int id) {
+    if (ResourceTable::getType(id) != ResourceTable::TYPE_DIMEN) return 0;
+    
+    size_t index = ResourceTable::getIndex(id);
+    return index < m_dimensions.size() ? m_dimensions[index] : 0;
+}
+
+int Resources::getDimensionPixelSize(int id) {
+    float value = getDimension(id);
+    
+    int size = (int) (value + 0.5f);
+    if (size != 0) return size;
+    if (value == 0) return 0;
+    return value > 0 ? 1 : -1;
+}
+
+void Resources::loadTable() {
+    
+    if (!s_tableLoaded) {
+        s_tableLoaded = true;
+        s_table = ResourceTable::load(ResourceTable::TABLE_PATH);
+    }
+    
+    if (s_table == NULL) return;
+    
+    // Converted once for the density of these resources
+    int count = s_table->getCount(ResourceTable::TYPE_DIMEN);
+    m_dimensions.resize(count);
+    
+    for (int i = 0; i < count; i++) {
+        float value;
+        int unit;
+        s_table->getDimension(ResourceTable::makeId(ResourceTable::TYPE_DIMEN, i), value, unit);
+        m_dimensions[i] = TypedValue::applyDimension(unit, value, m_displayMetrics);
+    }
+}
+
 void Resources::loadStrings() {
     loadValues("res/values/strings.xml", s_strings, "string");
 }
@@ -229,7 +402,7 @@ void Resources::loadColors() {
     loadValues("res/values/color.xml", s_colors, "color");
 }
 
-void Resources::loadValues(const char* file, map<string, string> &map, const char* type) {
+void Resources::loadValues(const char* file, HashMap<string, string> &map, const char* type) {
     
     CCPullParser parser = CCPullParser();
     
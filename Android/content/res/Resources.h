@@ -11,13 +11,16 @@
 
 #include "AndroidMacros.h"
 
+#include "Android/content/ComponentCallbacks2.h"
 #include "Android/text/CharSequence.h"
 #include "Android/utils/DisplayMetrics.h"
+#include "Android/utils/HashMap.h"
 #include "Android/content/res/Configuration.h"
 
 #include <string>
 #include <map>
 #include <memory>
+#include <vector>
 
 using namespace std;
 
@@ -26,6 +29,7 @@ ANDROID_BEGIN
 class ColorStateList;
 class Drawable;
 class AttributeSet;
+class ResourceTable;
 
 class Resources {
 public:
@@ -41,6 +45,35 @@ public:
     shared_ptr<CharSequence> getText(string resId);
     shared_ptr<ColorStateList> getColorStateList(string colorStateListId);
     
+    /**
+     * Return the identifier of a compiled resource from its reference, such
+     * as "@color/gray1" or "color/gray1". Returns 0 if there is no compiled
+     * resource table or no such resource.
+     */
+    int getIdentifier(const string &name);
+    
+    /**
+     * Accessors for the resources compiled by tools/rescompile.py, by the
+     * ids of the generated R header. Values are read from the table without
+     * being parsed.
+     */
+    int getColor(int id);
+    string getString(int id);
+    shared_ptr<CharSequence> getText(int id);
+    shared_ptr<Drawable> getDrawable(int id);
+    
+    /**
+     * Return the dimension of a compiled resource in pixels for the density
+     * of these resources, 0 if the id is not valid.
+     */
+    float getDimension(int id);
+    
+    /**
+     * Return the dimension of a compiled resource as a size in pixels: it is
+     * rounded, and a non zero dimension is at least one pixel.
+     */
+    int getDimensionPixelSize(int id);
+    
     /**
      * Return the current configuration that is in effect for this resource
      * object.  The returned object should be treated as read-only.
@@ -49,20 +82,36 @@ public:
      */
     Configuration getConfiguration();
     
+    /**
+     * Releases the lookups shared by every Resources object. They are rebuilt
+     * on demand.
+     */
+    static void trimMemory(int level);
+    
+    /**
+     * Appends an estimate of the memory held by the shared lookups.
+     */
+    static void getMemoryUsage(vector<ComponentCallbacks2::MemoryUsage> &usage);
+    
 private:
     
-    static map<string, string> s_drawables;
+    static HashMap<string, string> s_drawables;
     static map<int, string> s_resolutions;
-    static map<string, string> s_strings;
-    static map<string, string> s_colors;
-    static map<string, shared_ptr<ColorStateList>> s_colorStateLists;
+    static HashMap<string, string> s_strings;
+    static HashMap<string, string> s_colors;
+    static HashMap<string, shared_ptr<ColorStateList>> s_colorStateLists;
+    static shared_ptr<ResourceTable> s_table;
+    static bool s_tableLoaded;
     
     DisplayMetrics m_displayMetrics;
+    // The dimensions of the table in pixels, indexed as the table
+    vector<float> m_dimensions;
     
     shared_ptr<ColorStateList> getCachedColorStateList(string key);
     void loadStrings();
     void loadColors();
-    void loadValues(const char* file, map<string, string> &map, const char* type);
+    void loadTable();
+    void loadValues(const char* file, HashMap<string, string> &map, const char* type);
     Configuration mConfiguration = Configuration();
 };
 
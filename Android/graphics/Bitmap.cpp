@@ -8,10 +8,14 @@
 
 #include "Bitmap.h"
 
+#include "Android/graphics/PixelKernels.h"
 #include "Android/utils/Exceptions.h"
 
+#include <SkCanvas.h>
 #include <SkDither.h>
 
+#include <algorithm>
+
 ANDROID_BEGIN
 
 /**
@@ -143,6 +147,8 @@ Bitmap::FromColorProc Bitmap::ChooseFromColorProc(Config config) {
             return FromColor_D4444;
         case SkBitmap::kRGB_565_Config:
             return FromColor_D565;
+        case SkBitmap::kA8_Config:
+            return FromColor_DA8;
         default:
             break;
     }
@@ -151,34 +157,237 @@ Bitmap::FromColorProc Bitmap::ChooseFromColorProc(Config config) {
 
 void Bitmap::FromColor_D32(void* dst, const SkColor src[], int width,
                           int, int) {
-    SkPMColor* d = (SkPMColor*)dst;
-    
-    for (int i = 0; i < width; i++) {
-        *d++ = SkPreMultiplyColor(*src++);
-    }
+    PixelKernels::premultiply((SkPMColor*) dst, src, width);
 }
 
 void Bitmap::FromColor_D565(void* dst, const SkColor src[], int width,
                            int x, int y) {
-    uint16_t* d = (uint16_t*)dst;
-    
-    DITHER_565_SCAN(y);
-    for (int stop = x + width; x < stop; x++) {
-        SkColor c = *src++;
-        *d++ = SkDitherRGBTo565(SkColorGetR(c), SkColorGetG(c), SkColorGetB(c),
-                                DITHER_VALUE(x));
-    }
+    PixelKernels::colorTo565((uint16_t*) dst, src, width, x, y);
 }
 
 void Bitmap::FromColor_D4444(void* dst, const SkColor src[], int width,
                             int x, int y) {
     SkPMColor16* d = (SkPMColor16*)dst;
     
-    DITHER_4444_SCAN(y);
-    for (int stop = x + width; x < stop; x++) {
-        SkPMColor c = SkPreMultiplyColor(*src++);
-        *d++ = SkDitherARGB32To4444(c, DITHER_VALUE(x));
-        //        *d++ = SkPixel32ToPixel4444(c);
+    // Premultiplied a run at a time so the 4444 kernel sees PM colors
+    SkPMColor buffer[128];
+    while (width > 0) {
+        const int count = min(width, 128);
+        PixelKernels::premultiply(buffer, src, count);
+        PixelKernels::pmColorTo4444(d, buffer, count, x, y);
+        src += count;
+        d += count;
+        x += count;
+        width -= count;
+    }
+}
+
+void Bitmap::FromColor_DA8(void* dst, const SkColor src[], int width,
+                          int, int) {
+    uint8_t* d = (uint8_t*)dst;
+    
+    for (int i = 0; i < width; i++) {
+        *d++ = SkColorGetA(*src++);
+    }
+}
+
+void Bitmap::checkPixelsAccess(int x, int y, int width, int height, int offset, int stride) {
+    if (x < 0) {
+        throw new IllegalArgumentException("x must be >= 0");
+    }
+    if (y < 0) {
+        throw new IllegalArgumentException("y must be >= 0");
+    }
+    if (x + width > getWidth()) {
+        throw new IllegalArgumentException("x + width must be <= bitmap.width()");
+    }
+    if (y + height > getHeight()) {
+        throw new IllegalArgumentException("y + height must be <= bitmap.height()");
+    }
+    if (abs(stride) < width) {
+        throw new IllegalArgumentException("abs(stride) must be >= width");
+    }
+    if (offset < 0 || offset + (height - 1) * stride < 0) {
+        throw new IllegalArgumentException("offset is out of the pixels array");
+    }
+}
+
+void Bitmap::getPixels(SkColor *pixels, int offset, int stride,
+                       int x, int y, int width, int height) {
+    checkPixelsAccess(x, y, width, height, offset, stride);
+    if (width == 0 || height == 0) {
+        return;
+    }
+    
+    SkAutoLockPixels alp(*this);
+    if (getPixels() == NULL) {
+        return;
+    }
+    
+    SkColor* dst = pixels + offset;
+    for (int row = y; row < y + height; row++) {
+        if (config() == kARGB_8888_Config) {
+            PixelKernels::unpremultiply(dst, getAddr32(x, row), width);
+        } else {
+            for (int i = 0; i < width; i++) {
+                dst[i] = getColor(x + i, row);
+            }
+        }
+        dst += stride;
+    }
+}
+
+Bitmap *Bitmap::copy(Config config) {
+    SkAutoLockPixels alp(*this);
+    
+    Bitmap *bitmap = new Bitmap();
+    bitmap->mDensity = mDensity;
+    
+    const bool convert = this->config() == kARGB_8888_Config && getPixels() != NULL &&
+            (config == kARGB_8888_Config || config == kRGB_565_Config ||
+             config == kARGB_4444_Config || config == kA8_Config);
+    if (!convert) {
+        if (!copyTo(bitmap, config)) {
+            delete bitmap;
+            return NULL;
+        }
+        return bitmap;
+    }
+    
+    bitmap->setConfig(config, width(), height());
+    if (!bitmap->allocPixels()) {
+        delete bitmap;
+        return NULL;
+    }
+    
+    for (int y = 0; y < height(); y++) {
+        const SkPMColor* src = getAddr32(0, y);
+        switch (config) {
+            case kARGB_8888_Config:
+                memcpy(bitmap->getAddr32(0, y), src, width() * sizeof(SkPMColor));
+                break;
+            case kRGB_565_Config:
+                PixelKernels::pmColorTo565(bitmap->getAddr16(0, y), src, width(), 0, y);
+                break;
+            case kARGB_4444_Config:
+                PixelKernels::pmColorTo4444((SkPMColor16*) bitmap->getAddr16(0, y), src,
+                                            width(), 0, y);
+                break;
+            default:
+                PixelKernels::pmColorToA8(bitmap->getAddr8(0, y), src, width());
+                break;
+        }
+    }
+    
+    if (config == kRGB_565_Config) {
+        bitmap->setIsOpaque(true);
+    } else if (config != kA8_Config) {
+        bitmap->setIsOpaque(isOpaque());
+    }
+    bitmap->notifyPixelsChanged();
+    
+    return bitmap;
+}
+
+Bitmap *Bitmap::createScaledBitmap(Bitmap *src, int dstWidth, int dstHeight, bool filter) {
+    if (dstWidth <= 0 || dstHeight <= 0) {
+        throw new IllegalArgumentException("width and height must be > 0");
+    }
+    
+    if (src->width() == dstWidth && src->height() == dstHeight) {
+        return src->copy(src->config());
+    }
+    
+    SkAutoLockPixels alp(*src);
+    
+    Bitmap *bitmap = new Bitmap();
+    bitmap->mDensity = src->mDensity;
+    bitmap->setConfig(src->config(), dstWidth, dstHeight);
+    if (!bitmap->allocPixels()) {
+        delete bitmap;
+        return NULL;
+    }
+    
+    if (src->config() != kARGB_8888_Config || src->getPixels() == NULL) {
+        bitmap->eraseColor(0);
+        
+        SkPaint paint;
+        paint.setFilterBitmap(filter);
+        
+        SkCanvas canvas(*bitmap);
+        canvas.drawBitmapRect(*src, NULL, SkRect::MakeWH(dstWidth, dstHeight), &paint);
+        
+        bitmap->setIsOpaque(src->isOpaque());
+        return bitmap;
+    }
+    
+    // Halving with a box filter keeps every source pixel in the result,
+    // bilinear filtering alone skips pixels past a 2x reduction
+    const SkBitmap* level = src;
+    SkBitmap levels[2];
+    for (int step = 0; filter && level->width() >= dstWidth * 2 &&
+            level->height() >= dstHeight * 2; step++) {
+        SkBitmap &next = levels[step & 1];
+        next.reset();
+        next.setConfig(kARGB_8888_Config, level->width() / 2, level->height() / 2);
+        if (!next.allocPixels()) {
+            break;
+        }
+        
+        for (int y = 0; y < next.height(); y++) {
+            PixelKernels::downscale2x(next.getAddr32(0, y), level->getAddr32(0, 2 * y),
+                                      level->getAddr32(0, 2 * y + 1), next.width());
+        }
+        level = &next;
+    }
+    
+    resample(*level, *bitmap, filter);
+    
+    bitmap->setIsOpaque(src->isOpaque());
+    bitmap->notifyPixelsChanged();
+    
+    return bitmap;
+}
+
+void Bitmap::resample(const SkBitmap &src, const SkBitmap &dst, bool filter) {
+    const int srcWidth = src.width();
+    const int srcHeight = src.height();
+    const int dstWidth = dst.width();
+    const int dstHeight = dst.height();
+    
+    if (srcWidth == dstWidth && srcHeight == dstHeight) {
+        for (int y = 0; y < dstHeight; y++) {
+            memcpy(dst.getAddr32(0, y), src.getAddr32(0, y), dstWidth * sizeof(SkPMColor));
+        }
+        return;
+    }
+    
+    // Steps in 16.16 fixed point, sampling at the center of the pixels
+    const int32_t dx = (int32_t) (((int64_t) srcWidth << 16) / dstWidth);
+    const int32_t dy = (int32_t) (((int64_t) srcHeight << 16) / dstHeight);
+    
+    if (!filter) {
+        for (int y = 0; y < dstHeight; y++) {
+            const int sy = min((int) ((y * (int64_t) dy + (dy >> 1)) >> 16), srcHeight - 1);
+            const SkPMColor* row = src.getAddr32(0, sy);
+            SkPMColor* d = dst.getAddr32(0, y);
+            int32_t sx = dx >> 1;
+            for (int x = 0; x < dstWidth; x++, sx += dx) {
+                d[x] = row[min(sx >> 16, srcWidth - 1)];
+            }
+        }
+        return;
+    }
+    
+    const int32_t maxY = (srcHeight - 1) << 16;
+    int32_t sy = (dy >> 1) - 0x8000;
+    for (int y = 0; y < dstHeight; y++, sy += dy) {
+        const int32_t clamped = max(0, min(sy, maxY));
+        const int y0 = clamped >> 16;
+        const int y1 = min(y0 + 1, srcHeight - 1);
+        PixelKernels::bilinearRow(dst.getAddr32(0, y), src.getAddr32(0, y0), src.getAddr32(0, y1),
+                                  srcWidth, (dx >> 1) - 0x8000, dx, (clamped >> 8) & 0xFF,
+                                  dstWidth);
     }
 }
 
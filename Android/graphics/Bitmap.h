@@ -38,8 +38,36 @@ public:
     int getScaledHeight(DisplayMetrics *metrics);
     bool hasAlpha() { return !isOpaque(); }
     
+    using SkBitmap::getPixels;
+    
+    /**
+     * Returns in pixels[] a copy of the data in the bitmap, as unpremultiplied
+     * colors. Row i of the area is written at pixels[offset + i * stride].
+     *
+     * @throws IllegalArgumentException if the area is not inside the bitmap
+     */
+    void getPixels(SkColor *pixels, int offset, int stride,
+                   int x, int y, int width, int height);
+    
+    /**
+     * Returns a copy of this bitmap converted to the specified config, or
+     * NULL if the conversion is not supported or memory runs out. The caller
+     * owns the copy.
+     */
+    Bitmap *copy(Config config);
+    
     static Bitmap *createBitmap(int width, int height, Config config);
     
+    /**
+     * Returns a new bitmap scaled from src. When filtering, ARGB_8888 bitmaps
+     * are halved with a box filter while they are at least twice the
+     * requested size, then resampled bilinearly. The caller owns the bitmap,
+     * even when no scaling is needed.
+     *
+     * @throws IllegalArgumentException if the width or height are <= 0
+     */
+    static Bitmap *createScaledBitmap(Bitmap *src, int dstWidth, int dstHeight, bool filter);
+    
     static bool setPixels(const SkColor* src, int srcStride,
                                   int x, int y, int width, int height,
                                   const Bitmap& dstBitmap);
@@ -50,6 +78,8 @@ public:
                                int x, int y);
     static void FromColor_D4444(void* dst, const SkColor src[], int width,
                                 int x, int y);
+    static void FromColor_DA8(void* dst, const SkColor src[], int width,
+                              int x, int y);
     
     static int scaleFromDensity(int size, int sdensity, int tdensity);
     
@@ -70,6 +100,10 @@ private:
     static Bitmap *createBitmap(int width, int height, Config config, bool hasAlpha);
     static Bitmap *createBitmap(DisplayMetrics *display, int width, int height,
                                 Config config, bool hasAlpha);
+    
+    void checkPixelsAccess(int x, int y, int width, int height, int offset, int stride);
+    
+    static void resample(const SkBitmap &src, const SkBitmap &dst, bool filter);
 };
 
 ANDROID_END
@@ -13,6 +13,7 @@
 
 #include "cocos2d.h"
 
+#include "Android/content/res/AssetPack.h"
 #include "Android/graphics/Bitmap.h"
 
 #include <SkImageDecoder.h>
@@ -26,16 +27,12 @@ class BitmapFactory {
 public:
     static bool decodeFile(Bitmap *bitmap, const char* filePath) {
         
-        cocos2d::CCFileUtils *fileUtils = cocos2d::CCFileUtils::sharedFileUtils();
+        // Decoded straight from the resource pack when there is one
+        shared_ptr<AssetPack::Asset> asset = AssetPack::getFileData(filePath);
         
-        if (fileUtils->isFileExist(filePath)) {
-            unsigned long size = 0;
-            char* pBuffer = (char*) cocos2d::CCFileUtils::sharedFileUtils()->getFileData(filePath, "rt", &size);
-            
-            if (pBuffer && size > 0) {
-                SkImageDecoder::DecodeMemory(pBuffer, size, bitmap);
-                return !bitmap->pixelRef();
-            }
+        if (asset != NULL && asset->getLength() > 0) {
+            SkImageDecoder::DecodeMemory(asset->getBuffer(), asset->getLength(), bitmap);
+            return !bitmap->pixelRef();
         }
         
         return false;
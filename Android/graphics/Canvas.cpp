@@ -834,7 +834,7 @@ void Canvas::drawText(shared_ptr<CharSequence> text, int start, int end, float x
     } else if ((graphics = dynamic_pointer_cast<GraphicsOperations>(text)) != NULL) {
         graphics->drawText(shared_from_this(), start, end, x, y, paint);
     } else {
-        UnicodeString *buf = TextUtils::obtain(end - start);
+        shared_ptr<UnicodeString> buf = TextUtils::obtain(end - start);
         TextUtils::getChars(text, start, end, *buf, 0);
         drawText(buf->getBuffer(), start, end, x, y, paint);
         TextUtils::recycle(buf);
@@ -912,7 +912,7 @@ void Canvas::drawTextRun(shared_ptr<CharSequence> text, int start, int end,
     } else {
         int contextLen = contextEnd - contextStart;
         int len = end - start;
-        UnicodeString *buf = TextUtils::obtain(contextLen);
+        shared_ptr<UnicodeString> buf = TextUtils::obtain(contextLen);
         TextUtils::getChars(text, contextStart, contextEnd, *buf, 0);
         drawTextRun(buf->getBuffer(), start - contextStart, len,
                            0, contextLen, x, y, flags, paint);
@@ -36,7 +36,7 @@ const int Color::CYAN        = 0xFF00FFFF;
 const int Color::MAGENTA     = 0xFFFF00FF;
 const int Color::TRANSPARENT = 0;
 
-const map<string, int> Color::s_colorNameMap = {
+const HashMap<string, int> Color::s_colorNameMap = {
     {"black", BLACK},
     {"darkgray", DKGRAY},
     {"gray", GRAY},
@@ -237,10 +237,10 @@ int Color::parseColor(string colorString) {
         lower.resize(colorString.size());
         transform(colorString.begin(), colorString.end(), lower.begin(), ::tolower);
 
-        int color = s_colorNameMap.find(lower)->second;
+        HashMap<string, int>::const_iterator it = s_colorNameMap.find(lower);
 
-        if (color) {
-            return color;
+        if (it != s_colorNameMap.end() && it->second) {
+            return it->second;
         }
     }
 
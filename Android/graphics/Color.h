@@ -10,8 +10,9 @@
 
 #include "AndroidMacros.h"
 
+#include "Android/utils/HashMap.h"
+
 #include <string>
-#include <map>
 
 using namespace std;
 
@@ -153,7 +154,7 @@ public:
     
 private:
 
-    static const map<string, int> s_colorNameMap;
+    static const HashMap<string, int> s_colorNameMap;
 
 };
 
@@ -7,33 +7,150 @@
 
 #include "HardwareRenderer.h"
 
+#include "Android/content/Context.h"
 #include "Android/graphics/Canvas.h"
+#include "Android/graphics/RenderThread.h"
+#include "Android/utils/DisplayMetrics.h"
 
 #include "Android/view/View.h"
 #include "Android/view/AttachInfo.h"
 #include "Android/view/GLES20DisplayList.h"
 
+#include <algorithm>
+
 ANDROID_BEGIN
 
+/**
+ * Forwards trim requests to the hwui caches.
+ */
+class HardwareRendererCallbacks : public ComponentCallbacks2 {
+public:
+    virtual void onTrimMemory(int level) {
+        HardwareRenderer::trimMemory(level);
+    }
+
+    virtual void getMemoryUsage(vector<MemoryUsage> &usage) {
+        HardwareRenderer::getMemoryUsage(usage);
+    }
+};
+
+static HardwareRendererCallbacks s_callbacks;
+
+RenderContext *HardwareRenderer::s_renderContext = NULL;
+RenderThread *HardwareRenderer::s_renderThread = NULL;
+
 HardwareRenderer::HardwareRenderer(bool translucent) {
     m_translucent = translucent;
     m_redrawClip = new Rect();
+
+    // One thread for the process, as there is one set of caches
+    if (s_renderContext && !s_renderThread) {
+        s_renderThread = new RenderThread(s_renderContext);
+    }
+
+    Context::registerComponentCallbacks(&s_callbacks);
 }
 
 HardwareRenderer::~HardwareRenderer() {
+    // The canvas must be released where the GL context is current
+    runOnRenderThread([this] {
+        m_canvas = NULL;
+    });
 }
 
 HardwareRenderer *HardwareRenderer::create(bool translucent) {
     return new HardwareRenderer(translucent);
 }
 
+void HardwareRenderer::setRenderContext(RenderContext *context) {
+    s_renderContext = context;
+}
+
+bool HardwareRenderer::isThreaded() {
+    return s_renderThread != NULL;
+}
+
+void HardwareRenderer::runOnRenderThread(const function<void()> &task) {
+    if (s_renderThread) {
+        s_renderThread->runSync(task);
+    } else {
+        task();
+    }
+}
+
 GLES20DisplayList *HardwareRenderer::createDisplayList() {
-    return new GLES20DisplayList();
+    return new GLES20DisplayList(s_renderThread ? this : NULL);
+}
+
+void HardwareRenderer::addStagedDisplayList(GLES20DisplayList *displayList) {
+    m_stagedDisplayLists.push_back(displayList);
+}
+
+void HardwareRenderer::removeStagedDisplayList(GLES20DisplayList *displayList) {
+    // The last frame may still draw it
+    s_renderThread->waitForIdle();
+
+    m_stagedDisplayLists.erase(remove(m_stagedDisplayLists.begin(), m_stagedDisplayLists.end(),
+            displayList), m_stagedDisplayLists.end());
+}
+
+void HardwareRenderer::syncFrameState(AttachInfo *attachInfo) {
+
+    // The display lists are drawn in place, so they only change once the
+    // render thread is done with the previous frame. This bounds the frames
+    // in flight to one: the one drawn while the next is recorded.
+    s_renderThread->waitForIdle();
+
+    handleFunctorStatus(attachInfo, m_frameStatus);
+    m_frameStatus = GLES20DisplayList::STATUS_DONE;
+
+    for (size_t i = 0; i < m_stagedDisplayLists.size(); i++) {
+        m_stagedDisplayLists[i]->pushStagingChanges();
+    }
+    m_stagedDisplayLists.clear();
+}
+
+int HardwareRenderer::drawFrame(GLES20DisplayList *displayList) {
+
+    int status = GLES20DisplayList::STATUS_DONE;
+
+    m_canvas->onPreDraw(NULL);
+
+    int saveCount = m_canvas->save();
+    status |= m_canvas->drawDisplayList(displayList, m_redrawClip, GLES20DisplayList::FLAG_CLIP_CHILDREN);
+    m_canvas->restoreToCount(saveCount);
+
+    m_canvas->onPostDraw();
+
+    return status;
 }
 
 void HardwareRenderer::draw(shared_ptr<View> view, AttachInfo *attachInfo, Rect *dirty) {
 
-    if (m_canvas) {
+    if (m_canvas && s_renderThread) {
+
+        attachInfo->m_ignoreDirtyState = true;
+
+        view->mPrivateFlags |= View::PFLAG_DRAWN;
+
+        attachInfo->m_hardwareCanvas = m_canvas;
+
+        GLES20DisplayList *displayList = buildDisplayList(view, m_canvas);
+        view->m_recreateDisplayList = false;
+
+        // Views without a display list cannot be drawn off their thread
+        if (displayList) {
+            syncFrameState(attachInfo);
+
+            s_renderThread->post([this, displayList] {
+                m_frameStatus = drawFrame(displayList);
+                s_renderContext->swapBuffers();
+            });
+        }
+
+        attachInfo->m_ignoreDirtyState = false;
+
+    } else if (m_canvas) {
 
         attachInfo->m_ignoreDirtyState = true;
         
@@ -105,7 +222,11 @@ GLES20DisplayList *HardwareRenderer::buildDisplayList(shared_ptr<View> view, sha
 }
 
 bool HardwareRenderer::initialize() {
-    m_canvas = make_shared<Canvas>(m_translucent);
+    // The renderer of the canvas creates the caches, which belong to the
+    // thread owning the GL context
+    runOnRenderThread([this] {
+        m_canvas = make_shared<Canvas>(m_translucent);
+    });
     return (m_canvas != NULL);
 }
 
@@ -117,8 +238,71 @@ int HardwareRenderer::getHeight() {
     return m_height;
 }
 
+void HardwareRenderer::configureCaches(const DisplayMetrics &metrics) {
+    runOnRenderThread([&metrics] {
+        if (!Caches::hasInstance()) return;
+
+        CacheConfig config;
+        config.setForDisplay(metrics.widthPixels, metrics.heightPixels,
+                CacheConfig::getPhysicalMemorySize());
+        Caches::getInstance().setConfig(config);
+    });
+}
+
+void HardwareRenderer::trimMemory(int level) {
+    runOnRenderThread([level] {
+        if (!Caches::hasInstance()) return;
+
+        Caches &caches = Caches::getInstance();
+        if (level >= ComponentCallbacks2::TRIM_MEMORY_COMPLETE) {
+            caches.flush(Caches::kFlushMode_Full);
+        } else if (level >= ComponentCallbacks2::TRIM_MEMORY_BACKGROUND) {
+            caches.flush(Caches::kFlushMode_Moderate);
+        } else if (level >= ComponentCallbacks2::TRIM_MEMORY_RUNNING_CRITICAL) {
+            caches.flush(Caches::kFlushMode_Layers);
+        }
+    });
+}
+
+void HardwareRenderer::getMemoryUsage(vector<ComponentCallbacks2::MemoryUsage> &usage) {
+    // The sizes change as the render thread draws
+    if (s_renderThread && !s_renderThread->isCurrent()) {
+        s_renderThread->runSync([&usage] {
+            getMemoryUsage(usage);
+        });
+        return;
+    }
+
+    if (!Caches::hasInstance()) return;
+
+    Caches &caches = Caches::getInstance();
+
+    uint32_t fontRenderers = 0;
+    for (uint32_t i = 0; i < caches.fontRenderer.getFontRendererCount(); i++) {
+        fontRenderers += caches.fontRenderer.getFontRendererSize(i);
+    }
+
+    const uint32_t shapes = caches.roundRectShapeCache.getSize() +
+            caches.circleShapeCache.getSize() + caches.ovalShapeCache.getSize() +
+            caches.rectShapeCache.getSize() + caches.arcShapeCache.getSize();
+
+    const ComponentCallbacks2::MemoryUsage cacheUsage[] = {
+        { "TextureCache", caches.textureCache.getSize() },
+        { "LayerCache", caches.layerCache.getSize() },
+        { "GradientCache", caches.gradientCache.getSize() },
+        { "PathCache", caches.pathCache.getSize() },
+        { "ShapeCaches", shapes },
+        { "TessellationCache", caches.tessellationCache.getSize() },
+        { "TextDropShadowCache", caches.dropShadowCache.getSize() },
+        { "FontRenderer", fontRenderers }
+    };
+    usage.insert(usage.end(), cacheUsage, cacheUsage + sizeof(cacheUsage) / sizeof(cacheUsage[0]));
+}
+
 void HardwareRenderer::setup(int width, int height) {
-    m_canvas->setViewport(width, height);
+    runOnRenderThread([this, width, height] {
+        m_canvas->setViewport(width, height);
+    });
     m_width = width;
     m_height = height;
 }
@@ -9,8 +9,11 @@
 #define	HARDWARERENDERER_H
 
 #include "AndroidMacros.h"
+#include "Android/content/ComponentCallbacks2.h"
 #include "Android/graphics/Rect.h"
+#include <functional>
 #include <memory>
+#include <vector>
 
 using namespace std;
 
@@ -19,7 +22,10 @@ ANDROID_BEGIN
 class View;
 class AttachInfo;
 class Canvas;
+class DisplayMetrics;
 class GLES20DisplayList;
+class RenderContext;
+class RenderThread;
 
 class HardwareRenderer {
 public:
@@ -27,6 +33,12 @@ public:
     virtual ~HardwareRenderer();
 
     GLES20DisplayList *createDisplayList();
+
+    /**
+     * Records the display lists of the view on the calling thread and draws
+     * them. With a render thread, they are drawn and swapped there while the
+     * next frame is recorded.
+     */
     void draw(shared_ptr<View> view, AttachInfo *attachInfo, Rect *dirty);
     bool initialize();
     int getWidth();
@@ -34,15 +46,63 @@ public:
     void setup(int width, int height);
 
     static HardwareRenderer *create(bool translucent);
+
+    /**
+     * Draws on a render thread owning the context rather than on the thread
+     * of the views, which then records the next frame while the previous one
+     * is drawn. Must be called before the first renderer is created; the
+     * context must not be current on the thread of the views.
+     */
+    static void setRenderContext(RenderContext *context);
+
+    /**
+     * Returns true if frames are drawn and swapped on a render thread.
+     */
+    static bool isThreaded();
+
+    /**
+     * Sizes the renderer caches for the display and the memory of the
+     * device. Must be called on the thread that owns the GL context.
+     */
+    static void configureCaches(const DisplayMetrics &metrics);
+
+    /**
+     * Flushes the renderer caches, more of them the higher the level.
+     * Must be called on the thread that owns the GL context.
+     */
+    static void trimMemory(int level);
+
+    /**
+     * Appends the memory held by each renderer cache.
+     */
+    static void getMemoryUsage(vector<ComponentCallbacks2::MemoryUsage> &usage);
+
+    /**
+     * Called by display lists whose changes must be pushed at the next sync.
+     */
+    void addStagedDisplayList(GLES20DisplayList *displayList);
+    void removeStagedDisplayList(GLES20DisplayList *displayList);
 private:
+    static RenderContext *s_renderContext;
+    static RenderThread *s_renderThread;
+
+    // Runs on the render thread if there is one and waits for it
+    static void runOnRenderThread(const function<void()> &task);
+
     bool m_translucent = false;
     shared_ptr<Canvas> m_canvas;
     int m_width = 0;
     int m_height = 0;
     Rect *m_redrawClip = NULL;
+    // Display lists with changes the render thread has not seen
+    vector<GLES20DisplayList*> m_stagedDisplayLists;
+    // Status of the last frame drawn on the render thread
+    int m_frameStatus = 0;
     GLES20DisplayList *buildDisplayList(shared_ptr<View> view, shared_ptr<Canvas> canvas);
     int drawDisplayList(AttachInfo *attachInfo, shared_ptr<Canvas> canvas, GLES20DisplayList *displayList, int status);
     void handleFunctorStatus(AttachInfo *attachInfo, int status);
+    void syncFrameState(AttachInfo *attachInfo);
+    int drawFrame(GLES20DisplayList *displayList);
 };
 
 ANDROID_END
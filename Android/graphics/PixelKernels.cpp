@@ -0,0 +1,451 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PixelKernels.h"
+
+#include <SkDither.h>
+#include <SkUnPreMultiply.h>
+
+// The vector kernels expect a little endian CPU with alpha in the top byte
+// and red and blue either where SkColor has them or swapped
+#if defined(SK_CPU_LENDIAN) && SK_A32_SHIFT == 24 && SK_G32_SHIFT == 8 && \
+        ((SK_R32_SHIFT == 16 && SK_B32_SHIFT == 0) || (SK_R32_SHIFT == 0 && SK_B32_SHIFT == 16))
+    #if defined(__ARM_NEON__) || defined(__ARM_NEON)
+        #define PIXEL_KERNELS_NEON 1
+        #include <arm_neon.h>
+    #elif defined(__SSE2__) || defined(_M_X64)
+        #define PIXEL_KERNELS_SSE2 1
+        #include <emmintrin.h>
+    #endif
+#endif
+
+ANDROID_BEGIN
+
+// SkColor keeps blue in the low byte, SkPMColor may keep red there
+#define SWAP_RED_BLUE (SK_R32_SHIFT != 16)
+
+#if PIXEL_KERNELS_SSE2
+
+static inline __m128i swapRedBlue(__m128i pixels) {
+#if SWAP_RED_BLUE
+    const __m128i lowByte = _mm_set1_epi32(0xFF);
+    const __m128i alphaGreen = _mm_set1_epi32((int) 0xFF00FF00);
+    return _mm_or_si128(_mm_and_si128(pixels, alphaGreen),
+            _mm_or_si128(_mm_and_si128(_mm_srli_epi32(pixels, 16), lowByte),
+                    _mm_slli_epi32(_mm_and_si128(pixels, lowByte), 16)));
+#else
+    return pixels;
+#endif
+}
+
+/**
+ * Premultiplies two SkColors widened to 16-bit lanes, blue first.
+ */
+static inline __m128i premultiply16(__m128i pixels) {
+    const __m128i half = _mm_set1_epi16(128);
+    // Alpha is the fourth lane of each pixel
+    const __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+
+    __m128i alpha = _mm_shufflelo_epi16(pixels, _MM_SHUFFLE(3, 3, 3, 3));
+    alpha = _mm_shufflehi_epi16(alpha, _MM_SHUFFLE(3, 3, 3, 3));
+
+    // SkMulDiv255Round
+    __m128i product = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), half);
+    product = _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+    product = _mm_or_si128(_mm_andnot_si128(alphaLanes, product),
+            _mm_and_si128(alphaLanes, pixels));
+
+#if SWAP_RED_BLUE
+    product = _mm_shufflelo_epi16(product, _MM_SHUFFLE(3, 0, 1, 2));
+    product = _mm_shufflehi_epi16(product, _MM_SHUFFLE(3, 0, 1, 2));
+#endif
+    return product;
+}
+
+/**
+ * Extracts one channel of eight pixels into 16-bit lanes.
+ */
+static inline __m128i channel16(__m128i pixels0, __m128i pixels1, int shift) {
+    const __m128i lowByte = _mm_set1_epi32(0xFF);
+    const __m128i count = _mm_cvtsi32_si128(shift);
+    return _mm_packs_epi32(_mm_and_si128(_mm_srl_epi32(pixels0, count), lowByte),
+            _mm_and_si128(_mm_srl_epi32(pixels1, count), lowByte));
+}
+
+#endif
+
+#if PIXEL_KERNELS_NEON
+
+/**
+ * SkMulDiv255Round on eight channels.
+ */
+static inline uint8x8_t mulDiv255Round(uint8x8_t value, uint8x8_t alpha) {
+    const uint16x8_t product = vaddq_u16(vmull_u8(value, alpha), vdupq_n_u16(128));
+    return vaddhn_u16(product, vshrq_n_u16(product, 8));
+}
+
+#endif
+
+void PixelKernels::premultiply(SkPMColor *dst, const SkColor *src, int count) {
+    int i = 0;
+
+#if PIXEL_KERNELS_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4) {
+        const __m128i pixels = _mm_loadu_si128((const __m128i*) (src + i));
+        const __m128i lo = premultiply16(_mm_unpacklo_epi8(pixels, zero));
+        const __m128i hi = premultiply16(_mm_unpackhi_epi8(pixels, zero));
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif PIXEL_KERNELS_NEON
+    for (; i + 8 <= count; i += 8) {
+        // SkColor planes are blue, green, red and alpha
+        const uint8x8x4_t pixels = vld4_u8((const uint8_t*) (src + i));
+        uint8x8x4_t result;
+        result.val[SK_R32_SHIFT / 8] = mulDiv255Round(pixels.val[2], pixels.val[3]);
+        result.val[SK_G32_SHIFT / 8] = mulDiv255Round(pixels.val[1], pixels.val[3]);
+        result.val[SK_B32_SHIFT / 8] = mulDiv255Round(pixels.val[0], pixels.val[3]);
+        result.val[SK_A32_SHIFT / 8] = pixels.val[3];
+        vst4_u8((uint8_t*) (dst + i), result);
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = SkPreMultiplyColor(src[i]);
+    }
+}
+
+void PixelKernels::unpremultiply(SkColor *dst, const SkPMColor *src, int count) {
+    int i = 0;
+
+#if PIXEL_KERNELS_SSE2
+    const __m128i alphaMask = _mm_set1_epi32((int) 0xFF000000);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i pixels = _mm_loadu_si128((const __m128i*) (src + i));
+        const __m128i opaque = _mm_cmpeq_epi32(_mm_and_si128(pixels, alphaMask), alphaMask);
+        if (_mm_movemask_epi8(opaque) == 0xFFFF) {
+            _mm_storeu_si128((__m128i*) (dst + i), swapRedBlue(pixels));
+        } else {
+            for (int j = i; j < i + 4; j++) {
+                dst[j] = SkUnPreMultiply::PMColorToColor(src[j]);
+            }
+        }
+    }
+#elif PIXEL_KERNELS_NEON
+    for (; i + 8 <= count; i += 8) {
+        const uint8x8x4_t pixels = vld4_u8((const uint8_t*) (src + i));
+        const uint8x8_t alpha = pixels.val[SK_A32_SHIFT / 8];
+        if (vget_lane_u64(vreinterpret_u64_u8(alpha), 0) == ~0ULL) {
+            uint8x8x4_t result;
+            result.val[0] = pixels.val[SK_B32_SHIFT / 8];
+            result.val[1] = pixels.val[SK_G32_SHIFT / 8];
+            result.val[2] = pixels.val[SK_R32_SHIFT / 8];
+            result.val[3] = alpha;
+            vst4_u8((uint8_t*) (dst + i), result);
+        } else {
+            for (int j = i; j < i + 8; j++) {
+                dst[j] = SkUnPreMultiply::PMColorToColor(src[j]);
+            }
+        }
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = SkUnPreMultiply::PMColorToColor(src[i]);
+    }
+}
+
+/**
+ * Converts to dithered 565 pixels whose channels are at the given shifts.
+ */
+static void convertTo565(uint16_t *dst, const uint32_t *src, int count, int x, int y,
+        int redShift, int greenShift, int blueShift) {
+    DITHER_565_SCAN(y);
+    int i = 0;
+
+#if PIXEL_KERNELS_SSE2 || PIXEL_KERNELS_NEON
+    // Eight pixels span two dither periods, every batch uses the same dither
+    uint16_t ditherLanes[8];
+    for (int j = 0; j < 8; j++) {
+        ditherLanes[j] = DITHER_VALUE(x + j);
+    }
+#endif
+
+#if PIXEL_KERNELS_SSE2
+    const __m128i dither = _mm_loadu_si128((const __m128i*) ditherLanes);
+    const __m128i greenDither = _mm_srli_epi16(dither, 1);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i pixels0 = _mm_loadu_si128((const __m128i*) (src + i));
+        const __m128i pixels1 = _mm_loadu_si128((const __m128i*) (src + i + 4));
+        const __m128i r = channel16(pixels0, pixels1, redShift);
+        const __m128i g = channel16(pixels0, pixels1, greenShift);
+        const __m128i b = channel16(pixels0, pixels1, blueShift);
+
+        const __m128i r5 = _mm_srli_epi16(
+                _mm_sub_epi16(_mm_add_epi16(r, dither), _mm_srli_epi16(r, 5)), 3);
+        const __m128i g6 = _mm_srli_epi16(
+                _mm_sub_epi16(_mm_add_epi16(g, greenDither), _mm_srli_epi16(g, 6)), 2);
+        const __m128i b5 = _mm_srli_epi16(
+                _mm_sub_epi16(_mm_add_epi16(b, dither), _mm_srli_epi16(b, 5)), 3);
+
+        const __m128i result = _mm_or_si128(_mm_slli_epi16(r5, SK_R16_SHIFT),
+                _mm_or_si128(_mm_slli_epi16(g6, SK_G16_SHIFT), _mm_slli_epi16(b5, SK_B16_SHIFT)));
+        _mm_storeu_si128((__m128i*) (dst + i), result);
+    }
+#elif PIXEL_KERNELS_NEON
+    const uint16x8_t dither = vld1q_u16(ditherLanes);
+    const uint16x8_t greenDither = vshrq_n_u16(dither, 1);
+    for (; i + 8 <= count; i += 8) {
+        const uint8x8x4_t pixels = vld4_u8((const uint8_t*) (src + i));
+        const uint16x8_t r = vmovl_u8(pixels.val[redShift / 8]);
+        const uint16x8_t g = vmovl_u8(pixels.val[greenShift / 8]);
+        const uint16x8_t b = vmovl_u8(pixels.val[blueShift / 8]);
+
+        const uint16x8_t r5 = vshrq_n_u16(vsubq_u16(vaddq_u16(r, dither), vshrq_n_u16(r, 5)), 3);
+        const uint16x8_t g6 = vshrq_n_u16(
+                vsubq_u16(vaddq_u16(g, greenDither), vshrq_n_u16(g, 6)), 2);
+        const uint16x8_t b5 = vshrq_n_u16(vsubq_u16(vaddq_u16(b, dither), vshrq_n_u16(b, 5)), 3);
+
+        vst1q_u16(dst + i, vorrq_u16(vshlq_n_u16(r5, SK_R16_SHIFT),
+                vorrq_u16(vshlq_n_u16(g6, SK_G16_SHIFT), vshlq_n_u16(b5, SK_B16_SHIFT))));
+    }
+#endif
+
+    for (; i < count; i++) {
+        const uint32_t c = src[i];
+        dst[i] = SkDitherRGBTo565((c >> redShift) & 0xFF, (c >> greenShift) & 0xFF,
+                (c >> blueShift) & 0xFF, DITHER_VALUE(x + i));
+    }
+}
+
+void PixelKernels::colorTo565(uint16_t *dst, const SkColor *src, int count, int x, int y) {
+    convertTo565(dst, src, count, x, y, 16, 8, 0);
+}
+
+void PixelKernels::pmColorTo565(uint16_t *dst, const SkPMColor *src, int count, int x, int y) {
+    convertTo565(dst, src, count, x, y, SK_R32_SHIFT, SK_G32_SHIFT, SK_B32_SHIFT);
+}
+
+void PixelKernels::pmColorTo4444(SkPMColor16 *dst, const SkPMColor *src, int count,
+        int x, int y) {
+    DITHER_4444_SCAN(y);
+    int i = 0;
+
+#if PIXEL_KERNELS_SSE2 || PIXEL_KERNELS_NEON
+    uint16_t ditherLanes[8];
+    for (int j = 0; j < 8; j++) {
+        ditherLanes[j] = DITHER_VALUE(x + j);
+    }
+#endif
+
+#if PIXEL_KERNELS_SSE2
+    const __m128i dither = _mm_loadu_si128((const __m128i*) ditherLanes);
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i fifteen = _mm_set1_epi16(15);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i pixels0 = _mm_loadu_si128((const __m128i*) (src + i));
+        const __m128i pixels1 = _mm_loadu_si128((const __m128i*) (src + i + 4));
+        const __m128i a = channel16(pixels0, pixels1, SK_A32_SHIFT);
+        const __m128i r = channel16(pixels0, pixels1, SK_R32_SHIFT);
+        const __m128i g = channel16(pixels0, pixels1, SK_G32_SHIFT);
+        const __m128i b = channel16(pixels0, pixels1, SK_B32_SHIFT);
+
+        // The dither fades out with the alpha
+        const __m128i d = _mm_srli_epi16(_mm_mullo_epi16(dither, _mm_add_epi16(a, one)), 8);
+
+        const __m128i a4 = _mm_srli_epi16(
+                _mm_sub_epi16(_mm_add_epi16(a, fifteen), _mm_srli_epi16(a, 4)), 4);
+        const __m128i r4 = _mm_srli_epi16(
+                _mm_sub_epi16(_mm_add_epi16(r, d), _mm_srli_epi16(r, 4)), 4);
+        const __m128i g4 = _mm_srli_epi16(
+                _mm_sub_epi16(_mm_add_epi16(g, d), _mm_srli_epi16(g, 4)), 4);
+        const __m128i b4 = _mm_srli_epi16(
+                _mm_sub_epi16(_mm_add_epi16(b, d), _mm_srli_epi16(b, 4)), 4);
+
+        const __m128i result = _mm_or_si128(
+                _mm_or_si128(_mm_slli_epi16(a4, SK_A4444_SHIFT), _mm_slli_epi16(r4, SK_R4444_SHIFT)),
+                _mm_or_si128(_mm_slli_epi16(g4, SK_G4444_SHIFT), _mm_slli_epi16(b4, SK_B4444_SHIFT)));
+        _mm_storeu_si128((__m128i*) (dst + i), result);
+    }
+#elif PIXEL_KERNELS_NEON
+    const uint16x8_t dither = vld1q_u16(ditherLanes);
+    const uint16x8_t one = vdupq_n_u16(1);
+    const uint16x8_t fifteen = vdupq_n_u16(15);
+    for (; i + 8 <= count; i += 8) {
+        const uint8x8x4_t pixels = vld4_u8((const uint8_t*) (src + i));
+        const uint16x8_t a = vmovl_u8(pixels.val[SK_A32_SHIFT / 8]);
+        const uint16x8_t r = vmovl_u8(pixels.val[SK_R32_SHIFT / 8]);
+        const uint16x8_t g = vmovl_u8(pixels.val[SK_G32_SHIFT / 8]);
+        const uint16x8_t b = vmovl_u8(pixels.val[SK_B32_SHIFT / 8]);
+
+        // The dither fades out with the alpha
+        const uint16x8_t d = vshrq_n_u16(vmulq_u16(dither, vaddq_u16(a, one)), 8);
+
+        const uint16x8_t a4 = vshrq_n_u16(vsubq_u16(vaddq_u16(a, fifteen), vshrq_n_u16(a, 4)), 4);
+        const uint16x8_t r4 = vshrq_n_u16(vsubq_u16(vaddq_u16(r, d), vshrq_n_u16(r, 4)), 4);
+        const uint16x8_t g4 = vshrq_n_u16(vsubq_u16(vaddq_u16(g, d), vshrq_n_u16(g, 4)), 4);
+        const uint16x8_t b4 = vshrq_n_u16(vsubq_u16(vaddq_u16(b, d), vshrq_n_u16(b, 4)), 4);
+
+        vst1q_u16(dst + i, vorrq_u16(
+                vorrq_u16(vshlq_n_u16(a4, SK_A4444_SHIFT), vshlq_n_u16(r4, SK_R4444_SHIFT)),
+                vorrq_u16(vshlq_n_u16(g4, SK_G4444_SHIFT), vshlq_n_u16(b4, SK_B4444_SHIFT))));
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = SkDitherARGB32To4444(src[i], DITHER_VALUE(x + i));
+    }
+}
+
+void PixelKernels::pmColorToA8(uint8_t *dst, const SkPMColor *src, int count) {
+    int i = 0;
+
+#if PIXEL_KERNELS_SSE2
+    for (; i + 16 <= count; i += 16) {
+        const __m128i a0 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*) (src + i)), 24);
+        const __m128i a1 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*) (src + i + 4)), 24);
+        const __m128i a2 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*) (src + i + 8)), 24);
+        const __m128i a3 = _mm_srli_epi32(_mm_loadu_si128((const __m128i*) (src + i + 12)), 24);
+        _mm_storeu_si128((__m128i*) (dst + i),
+                _mm_packus_epi16(_mm_packs_epi32(a0, a1), _mm_packs_epi32(a2, a3)));
+    }
+#elif PIXEL_KERNELS_NEON
+    for (; i + 16 <= count; i += 16) {
+        const uint8x16x4_t pixels = vld4q_u8((const uint8_t*) (src + i));
+        vst1q_u8(dst + i, pixels.val[SK_A32_SHIFT / 8]);
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = SkGetPackedA32(src[i]);
+    }
+}
+
+bool PixelKernels::isOpaque(const SkPMColor *src, int count) {
+    int i = 0;
+    uint32_t all = 0xFFFFFFFF;
+
+#if PIXEL_KERNELS_SSE2
+    __m128i accumulator = _mm_set1_epi32(-1);
+    for (; i + 4 <= count; i += 4) {
+        accumulator = _mm_and_si128(accumulator, _mm_loadu_si128((const __m128i*) (src + i)));
+    }
+    accumulator = _mm_and_si128(accumulator, _mm_srli_si128(accumulator, 8));
+    accumulator = _mm_and_si128(accumulator, _mm_srli_si128(accumulator, 4));
+    all = _mm_cvtsi128_si32(accumulator);
+#elif PIXEL_KERNELS_NEON
+    uint32x4_t accumulator = vdupq_n_u32(0xFFFFFFFF);
+    for (; i + 4 <= count; i += 4) {
+        accumulator = vandq_u32(accumulator, vld1q_u32(src + i));
+    }
+    const uint32x2_t half = vand_u32(vget_low_u32(accumulator), vget_high_u32(accumulator));
+    all = vget_lane_u32(half, 0) & vget_lane_u32(half, 1);
+#endif
+
+    for (; i < count; i++) {
+        all &= src[i];
+    }
+    return SkGetPackedA32(all) == 0xFF;
+}
+
+/**
+ * Averages four pixels, two channels at a time.
+ */
+static inline SkPMColor average4(SkPMColor a, SkPMColor b, SkPMColor c, SkPMColor d) {
+    const uint32_t rb = (((a & 0xFF00FF) + (b & 0xFF00FF) + (c & 0xFF00FF) + (d & 0xFF00FF) +
+            0x20002) >> 2) & 0xFF00FF;
+    const uint32_t ag = ((((a >> 8) & 0xFF00FF) + ((b >> 8) & 0xFF00FF) +
+            ((c >> 8) & 0xFF00FF) + ((d >> 8) & 0xFF00FF) + 0x20002) >> 2) & 0xFF00FF;
+    return rb | (ag << 8);
+}
+
+void PixelKernels::downscale2x(SkPMColor *dst, const SkPMColor *row0, const SkPMColor *row1,
+        int count) {
+    int i = 0;
+
+#if PIXEL_KERNELS_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i two = _mm_set1_epi16(2);
+    for (; i + 4 <= count; i += 4) {
+        const __m128i top0 = _mm_loadu_si128((const __m128i*) (row0 + 2 * i));
+        const __m128i top1 = _mm_loadu_si128((const __m128i*) (row0 + 2 * i + 4));
+        const __m128i bottom0 = _mm_loadu_si128((const __m128i*) (row1 + 2 * i));
+        const __m128i bottom1 = _mm_loadu_si128((const __m128i*) (row1 + 2 * i + 4));
+
+        // Vertical sums, two pixels per register
+        const __m128i sum01 = _mm_add_epi16(_mm_unpacklo_epi8(top0, zero),
+                _mm_unpacklo_epi8(bottom0, zero));
+        const __m128i sum23 = _mm_add_epi16(_mm_unpackhi_epi8(top0, zero),
+                _mm_unpackhi_epi8(bottom0, zero));
+        const __m128i sum45 = _mm_add_epi16(_mm_unpacklo_epi8(top1, zero),
+                _mm_unpacklo_epi8(bottom1, zero));
+        const __m128i sum67 = _mm_add_epi16(_mm_unpackhi_epi8(top1, zero),
+                _mm_unpackhi_epi8(bottom1, zero));
+
+        // Horizontal sums of neighboring pixels
+        __m128i lo = _mm_add_epi16(_mm_unpacklo_epi64(sum01, sum23),
+                _mm_unpackhi_epi64(sum01, sum23));
+        __m128i hi = _mm_add_epi16(_mm_unpacklo_epi64(sum45, sum67),
+                _mm_unpackhi_epi64(sum45, sum67));
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, two), 2);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, two), 2);
+
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif PIXEL_KERNELS_NEON
+    for (; i + 8 <= count; i += 8) {
+        const uint8x16x4_t top = vld4q_u8((const uint8_t*) (row0 + 2 * i));
+        const uint8x16x4_t bottom = vld4q_u8((const uint8_t*) (row1 + 2 * i));
+        uint8x8x4_t result;
+        for (int c = 0; c < 4; c++) {
+            const uint16x8_t sum = vaddq_u16(vpaddlq_u8(top.val[c]), vpaddlq_u8(bottom.val[c]));
+            result.val[c] = vrshrn_n_u16(sum, 2);
+        }
+        vst4_u8((uint8_t*) (dst + i), result);
+    }
+#endif
+
+    for (; i < count; i++) {
+        dst[i] = average4(row0[2 * i], row0[2 * i + 1], row1[2 * i], row1[2 * i + 1]);
+    }
+}
+
+/**
+ * Interpolates between two pixels, two channels at a time. The weight of
+ * b goes from 0 to 256.
+ */
+static inline SkPMColor lerp(SkPMColor a, SkPMColor b, unsigned weight) {
+    const unsigned inverse = 256 - weight;
+    const uint32_t rb = (((a & 0xFF00FF) * inverse + (b & 0xFF00FF) * weight) >> 8) & 0xFF00FF;
+    const uint32_t ag = (((a >> 8) & 0xFF00FF) * inverse + ((b >> 8) & 0xFF00FF) * weight) &
+            0xFF00FF00;
+    return rb | ag;
+}
+
+void PixelKernels::bilinearRow(SkPMColor *dst, const SkPMColor *row0, const SkPMColor *row1,
+        int srcWidth, int32_t x, int32_t dx, unsigned weightY, int count) {
+    const int32_t maxX = (srcWidth - 1) << 16;
+    for (int i = 0; i < count; i++, x += dx) {
+        const int32_t sx = x < 0 ? 0 : (x > maxX ? maxX : x);
+        const int x0 = sx >> 16;
+        const int x1 = x0 + 1 < srcWidth ? x0 + 1 : x0;
+        const unsigned weightX = (sx >> 8) & 0xFF;
+
+        const SkPMColor top = lerp(row0[x0], row0[x1], weightX);
+        const SkPMColor bottom = lerp(row1[x0], row1[x1], weightX);
+        dst[i] = lerp(top, bottom, weightY);
+    }
+}
+
+ANDROID_END
@@ -0,0 +1,98 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __Androidpp__PixelKernels__
+#define __Androidpp__PixelKernels__
+
+#include "AndroidMacros.h"
+
+#include <SkColor.h>
+#include <SkColorPriv.h>
+
+#include <stdint.h>
+
+ANDROID_BEGIN
+
+/**
+ * Row kernels converting, premultiplying and resampling pixels. Each kernel
+ * processes one run of pixels and produces exactly what the matching Skia
+ * scalar routine would, using SSE2 or NEON where the CPU has them and plain
+ * C++ everywhere else.
+ *
+ * SkColor is unpremultiplied ARGB, SkPMColor premultiplied in the byte order
+ * Skia was configured with.
+ */
+class PixelKernels {
+
+public:
+
+    /**
+     * Premultiplies colors, as SkPreMultiplyColor.
+     */
+    static void premultiply(SkPMColor *dst, const SkColor *src, int count);
+
+    /**
+     * Unpremultiplies colors, as SkUnPreMultiply::PMColorToColor. Runs of
+     * opaque pixels are only reordered.
+     */
+    static void unpremultiply(SkColor *dst, const SkPMColor *src, int count);
+
+    /**
+     * Converts colors to 565, ignoring their alpha, with the dither Skia
+     * uses for the pixel at (x, y) of a bitmap.
+     */
+    static void colorTo565(uint16_t *dst, const SkColor *src, int count, int x, int y);
+
+    /**
+     * Converts premultiplied colors to 565, ignoring their alpha, dithered
+     * as colorTo565.
+     */
+    static void pmColorTo565(uint16_t *dst, const SkPMColor *src, int count, int x, int y);
+
+    /**
+     * Converts premultiplied colors to 4444, as SkDitherARGB32To4444 with
+     * the dither of the pixel at (x, y).
+     */
+    static void pmColorTo4444(SkPMColor16 *dst, const SkPMColor *src, int count, int x, int y);
+
+    /**
+     * Extracts the alpha of premultiplied colors.
+     */
+    static void pmColorToA8(uint8_t *dst, const SkPMColor *src, int count);
+
+    /**
+     * Returns true if every pixel is opaque.
+     */
+    static bool isOpaque(const SkPMColor *src, int count);
+
+    /**
+     * Averages 2x2 blocks of premultiplied colors: dst[i] is the average of
+     * pixels 2i and 2i + 1 of both rows, which must hold 2 * count pixels.
+     */
+    static void downscale2x(SkPMColor *dst, const SkPMColor *row0, const SkPMColor *row1,
+                            int count);
+
+    /**
+     * Interpolates one row of premultiplied colors for a bilinear resample.
+     * Pixel i samples rows row0 and row1 at (x + i * dx) in 16.16 fixed
+     * point, clamped to srcWidth; weightY is the weight of row1, 0 to 256.
+     * Two channels are interpolated per 32-bit word on every CPU.
+     */
+    static void bilinearRow(SkPMColor *dst, const SkPMColor *row0, const SkPMColor *row1,
+                            int srcWidth, int32_t x, int32_t dx, unsigned weightY, int count);
+};
+
+ANDROID_END
+
+#endif /* defined(__Androidpp__PixelKernels__) */
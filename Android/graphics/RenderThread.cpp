@@ -0,0 +1,92 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "RenderThread.h"
+
+#include "cocos2d.h"
+
+ANDROID_BEGIN
+
+RenderThread::RenderThread(RenderContext *context) : m_context(context) {
+    // Started last so that every other member is ready
+    m_thread = thread(&RenderThread::threadLoop, this);
+}
+
+RenderThread::~RenderThread() {
+    {
+        unique_lock<mutex> lock(m_lock);
+        m_exit = true;
+    }
+    m_taskCondition.notify_one();
+    m_thread.join();
+}
+
+void RenderThread::post(const Task &task) {
+    {
+        unique_lock<mutex> lock(m_lock);
+        m_tasks.push_back(task);
+    }
+    m_taskCondition.notify_one();
+}
+
+void RenderThread::runSync(const Task &task) {
+
+    // Would wait for itself
+    if (isCurrent()) {
+        task();
+        return;
+    }
+
+    post(task);
+    waitForIdle();
+}
+
+void RenderThread::waitForIdle() {
+    unique_lock<mutex> lock(m_lock);
+    m_idleCondition.wait(lock, [this] { return m_tasks.empty() && !m_busy; });
+}
+
+void RenderThread::threadLoop() {
+
+    if (!m_context->makeCurrent()) {
+        CCLOG("RenderThread could not make its context current");
+    }
+
+    unique_lock<mutex> lock(m_lock);
+
+    while (true) {
+        m_taskCondition.wait(lock, [this] { return m_exit || !m_tasks.empty(); });
+        if (m_tasks.empty()) {
+            break;
+        }
+
+        Task task = m_tasks.front();
+        m_tasks.pop_front();
+        m_busy = true;
+
+        lock.unlock();
+        task();
+        lock.lock();
+
+        m_busy = false;
+        if (m_tasks.empty()) {
+            m_idleCondition.notify_all();
+        }
+    }
+
+    lock.unlock();
+    m_context->doneCurrent();
+}
+
+ANDROID_END
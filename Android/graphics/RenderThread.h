@@ -0,0 +1,108 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __Androidpp__RenderThread__
+#define __Androidpp__RenderThread__
+
+#include "AndroidMacros.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using namespace std;
+
+ANDROID_BEGIN
+
+/**
+ * The GL context of the window, supplied by the platform to draw on a render
+ * thread. It must not be current on any other thread once handed over.
+ */
+class RenderContext {
+public:
+    virtual ~RenderContext() {}
+
+    /**
+     * Makes the context current on the calling thread.
+     */
+    virtual bool makeCurrent() = 0;
+
+    /**
+     * Presents the frame drawn in the context.
+     */
+    virtual void swapBuffers() = 0;
+
+    /**
+     * Releases the context from the calling thread.
+     */
+    virtual void doneCurrent() = 0;
+};
+
+/**
+ * A thread owning a RenderContext, running the tasks posted to it in order
+ * with the context current.
+ */
+class RenderThread {
+public:
+    typedef function<void()> Task;
+
+    RenderThread(RenderContext *context);
+
+    /**
+     * Runs the tasks already posted, then releases the context and stops.
+     */
+    ~RenderThread();
+
+    RenderContext *getContext() { return m_context; }
+
+    /**
+     * Returns true if called from the render thread.
+     */
+    bool isCurrent() const { return this_thread::get_id() == m_thread.get_id(); }
+
+    /**
+     * Queues a task and returns.
+     */
+    void post(const Task &task);
+
+    /**
+     * Queues a task and waits until it has run.
+     */
+    void runSync(const Task &task);
+
+    /**
+     * Waits until every posted task has run.
+     */
+    void waitForIdle();
+
+private:
+    void threadLoop();
+
+    RenderContext *m_context;
+
+    mutex m_lock;
+    condition_variable m_taskCondition;
+    condition_variable m_idleCondition;
+    deque<Task> m_tasks;
+    bool m_busy = false;
+    bool m_exit = false;
+
+    thread m_thread;
+};
+
+ANDROID_END
+
+#endif /* defined(__Androidpp__RenderThread__) */
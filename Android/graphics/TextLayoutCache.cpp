@@ -18,6 +18,7 @@
 
 #include "TextLayoutCache.h"
 #include "TextLayout.h"
+#include "Android/content/Context.h"
 #include "SkFontHost.h"
 #include <unicode/unistr.h>
 #include <unicode/normlzr.h>
@@ -90,7 +91,20 @@ void TextLayoutCache::operator()(TextLayoutCacheKey& text, shared_ptr<TextLayout
  * Cache clearing
  */
 void TextLayoutCache::clear() {
+    AutoMutex _l(mLock);
+    mCache.clear();
+}
+
+void TextLayoutCache::purgeCaches() {
+    // The shaper is only used with the lock held
+    AutoMutex _l(mLock);
     mCache.clear();
+    mShaper->purgeCaches();
+}
+
+uint32_t TextLayoutCache::getSize() {
+    AutoMutex _l(mLock);
+    return mSize;
 }
 
 /*
@@ -341,6 +355,8 @@ uint32_t TextLayoutValue::getElapsedTime() {
 TextLayoutShaper::TextLayoutShaper() : mShaperItemGlyphArraySize(0) {
     init();
 
+    mBidi = ubidi_open();
+
     mFontRec.klass = &harfbuzzSkiaClass;
     mFontRec.userData = 0;
 
@@ -383,6 +399,9 @@ void TextLayoutShaper::unrefTypefaces() {
 }
 
 TextLayoutShaper::~TextLayoutShaper() {
+    if (mBidi) {
+        ubidi_close(mBidi);
+    }
     unrefTypefaces();
     deleteShaperItemGlyphArrays();
 }
@@ -407,6 +426,15 @@ void TextLayoutShaper::computeValues(const SkPaint* paint, const UChar* chars,
             return;
         }
 
+        // Text made only of characters below U+0300 has no strong RTL characters,
+        // so an LTR paragraph is a single LTR run and needs no BiDi analysis.
+        if ((dirFlags == kBidi_LTR || dirFlags == kBidi_Default_LTR || dirFlags == kBidi_Force_LTR) &&
+                isSimpleText(chars, contextCount)) {
+            computeRunValues(paint, chars + start, count, false,
+                    outAdvances, outTotalAdvance, outGlyphs);
+            return;
+        }
+
         UBiDiLevel bidiReq = 0;
         bool forceLTR = false;
         bool forceRTL = false;
@@ -425,7 +453,7 @@ void TextLayoutShaper::computeValues(const SkPaint* paint, const UChar* chars,
         if (forceLTR || forceRTL) {
             useSingleRun = true;
         } else {
-            UBiDi* bidi = ubidi_open();
+            UBiDi* bidi = mBidi;
             if (bidi) {
                 UErrorCode status = U_ZERO_ERROR;
 #if DEBUG_GLYPHS
@@ -507,7 +535,6 @@ void TextLayoutShaper::computeValues(const SkPaint* paint, const UChar* chars,
                     useSingleRun = true;
                     isRTL = (bidiReq = 1) || (bidiReq = UBIDI_DEFAULT_RTL);
                 }
-                ubidi_close(bidi);
             } else {
                 CCLOG("Cannot ubidi_open()");
                 useSingleRun = true;
@@ -551,13 +578,20 @@ void TextLayoutShaper::computeRunValues(const SkPaint* paint, const UChar* chars
         return;
     }
 
+    const bool simple = !isRTL && isSimpleText(chars, count);
+    if (simple && computeSimpleRunValues(paint, chars, count,
+            outAdvances, outTotalAdvance, outGlyphs)) {
+        return;
+    }
+
     // To be filled in later
     for (size_t i = 0; i < count; i++) {
         outAdvances->add(0);
     }
     UErrorCode error = U_ZERO_ERROR;
     bool useNormalizedString = false;
-    for (ssize_t i = count - 1; i >= 0; --i) {
+    // A simple run has no combining diacritical marks to normalize
+    for (ssize_t i = simple ? -1 : ssize_t(count) - 1; i >= 0; --i) {
         UChar ch1 = chars[i];
         if (::ublock_getCode(ch1) == UBLOCK_COMBINING_DIACRITICAL_MARKS) {
             // So we have found a diacritic, let's get now the main code point which is paired
@@ -646,11 +680,7 @@ void TextLayoutShaper::computeRunValues(const SkPaint* paint, const UChar* chars
     mShaperItem.stringLength = count;
 
     // Define shaping paint properties
-    mShapingPaint.setTextSize(paint->getTextSize());
-    mShapingPaint.setTextSkewX(paint->getTextSkewX());
-    mShapingPaint.setTextScaleX(paint->getTextScaleX());
-    mShapingPaint.setFlags(paint->getFlags());
-    mShapingPaint.setHinting(paint->getHinting());
+    setupShapingPaint(paint);
 
     // Split the BiDi run into Script runs. Harfbuzz will populate the pos, length and script
     // into the shaperItem
@@ -758,6 +788,93 @@ void TextLayoutShaper::computeRunValues(const SkPaint* paint, const UChar* chars
 #endif
 }
 
+void TextLayoutShaper::setupShapingPaint(const SkPaint* paint) {
+    mShapingPaint.setTextSize(paint->getTextSize());
+    mShapingPaint.setTextSkewX(paint->getTextSkewX());
+    mShapingPaint.setTextScaleX(paint->getTextScaleX());
+    mShapingPaint.setFlags(paint->getFlags());
+    mShapingPaint.setHinting(paint->getHinting());
+}
+
+bool TextLayoutShaper::isSimpleText(const UChar* chars, size_t count) {
+    size_t i = 0;
+
+    // Test four UTF-16 units per step. In each 16-bit lane, adding 0x7d00 to the
+    // low 15 bits sets bit 15 iff the unit is >= 0x0300 (it cannot carry into the
+    // next lane), and or-ing the unit itself catches units >= 0x8000.
+    if (count >= 4) {
+        const uint64_t kLow15 = 0x7fff7fff7fff7fffULL;
+        const uint64_t kBias = 0x7d007d007d007d00ULL;
+        const uint64_t kHigh = 0x8000800080008000ULL;
+        for (; i + 4 <= count; i += 4) {
+            uint64_t units;
+            memcpy(&units, chars + i, sizeof(units));
+            if ((((units & kLow15) + kBias) | units) & kHigh) {
+                return false;
+            }
+        }
+    }
+    for (; i < count; i++) {
+        if (chars[i] >= 0x0300) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TextLayoutShaper::computeSimpleRunValues(const SkPaint* paint, const UChar* chars,
+        size_t count,
+        Vector<float>* const outAdvances, float* outTotalAdvance,
+        Vector<UChar>* const outGlyphs) {
+    SkTypeface* typeface = paint->getTypeface();
+    if (!typeface) {
+        typeface = mDefaultTypeface;
+    }
+    HB_Face face = getCachedHBFace(typeface);
+
+    // With OpenType tables for common scripts Harfbuzz may form ligatures or
+    // apply kerning, so only faces without them can skip shaping.
+    if (!face || face->supported_scripts[HB_Script_Common]) {
+        return false;
+    }
+
+    setupShapingPaint(paint);
+    mShapingPaint.setTypeface(typeface);
+
+    // Reuse the shaper item arrays as scratch space: 16-bit glyph ids in the
+    // glyph array and SkScalar widths in the advance array, as HarfbuzzSkia does.
+    ensureShaperItemGlyphArrays(count);
+    uint16_t* glyphs16 = reinterpret_cast<uint16_t*>(mShaperItem.glyphs);
+    SkScalar* widths = reinterpret_cast<SkScalar*>(mShaperItem.advances);
+
+    mShapingPaint.setTextEncoding(SkPaint::kUTF16_TextEncoding);
+    int numGlyphs = mShapingPaint.textToGlyphs(chars, count * sizeof(UChar), glyphs16);
+    if (numGlyphs != int(count)) {
+        return false;
+    }
+    mShapingPaint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+    mShapingPaint.getTextWidths(glyphs16, count * sizeof(uint16_t), widths);
+
+    float totalAdvance = 0;
+    for (size_t i = 0; i < count; i++) {
+        // Round through 26.6 fixed point like the Harfbuzz path does
+        float advance = HBFixedToFloat(SkScalarToHBFixed(widths[i]));
+        outAdvances->add(advance);
+        totalAdvance += advance;
+    }
+    if (outGlyphs) {
+        for (size_t i = 0; i < count; i++) {
+            outGlyphs->add(glyphs16[i]);
+        }
+    }
+    *outTotalAdvance = totalAdvance;
+
+#if DEBUG_GLYPHS
+    CCLOG("Simple run -- count = %d, totalAdvance = %0.2f", count, totalAdvance);
+#endif
+    return true;
+}
+
 /**
  * Return the first typeface in the logical change, starting with this typeface,
  * that contains the specified unichar, or NULL if none is found.
@@ -1016,9 +1133,11 @@ TextLayoutEngine::TextLayoutEngine() {
 #else
     mTextLayoutCache = NULL;
 #endif
+    androidcpp::Context::registerComponentCallbacks(this);
 }
 
 TextLayoutEngine::~TextLayoutEngine() {
+    androidcpp::Context::unregisterComponentCallbacks(this);
     delete mTextLayoutCache;
     delete mShaper;
 }
@@ -1043,13 +1162,29 @@ shared_ptr<TextLayoutValue> TextLayoutEngine::getValue(const SkPaint* paint, con
 
 void TextLayoutEngine::purgeCaches() {
 #if USE_TEXT_LAYOUT_CACHE
-    mTextLayoutCache->clear();
-    mShaper->purgeCaches();
+    mTextLayoutCache->purgeCaches();
 #if DEBUG_GLYPHS
     CCLOG("Purged TextLayoutEngine caches");
 #endif
 #endif
 }
 
+void TextLayoutEngine::onTrimMemory(int level) {
+#if USE_TEXT_LAYOUT_CACHE
+    if (level >= TRIM_MEMORY_COMPLETE) {
+        purgeCaches();
+    } else if (level >= TRIM_MEMORY_RUNNING_CRITICAL) {
+        mTextLayoutCache->clear();
+    }
+#endif
+}
+
+void TextLayoutEngine::getMemoryUsage(vector<MemoryUsage>& usage) {
+#if USE_TEXT_LAYOUT_CACHE
+    MemoryUsage cache = { "TextLayoutCache", mTextLayoutCache->getSize() };
+    usage.push_back(cache);
+#endif
+}
+
 
 } // namespace android
@@ -40,6 +40,8 @@
 #include "HarfbuzzSkia.h"
 #include "harfbuzz-shaper.h"
 
+#include "Android/content/ComponentCallbacks2.h"
+
 #include <memory>
 
 //#include <android_runtime/AndroidRuntime.h>
@@ -182,6 +184,11 @@ private:
      */
     HB_ShaperItem mShaperItem;
 
+    /**
+     * ICU BiDi object, reused across computeValues() calls
+     */
+    UBiDi* mBidi;
+
     /**
      * Harfbuzz font
      */
@@ -233,6 +240,24 @@ private:
 
     size_t shapeFontRun(const SkPaint* paint, bool isRTL);
 
+    void setupShapingPaint(const SkPaint* paint);
+
+    /**
+     * Returns true if every UTF-16 unit is below U+0300: no combining marks,
+     * no surrogates and no strong RTL characters.
+     */
+    static bool isSimpleText(const UChar* chars, size_t count);
+
+    /**
+     * Fills glyphs and advances of a simple LTR run straight from the
+     * typeface cmap and advance tables, bypassing Harfbuzz. Returns false
+     * if the run has to be shaped.
+     */
+    bool computeSimpleRunValues(const SkPaint* paint, const UChar* chars,
+            size_t count,
+            Vector<float>* const outAdvances, float* outTotalAdvance,
+            Vector<UChar>* const outGlyphs);
+
     void computeValues(const SkPaint* paint, const UChar* chars,
             size_t start, size_t count, size_t contextCount, int dirFlags,
             Vector<float>* const outAdvances, float* outTotalAdvance,
@@ -280,6 +305,16 @@ public:
      */
     void clear();
 
+    /**
+     * Clear the cache and the shaper caches
+     */
+    void purgeCaches();
+
+    /**
+     * Get the size of the cache in bytes
+     */
+    uint32_t getSize();
+
 private:
     TextLayoutShaper* mShaper;
     Mutex mLock;
@@ -313,7 +348,8 @@ private:
 /**
  * The TextLayoutEngine is reponsible for computing TextLayoutValues
  */
-class TextLayoutEngine : public Singleton<TextLayoutEngine> {
+class TextLayoutEngine : public Singleton<TextLayoutEngine>,
+        public androidcpp::ComponentCallbacks2 {
 public:
     TextLayoutEngine();
     virtual ~TextLayoutEngine();
@@ -323,6 +359,13 @@ public:
 
     void purgeCaches();
 
+    /**
+     * Drops the cached layouts once the UI is hidden or memory runs critically
+     * low, and the shaper's faces as well when the process may be killed.
+     */
+    virtual void onTrimMemory(int level);
+    virtual void getMemoryUsage(vector<MemoryUsage>& usage);
+
 private:
     TextLayoutCache* mTextLayoutCache;
     TextLayoutShaper* mShaper;
@@ -209,8 +209,17 @@ bool DrawableContainer::setVisible(bool visible, bool restart) {
 }
 
 int DrawableContainer::getOpacity() {
-    return mCurrDrawable == NULL || !mCurrDrawable->isVisible() ? PixelFormats::PIXEL_FORMAT_TRANSPARENT :
-    mDrawableContainerState->getOpacity();
+    if (mCurrDrawable == NULL || !mCurrDrawable->isVisible()) {
+        return PixelFormats::PIXEL_FORMAT_TRANSPARENT;
+    }
+    
+    // Only the current drawable is drawn, along with the previous one while
+    // it fades out. Views recompute their opacity when the drawable changes.
+    int op = mCurrDrawable->getOpacity();
+    if (mLastDrawable != NULL && mExitAnimationEnd != 0) {
+        op = resolveOpacity(op, mLastDrawable->getOpacity());
+    }
+    return op;
 }
 
 bool DrawableContainer::selectDrawable(int idx) {
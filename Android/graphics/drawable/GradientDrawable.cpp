@@ -495,7 +495,7 @@ void GradientDrawable::setColorFilter(ColorFilter *cf) {
 }
 
 int GradientDrawable::getOpacity() {
-    return m_gradientState.mOpaque ? PixelFormats::PIXEL_FORMAT_OPAQUE : PixelFormats::PIXEL_FORMAT_TRANSLUCENT;
+    return m_gradientState.mOpaque && m_alpha == 255 ? PixelFormats::PIXEL_FORMAT_OPAQUE : PixelFormats::PIXEL_FORMAT_TRANSLUCENT;
 }
 
 void GradientDrawable::onBoundsChange(Rect r) {
@@ -276,7 +276,7 @@ private:
         float mGradientRadius = 0.5f;
         bool mUseLevel;
         bool mUseLevelForShape;
-        bool mOpaque;
+        bool mOpaque = false;
         
         void computeOpacity() {
             if (mShape != RECTANGLE) {
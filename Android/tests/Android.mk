@@ -0,0 +1,28 @@
+# Build the unit tests.
+LOCAL_PATH := $(call my-dir)
+include $(CLEAR_VARS)
+
+# Build the unit tests.
+test_src_files := \
+    DynamicLayout_test.cpp \
+    HashMap_test.cpp \
+    PackedIntVector_test.cpp \
+    PixelKernels_test.cpp \
+    RelativeLayout_test.cpp \
+    TextLayoutStress_test.cpp
+
+static_libraries := \
+    android_static \
+    libgtest \
+    libgtest_main
+
+$(foreach file,$(test_src_files), \
+    $(eval include $(CLEAR_VARS)) \
+    $(eval LOCAL_STATIC_LIBRARIES := $(static_libraries)) \
+    $(eval LOCAL_SRC_FILES := $(file)) \
+    $(eval LOCAL_C_INCLUDES := $(LOCAL_PATH)/.. $(LOCAL_PATH)/../..) \
+    $(eval LOCAL_CFLAGS := -fexceptions -DBUILD_FOR_ANDROID) \
+    $(eval LOCAL_CPPFLAGS := -std=c++11) \
+    $(eval LOCAL_MODULE := $(notdir $(file:%.cpp=%))) \
+    $(eval include $(BUILD_NATIVE_TEST)) \
+)
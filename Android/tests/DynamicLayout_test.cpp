@@ -0,0 +1,110 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Android/text/DynamicLayout.h"
+#include "Android/text/SpannableStringBuilder.h"
+#include "Android/text/StaticLayout.h"
+#include "Android/text/String.h"
+#include "Android/text/TextPaint.h"
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <time.h>
+
+ANDROID_BEGIN
+
+class DynamicLayoutTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        mPaint = make_shared<TextPaint>();
+        mPaint->setTextSize(16);
+    }
+
+    virtual void TearDown() {
+    }
+
+    shared_ptr<TextPaint> mPaint;
+};
+
+static const int WIDTH = 320;
+static const int PARAGRAPHS = 200;
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static shared_ptr<SpannableStringBuilder> makeText() {
+    UnicodeString text;
+    for (int i = 0; i < PARAGRAPHS; i++) {
+        text += "The quick brown fox jumps over the lazy dog, then keeps on running ";
+        text += "until the end of the paragraph wraps onto another line.\n";
+    }
+    return make_shared<SpannableStringBuilder>(make_shared<String>(text));
+}
+
+// Checks the incremental layout against a full layout of the same text
+static void expectSameLines(Layout &dynamic, Layout &reference) {
+    ASSERT_EQ(reference.getLineCount(), dynamic.getLineCount());
+    for (int line = 0; line < reference.getLineCount(); line++) {
+        ASSERT_EQ(reference.getLineStart(line), dynamic.getLineStart(line)) << "line " << line;
+        ASSERT_EQ(reference.getLineTop(line), dynamic.getLineTop(line)) << "line " << line;
+    }
+    EXPECT_EQ(reference.getHeight(), dynamic.getHeight());
+}
+
+TEST_F(DynamicLayoutTest, Keystrokes) {
+    const int keystrokes = 500;
+
+    shared_ptr<SpannableStringBuilder> text = makeText();
+    DynamicLayout layout(text, mPaint, WIDTH, Layout::Alignment::ALIGN_NORMAL, 1.0f, 0.0f, true);
+    shared_ptr<CharSequence> key = make_shared<String>(UnicodeString("x"));
+
+    // Types into, then deletes from, the middle of the text
+    const int where = text->length() / 2;
+    double start = now();
+    for (int i = 0; i < keystrokes; i++) {
+        text->insert(where + i, key);
+    }
+    const double typed = now() - start;
+
+    StaticLayout typedReference(text, mPaint, WIDTH, Layout::Alignment::ALIGN_NORMAL,
+            1.0f, 0.0f, true);
+    expectSameLines(layout, typedReference);
+
+    start = now();
+    for (int i = keystrokes; i > 0; i--) {
+        text->deletes(where + i - 1, where + i);
+    }
+    const double deleted = now() - start;
+
+    StaticLayout deletedReference(text, mPaint, WIDTH, Layout::Alignment::ALIGN_NORMAL,
+            1.0f, 0.0f, true);
+    expectSameLines(layout, deletedReference);
+
+    // What every keystroke would cost without incremental reflow
+    start = now();
+    for (int i = 0; i < 10; i++) {
+        StaticLayout full(text, mPaint, WIDTH, Layout::Alignment::ALIGN_NORMAL, 1.0f, 0.0f, true);
+    }
+    const double relayout = (now() - start) / 10;
+
+    printf("DynamicLayout: %d lines, insert %.1f us/key, delete %.1f us/key, "
+            "full StaticLayout %.1f us\n", layout.getLineCount(),
+            typed * 1e6 / keystrokes, deleted * 1e6 / keystrokes, relayout * 1e6);
+}
+
+ANDROID_END
@@ -0,0 +1,314 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Android/utils/HashMap.h"
+#include "Android/text/SpannableString.h"
+#include "Android/text/SpannedString.h"
+#include "Android/text/String.h"
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <set>
+
+ANDROID_BEGIN
+
+class HashMapTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+    }
+
+    virtual void TearDown() {
+    }
+};
+
+// A key whose hash is chosen by the test, to force collisions
+struct Key {
+    int id;
+    size_t hash;
+
+    Key() : id(0), hash(0) {}
+    Key(int id, size_t hash) : id(id), hash(hash) {}
+};
+
+struct KeyTraits {
+
+    static size_t hash(const Key &key) {
+        return key.hash;
+    }
+
+    static bool equals(const Key &a, const Key &b) {
+        return a.id == b.id;
+    }
+};
+
+typedef HashMap<Key, int, KeyTraits> KeyMap;
+
+// The most entries the first 8 slots hold before the map grows
+static const int FIRST_CAPACITY = 8;
+static const int FIRST_FILL = 6;
+
+static void expectFound(KeyMap &map, const Key &key, int value) {
+    KeyMap::iterator it = map.find(key);
+    ASSERT_TRUE(it != map.end()) << "key " << key.id;
+    EXPECT_EQ(key.id, it->first.id);
+    EXPECT_EQ(value, it->second) << "key " << key.id;
+    EXPECT_EQ(1U, map.count(key));
+}
+
+static void expectMissing(KeyMap &map, const Key &key) {
+    EXPECT_TRUE(map.find(key) == map.end()) << "key " << key.id;
+    EXPECT_EQ(0U, map.count(key));
+}
+
+TEST_F(HashMapTest, CollidingKeys) {
+    KeyMap map;
+    for (int i = 0; i < FIRST_FILL; i++) {
+        EXPECT_TRUE(map.insert(make_pair(Key(i, 42), i * 10)).second);
+    }
+    EXPECT_EQ((size_t) FIRST_FILL, map.size());
+    EXPECT_EQ((size_t) FIRST_CAPACITY, map.capacity());
+
+    EXPECT_FALSE(map.insert(make_pair(Key(3, 42), -1)).second)
+            << "a key already in the map should not be added again";
+    for (int i = 0; i < FIRST_FILL; i++) {
+        expectFound(map, Key(i, 42), i * 10);
+    }
+    expectMissing(map, Key(FIRST_FILL, 42));
+}
+
+TEST_F(HashMapTest, CollisionsWrapAroundTheTable) {
+    // Iteration goes by slot, so a chain wrapping past the last slot makes a
+    // key other than the first inserted one come first
+    for (size_t hash = 1; hash < 64; hash++) {
+        KeyMap map;
+        for (int i = 0; i < FIRST_FILL; i++) {
+            map.insert(make_pair(Key(i, hash), i));
+        }
+        const int first = map.begin()->first.id;
+        if (first == 0) {
+            continue;
+        }
+
+        // The chain starts at slot 8 - first: erasing its head moves every
+        // entry back across the end of the table
+        map.erase(Key(0, hash));
+        expectMissing(map, Key(0, hash));
+        for (int i = 1; i < FIRST_FILL; i++) {
+            expectFound(map, Key(i, hash), i);
+        }
+
+        // The slot freed at the end of the chain takes the next colliding key
+        EXPECT_TRUE(map.insert(make_pair(Key(100, hash), 100)).second);
+        for (int i = 1; i < FIRST_FILL; i++) {
+            expectFound(map, Key(i, hash), i);
+        }
+        expectFound(map, Key(100, hash), 100);
+
+        // Erasing the end of the chain leaves the keys before it in place
+        map.erase(Key(FIRST_FILL - 1, hash));
+        for (int i = 1; i < FIRST_FILL - 1; i++) {
+            expectFound(map, Key(i, hash), i);
+        }
+        expectFound(map, Key(100, hash), 100);
+        EXPECT_EQ((size_t) FIRST_FILL - 1, map.size());
+        return;
+    }
+    FAIL() << "no hash found whose chain wraps around";
+}
+
+TEST_F(HashMapTest, EraseWithinProbeChains) {
+    // Two chains with different hashes probe through the same slots
+    const size_t hashes[] = { 7, 7 * 31 };
+    for (int erased = 0; erased < FIRST_FILL; erased++) {
+        KeyMap map;
+        for (int i = 0; i < FIRST_FILL; i++) {
+            map.insert(make_pair(Key(i, hashes[i & 1]), i));
+        }
+
+        EXPECT_EQ(1U, map.erase(Key(erased, hashes[erased & 1])));
+        EXPECT_EQ(0U, map.erase(Key(erased, hashes[erased & 1])));
+        EXPECT_EQ((size_t) FIRST_FILL - 1, map.size());
+        for (int i = 0; i < FIRST_FILL; i++) {
+            if (i == erased) {
+                expectMissing(map, Key(i, hashes[i & 1]));
+            } else {
+                expectFound(map, Key(i, hashes[i & 1]), i);
+            }
+        }
+    }
+}
+
+TEST_F(HashMapTest, MatchesStdMap) {
+    // Few distinct hashes keep the chains long while the map grows and shrinks
+    KeyMap map;
+    std::map<int, int> reference;
+    uint32_t random = 12345;
+    for (int op = 0; op < 20000; op++) {
+        random = random * 1103515245 + 12345;
+        const int id = (random >> 8) % 500;
+        const Key key(id, id % 7);
+
+        if ((random >> 24) % 3 == 0) {
+            EXPECT_EQ(reference.erase(id), map.erase(key)) << "op " << op;
+        } else {
+            const bool added = reference.insert(make_pair(id, op)).second;
+            EXPECT_EQ(added, map.insert(make_pair(key, op)).second) << "op " << op;
+        }
+        ASSERT_EQ(reference.size(), map.size()) << "op " << op;
+    }
+
+    for (std::map<int, int>::iterator it = reference.begin(); it != reference.end(); ++it) {
+        expectFound(map, Key(it->first, it->first % 7), it->second);
+    }
+    for (int id = 0; id < 500; id++) {
+        if (reference.count(id) == 0) {
+            expectMissing(map, Key(id, id % 7));
+        }
+    }
+}
+
+TEST_F(HashMapTest, Rehash) {
+    HashMap<int, int> map;
+    EXPECT_EQ(0U, map.capacity());
+    EXPECT_TRUE(map.find(0) == map.end());
+
+    size_t capacity = 0;
+    for (int i = 0; i < 1000; i++) {
+        map[i] = -i;
+        if (map.capacity() != capacity) {
+            EXPECT_GT(map.capacity(), capacity) << "size " << map.size();
+            capacity = map.capacity();
+        }
+        EXPECT_EQ(0U, capacity & (capacity - 1)) << "capacity " << capacity;
+        EXPECT_LE(map.size() * 4, capacity * 3) << "size " << map.size();
+    }
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(-i, map.find(i)->second) << "key " << i;
+    }
+
+    map.clear();
+    EXPECT_EQ(0U, map.size());
+    EXPECT_EQ(0U, map.capacity());
+    EXPECT_TRUE(map.find(0) == map.end());
+
+    map.reserve(5000);
+    capacity = map.capacity();
+    for (int i = 0; i < 5000; i++) {
+        map[i] = i;
+    }
+    EXPECT_EQ(capacity, map.capacity()) << "reserve should make room for every entry";
+    EXPECT_EQ(5000U, map.size());
+}
+
+TEST_F(HashMapTest, Iteration) {
+    HashMap<int, int> map;
+    EXPECT_TRUE(map.begin() == map.end());
+
+    for (int i = 0; i < 100; i++) {
+        map[i * 3] = i;
+    }
+    for (int i = 0; i < 100; i += 2) {
+        map.erase(i * 3);
+    }
+
+    std::set<int> seen;
+    for (HashMap<int, int>::iterator it = map.begin(); it != map.end(); ++it) {
+        EXPECT_TRUE(seen.insert(it->first).second) << "key " << it->first << " visited twice";
+        EXPECT_EQ(it->first, it->second * 3);
+        it->second = -it->second;
+    }
+    EXPECT_EQ(50U, seen.size());
+
+    const HashMap<int, int> &constMap = map;
+    size_t count = 0;
+    for (HashMap<int, int>::const_iterator it = constMap.begin(); it != constMap.end(); ++it) {
+        EXPECT_EQ(it->first, -it->second * 3) << "values should be writable through an iterator";
+        EXPECT_EQ(1, (it->first / 3) & 1);
+        count++;
+    }
+    EXPECT_EQ(map.size(), count);
+
+    HashMap<int, int>::const_iterator found = map.find(3);
+    EXPECT_TRUE(found == constMap.find(3));
+
+    HashSet<int> set = { 1, 2, 3 };
+    std::set<int> keys;
+    for (HashSet<int>::const_iterator it = set.begin(); it != set.end(); ++it) {
+        keys.insert(*it);
+    }
+    EXPECT_EQ(3U, keys.size());
+    EXPECT_EQ(1U, keys.count(2));
+}
+
+static shared_ptr<String> makeString(const char *chars) {
+    return make_shared<String>(UnicodeString(chars));
+}
+
+TEST_F(HashMapTest, StringKeys) {
+    shared_ptr<String> a = makeString("hello");
+    shared_ptr<String> b = makeString("hello");
+    EXPECT_TRUE(a->equals(b.get()));
+    EXPECT_EQ(a->hashCode(), b->hashCode());
+    EXPECT_EQ(99162322, a->hashCode()) << "should hash as java.lang.String does";
+    EXPECT_FALSE(a->equals(makeString("world").get()));
+
+    HashMap<shared_ptr<String>, int> map;
+    map[a] = 1;
+    EXPECT_EQ(1U, map.count(b)) << "an equal String should find the entry";
+    EXPECT_FALSE(map.insert(make_pair(b, 2)).second);
+    EXPECT_EQ(1, map[b]);
+    EXPECT_EQ(0U, map.count(makeString("world")));
+}
+
+TEST_F(HashMapTest, SpannedStringKeys) {
+    shared_ptr<String> text = makeString("hello");
+    shared_ptr<SpannedString> plain = make_shared<SpannedString>(text);
+    shared_ptr<SpannedString> copy = make_shared<SpannedString>(makeString("hello"));
+
+    // Hashes the chars as String does, so that equal objects hash alike
+    EXPECT_EQ(text->hashCode(), plain->hashCode());
+    EXPECT_TRUE(plain->equals(copy.get()));
+    EXPECT_TRUE(copy->equals(plain.get()));
+    EXPECT_EQ(plain->hashCode(), copy->hashCode());
+
+    // A String is not a Spanned, so neither equals the other
+    EXPECT_FALSE(plain->equals(text.get()));
+    EXPECT_FALSE(text->equals(plain.get()));
+
+    // The same chars with a span: the same hash, but a different key
+    shared_ptr<SpannableString> spannable = make_shared<SpannableString>(text);
+    spannable->setSpan(make_shared<Object>(), 0, 2, Spanned::SPAN_EXCLUSIVE_EXCLUSIVE);
+    shared_ptr<SpannedString> spanned = make_shared<SpannedString>(spannable);
+    EXPECT_EQ(plain->hashCode(), spanned->hashCode());
+    EXPECT_FALSE(plain->equals(spanned.get()));
+    EXPECT_TRUE(spanned->equals(spannable.get()));
+
+    HashMap<shared_ptr<CharSequence>, int> map;
+    map[text] = 1;
+    map[plain] = 2;
+    map[spanned] = 3;
+    EXPECT_EQ(3U, map.size());
+    EXPECT_EQ(1, map[makeString("hello")]);
+    EXPECT_EQ(2, map[copy]);
+    EXPECT_EQ(3, map[make_shared<SpannedString>(spannable)]);
+    EXPECT_EQ(3U, map.size());
+
+    EXPECT_EQ(1U, map.erase(copy));
+    EXPECT_EQ(0U, map.count(plain));
+    EXPECT_EQ(1, map[text]);
+    EXPECT_EQ(3, map[spanned]);
+}
+
+ANDROID_END
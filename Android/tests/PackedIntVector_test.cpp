@@ -0,0 +1,135 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Android/text/PackedIntVector.h"
+#include "Android/utils/Exceptions.h"
+
+#include <gtest/gtest.h>
+
+#include <stdlib.h>
+
+ANDROID_BEGIN
+
+class PackedIntVectorTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        srand(1);
+    }
+
+    virtual void TearDown() {
+    }
+};
+
+static const int COLUMNS = 3;
+
+// Plain row-major copy of what the vector should hold
+typedef vector<vector<int>> Reference;
+
+static void expectSame(PackedIntVector &vector, const Reference &reference) {
+    ASSERT_EQ((int) reference.size(), vector.size());
+    for (int row = 0; row < (int) reference.size(); row++) {
+        for (int column = 0; column < COLUMNS; column++) {
+            ASSERT_EQ(reference[row][column], vector.getValue(row, column))
+                    << "row " << row << ", column " << column;
+        }
+    }
+}
+
+static void insertRow(PackedIntVector &vector, Reference &reference, int row) {
+    std::vector<int> values(COLUMNS);
+    for (int column = 0; column < COLUMNS; column++) {
+        values[column] = rand() % 1000;
+    }
+    vector.insertAt(row, values);
+    reference.insert(reference.begin() + row, values);
+}
+
+static void adjustBelow(PackedIntVector &vector, Reference &reference, int row, int column,
+        int delta) {
+    vector.adjustValuesBelow(row, column, delta);
+    for (int i = row; i < (int) reference.size(); i++) {
+        reference[i][column] += delta;
+    }
+}
+
+TEST_F(PackedIntVectorTest, InsertAdjustDelete) {
+    PackedIntVector vector(COLUMNS);
+    Reference reference;
+
+    for (int i = 0; i < 2000; i++) {
+        const int size = (int) reference.size();
+        switch (rand() % 4) {
+            case 0:
+            case 1:
+                insertRow(vector, reference, rand() % (size + 1));
+                break;
+            case 2:
+                adjustBelow(vector, reference, rand() % (size + 1), rand() % COLUMNS,
+                        rand() % 21 - 10);
+                break;
+            case 3:
+                if (size > 0) {
+                    const int row = rand() % size;
+                    const int count = rand() % (size - row) / 4 + 1;
+                    vector.deleteAt(row, count);
+                    reference.erase(reference.begin() + row, reference.begin() + row + count);
+                }
+                break;
+        }
+    }
+    expectSame(vector, reference);
+}
+
+TEST_F(PackedIntVectorTest, ShrinkKeepsValues) {
+    PackedIntVector vector(COLUMNS);
+    Reference reference;
+
+    for (int i = 0; i < 1000; i++) {
+        insertRow(vector, reference, i);
+    }
+    // Leave pending value gaps on both sides of the row gap
+    adjustBelow(vector, reference, 100, 0, 5);
+    adjustBelow(vector, reference, 900, 1, -3);
+    adjustBelow(vector, reference, 10, 2, 7);
+
+    // Shrinks the buffer several times as the rows go away
+    for (int i = 0; i < 49; i++) {
+        vector.deleteAt(20, 20);
+        reference.erase(reference.begin() + 20, reference.begin() + 40);
+        expectSame(vector, reference);
+    }
+    ASSERT_EQ(20, vector.size());
+
+    vector.deleteAt(0, vector.size());
+    reference.clear();
+    expectSame(vector, reference);
+
+    // The shrunk buffer must still grow again
+    for (int i = 0; i < 300; i++) {
+        insertRow(vector, reference, rand() % (i + 1));
+    }
+    adjustBelow(vector, reference, 150, 1, 11);
+    expectSame(vector, reference);
+}
+
+TEST_F(PackedIntVectorTest, OutOfBounds) {
+    PackedIntVector vector(COLUMNS);
+    vector.insertAt(0, std::vector<int>());
+    EXPECT_THROW(vector.getValue(1, 0), IndexOutOfBoundsException);
+    EXPECT_THROW(vector.getValue(0, COLUMNS), IndexOutOfBoundsException);
+    EXPECT_THROW(vector.deleteAt(0, 2), IndexOutOfBoundsException);
+    EXPECT_THROW(vector.insertAt(0, std::vector<int>(1)), IndexOutOfBoundsException);
+}
+
+ANDROID_END
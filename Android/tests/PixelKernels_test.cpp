@@ -0,0 +1,362 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Android/graphics/PixelKernels.h"
+
+#include <SkDither.h>
+#include <SkUnPreMultiply.h>
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <vector>
+
+ANDROID_BEGIN
+
+class PixelKernelsTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        srand(1);
+    }
+
+    virtual void TearDown() {
+    }
+};
+
+// Longest run checked, enough for two vector loops and every tail length
+static const int MAX_COUNT = 45;
+// Pixel offsets of the source and destination, to break 16-byte alignment
+static const int MAX_OFFSET = 4;
+
+/**
+ * Returns random colors mixing translucent, transparent and runs of
+ * opaque pixels, so the opaque shortcuts are taken and skipped.
+ */
+static std::vector<SkColor> randomColors(int count) {
+    std::vector<SkColor> colors(count);
+    for (int i = 0; i < count; i++) {
+        const uint32_t rgb = ((rand() & 0xFFF) << 12) ^ (rand() & 0xFFFFFF);
+        uint32_t alpha = rand() & 0xFF;
+        if (((i / 8) & 3) == 1) alpha = 0xFF;
+        if (i % 11 == 5) alpha = 0;
+        colors[i] = (alpha << 24) | (rgb & 0xFFFFFF);
+    }
+    return colors;
+}
+
+static std::vector<SkPMColor> randomPMColors(int count) {
+    std::vector<SkColor> colors = randomColors(count);
+    std::vector<SkPMColor> pmColors(count);
+    for (int i = 0; i < count; i++) {
+        pmColors[i] = SkPreMultiplyColor(colors[i]);
+    }
+    return pmColors;
+}
+
+TEST_F(PixelKernelsTest, Premultiply) {
+    const std::vector<SkColor> src = randomColors(MAX_COUNT + MAX_OFFSET);
+    std::vector<SkPMColor> dst(MAX_COUNT + MAX_OFFSET);
+    for (int offset = 0; offset < MAX_OFFSET; offset++) {
+        for (int count = 0; count <= MAX_COUNT; count++) {
+            PixelKernels::premultiply(&dst[offset], &src[offset], count);
+            for (int i = 0; i < count; i++) {
+                ASSERT_EQ(SkPreMultiplyColor(src[offset + i]), dst[offset + i])
+                        << "offset " << offset << ", count " << count << ", pixel " << i;
+            }
+        }
+    }
+}
+
+TEST_F(PixelKernelsTest, Unpremultiply) {
+    const std::vector<SkPMColor> src = randomPMColors(MAX_COUNT + MAX_OFFSET);
+    std::vector<SkColor> dst(MAX_COUNT + MAX_OFFSET);
+    for (int offset = 0; offset < MAX_OFFSET; offset++) {
+        for (int count = 0; count <= MAX_COUNT; count++) {
+            PixelKernels::unpremultiply(&dst[offset], &src[offset], count);
+            for (int i = 0; i < count; i++) {
+                ASSERT_EQ(SkUnPreMultiply::PMColorToColor(src[offset + i]), dst[offset + i])
+                        << "offset " << offset << ", count " << count << ", pixel " << i;
+            }
+        }
+    }
+}
+
+TEST_F(PixelKernelsTest, ColorTo565) {
+    const std::vector<SkColor> src = randomColors(MAX_COUNT + MAX_OFFSET);
+    const std::vector<SkPMColor> pmSrc = randomPMColors(MAX_COUNT + MAX_OFFSET);
+    std::vector<uint16_t> dst(MAX_COUNT + MAX_OFFSET);
+    for (int y = 0; y < 4; y++) {
+        DITHER_565_SCAN(y);
+        for (int x = 0; x < 4; x++) {
+            for (int offset = 0; offset < MAX_OFFSET; offset++) {
+                for (int count = 0; count <= MAX_COUNT; count++) {
+                    PixelKernels::colorTo565(&dst[offset], &src[offset], count, x, y);
+                    for (int i = 0; i < count; i++) {
+                        const SkColor c = src[offset + i];
+                        ASSERT_EQ(SkDitherRGBTo565(SkColorGetR(c), SkColorGetG(c),
+                                SkColorGetB(c), DITHER_VALUE(x + i)), dst[offset + i])
+                                << "(" << x << ", " << y << "), offset " << offset
+                                << ", count " << count << ", pixel " << i;
+                    }
+
+                    PixelKernels::pmColorTo565(&dst[offset], &pmSrc[offset], count, x, y);
+                    for (int i = 0; i < count; i++) {
+                        const SkPMColor c = pmSrc[offset + i];
+                        ASSERT_EQ(SkDitherRGBTo565(SkGetPackedR32(c), SkGetPackedG32(c),
+                                SkGetPackedB32(c), DITHER_VALUE(x + i)), dst[offset + i])
+                                << "(" << x << ", " << y << "), offset " << offset
+                                << ", count " << count << ", pixel " << i;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_F(PixelKernelsTest, PMColorTo4444) {
+    const std::vector<SkPMColor> src = randomPMColors(MAX_COUNT + MAX_OFFSET);
+    std::vector<SkPMColor16> dst(MAX_COUNT + MAX_OFFSET);
+    for (int y = 0; y < 4; y++) {
+        DITHER_4444_SCAN(y);
+        for (int x = 0; x < 4; x++) {
+            for (int offset = 0; offset < MAX_OFFSET; offset++) {
+                for (int count = 0; count <= MAX_COUNT; count++) {
+                    PixelKernels::pmColorTo4444(&dst[offset], &src[offset], count, x, y);
+                    for (int i = 0; i < count; i++) {
+                        ASSERT_EQ(SkDitherARGB32To4444(src[offset + i], DITHER_VALUE(x + i)),
+                                dst[offset + i])
+                                << "(" << x << ", " << y << "), offset " << offset
+                                << ", count " << count << ", pixel " << i;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_F(PixelKernelsTest, PMColorToA8) {
+    const std::vector<SkPMColor> src = randomPMColors(MAX_COUNT + MAX_OFFSET);
+    std::vector<uint8_t> dst(MAX_COUNT + MAX_OFFSET);
+    for (int offset = 0; offset < MAX_OFFSET; offset++) {
+        for (int count = 0; count <= MAX_COUNT; count++) {
+            PixelKernels::pmColorToA8(&dst[offset], &src[offset], count);
+            for (int i = 0; i < count; i++) {
+                ASSERT_EQ(SkGetPackedA32(src[offset + i]), dst[offset + i])
+                        << "offset " << offset << ", count " << count << ", pixel " << i;
+            }
+        }
+    }
+}
+
+TEST_F(PixelKernelsTest, IsOpaque) {
+    std::vector<SkPMColor> src(MAX_COUNT + MAX_OFFSET, SkPackARGB32(0xFF, 0x10, 0x20, 0x30));
+    for (int offset = 0; offset < MAX_OFFSET; offset++) {
+        for (int count = 0; count <= MAX_COUNT; count++) {
+            EXPECT_TRUE(PixelKernels::isOpaque(&src[offset], count))
+                    << "offset " << offset << ", count " << count;
+
+            // A single translucent pixel anywhere in the run, vector lanes and tail alike
+            for (int i = 0; i < count; i++) {
+                const SkPMColor saved = src[offset + i];
+                src[offset + i] = SkPackARGB32(0xFE, 0x10, 0x20, 0x30);
+                EXPECT_FALSE(PixelKernels::isOpaque(&src[offset], count))
+                        << "offset " << offset << ", count " << count << ", pixel " << i;
+                src[offset + i] = saved;
+            }
+        }
+    }
+}
+
+static SkPMColor referenceAverage4(SkPMColor a, SkPMColor b, SkPMColor c, SkPMColor d) {
+    SkPMColor result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        const uint32_t sum = ((a >> shift) & 0xFF) + ((b >> shift) & 0xFF) +
+                ((c >> shift) & 0xFF) + ((d >> shift) & 0xFF);
+        result |= ((sum + 2) >> 2) << shift;
+    }
+    return result;
+}
+
+TEST_F(PixelKernelsTest, Downscale2x) {
+    const std::vector<SkPMColor> row0 = randomPMColors(2 * (MAX_COUNT + MAX_OFFSET));
+    const std::vector<SkPMColor> row1 = randomPMColors(2 * (MAX_COUNT + MAX_OFFSET));
+    std::vector<SkPMColor> dst(MAX_COUNT + MAX_OFFSET);
+    for (int offset = 0; offset < MAX_OFFSET; offset++) {
+        for (int count = 0; count <= MAX_COUNT; count++) {
+            // An odd source offset leaves both rows unaligned
+            const SkPMColor* top = &row0[offset];
+            const SkPMColor* bottom = &row1[offset];
+            PixelKernels::downscale2x(&dst[offset], top, bottom, count);
+            for (int i = 0; i < count; i++) {
+                ASSERT_EQ(referenceAverage4(top[2 * i], top[2 * i + 1],
+                        bottom[2 * i], bottom[2 * i + 1]), dst[offset + i])
+                        << "offset " << offset << ", count " << count << ", pixel " << i;
+            }
+        }
+    }
+}
+
+static SkPMColor referenceLerp(SkPMColor a, SkPMColor b, unsigned weight) {
+    SkPMColor result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        const uint32_t value = (((a >> shift) & 0xFF) * (256 - weight) +
+                ((b >> shift) & 0xFF) * weight) >> 8;
+        result |= value << shift;
+    }
+    return result;
+}
+
+TEST_F(PixelKernelsTest, BilinearRow) {
+    const int srcWidth = 17;
+    const std::vector<SkPMColor> row0 = randomPMColors(srcWidth);
+    const std::vector<SkPMColor> row1 = randomPMColors(srcWidth);
+    std::vector<SkPMColor> dst(MAX_COUNT + MAX_OFFSET);
+
+    // Upscales, downscales and samples past both edges
+    const int32_t steps[] = { 0x4000, 0x10000, 0x18000, 0x5555 };
+    for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+        for (unsigned weightY = 0; weightY <= 256; weightY += 64) {
+            for (int offset = 0; offset < MAX_OFFSET; offset++) {
+                const int32_t x0 = -0x20000 + offset * 0x3333;
+                PixelKernels::bilinearRow(&dst[offset], &row0[0], &row1[0], srcWidth,
+                        x0, steps[s], weightY, MAX_COUNT);
+
+                int32_t x = x0;
+                for (int i = 0; i < MAX_COUNT; i++, x += steps[s]) {
+                    const int32_t maxX = (srcWidth - 1) << 16;
+                    const int32_t sx = x < 0 ? 0 : (x > maxX ? maxX : x);
+                    const int left = sx >> 16;
+                    const int right = left + 1 < srcWidth ? left + 1 : left;
+                    const unsigned weightX = (sx >> 8) & 0xFF;
+                    const SkPMColor expected = referenceLerp(
+                            referenceLerp(row0[left], row0[right], weightX),
+                            referenceLerp(row1[left], row1[right], weightX), weightY);
+                    ASSERT_EQ(expected, dst[offset + i])
+                            << "dx " << steps[s] << ", weightY " << weightY
+                            << ", offset " << offset << ", pixel " << i;
+                }
+            }
+        }
+    }
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+TEST_F(PixelKernelsTest, Throughput) {
+    // A 1080p frame, one row at a time
+    const int width = 1920;
+    const int rows = 1080;
+    const std::vector<SkColor> colors = randomColors(2 * width);
+    const std::vector<SkPMColor> pmColors = randomPMColors(2 * width);
+    std::vector<SkPMColor> pmDst(width);
+    std::vector<SkColor> colorDst(width);
+    std::vector<uint16_t> dst16(width);
+    std::vector<uint8_t> dst8(width);
+    uint32_t checksum = 0;
+
+    struct Result {
+        const char* name;
+        double kernel;
+        double scalar;
+    } results[5];
+    double start;
+
+    start = now();
+    for (int y = 0; y < rows; y++) {
+        PixelKernels::premultiply(&pmDst[0], &colors[0], width);
+    }
+    results[0].kernel = now() - start;
+    start = now();
+    for (int y = 0; y < rows; y++) {
+        for (int i = 0; i < width; i++) pmDst[i] = SkPreMultiplyColor(colors[i]);
+    }
+    results[0].scalar = now() - start;
+    results[0].name = "premultiply";
+    checksum += pmDst[width / 2];
+
+    start = now();
+    for (int y = 0; y < rows; y++) {
+        PixelKernels::unpremultiply(&colorDst[0], &pmColors[0], width);
+    }
+    results[1].kernel = now() - start;
+    start = now();
+    for (int y = 0; y < rows; y++) {
+        for (int i = 0; i < width; i++) colorDst[i] = SkUnPreMultiply::PMColorToColor(pmColors[i]);
+    }
+    results[1].scalar = now() - start;
+    results[1].name = "unpremultiply";
+    checksum += colorDst[width / 2];
+
+    start = now();
+    for (int y = 0; y < rows; y++) {
+        PixelKernels::pmColorTo565(&dst16[0], &pmColors[0], width, 0, y);
+    }
+    results[2].kernel = now() - start;
+    start = now();
+    for (int y = 0; y < rows; y++) {
+        DITHER_565_SCAN(y);
+        for (int i = 0; i < width; i++) {
+            const SkPMColor c = pmColors[i];
+            dst16[i] = SkDitherRGBTo565(SkGetPackedR32(c), SkGetPackedG32(c), SkGetPackedB32(c),
+                    DITHER_VALUE(i));
+        }
+    }
+    results[2].scalar = now() - start;
+    results[2].name = "pmColorTo565";
+    checksum += dst16[width / 2];
+
+    start = now();
+    for (int y = 0; y < rows; y++) {
+        PixelKernels::pmColorToA8(&dst8[0], &pmColors[0], width);
+    }
+    results[3].kernel = now() - start;
+    start = now();
+    for (int y = 0; y < rows; y++) {
+        for (int i = 0; i < width; i++) dst8[i] = SkGetPackedA32(pmColors[i]);
+    }
+    results[3].scalar = now() - start;
+    results[3].name = "pmColorToA8";
+    checksum += dst8[width / 2];
+
+    start = now();
+    for (int y = 0; y < rows; y++) {
+        PixelKernels::downscale2x(&pmDst[0], &pmColors[0], &pmColors[width], width / 2);
+    }
+    results[4].kernel = now() - start;
+    start = now();
+    for (int y = 0; y < rows; y++) {
+        for (int i = 0; i < width / 2; i++) {
+            pmDst[i] = referenceAverage4(pmColors[2 * i], pmColors[2 * i + 1],
+                    pmColors[width + 2 * i], pmColors[width + 2 * i + 1]);
+        }
+    }
+    results[4].scalar = now() - start;
+    results[4].name = "downscale2x";
+    checksum += pmDst[width / 4];
+
+    EXPECT_NE(0U, checksum);
+    for (size_t i = 0; i < sizeof(results) / sizeof(results[0]); i++) {
+        printf("%-14s %7.1f Mpixel/s, scalar %7.1f Mpixel/s\n", results[i].name,
+                width * rows / results[i].kernel / 1e6, width * rows / results[i].scalar / 1e6);
+    }
+}
+
+ANDROID_END
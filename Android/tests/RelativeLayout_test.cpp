@@ -0,0 +1,327 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Android/widget/RelativeLayout.h"
+#include "Android/widget/RelativeLayoutParams.h"
+
+#include <gtest/gtest.h>
+
+#include <deque>
+#include <map>
+
+#include <stdio.h>
+#include <time.h>
+
+ANDROID_BEGIN
+
+static const int CHILDREN = 50;
+
+class RelativeLayoutTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        mLayout = make_shared<RelativeLayout>((Context*) NULL);
+    }
+
+    virtual void TearDown() {
+    }
+
+    // Sorts the children as onMeasure does
+    void sortChildren() {
+        mLayout->sortChildren();
+    }
+
+    const vector<shared_ptr<View>> &getSortedVerticalChildren() {
+        return mLayout->m_sortedVerticalChildren;
+    }
+
+    const vector<shared_ptr<View>> &getSortedHorizontalChildren() {
+        return mLayout->m_sortedHorizontalChildren;
+    }
+
+    const int *getRulesVertical() { return RelativeLayout::RULES_VERTICAL; }
+    const int *getRulesHorizontal() { return RelativeLayout::RULES_HORIZONTAL; }
+
+    vector<shared_ptr<View>> getChildren() {
+        vector<shared_ptr<View>> children;
+        for (int i = 0; i < mLayout->getChildCount(); i++) {
+            children.push_back(mLayout->getChildAt(i));
+        }
+        return children;
+    }
+
+    shared_ptr<RelativeLayout> mLayout;
+};
+
+static string getChildId(int i) {
+    char id[16];
+    snprintf(id, sizeof(id), "child%d", i);
+    return id;
+}
+
+static int64_t getKey(const string &id) {
+    return (int64_t) hash<string>()(id);
+}
+
+static RelativeLayoutParams *getParams(const shared_ptr<View> &child) {
+    return (RelativeLayoutParams*) child->getLayoutParams();
+}
+
+static void setRule(const shared_ptr<View> &child, int verb, int64_t anchor) {
+    RelativeLayoutParams *params = getParams(child);
+    params->m_rules[verb] = anchor;
+    params->m_initialRules[verb] = anchor;
+}
+
+// The rules a child may use: the ones the two sorts look at, without the
+// relative ones that depend on the layout direction
+static const int VERBS[] = {
+    RelativeLayoutParams::ABOVE, RelativeLayoutParams::BELOW, RelativeLayoutParams::ALIGN_BASELINE,
+    RelativeLayoutParams::ALIGN_TOP, RelativeLayoutParams::ALIGN_BOTTOM,
+    RelativeLayoutParams::LEFT_OF, RelativeLayoutParams::RIGHT_OF,
+    RelativeLayoutParams::ALIGN_LEFT, RelativeLayoutParams::ALIGN_RIGHT
+};
+static const int RULE_COUNT = sizeof(VERBS) / sizeof(VERBS[0]);
+
+/**
+ * Adds children whose rules form an acyclic graph: each child only depends
+ * on children ranked before it, which may come before or after it in the
+ * layout. Some rules name an unknown id or the child itself, and some
+ * children have two rules with the same anchor.
+ */
+static void addChildren(const shared_ptr<RelativeLayout> &layout, uint32_t seed) {
+    uint32_t random = seed;
+    vector<int> rank(CHILDREN);
+    for (int i = 0; i < CHILDREN; i++) {
+        rank[i] = i;
+    }
+    for (int i = CHILDREN - 1; i > 0; i--) {
+        random = random * 1103515245 + 12345;
+        swap(rank[i], rank[(random >> 8) % (i + 1)]);
+    }
+
+    for (int i = 0; i < CHILDREN; i++) {
+        shared_ptr<View> child = make_shared<View>((Context*) NULL);
+        child->setId(getChildId(i));
+        layout->addView(child, new RelativeLayoutParams(LayoutParams::WRAP_CONTENT,
+                LayoutParams::WRAP_CONTENT));
+    }
+
+    for (int i = 0; i < CHILDREN; i++) {
+        shared_ptr<View> child = layout->getChildAt(i);
+        for (int r = 0; r < 3; r++) {
+            random = random * 1103515245 + 12345;
+            const int verb = VERBS[(random >> 8) % RULE_COUNT];
+            const int anchor = (random >> 16) % CHILDREN;
+            switch ((random >> 28) % 8) {
+                case 0:
+                    setRule(child, verb, getKey("unknown"));
+                    break;
+                case 1:
+                    setRule(child, verb, getKey(getChildId(i)));
+                    break;
+                default:
+                    if (rank[anchor] < rank[i]) {
+                        setRule(child, verb, getKey(getChildId(anchor)));
+                    }
+                    break;
+            }
+        }
+    }
+}
+
+/**
+ * The sort of the map-based graph the flat arrays replaced. It keeps its
+ * fixes: the dependencies are erased from the node rather than from a copy,
+ * unknown ids are skipped and negative id hashes count.
+ */
+struct MapNode {
+    shared_ptr<View> view;
+    map<MapNode*, bool> dependents;
+    map<int64_t, MapNode*> dependencies;
+};
+
+static vector<shared_ptr<View>> mapSort(const vector<shared_ptr<View>> &children,
+        const int rulesFilter[], int rulesCount) {
+    const int count = children.size();
+
+    // Contiguous, so that the dependents iterate in the order of the children
+    vector<MapNode> nodes(count);
+    map<int64_t, MapNode*> keyNodes;
+    for (int i = 0; i < count; i++) {
+        nodes[i].view = children[i];
+        if (children[i]->getId() != View::NO_ID) {
+            keyNodes[getKey(children[i]->getId())] = &nodes[i];
+        }
+    }
+
+    for (int i = 0; i < count; i++) {
+        MapNode *node = &nodes[i];
+        const vector<int64_t> &rules = getParams(node->view)->getRules();
+        for (int j = 0; j < rulesCount; j++) {
+            const int64_t rule = rules[rulesFilter[j]];
+            if (rule != 0) {
+                map<int64_t, MapNode*>::iterator it = keyNodes.find(rule);
+                if (it == keyNodes.end() || it->second == node) {
+                    continue;
+                }
+                it->second->dependents[node] = true;
+                node->dependencies[rule] = it->second;
+            }
+        }
+    }
+
+    deque<MapNode*> roots;
+    for (int i = 0; i < count; i++) {
+        if (nodes[i].dependencies.empty()) roots.push_back(&nodes[i]);
+    }
+
+    vector<shared_ptr<View>> sorted;
+    while (!roots.empty()) {
+        MapNode *node = roots.back();
+        roots.pop_back();
+        sorted.push_back(node->view);
+
+        const int64_t key = getKey(node->view->getId());
+        for (map<MapNode*, bool>::iterator it = node->dependents.begin();
+                it != node->dependents.end(); ++it) {
+            MapNode *dependent = it->first;
+            dependent->dependencies.erase(key);
+            if (dependent->dependencies.empty()) {
+                roots.push_back(dependent);
+            }
+        }
+    }
+    return sorted;
+}
+
+static void expectSameOrder(const vector<shared_ptr<View>> &expected,
+        const vector<shared_ptr<View>> &sorted, const char *axis) {
+    ASSERT_EQ(expected.size(), sorted.size()) << axis;
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_TRUE(expected[i] == sorted[i]) << axis << " position " << i << ": expected "
+                << expected[i]->getId() << ", sorted "
+                << (sorted[i] != NULL ? sorted[i]->getId() : string("NULL"));
+    }
+}
+
+TEST_F(RelativeLayoutTest, SortMatchesMapSort) {
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        mLayout = make_shared<RelativeLayout>((Context*) NULL);
+        addChildren(mLayout, seed);
+        sortChildren();
+
+        const vector<shared_ptr<View>> children = getChildren();
+        expectSameOrder(mapSort(children, getRulesVertical(), 5),
+                getSortedVerticalChildren(), "vertical");
+        expectSameOrder(mapSort(children, getRulesHorizontal(), 8),
+                getSortedHorizontalChildren(), "horizontal");
+    }
+}
+
+TEST_F(RelativeLayoutTest, SortFollowsChangedRules) {
+    addChildren(mLayout, 7);
+    sortChildren();
+
+    // The last child now comes first: everything else is below it
+    const shared_ptr<View> last = mLayout->getChildAt(CHILDREN - 1);
+    for (int i = 0; i < CHILDREN; i++) {
+        setRule(last, VERBS[i % RULE_COUNT], 0);
+    }
+    for (int i = 0; i < CHILDREN - 1; i++) {
+        setRule(mLayout->getChildAt(i), RelativeLayoutParams::BELOW, getKey(last->getId()));
+    }
+    sortChildren();
+
+    const vector<shared_ptr<View>> children = getChildren();
+    expectSameOrder(mapSort(children, getRulesVertical(), 5),
+            getSortedVerticalChildren(), "vertical");
+    EXPECT_TRUE(getSortedVerticalChildren()[0] == last);
+    expectSameOrder(mapSort(children, getRulesHorizontal(), 8),
+            getSortedHorizontalChildren(), "horizontal");
+}
+
+TEST_F(RelativeLayoutTest, CycleLeavesSortedPrefix) {
+    addChildren(mLayout, 3);
+    setRule(mLayout->getChildAt(0), RelativeLayoutParams::ABOVE, getKey(getChildId(1)));
+    setRule(mLayout->getChildAt(1), RelativeLayoutParams::ABOVE, getKey(getChildId(0)));
+    sortChildren();
+
+    const vector<shared_ptr<View>> expected = mapSort(getChildren(), getRulesVertical(), 5);
+    const vector<shared_ptr<View>> &sorted = getSortedVerticalChildren();
+    ASSERT_LT(expected.size(), sorted.size());
+    for (size_t i = 0; i < sorted.size(); i++) {
+        if (i < expected.size()) {
+            EXPECT_TRUE(expected[i] == sorted[i]) << "position " << i;
+        } else {
+            EXPECT_TRUE(sorted[i] == NULL) << "position " << i;
+        }
+    }
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+TEST_F(RelativeLayoutTest, MeasureFiftyChildren) {
+    const int iterations = 1000;
+    const int widthSpec = View::MeasureSpec::makeMeasureSpec(480, View::MeasureSpec::EXACTLY);
+    const int heightSpec = View::MeasureSpec::makeMeasureSpec(800, View::MeasureSpec::EXACTLY);
+
+    addChildren(mLayout, 11);
+    const shared_ptr<View> first = mLayout->getChildAt(0);
+    const int64_t firstBelow = getParams(first)->getRules()[RelativeLayoutParams::BELOW];
+
+    double start = now();
+    for (int i = 0; i < iterations; i++) {
+        mLayout->requestLayout();
+        mLayout->measure(widthSpec, heightSpec);
+        mLayout->layout(0, 0, 480, 800);
+    }
+    const double cached = now() - start;
+
+    // A changed rule makes every pass rebuild the graph
+    start = now();
+    for (int i = 0; i < iterations; i++) {
+        setRule(first, RelativeLayoutParams::BELOW, (i & 1) ? firstBelow : getKey("unknown"));
+        mLayout->requestLayout();
+        mLayout->measure(widthSpec, heightSpec);
+        mLayout->layout(0, 0, 480, 800);
+    }
+    const double rebuilt = now() - start;
+
+    // The sorts alone, against the map-based one
+    start = now();
+    for (int i = 0; i < iterations; i++) {
+        setRule(first, RelativeLayoutParams::BELOW, (i & 1) ? firstBelow : getKey("unknown"));
+        sortChildren();
+    }
+    const double sort = now() - start;
+
+    const vector<shared_ptr<View>> children = getChildren();
+    start = now();
+    for (int i = 0; i < iterations; i++) {
+        setRule(first, RelativeLayoutParams::BELOW, (i & 1) ? firstBelow : getKey("unknown"));
+        mapSort(children, getRulesVertical(), 5);
+        mapSort(children, getRulesHorizontal(), 8);
+    }
+    const double mapSorts = now() - start;
+
+    printf("RelativeLayout: %d children, measure+layout %.1f us cached, %.1f us rebuilt, "
+            "sort %.1f us, map sort %.1f us\n", CHILDREN, cached * 1e6 / iterations,
+            rebuilt * 1e6 / iterations, sort * 1e6 / iterations, mapSorts * 1e6 / iterations);
+}
+
+ANDROID_END
@@ -0,0 +1,167 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Android/text/DynamicLayout.h"
+#include "Android/text/SpannableStringBuilder.h"
+#include "Android/text/StaticLayout.h"
+#include "Android/text/String.h"
+#include "Android/text/TextPaint.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include <stdio.h>
+#include <time.h>
+
+ANDROID_BEGIN
+
+class TextLayoutStressTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+    }
+
+    virtual void TearDown() {
+    }
+};
+
+static const int WIDTH = 240;
+static const int PARAGRAPHS = 2000;
+static const int THREADS = 8;
+
+static const char* const WORDS[] = {
+    "The", "quick", "brown", "fox", "jumps", "over", "the", "lazy", "dog,",
+    "then", "keeps", "on", "running", "until", "every", "paragraph", "wraps.",
+    "Supercalifragilisticexpialidocious", "a", "I", "(and", "so", "on)"
+};
+static const int WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Paragraphs of different lengths, so that they break into different lines
+static UnicodeString makeParagraph(int index) {
+    UnicodeString text;
+    const int words = 5 + (index * 7) % 60;
+    for (int i = 0; i < words; i++) {
+        if (i > 0) {
+            text += " ";
+        }
+        text += WORDS[(index + i * 3) % WORD_COUNT];
+    }
+    return text;
+}
+
+static shared_ptr<TextPaint> makePaint() {
+    shared_ptr<TextPaint> paint = make_shared<TextPaint>();
+    paint->setTextSize(16);
+    return paint;
+}
+
+// What a layout measured: the line breaks, their positions and widths
+struct Lines {
+    vector<int> starts;
+    vector<int> tops;
+    vector<float> widths;
+    float desiredWidth = 0;
+};
+
+static void measure(Layout &layout, shared_ptr<CharSequence> text, shared_ptr<TextPaint> paint,
+        Lines &lines) {
+    lines.starts.clear();
+    lines.tops.clear();
+    lines.widths.clear();
+    for (int line = 0; line < layout.getLineCount(); line++) {
+        lines.starts.push_back(layout.getLineStart(line));
+        lines.tops.push_back(layout.getLineTop(line));
+        lines.widths.push_back(layout.getLineWidth(line));
+    }
+    lines.desiredWidth = Layout::getDesiredWidth(text, paint);
+}
+
+static void layOut(const UnicodeString &paragraph, shared_ptr<TextPaint> paint,
+        Lines &staticLines, Lines &dynamicLines) {
+    shared_ptr<String> text = make_shared<String>(paragraph);
+    StaticLayout staticLayout(text, paint, WIDTH, Layout::Alignment::ALIGN_NORMAL,
+            1.0f, 0.0f, true);
+    measure(staticLayout, text, paint, staticLines);
+
+    shared_ptr<SpannableStringBuilder> editable = make_shared<SpannableStringBuilder>(text);
+    DynamicLayout dynamicLayout(editable, paint, WIDTH, Layout::Alignment::ALIGN_NORMAL,
+            1.0f, 0.0f, true);
+    measure(dynamicLayout, editable, paint, dynamicLines);
+}
+
+static void expectSameLines(const Lines &reference, const Lines &lines, int paragraph,
+        const char *layout) {
+    ASSERT_EQ(reference.starts.size(), lines.starts.size())
+            << layout << " paragraph " << paragraph;
+    for (size_t line = 0; line < reference.starts.size(); line++) {
+        ASSERT_EQ(reference.starts[line], lines.starts[line])
+                << layout << " paragraph " << paragraph << " line " << line;
+        ASSERT_EQ(reference.tops[line], lines.tops[line])
+                << layout << " paragraph " << paragraph << " line " << line;
+        ASSERT_EQ(reference.widths[line], lines.widths[line])
+                << layout << " paragraph " << paragraph << " line " << line;
+    }
+    EXPECT_EQ(reference.desiredWidth, lines.desiredWidth) << layout << " paragraph " << paragraph;
+}
+
+TEST_F(TextLayoutStressTest, ConcurrentLayoutsMatchSingleThreaded) {
+    vector<UnicodeString> paragraphs;
+    for (int i = 0; i < PARAGRAPHS; i++) {
+        paragraphs.push_back(makeParagraph(i));
+    }
+
+    vector<Lines> staticReference(PARAGRAPHS), dynamicReference(PARAGRAPHS);
+    shared_ptr<TextPaint> paint = makePaint();
+    double start = now();
+    for (int i = 0; i < PARAGRAPHS; i++) {
+        layOut(paragraphs[i], paint, staticReference[i], dynamicReference[i]);
+    }
+    const double single = now() - start;
+
+    // Every worker takes the next paragraph until all of them are laid out
+    vector<Lines> staticLines(PARAGRAPHS), dynamicLines(PARAGRAPHS);
+    atomic<int> next(0);
+    vector<thread> workers;
+    start = now();
+    for (int t = 0; t < THREADS; t++) {
+        workers.push_back(thread([&]() {
+            shared_ptr<TextPaint> workerPaint = makePaint();
+            for (int i = next++; i < PARAGRAPHS; i = next++) {
+                layOut(paragraphs[i], workerPaint, staticLines[i], dynamicLines[i]);
+            }
+        }));
+    }
+    for (size_t t = 0; t < workers.size(); t++) {
+        workers[t].join();
+    }
+    const double concurrent = now() - start;
+
+    for (int i = 0; i < PARAGRAPHS; i++) {
+        expectSameLines(staticReference[i], staticLines[i], i, "StaticLayout");
+        expectSameLines(dynamicReference[i], dynamicLines[i], i, "DynamicLayout");
+    }
+
+    printf("Text layout: %d paragraphs, 1 thread %.1f ms, %d threads %.1f ms\n",
+            PARAGRAPHS, single * 1e3, THREADS, concurrent * 1e3);
+}
+
+ANDROID_END
@@ -26,8 +26,6 @@ using namespace icu;
 
 ANDROID_BEGIN
 
-TextPaint BoringLayout::sTemp = TextPaint();
-
 string BoringLayout::Metrics::toString() {
     stringstream str;
     str << Paint::FontMetricsInt::toString() << " width=" << width;
@@ -214,7 +212,7 @@ shared_ptr<BoringLayout::Metrics> BoringLayout::isBoring(shared_ptr<CharSequence
 
 shared_ptr<BoringLayout::Metrics> BoringLayout::isBoring(shared_ptr<CharSequence> text, shared_ptr<TextPaint> paint,
                         shared_ptr<TextDirectionHeuristic> textDir, shared_ptr<Metrics> metrics) {
-    UnicodeString *temp = TextUtils::obtain(500);
+    shared_ptr<UnicodeString> temp = TextUtils::obtain(500);
     int length = text->length();
     bool boring = true;
     
@@ -39,9 +39,13 @@ class String;
  * you are encouraged to use a Layout instead of calling
  * {@link android.graphics.Canvas#drawText(CharSequence, int, int, float, float, android.graphics.Paint)
  *  Canvas.drawText()} directly.</p>
+ * <p>Like {@link StaticLayout}, it may be measured and built on several
+ * threads at once.</p>
  */
 class BoringLayout : public Layout, public TextUtils::EllipsizeCallback, public enable_shared_from_this<BoringLayout> {
     
+    friend class PrecomputedText;
+    
 public:
     
     class Metrics : public Paint::FontMetricsInt {
@@ -191,8 +195,6 @@ private:
     int mTopPadding = 0, mBottomPadding = 0;
     float mMax = 0;
     int mEllipsizedWidth = 0, mEllipsizedStart = 0, mEllipsizedCount = 0;
-    
-    static TextPaint sTemp;
 };
 
 ANDROID_END
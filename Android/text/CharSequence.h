@@ -32,15 +32,14 @@ class String;
  * Multilingual Plane (BMP)</i> or a surrogate. Refer to <a
  * href="Character.html#unicode">Unicode Character Representation</a> for details.
  *
- * <p> This interface does not refine the general contracts of the {@link
- * java.lang.Object#equals(java.lang.Object) equals} and {@link
- * java.lang.Object#hashCode() hashCode} methods.  The result of comparing two
- * objects that implement <tt>CharSequence</tt> is therefore, in general,
- * undefined.  Each object may be implemented by a different class, and there
- * is no guarantee that each class will be capable of testing its instances
- * for equality with those of the other.  It is therefore inappropriate to use
- * arbitrary <tt>CharSequence</tt> instances as elements in a set or as keys in
- * a map. </p>
+ * <p> Sequences whose chars do not change ({@link String}, {@link
+ * SpannedString} and {@link SpannableString}) hash their chars as {@link
+ * String#hashCode()} does, so equal sequences of these have equal hashes and
+ * may be used as keys of a HashMap.  {@link String} equals only a String with
+ * the same chars; the spanned strings equal a Spanned with the same chars and
+ * spans.  Other sequences, such as {@link SpannableStringBuilder}, keep the
+ * identity of {@link Object}.  Use {@link TextUtils#equals} to compare the
+ * chars of any two sequences. </p>
  *
  * @author Mike McCloskey
  * @since 1.4
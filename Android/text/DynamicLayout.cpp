@@ -0,0 +1,400 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "DynamicLayout.h"
+
+#include "Android/graphics/Paint.h"
+#include "Android/text/CharSequence.h"
+#include "Android/text/Spannable.h"
+#include "Android/text/Spanned.h"
+#include "Android/text/StaticLayout.h"
+#include "Android/text/TextDirectionHeuristics.h"
+#include "Android/text/TextPaint.h"
+#include "Android/text/TextUtils.h"
+#include "Android/text/style/UpdateLayout.h"
+#include "Android/text/style/WrapTogetherSpan.h"
+
+ANDROID_BEGIN
+
+Pools::ThreadLocalPool<StaticLayout> DynamicLayout::sStaticLayout(1);
+
+DynamicLayout::DynamicLayout(shared_ptr<CharSequence> base,
+                             shared_ptr<TextPaint> paint,
+                             int width, Alignment align,
+                             float spacingmult, float spacingadd,
+                             bool includepad) : DynamicLayout(base, base, paint, width, align, spacingmult, spacingadd,
+                                                              includepad) {
+}
+
+DynamicLayout::DynamicLayout(shared_ptr<CharSequence> base, shared_ptr<CharSequence> display,
+                             shared_ptr<TextPaint> paint,
+                             int width, Alignment align,
+                             float spacingmult, float spacingadd,
+                             bool includepad) : DynamicLayout(base, display, paint, width, align,
+                                                              TextDirectionHeuristics::FIRSTSTRONG_LTR,
+                                                              spacingmult, spacingadd, includepad, NULL, 0) {
+}
+
+DynamicLayout::DynamicLayout(shared_ptr<CharSequence> base, shared_ptr<CharSequence> display,
+                             shared_ptr<TextPaint> paint,
+                             int width, Alignment align, shared_ptr<TextDirectionHeuristic> textDir,
+                             float spacingmult, float spacingadd,
+                             bool includepad,
+                             shared_ptr<TextUtils::TruncateAt> ellipsize, int ellipsizedWidth) : Layout(createText(display, ellipsize),
+                                                                                                        paint, width, align, textDir, spacingmult, spacingadd),
+                                                                                                 mInts(ellipsize != NULL ? COLUMNS_ELLIPSIZE : COLUMNS_NORMAL),
+                                                                                                 mObjects(1) {
+    mBase = base;
+    mDisplay = display;
+    
+    if (ellipsize != NULL) {
+        mEllipsizedWidth = ellipsizedWidth;
+        mEllipsizeAt = ellipsize;
+    } else {
+        mEllipsizedWidth = width;
+        mEllipsizeAt = NULL;
+    }
+    
+    mIncludePad = includepad;
+    
+    if (ellipsize != NULL) {
+        shared_ptr<Ellipsizer> e = dynamic_pointer_cast<Ellipsizer>(getText());
+        
+        e->mLayout = this;
+        e->mWidth = ellipsizedWidth;
+        e->mMethod = ellipsize;
+        mEllipsize = true;
+    }
+    
+    // Initial state is a single line with 0 characters (0 to 0),
+    // with top at 0 and bottom at whatever is natural, and
+    // undefined ellipsis.
+    
+    vector<int> start;
+    
+    if (ellipsize != NULL) {
+        start = vector<int>(COLUMNS_ELLIPSIZE);
+        start[ELLIPSIS_START] = ELLIPSIS_UNDEFINED;
+    } else {
+        start = vector<int>(COLUMNS_NORMAL);
+    }
+    
+    vector<Directions> dirs = vector<Directions>(1, Directions::DIRS_ALL_LEFT_TO_RIGHT);
+    
+    shared_ptr<Paint::FontMetricsInt> fm = make_shared<Paint::FontMetricsInt>();
+    paint->getFontMetricsInt(fm);
+    int asc = fm->ascent;
+    int desc = fm->descent;
+    
+    start[DIR] = Directions::DIR_LEFT_TO_RIGHT << DIR_SHIFT;
+    start[TOP] = 0;
+    start[DESCENT] = desc;
+    mInts.insertAt(0, start);
+    
+    start[TOP] = desc - asc;
+    mInts.insertAt(1, start);
+    
+    mObjects.insertAt(0, dirs);
+    
+    // Update from 0 characters to whatever the real text is
+    reflow(base, 0, 0, base->length());
+    
+    shared_ptr<Spannable> sp = dynamic_pointer_cast<Spannable>(base);
+    if (sp != NULL) {
+        if (mWatcher == NULL)
+            mWatcher = make_shared<ChangeWatcher>(this);
+        
+        // Strip out any watchers for other DynamicLayouts.
+        vector<shared_ptr<Object>> spans = sp->getSpans(0, sp->length(), "DynamicLayout::ChangeWatcher");
+        for (int i = 0; i < spans.size(); i++)
+            sp->removeSpan(spans[i]);
+        
+        sp->setSpan(mWatcher, 0, base->length(),
+                    Spannable::SPAN_INCLUSIVE_INCLUSIVE |
+                    (PRIORITY << Spannable::SPAN_PRIORITY_SHIFT));
+    }
+}
+
+DynamicLayout::~DynamicLayout() {
+    if (mWatcher != NULL) {
+        mWatcher->detach();
+        
+        shared_ptr<Spannable> sp = dynamic_pointer_cast<Spannable>(mBase);
+        if (sp != NULL) {
+            sp->removeSpan(mWatcher);
+        }
+    }
+}
+
+shared_ptr<CharSequence> DynamicLayout::createText(shared_ptr<CharSequence> display, shared_ptr<TextUtils::TruncateAt> ellipsize) {
+    if (ellipsize == NULL) {
+        return display;
+    } else if (dynamic_pointer_cast<Spanned>(display) != NULL) {
+        return make_shared<SpannedEllipsizer>(display);
+    } else {
+        return make_shared<Ellipsizer>(display);
+    }
+}
+
+void DynamicLayout::reflow(shared_ptr<CharSequence> s, int where, int before, int after) {
+    if (s != mBase)
+        return;
+    
+    shared_ptr<CharSequence> text = mDisplay;
+    int len = text->length();
+    
+    // seek back to the start of the paragraph
+    
+    int find = TextUtils::lastIndexOf(text, '\n', where - 1);
+    if (find < 0)
+        find = 0;
+    else
+        find = find + 1;
+    
+    {
+        int diff = where - find;
+        before += diff;
+        after += diff;
+        where -= diff;
+    }
+    
+    // seek forward to the end of the paragraph
+    
+    int look = TextUtils::indexOf(text, '\n', where + after);
+    if (look < 0)
+        look = len;
+    else
+        look++; // we want the index after the \n
+    
+    int change = look - (where + after);
+    before += change;
+    after += change;
+    
+    // seek further out to cover anything that is forced to wrap together
+    
+    shared_ptr<Spanned> sp = dynamic_pointer_cast<Spanned>(text);
+    if (sp != NULL) {
+        bool again;
+        
+        do {
+            again = false;
+            
+            vector<shared_ptr<Object>> force = sp->getSpans(where, where + after,
+                                                            "WrapTogetherSpan");
+            
+            for (int i = 0; i < force.size(); i++) {
+                int st = sp->getSpanStart(force[i]);
+                int en = sp->getSpanEnd(force[i]);
+                
+                if (st < where) {
+                    again = true;
+                    
+                    int diff = where - st;
+                    before += diff;
+                    after += diff;
+                    where -= diff;
+                }
+                
+                if (en > where + after) {
+                    again = true;
+                    
+                    int diff = en - (where + after);
+                    before += diff;
+                    after += diff;
+                }
+            }
+        } while (again);
+    }
+    
+    // find affected region of old layout
+    
+    int startline = getLineForOffset(where);
+    int startv = getLineTop(startline);
+    
+    int endline = getLineForOffset(where + before);
+    if (where + after == len)
+        endline = getLineCount();
+    int endv = getLineTop(endline);
+    bool islast = (endline == getLineCount());
+    
+    // generate new layout for affected text
+    
+    shared_ptr<StaticLayout> reflowed = sStaticLayout.acquire();
+    
+    if (reflowed == NULL) {
+        reflowed = shared_ptr<StaticLayout>(new StaticLayout(NULL));
+    } else {
+        reflowed->prepare();
+    }
+    
+    reflowed->generate(text, where, where + after,
+                       getPaint(), getWidth(), getTextDirectionHeuristic(), getSpacingMultiplier(),
+                       getSpacingAdd(), false,
+                       true, mEllipsizedWidth, mEllipsizeAt);
+    int n = reflowed->getLineCount();
+    
+    // If the new layout has a blank line at the end, but it is not
+    // the very end of the buffer, then we already have a line that
+    // starts there, so disregard the blank line.
+    
+    if (where + after != len && reflowed->getLineStart(n - 1) == where + after)
+        n--;
+    
+    // remove affected lines from old layout
+    mInts.deleteAt(startline, endline - startline);
+    mObjects.deleteAt(startline, endline - startline);
+    
+    // adjust offsets in layout for new height and offsets
+    
+    int ht = reflowed->getLineTop(n);
+    int toppad = 0, botpad = 0;
+    
+    if (mIncludePad && startline == 0) {
+        toppad = reflowed->getTopPadding();
+        mTopPadding = toppad;
+        ht -= toppad;
+    }
+    if (mIncludePad && islast) {
+        botpad = reflowed->getBottomPadding();
+        mBottomPadding = botpad;
+        ht += botpad;
+    }
+    
+    mInts.adjustValuesBelow(startline, START, after - before);
+    mInts.adjustValuesBelow(startline, TOP, startv - endv + ht);
+    
+    // insert new layout
+    
+    vector<int> ints;
+    
+    if (mEllipsize) {
+        ints = vector<int>(COLUMNS_ELLIPSIZE);
+        ints[ELLIPSIS_START] = ELLIPSIS_UNDEFINED;
+    } else {
+        ints = vector<int>(COLUMNS_NORMAL);
+    }
+    
+    vector<Directions> objects = vector<Directions>(1);
+    
+    for (int i = 0; i < n; i++) {
+        ints[START] = reflowed->getLineStart(i) |
+                      (reflowed->getParagraphDirection(i) << DIR_SHIFT) |
+                      (reflowed->getLineContainsTab(i) ? TAB_MASK : 0);
+        
+        int top = reflowed->getLineTop(i) + startv;
+        if (i > 0)
+            top -= toppad;
+        ints[TOP] = top;
+        
+        int desc = reflowed->getLineDescent(i);
+        if (i == n - 1)
+            desc += botpad;
+        
+        ints[DESCENT] = desc;
+        objects[0] = reflowed->getLineDirections(i);
+        
+        if (mEllipsize) {
+            ints[ELLIPSIS_START] = reflowed->getEllipsisStart(i);
+            ints[ELLIPSIS_COUNT] = reflowed->getEllipsisCount(i);
+        }
+        
+        mInts.insertAt(startline + i, ints);
+        mObjects.insertAt(startline + i, objects);
+    }
+    
+    reflowed->finish();
+    sStaticLayout.release(reflowed);
+}
+
+int DynamicLayout::getLineCount() {
+    return mInts.size() - 1;
+}
+
+int DynamicLayout::getLineTop(int line) {
+    return mInts.getValue(line, TOP);
+}
+
+int DynamicLayout::getLineDescent(int line) {
+    return mInts.getValue(line, DESCENT);
+}
+
+int DynamicLayout::getLineStart(int line) {
+    return mInts.getValue(line, START) & START_MASK;
+}
+
+bool DynamicLayout::getLineContainsTab(int line) {
+    return (mInts.getValue(line, TAB) & TAB_MASK) != 0;
+}
+
+int DynamicLayout::getParagraphDirection(int line) {
+    return mInts.getValue(line, DIR) >> DIR_SHIFT;
+}
+
+Directions DynamicLayout::getLineDirections(int line) {
+    return mObjects.getValue(line, 0);
+}
+
+int DynamicLayout::getTopPadding() {
+    return mTopPadding;
+}
+
+int DynamicLayout::getBottomPadding() {
+    return mBottomPadding;
+}
+
+int DynamicLayout::getEllipsizedWidth() {
+    return mEllipsizedWidth;
+}
+
+int DynamicLayout::getEllipsisStart(int line) {
+    if (mEllipsizeAt == NULL) {
+        return 0;
+    }
+    
+    return mInts.getValue(line, ELLIPSIS_START);
+}
+
+int DynamicLayout::getEllipsisCount(int line) {
+    if (mEllipsizeAt == NULL) {
+        return 0;
+    }
+    
+    return mInts.getValue(line, ELLIPSIS_COUNT);
+}
+
+void DynamicLayout::ChangeWatcher::reflow(shared_ptr<CharSequence> s, int where, int before, int after) {
+    // The layout removes this watcher from the text when it is destroyed.
+    if (mLayout != NULL) {
+        mLayout->reflow(s, where, before, after);
+    }
+}
+
+void DynamicLayout::ChangeWatcher::onSpanAdded(shared_ptr<Spannable> s, shared_ptr<Object> o, int start, int end) {
+    if (dynamic_pointer_cast<UpdateLayout>(o) != NULL)
+        reflow(s, start, end - start, end - start);
+}
+
+void DynamicLayout::ChangeWatcher::onSpanRemoved(shared_ptr<Spannable> s, shared_ptr<Object> o, int start, int end) {
+    if (dynamic_pointer_cast<UpdateLayout>(o) != NULL)
+        reflow(s, start, end - start, end - start);
+}
+
+void DynamicLayout::ChangeWatcher::onSpanChanged(shared_ptr<Spannable> s, shared_ptr<Object> o, int start, int end, int nstart, int nend) {
+    if (dynamic_pointer_cast<UpdateLayout>(o) != NULL) {
+        reflow(s, start, end - start, end - start);
+        reflow(s, nstart, nend - nstart, nend - nstart);
+    }
+}
+
+ANDROID_END
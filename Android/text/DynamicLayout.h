@@ -0,0 +1,213 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __Androidpp__DynamicLayout__
+#define __Androidpp__DynamicLayout__
+
+#include "AndroidMacros.h"
+
+#include "Android/text/Directions.h"
+#include "Android/text/Layout.h"
+#include "Android/text/PackedIntVector.h"
+#include "Android/text/PackedObjectVector.h"
+#include "Android/text/SpanWatcher.h"
+#include "Android/text/TextWatcher.h"
+#include "Android/utils/Pools.h"
+
+#include <memory>
+
+using namespace std;
+
+ANDROID_BEGIN
+
+class CharSequence;
+class Editable;
+class Spannable;
+class StaticLayout;
+class TextPaint;
+class TextDirectionHeuristic;
+
+/**
+ * DynamicLayout is a text layout that updates itself as the text is edited.
+ * <p>This is used by widgets to control text layout. You should not need
+ * to use this class directly unless you are implementing your own widget
+ * or custom display object, or need to call
+ * {@link android.graphics.Canvas#drawText(java.lang.CharSequence, int, int, float, float, android.graphics.Paint)
+ *  Canvas.drawText()} directly.</p>
+ *
+ * <p>Only the paragraphs touched by an edit are broken into lines again.
+ * The line metadata is kept in a {@link PackedIntVector}, so inserting or
+ * deleting lines and shifting the offsets and tops of every line below an
+ * edit does not touch the rest of the layout.</p>
+ */
+class DynamicLayout : public Layout {
+    
+public:
+    
+    /**
+     * Make a layout for the specified text that will be updated as
+     * the text is changed.
+     */
+    DynamicLayout(shared_ptr<CharSequence> base,
+                  shared_ptr<TextPaint> paint,
+                  int width, Alignment align,
+                  float spacingmult, float spacingadd,
+                  bool includepad);
+    
+    /**
+     * Make a layout for the transformed text (password transformation
+     * being the primary example of a transformation)
+     * that will be updated as the base text is changed.
+     */
+    DynamicLayout(shared_ptr<CharSequence> base, shared_ptr<CharSequence> display,
+                  shared_ptr<TextPaint> paint,
+                  int width, Alignment align,
+                  float spacingmult, float spacingadd,
+                  bool includepad);
+    
+    /**
+     * Make a layout for the transformed text (password transformation
+     * being the primary example of a transformation)
+     * that will be updated as the base text is changed.
+     * If ellipsize is non-null, the Layout will ellipsize the text
+     * down to ellipsizedWidth.
+     *
+     * @hide
+     */
+    DynamicLayout(shared_ptr<CharSequence> base, shared_ptr<CharSequence> display,
+                  shared_ptr<TextPaint> paint,
+                  int width, Alignment align, shared_ptr<TextDirectionHeuristic> textDir,
+                  float spacingmult, float spacingadd,
+                  bool includepad,
+                  shared_ptr<TextUtils::TruncateAt> ellipsize, int ellipsizedWidth);
+    
+    virtual ~DynamicLayout();
+    
+    virtual int getLineCount();
+    
+    virtual int getLineTop(int line);
+    
+    virtual int getLineDescent(int line);
+    
+    virtual int getLineStart(int line);
+    
+    virtual bool getLineContainsTab(int line);
+    
+    virtual int getParagraphDirection(int line);
+    
+    virtual Directions getLineDirections(int line);
+    
+    virtual int getTopPadding();
+    
+    virtual int getBottomPadding();
+    
+    virtual int getEllipsizedWidth();
+    
+    virtual int getEllipsisStart(int line);
+    
+    virtual int getEllipsisCount(int line);
+    
+private:
+    
+    class ChangeWatcher : public TextWatcher, public SpanWatcher, public virtual Object {
+        
+    private:
+        
+        DynamicLayout *mLayout = NULL;
+        
+        void reflow(shared_ptr<CharSequence> s, int where, int before, int after);
+        
+    public:
+        
+        ChangeWatcher(DynamicLayout *layout) {
+            mLayout = layout;
+        }
+        
+        /**
+         * Called by the layout when it goes away, so that later edits
+         * only remove this watcher from the text.
+         */
+        void detach() {
+            mLayout = NULL;
+        }
+        
+        void beforeTextChanged(shared_ptr<CharSequence> s, int where, int before, int after) {
+            // Intentionally empty
+        }
+        
+        void onTextChanged(shared_ptr<CharSequence> s, int where, int before, int after) {
+            reflow(s, where, before, after);
+        }
+        
+        void afterTextChanged(shared_ptr<Editable> s) {
+            // Intentionally empty
+        }
+        
+        void onSpanAdded(shared_ptr<Spannable> s, shared_ptr<Object> o, int start, int end);
+        
+        void onSpanRemoved(shared_ptr<Spannable> s, shared_ptr<Object> o, int start, int end);
+        
+        void onSpanChanged(shared_ptr<Spannable> s, shared_ptr<Object> o, int start, int end, int nstart, int nend);
+        
+        virtual string getType() {
+            return "DynamicLayout::ChangeWatcher";
+        };
+    };
+    
+    void reflow(shared_ptr<CharSequence> s, int where, int before, int after);
+    
+    shared_ptr<CharSequence> createText(shared_ptr<CharSequence> display, shared_ptr<TextUtils::TruncateAt> ellipsize);
+    
+    shared_ptr<CharSequence> mBase;
+    shared_ptr<CharSequence> mDisplay;
+    shared_ptr<ChangeWatcher> mWatcher;
+    bool mIncludePad = false;
+    bool mEllipsize = false;
+    int mEllipsizedWidth = 0;
+    shared_ptr<TextUtils::TruncateAt> mEllipsizeAt;
+    
+    PackedIntVector mInts;
+    PackedObjectVector<Directions> mObjects;
+    
+    int mTopPadding = 0, mBottomPadding = 0;
+    
+    /*
+     * The StaticLayout used to break the changed paragraphs, reused
+     * across calls to reflow()
+     */
+    static Pools::ThreadLocalPool<StaticLayout> sStaticLayout;
+    
+    static const int PRIORITY = 128;
+    
+    static const int START = 0;
+    static const int DIR = START;
+    static const int TAB = START;
+    static const int TOP = 1;
+    static const int DESCENT = 2;
+    static const int COLUMNS_NORMAL = 3;
+    
+    static const int ELLIPSIS_START = 3;
+    static const int ELLIPSIS_COUNT = 4;
+    static const int COLUMNS_ELLIPSIZE = 5;
+    
+    static const int START_MASK = 0x1FFFFFFF;
+    static const int DIR_SHIFT  = 30;
+    static const int TAB_MASK   = 0x20000000;
+    
+    static const int ELLIPSIS_UNDEFINED = (int) 0x80000000;
+};
+
+ANDROID_END
+
+#endif /* defined(__Androidpp__DynamicLayout__) */
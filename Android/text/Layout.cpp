@@ -36,9 +36,8 @@ ANDROID_BEGIN
 
 const int Layout::TAB_INCREMENT = 20;
 
-Rect Layout::sTempRect = Rect();
 
-vector<shared_ptr<ParagraphStyle>> Layout::NO_PARA_SPANS = vector<shared_ptr<ParagraphStyle>>();
+const vector<shared_ptr<ParagraphStyle>> Layout::NO_PARA_SPANS = vector<shared_ptr<ParagraphStyle>>();
 
 const vector<UChar> Layout::ELLIPSIS_NORMAL = { 0x2026 }; // this is "..."
 const vector<UChar> Layout::ELLIPSIS_TWO_DOTS = { 0x2025 };
@@ -365,18 +364,14 @@ void Layout::drawBackground(shared_ptr<Canvas> canvas, Path *highlight, Paint *h
 }
 
 long long Layout::getLineRangeForDraw(shared_ptr<Canvas> canvas) {
-    int dtop, dbottom;
+    Rect clip;
+    if (!canvas->getClipBounds(&clip)) {
+        // Negative range end used as a special flag
+        return TextUtils::packRangeInLong(0, -1);
+    }
     
-    // TODO: synchronization here
-//    synchronized (sTempRect) {
-        if (!canvas->getClipBounds(&sTempRect)) {
-            // Negative range end used as a special flag
-            return TextUtils::packRangeInLong(0, -1);
-        }
-        
-        dtop = sTempRect.top();
-        dbottom = sTempRect.bottom();
-//    }
+    const int dtop = clip.top();
+    const int dbottom = clip.bottom();
     
     const int top = max(dtop, 0);
     const int bottom = min(getLineTop(getLineCount()), dbottom);
@@ -1276,7 +1271,7 @@ Layout::Ellipsizer::Ellipsizer(shared_ptr<CharSequence> s) {
 }
 
 UChar Layout::Ellipsizer::charAt(int off) {
-    UnicodeString *buf = TextUtils::obtain(1);
+    shared_ptr<UnicodeString> buf = TextUtils::obtain(1);
     getChars(off, off + 1, *buf, 0);
     UChar ret = buf->charAt(0);
     
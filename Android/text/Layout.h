@@ -48,6 +48,8 @@ class TextPaint;
  */
 class Layout {
     
+    friend class PrecomputedText;
+    
 public:
     
     enum Alignment {
@@ -62,7 +64,7 @@ public:
     
 private:
     
-    static vector<shared_ptr<ParagraphStyle>> NO_PARA_SPANS;
+    static const vector<shared_ptr<ParagraphStyle>> NO_PARA_SPANS;
     
 //    /* package */ static const EmojiFactory EMOJI_FACTORY = EmojiFactory.newAvailableInstance();
 //    /* package */ static const int MIN_EMOJI, MAX_EMOJI;
@@ -682,6 +684,7 @@ protected:
     
     class Ellipsizer : public virtual CharSequence, public virtual GetChars {
         
+        friend class DynamicLayout;
         friend class StaticLayout;
         
     private:
@@ -743,7 +746,6 @@ private:
     Alignment mAlignment = Alignment::ALIGN_NORMAL;
     float mSpacingMult = 0;
     float mSpacingAdd = 0;
-    static Rect sTempRect;
     shared_ptr<Spanned> mSpannedText;
     shared_ptr<TextDirectionHeuristic> mTextDir;
     SpanSet<LineBackgroundSpan> mLineBackgroundSpans;
@@ -23,23 +23,17 @@
 
 ANDROID_BEGIN
 
-vector<shared_ptr<MeasuredText>> MeasuredText::sCached = vector<shared_ptr<MeasuredText>>(3);
+Pools::ThreadLocalPool<MeasuredText> MeasuredText::sPool(3);
 
 MeasuredText::MeasuredText() {
     mWorkPaint = make_shared<TextPaint>();
 }
 
 shared_ptr<MeasuredText> MeasuredText::obtain() {
-    shared_ptr<MeasuredText> mt;
-//    synchronized (sLock) {
-        for (int i = sCached.size(); --i >= 0;) {
-            if (sCached[i] != NULL) {
-                mt = sCached[i];
-                sCached[i] = NULL;
-                return mt;
-            }
-        }
-//    }
+    shared_ptr<MeasuredText> mt = sPool.acquire();
+    if (mt != NULL) {
+        return mt;
+    }
     mt = make_shared<MeasuredText>();
     if (localLOGV) {
 //        Log.v("MEAS", "new: " + mt);
@@ -50,15 +44,7 @@ shared_ptr<MeasuredText> MeasuredText::obtain() {
 shared_ptr<MeasuredText> MeasuredText::recycle(shared_ptr<MeasuredText> mt) {
     mt->mText = NULL;
     if (mt->mLen < 1000) {
-//        synchronized(sLock) {
-            for (int i = 0; i < sCached.size(); ++i) {
-                if (sCached[i] == NULL) {
-                    sCached[i] = mt;
-                    mt->mText = NULL;
-                    break;
-                }
-//            }
-        }
+        sPool.release(mt);
     }
     return NULL;
 }
@@ -13,6 +13,7 @@
 
 #include "Android/graphics/Paint.h"
 #include "Android/utils/Object.h"
+#include "Android/utils/Pools.h"
 
 #include <unicode/unistr.h>
 
@@ -22,6 +23,7 @@
 
 using namespace icu;
 using namespace std;
+using namespace android;
 
 ANDROID_BEGIN
 
@@ -30,6 +32,10 @@ class TextPaint;
 class MetricAffectingSpan;
 class TextDirectionHeuristic;
 
+/**
+ * The widths and directions of a paragraph. Instances are pooled per thread,
+ * so text may be measured on several threads at once.
+ */
 class MeasuredText {
     
     friend class Layout;
@@ -55,8 +61,8 @@ private:
     int mPos;
     shared_ptr<TextPaint> mWorkPaint;
     
-//    static const Object[] sLock = new Object[0];
-    static vector<shared_ptr<MeasuredText>> sCached;
+    // Layouts may be built on worker threads (see PrecomputedText)
+    static Pools::ThreadLocalPool<MeasuredText> sPool;
     
 public:
     
@@ -0,0 +1,260 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PackedIntVector.h"
+
+#include "Android/utils/ArrayUtils.h"
+#include "Android/utils/Exceptions.h"
+
+#include <sstream>
+
+ANDROID_BEGIN
+
+static string packedIndex(int row, int column) {
+    stringstream str;
+    str << row << ", " << column;
+    return str.str();
+}
+
+PackedIntVector::PackedIntVector(int columns) : mColumns(columns) {
+    mRows = 0;
+    
+    mRowGapStart = 0;
+    mRowGapLength = mRows;
+    
+    mValueGap = vector<int>(2 * columns);
+}
+
+int PackedIntVector::getValue(int row, int column) {
+    const int columns = mColumns;
+    
+    if (((row | column) < 0) || (row >= size()) || (column >= columns)) {
+        throw IndexOutOfBoundsException(packedIndex(row, column));
+    }
+    
+    if (row >= mRowGapStart) {
+        row += mRowGapLength;
+    }
+    
+    int value = mValues[row * columns + column];
+    
+    const vector<int> &valuegap = mValueGap;
+    if (row >= valuegap[column]) {
+        value += valuegap[column + columns];
+    }
+    
+    return value;
+}
+
+void PackedIntVector::setValue(int row, int column, int value) {
+    if (((row | column) < 0) || (row >= size()) || (column >= mColumns)) {
+        throw IndexOutOfBoundsException(packedIndex(row, column));
+    }
+    
+    setValueInternal(row, column, value);
+}
+
+void PackedIntVector::setValueInternal(int row, int column, int value) {
+    if (row >= mRowGapStart) {
+        row += mRowGapLength;
+    }
+    
+    const vector<int> &valuegap = mValueGap;
+    if (row >= valuegap[column]) {
+        value -= valuegap[column + mColumns];
+    }
+    
+    mValues[row * mColumns + column] = value;
+}
+
+void PackedIntVector::adjustValuesBelow(int startRow, int column, int delta) {
+    if (((startRow | column) < 0) || (startRow > size()) ||
+        (column >= width())) {
+        throw IndexOutOfBoundsException(packedIndex(startRow, column));
+    }
+    
+    if (startRow >= mRowGapStart) {
+        startRow += mRowGapLength;
+    }
+    
+    moveValueGapTo(column, startRow);
+    mValueGap[column + mColumns] += delta;
+}
+
+void PackedIntVector::insertAt(int row, const vector<int> &values) {
+    if ((row < 0) || (row > size())) {
+        stringstream str;
+        str << "row " << row;
+        throw IndexOutOfBoundsException(str.str());
+    }
+    
+    if (!values.empty() && ((int) values.size() < width())) {
+        stringstream str;
+        str << "value count " << values.size();
+        throw IndexOutOfBoundsException(str.str());
+    }
+    
+    moveRowGapTo(row);
+    
+    if (mRowGapLength == 0) {
+        growBuffer();
+    }
+    
+    mRowGapStart++;
+    mRowGapLength--;
+    
+    if (values.empty()) {
+        for (int i = mColumns - 1; i >= 0; i--) {
+            setValueInternal(row, i, 0);
+        }
+    } else {
+        for (int i = mColumns - 1; i >= 0; i--) {
+            setValueInternal(row, i, values[i]);
+        }
+    }
+}
+
+void PackedIntVector::deleteAt(int row, int count) {
+    if (((row | count) < 0) || (row + count > size())) {
+        stringstream str;
+        str << row << ", " << count;
+        throw IndexOutOfBoundsException(str.str());
+    }
+    
+    moveRowGapTo(row + count);
+    
+    mRowGapStart -= count;
+    mRowGapLength += count;
+    
+    // Give memory back once the gap is most of the buffer, keeping
+    // twice the remaining rows so the next inserts don't regrow it.
+    if (mRows > MIN_SHRINK_ROWS && size() * 4 < mRows) {
+        int newsize = ArrayUtils::idealIntArraySize(size() * 2 * mColumns) / mColumns;
+        if (newsize < mRows) {
+            resizeBuffer(newsize);
+        }
+    }
+}
+
+void PackedIntVector::growBuffer() {
+    int newsize = size() + 1;
+    resizeBuffer(ArrayUtils::idealIntArraySize(newsize * mColumns) / mColumns);
+}
+
+void PackedIntVector::resizeBuffer(int newsize) {
+    const int columns = mColumns;
+    vector<int> newvalues = vector<int>(newsize * columns);
+    
+    vector<int> &valuegap = mValueGap;
+    const int rowgapstart = mRowGapStart;
+    
+    int after = mRows - (rowgapstart + mRowGapLength);
+    
+    if (!mValues.empty()) {
+        copy(mValues.begin(), mValues.begin() + columns * rowgapstart, newvalues.begin());
+        copy(mValues.begin() + (mRows - after) * columns, mValues.begin() + mRows * columns,
+             newvalues.begin() + (newsize - after) * columns);
+    }
+    
+    for (int i = 0; i < columns; i++) {
+        if (valuegap[i] >= rowgapstart) {
+            valuegap[i] += newsize - mRows;
+            
+            if (valuegap[i] < rowgapstart) {
+                valuegap[i] = rowgapstart;
+            }
+        }
+    }
+    
+    mRowGapLength += newsize - mRows;
+    mRows = newsize;
+    mValues.swap(newvalues);
+}
+
+void PackedIntVector::moveValueGapTo(int column, int where) {
+    vector<int> &valuegap = mValueGap;
+    vector<int> &values = mValues;
+    const int columns = mColumns;
+    
+    if (where == valuegap[column]) {
+        return;
+    } else if (where > valuegap[column]) {
+        for (int i = valuegap[column]; i < where; i++) {
+            values[i * columns + column] += valuegap[column + columns];
+        }
+    } else /* where < valuegap[column] */ {
+        for (int i = where; i < valuegap[column]; i++) {
+            values[i * columns + column] -= valuegap[column + columns];
+        }
+    }
+    
+    valuegap[column] = where;
+}
+
+void PackedIntVector::moveRowGapTo(int where) {
+    if (where == mRowGapStart) {
+        return;
+    }
+    
+    const int columns = mColumns;
+    const vector<int> &valuegap = mValueGap;
+    vector<int> &values = mValues;
+    const int gapend = mRowGapStart + mRowGapLength;
+    
+    if (where > mRowGapStart) {
+        int moving = where - mRowGapStart;
+        
+        for (int i = gapend; i < gapend + moving; i++) {
+            int destrow = i - gapend + mRowGapStart;
+            
+            for (int j = 0; j < columns; j++) {
+                int val = values[i * columns + j];
+                
+                if (i >= valuegap[j]) {
+                    val += valuegap[j + columns];
+                }
+                
+                if (destrow >= valuegap[j]) {
+                    val -= valuegap[j + columns];
+                }
+                
+                values[destrow * columns + j] = val;
+            }
+        }
+    } else /* where < mRowGapStart */ {
+        int moving = mRowGapStart - where;
+        
+        for (int i = where + moving - 1; i >= where; i--) {
+            int destrow = i - where + gapend - moving;
+            
+            for (int j = 0; j < columns; j++) {
+                int val = values[i * columns + j];
+                
+                if (i >= valuegap[j]) {
+                    val += valuegap[j + columns];
+                }
+                
+                if (destrow >= valuegap[j]) {
+                    val -= valuegap[j + columns];
+                }
+                
+                values[destrow * columns + j] = val;
+            }
+        }
+    }
+    
+    mRowGapStart = where;
+}
+
+ANDROID_END
@@ -0,0 +1,185 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __Androidpp__PackedIntVector__
+#define __Androidpp__PackedIntVector__
+
+#include "AndroidMacros.h"
+
+#include <vector>
+
+using namespace std;
+
+ANDROID_BEGIN
+
+/**
+ * PackedIntVector stores a two-dimensional array of integers,
+ * optimized for inserting and deleting rows and for
+ * offsetting the values in segments of a given column.
+ *
+ * Rows are kept in a gap buffer, so a run of edits near the same
+ * row only moves the rows between the old and the new gap position.
+ * Each column also has a value gap: values at or after it are stored
+ * relative to a per-column delta, so shifting every value below a row
+ * by a constant is a single addition.
+ */
+class PackedIntVector {
+    
+public:
+    
+    /**
+     * Creates a new PackedIntVector with the specified width and
+     * a height of 0.
+     *
+     * @param columns the width of the PackedIntVector.
+     */
+    PackedIntVector(int columns);
+    
+    /**
+     * Returns the value at the specified row and column.
+     *
+     * @param row the index of the row to return.
+     * @param column the index of the column to return.
+     *
+     * @return the value stored at the specified position.
+     *
+     * @throws IndexOutOfBoundsException if the row is out of range
+     *         (row &lt; 0 || row >= size()) or the column is out of range
+     *         (column &lt; 0 || column >= width()).
+     */
+    int getValue(int row, int column);
+    
+    /**
+     * Sets the value at the specified row and column.
+     *
+     * @param row the index of the row to set.
+     * @param column the index of the column to set.
+     *
+     * @throws IndexOutOfBoundsException if the row is out of range
+     *         (row &lt; 0 || row >= size()) or the column is out of range
+     *         (column &lt; 0 || column >= width()).
+     */
+    void setValue(int row, int column, int value);
+    
+    /**
+     * Increments all values in the specified column whose row >= the
+     * specified row by the specified delta.
+     *
+     * @param startRow the row at which to begin incrementing.
+     *        This may be == size(), which case there is no effect.
+     * @param column the index of the column to set.
+     *
+     * @throws IndexOutOfBoundsException if the row is out of range
+     *         (startRow &lt; 0 || startRow > size()) or the column
+     *         is out of range (column &lt; 0 || column >= width()).
+     */
+    void adjustValuesBelow(int startRow, int column, int delta);
+    
+    /**
+     * Inserts a new row of values at the specified row offset.
+     *
+     * @param row the row above which to insert the new row.
+     *        This may be == size(), which case the new row is added
+     *        at the end.
+     * @param values the new values to be added.  If this is empty,
+     *        a row of zeroes is added.
+     *
+     * @throws IndexOutOfBoundsException if the row is out of range
+     *         (row &lt; 0 || row > size()) or if the length of the
+     *         values array is too small (values.size() < width()).
+     */
+    void insertAt(int row, const vector<int> &values);
+    
+    /**
+     * Deletes the specified number of rows starting with the specified
+     * row.
+     *
+     * @param row the index of the first row to be deleted.
+     * @param count the number of rows to delete.
+     *
+     * @throws IndexOutOfBoundsException if any of the rows to be deleted
+     *         are out of range (row &lt; 0 || count &lt; 0 ||
+     *         row + count > size()).
+     */
+    void deleteAt(int row, int count);
+    
+    /**
+     * Returns the number of rows in the PackedIntVector.  This number
+     * will change as rows are inserted and deleted.
+     *
+     * @return the number of rows.
+     */
+    int size() const {
+        return mRows - mRowGapLength;
+    }
+    
+    /**
+     * Returns the width of the PackedIntVector.  This number is set
+     * at construction and will not change.
+     *
+     * @return the number of columns.
+     */
+    int width() const {
+        return mColumns;
+    }
+    
+private:
+    
+    /**
+     * Sets the value at the specified row and column.
+     * Private internal version: does not check args.
+     */
+    void setValueInternal(int row, int column, int value);
+    
+    /**
+     * Grows the value and gap arrays to be large enough to store at least
+     * one more than the current number of rows.
+     */
+    void growBuffer();
+    
+    /**
+     * Reallocates the value array to hold newsize rows, which must be
+     * at least size(), by widening or narrowing the row gap.
+     */
+    void resizeBuffer(int newsize);
+    
+    /**
+     * Moves the gap in the values of the specified column to begin at
+     * the specified row.
+     */
+    void moveValueGapTo(int column, int where);
+    
+    /**
+     * Moves the gap in the row indices to begin at the specified row.
+     */
+    void moveRowGapTo(int where);
+    
+    /**
+     * Buffers at or below this many rows are never shrunk.
+     */
+    static const int MIN_SHRINK_ROWS = 64;
+    
+    const int mColumns;
+    int mRows = 0;
+    
+    int mRowGapStart = 0;
+    int mRowGapLength = 0;
+    
+    vector<int> mValues;
+    vector<int> mValueGap; // starts, followed by lengths
+};
+
+ANDROID_END
+
+#endif /* defined(__Androidpp__PackedIntVector__) */
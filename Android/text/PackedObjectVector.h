@@ -0,0 +1,168 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef Androidpp_PackedObjectVector_h
+#define Androidpp_PackedObjectVector_h
+
+#include "AndroidMacros.h"
+
+#include "Android/utils/ArrayUtils.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+ANDROID_BEGIN
+
+/**
+ * A two-dimensional array of values kept in a gap buffer, the
+ * object counterpart of {@link PackedIntVector}.
+ */
+template<class E>
+class PackedObjectVector {
+    
+private:
+    
+    int mColumns = 0;
+    int mRows = 0;
+    
+    int mRowGapStart = 0;
+    int mRowGapLength = 0;
+    
+    vector<E> mValues;
+    
+public:
+    
+    PackedObjectVector(int columns) {
+        mColumns = columns;
+        mRows = ArrayUtils::idealIntArraySize(0) / mColumns;
+        
+        mRowGapStart = 0;
+        mRowGapLength = mRows;
+        
+        mValues = vector<E>(mRows * mColumns);
+    }
+    
+    E getValue(int row, int column) {
+        if (row >= mRowGapStart)
+            row += mRowGapLength;
+        
+        return mValues[row * mColumns + column];
+    }
+    
+    void setValue(int row, int column, E value) {
+        if (row >= mRowGapStart)
+            row += mRowGapLength;
+        
+        mValues[row * mColumns + column] = value;
+    }
+    
+    /**
+     * Inserts a new row at the specified row offset. If values is
+     * empty the row is filled with default constructed values.
+     */
+    void insertAt(int row, const vector<E> &values) {
+        moveRowGapTo(row);
+        
+        if (mRowGapLength == 0)
+            growBuffer();
+        
+        mRowGapStart++;
+        mRowGapLength--;
+        
+        if (values.empty()) {
+            for (int i = 0; i < mColumns; i++) {
+                setValue(row, i, E());
+            }
+        } else {
+            for (int i = 0; i < mColumns; i++) {
+                setValue(row, i, values[i]);
+            }
+        }
+    }
+    
+    void deleteAt(int row, int count) {
+        moveRowGapTo(row + count);
+        
+        mRowGapStart -= count;
+        mRowGapLength += count;
+        
+        // Release what the deleted rows referenced.
+        for (int i = mRowGapStart * mColumns; i < (mRowGapStart + count) * mColumns; i++) {
+            mValues[i] = E();
+        }
+    }
+    
+    int size() const {
+        return mRows - mRowGapLength;
+    }
+    
+    int width() const {
+        return mColumns;
+    }
+    
+private:
+    
+    void growBuffer() {
+        int newsize = size() + 1;
+        newsize = ArrayUtils::idealIntArraySize(newsize * mColumns) / mColumns;
+        vector<E> newvalues = vector<E>(newsize * mColumns);
+        
+        int after = mRows - (mRowGapStart + mRowGapLength);
+        
+        move(mValues.begin(), mValues.begin() + mColumns * mRowGapStart, newvalues.begin());
+        move(mValues.begin() + (mRows - after) * mColumns, mValues.begin() + mRows * mColumns,
+             newvalues.begin() + (newsize - after) * mColumns);
+        
+        mRowGapLength += newsize - mRows;
+        mRows = newsize;
+        mValues.swap(newvalues);
+    }
+    
+    void moveRowGapTo(int where) {
+        if (where == mRowGapStart)
+            return;
+        
+        const int gapend = mRowGapStart + mRowGapLength;
+        
+        if (where > mRowGapStart) {
+            int moving = where - mRowGapStart;
+            
+            for (int i = gapend; i < gapend + moving; i++) {
+                int destrow = i - gapend + mRowGapStart;
+                
+                for (int j = 0; j < mColumns; j++) {
+                    swap(mValues[destrow * mColumns + j], mValues[i * mColumns + j]);
+                }
+            }
+        } else /* where < mRowGapStart */ {
+            int moving = mRowGapStart - where;
+            
+            for (int i = where + moving - 1; i >= where; i--) {
+                int destrow = i - where + gapend - moving;
+                
+                for (int j = 0; j < mColumns; j++) {
+                    swap(mValues[destrow * mColumns + j], mValues[i * mColumns + j]);
+                }
+            }
+        }
+        
+        mRowGapStart = where;
+    }
+};
+
+ANDROID_END
+
+#endif
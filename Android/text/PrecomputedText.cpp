@@ -0,0 +1,118 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "PrecomputedText.h"
+
+#include "Android/text/CharSequence.h"
+#include "Android/text/Directions.h"
+#include "Android/text/StaticLayout.h"
+#include "Android/text/TextDirectionHeuristic.h"
+#include "Android/text/TextPaint.h"
+#include "Android/text/TextUtils.h"
+
+#include <math.h>
+
+ANDROID_BEGIN
+
+PrecomputedText::Params::Params(shared_ptr<TextPaint> paint, int width, Layout::Alignment align,
+                                shared_ptr<TextDirectionHeuristic> textDir,
+                                float spacingMult, float spacingAdd, bool includePad) {
+    mPaint = make_shared<TextPaint>(*paint);
+    mWidth = width;
+    mAlignment = align;
+    mTextDir = textDir;
+    mSpacingMult = spacingMult;
+    mSpacingAdd = spacingAdd;
+    mIncludePad = includePad;
+}
+
+bool PrecomputedText::Params::isMeasureCompatible(shared_ptr<TextPaint> paint,
+                                                  shared_ptr<TextDirectionHeuristic> textDir) {
+    return mTextDir == textDir &&
+    mPaint->getTypeface() == paint->getTypeface() &&
+    mPaint->getTextSize() == paint->getTextSize() &&
+    mPaint->getTextScaleX() == paint->getTextScaleX() &&
+    mPaint->getTextSkewX() == paint->getTextSkewX() &&
+    mPaint->getFlags() == paint->getFlags() &&
+    mPaint->getHinting() == paint->getHinting() &&
+    mPaint->mBidiFlags == paint->mBidiFlags;
+}
+
+bool PrecomputedText::Params::isLayoutCompatible(shared_ptr<TextPaint> paint, int width, Layout::Alignment align,
+                                                 shared_ptr<TextDirectionHeuristic> textDir,
+                                                 float spacingMult, float spacingAdd, bool includePad) {
+    return mWidth == width && mAlignment == align &&
+    mSpacingMult == spacingMult && mSpacingAdd == spacingAdd &&
+    mIncludePad == includePad && isMeasureCompatible(paint, textDir);
+}
+
+shared_ptr<PrecomputedText> PrecomputedText::create(shared_ptr<CharSequence> text, const Params &params) {
+    return make_shared<PrecomputedText>(TextUtils::stringOrSpannedString(text), params);
+}
+
+PrecomputedText::PrecomputedText(shared_ptr<CharSequence> text, const Params &params) : mParams(params) {
+    mText = text;
+
+    shared_ptr<TextPaint> paint = mParams.mPaint;
+
+    // The same steps as TextView::onMeasure() and makeSingleLayout() take for
+    // text that is not ellipsized.
+    mBoring = BoringLayout::isBoring(mText, paint, mParams.mTextDir, NULL);
+
+    if (mBoring != NULL) {
+        mDesiredWidth = mBoring->width;
+    } else {
+        mDesiredWidth = (int) ceil(Layout::getDesiredWidth(mText, paint));
+    }
+
+    if (mParams.mWidth < 0) {
+        return;
+    }
+
+    if (mBoring != NULL && mBoring->width <= mParams.mWidth) {
+        mLayout = BoringLayout::make(mText, paint, mParams.mWidth, mParams.mAlignment,
+                                     mParams.mSpacingMult, mParams.mSpacingAdd,
+                                     mBoring, mParams.mIncludePad);
+    } else {
+        mLayout = make_shared<StaticLayout>(mText, paint, mParams.mWidth, mParams.mAlignment,
+                                            mParams.mTextDir, mParams.mSpacingMult,
+                                            mParams.mSpacingAdd, mParams.mIncludePad);
+    }
+}
+
+shared_ptr<Layout> PrecomputedText::takeLayout(shared_ptr<TextPaint> paint) {
+    shared_ptr<Layout> layout;
+
+    {
+        AutoMutex _l(mLock);
+        layout.swap(mLayout);
+    }
+
+    if (layout == NULL) {
+        return NULL;
+    }
+
+    // The measuring paint was a copy; draw with the caller's paint so color
+    // and shadow changes keep applying.
+    layout->mPaint = paint;
+
+    shared_ptr<BoringLayout> boring = dynamic_pointer_cast<BoringLayout>(layout);
+    if (boring != NULL) {
+        boring->mPaint = paint;
+    }
+
+    return layout;
+}
+
+ANDROID_END
@@ -0,0 +1,145 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __Androidpp__PrecomputedText__
+#define __Androidpp__PrecomputedText__
+
+#include "AndroidMacros.h"
+
+#include "Android/text/BoringLayout.h"
+#include "Android/text/Layout.h"
+
+#include <utils/Mutex.h>
+
+#include <memory>
+
+using namespace std;
+using namespace android;
+
+ANDROID_BEGIN
+
+class CharSequence;
+class TextPaint;
+class TextDirectionHeuristic;
+
+/**
+ * A text which has the character metrics data and, if a width is given,
+ * its line breaks already computed.
+ * <p>Measuring and breaking a long text is expensive. {@link #create} may be
+ * called on a background thread and the result handed to
+ * {@link TextView#setText(shared_ptr<PrecomputedText>)}, which adopts the
+ * measurements and the layout instead of computing them on the UI thread.
+ * The text is only used as-is if the TextView's paint, text direction and
+ * layout parameters still match the {@link Params} it was computed for.</p>
+ */
+class PrecomputedText {
+
+public:
+
+    /**
+     * The text measuring and layout parameters.
+     * Obtain one from {@link TextView#getTextMetricsParams} so the result
+     * matches the TextView it is meant for.
+     */
+    class Params {
+
+        friend class PrecomputedText;
+
+    public:
+
+        /**
+         * @param paint the paint to measure with; a copy is kept so the
+         * caller may keep changing its own paint
+         * @param width the width to break lines at, or -1 to only measure
+         */
+        Params(shared_ptr<TextPaint> paint, int width, Layout::Alignment align,
+               shared_ptr<TextDirectionHeuristic> textDir,
+               float spacingMult, float spacingAdd, bool includePad);
+
+        shared_ptr<TextPaint> getTextPaint() { return mPaint; }
+        int getWidth() { return mWidth; }
+        Layout::Alignment getAlignment() { return mAlignment; }
+        shared_ptr<TextDirectionHeuristic> getTextDirection() { return mTextDir; }
+
+        /**
+         * Returns true if text measured with these parameters has the same
+         * character widths as text measured with the given paint and direction.
+         */
+        bool isMeasureCompatible(shared_ptr<TextPaint> paint, shared_ptr<TextDirectionHeuristic> textDir);
+
+        /**
+         * Returns true if a layout built with these parameters is identical
+         * to one built with the given ones.
+         */
+        bool isLayoutCompatible(shared_ptr<TextPaint> paint, int width, Layout::Alignment align,
+                                shared_ptr<TextDirectionHeuristic> textDir,
+                                float spacingMult, float spacingAdd, bool includePad);
+
+    private:
+
+        shared_ptr<TextPaint> mPaint;
+        int mWidth;
+        Layout::Alignment mAlignment;
+        shared_ptr<TextDirectionHeuristic> mTextDir;
+        float mSpacingMult;
+        float mSpacingAdd;
+        bool mIncludePad;
+    };
+
+    /**
+     * Measures the text and, if params has a width, breaks it into lines.
+     * Safe to call from any thread as long as text is not modified meanwhile.
+     */
+    static shared_ptr<PrecomputedText> create(shared_ptr<CharSequence> text, const Params &params);
+
+    PrecomputedText(shared_ptr<CharSequence> text, const Params &params);
+
+    /**
+     * Returns the text, as it should be passed to the TextView.
+     */
+    shared_ptr<CharSequence> getText() { return mText; }
+
+    Params &getParams() { return mParams; }
+
+    /**
+     * Returns the boring metrics of the text, or NULL if it is not boring.
+     */
+    shared_ptr<BoringLayout::Metrics> getBoring() { return mBoring; }
+
+    /**
+     * Returns the width the text needs with one line per paragraph.
+     */
+    int getDesiredWidth() { return mDesiredWidth; }
+
+    /**
+     * Hands out the precomputed layout, drawing with the given paint from now
+     * on. The layout is handed out only once since it is owned by whoever
+     * takes it; returns NULL afterwards, or if no width was given.
+     */
+    shared_ptr<Layout> takeLayout(shared_ptr<TextPaint> paint);
+
+private:
+
+    shared_ptr<CharSequence> mText;
+    Params mParams;
+    shared_ptr<BoringLayout::Metrics> mBoring;
+    int mDesiredWidth = 0;
+
+    Mutex mLock;
+    shared_ptr<Layout> mLayout;
+};
+
+ANDROID_END
+
+#endif /* defined(__Androidpp__PrecomputedText__) */
@@ -64,6 +64,14 @@ public:
         return SpannableStringInternal::toString();
     }
     
+    int hashCode() const {
+        return SpannableStringInternal::hashCode();
+    }
+    
+    bool equals(const Object *object) const {
+        return object == this || SpannableStringInternal::equals(object);
+    }
+    
     /* subclasses must do subSequence() to preserve type */
     
     void getChars(int start, int end, UnicodeString &dest, int off) {
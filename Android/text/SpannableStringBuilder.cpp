@@ -779,7 +779,7 @@ vector<shared_ptr<Object>> SpannableStringBuilder::getSpans(int queryStart, int
         }
         
         // Expensive test, should be performed after the previous tests
-        if (kind.compare(spans[i]->getType()) != 0) continue;
+        if (!TextUtils::isSpanOfKind(spans[i], kind)) continue;
         
         if (count == 0) {
             // Safe conversion thanks to the isInstance test above
@@ -932,7 +932,7 @@ void SpannableStringBuilder::sendSpanAdded(shared_ptr<Object> what, int start, i
     int n = recip.size();
     
     for (int i = 0; i < n; i++) {
-        dynamic_pointer_cast<SpanWatcher>(what)->onSpanAdded(shared_from_this(), what, start, end);
+        dynamic_pointer_cast<SpanWatcher>(recip[i])->onSpanAdded(shared_from_this(), what, start, end);
     }
 }
 
@@ -941,7 +941,7 @@ void SpannableStringBuilder::sendSpanRemoved(shared_ptr<Object> what, int start,
     int n = recip.size();
     
     for (int i = 0; i < n; i++) {
-        dynamic_pointer_cast<SpanWatcher>(what)->onSpanRemoved(shared_from_this(), what, start, end);
+        dynamic_pointer_cast<SpanWatcher>(recip[i])->onSpanRemoved(shared_from_this(), what, start, end);
     }
 }
 
@@ -990,7 +990,7 @@ void SpannableStringBuilder::drawText(shared_ptr<Canvas> c, int start, int end,
     } else if (start >= mGapStart) {
         c->drawText(mText, start + mGapLength, end - start, x, y, p);
     } else {
-        UnicodeString *buf = TextUtils::obtain(end - start);
+        shared_ptr<UnicodeString> buf = TextUtils::obtain(end - start);
         
         getChars(start, end, *buf, 0);
         c->drawText(*buf, 0, end - start, x, y, p);
@@ -1011,7 +1011,7 @@ void SpannableStringBuilder::drawTextRun(shared_ptr<Canvas> c, int start, int en
         c->drawTextRun(mText.getBuffer(), start + mGapLength, len, contextStart + mGapLength,
                       contextLen, x, y, flags, p);
     } else {
-        UnicodeString *buf = TextUtils::obtain(contextLen);
+        shared_ptr<UnicodeString> buf = TextUtils::obtain(contextLen);
         getChars(contextStart, contextEnd, *buf, 0);
         c->drawTextRun(buf->getBuffer(), start - contextStart, len, 0, contextLen, x, y, flags, p);
         TextUtils::recycle(buf);
@@ -1028,7 +1028,7 @@ float SpannableStringBuilder::measureText(int start, int end, Paint *p) {
     } else if (start >= mGapStart) {
         ret = p->measureText(mText, start + mGapLength, end - start);
     } else {
-        UnicodeString *buf = TextUtils::obtain(end - start);
+        shared_ptr<UnicodeString> buf = TextUtils::obtain(end - start);
         
         getChars(start, end, *buf, 0);
         ret = p->measureText(*buf, 0, end - start);
@@ -1048,7 +1048,7 @@ int SpannableStringBuilder::getTextWidths(int start, int end, vector<float> widt
     } else if (start >= mGapStart) {
         ret = p->getTextWidths(mText, start + mGapLength, end - start, widths);
     } else {
-        UnicodeString *buf = TextUtils::obtain(end - start);
+        shared_ptr<UnicodeString> buf = TextUtils::obtain(end - start);
         
         getChars(start, end, *buf, 0);
         ret = p->getTextWidths(*buf, 0, end - start, widths);
@@ -1072,7 +1072,7 @@ float SpannableStringBuilder::getTextRunAdvances(int start, int end, int context
         ret = p->getTextRunAdvances(mText, start + mGapLength, end,
                                    contextStart + mGapLength, contextEnd, flags, &advances, advancesPos);
     } else {
-        UnicodeString *buf = TextUtils::obtain(contextLen);
+        shared_ptr<UnicodeString> buf = TextUtils::obtain(contextLen);
         getChars(contextStart, contextEnd, *buf, 0);
         ret = p->getTextRunAdvances(*buf, start - contextStart, end,
                                    0, contextEnd, flags, &advances, advancesPos);
@@ -1095,7 +1095,7 @@ int SpannableStringBuilder::getTextRunCursor(int contextStart, int contextEnd, i
         ret = p->getTextRunCursor(mText, contextStart + mGapLength, contextLen,
                                  flags, offset + mGapLength, cursorOpt) - mGapLength;
     } else {
-        UnicodeString *buf = TextUtils::obtain(contextLen);
+        shared_ptr<UnicodeString> buf = TextUtils::obtain(contextLen);
         getChars(contextStart, contextEnd, *buf, 0);
         ret = p->getTextRunCursor(*buf, 0, contextLen,
                                  flags, offset - contextStart, cursorOpt) + contextStart;
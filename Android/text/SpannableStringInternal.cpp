@@ -10,6 +10,7 @@
 
 #include "Android/text/Spanned.h"
 #include "Android/text/SpanWatcher.h"
+#include "Android/text/TextUtils.h"
 #include "Android/utils/ArrayUtils.h"
 #include "Android/utils/Exceptions.h"
 #include "Android/utils/System.h"
@@ -59,6 +60,35 @@ void SpannableStringInternal::getChars(int start, int end, UnicodeString &dest,
     }
 }
 
+bool SpannableStringInternal::equals(const Object *object) const {
+    // The Spanned accessors are not const though they do not modify
+    Spanned *other = dynamic_cast<Spanned*>(const_cast<Object*>(object));
+    if (other == NULL || !mText->equals(other->toString().get())) {
+        return false;
+    }
+    
+    vector<shared_ptr<Object>> otherSpans = other->getSpans(0, other->length(), "");
+    if ((int) otherSpans.size() != mSpanCount) {
+        return false;
+    }
+    
+    for (int i = 0; i < mSpanCount; i++) {
+        const shared_ptr<Object> &thisSpan = mSpans[i];
+        const shared_ptr<Object> &otherSpan = otherSpans[i];
+        
+        if (thisSpan != otherSpan && !thisSpan->equals(otherSpan.get())) {
+            return false;
+        }
+        if (mSpanData[i * COLUMNS + START] != other->getSpanStart(otherSpan) ||
+                mSpanData[i * COLUMNS + END] != other->getSpanEnd(otherSpan) ||
+                mSpanData[i * COLUMNS + FLAGS] != other->getSpanFlags(otherSpan)) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
 int SpannableStringInternal::getSpanStart(shared_ptr<Object> what) {
     int count = mSpanCount;
     vector<shared_ptr<Object>> &spans = mSpans;
@@ -111,7 +141,7 @@ vector<shared_ptr<Object>> SpannableStringInternal::getSpans(int queryStart, int
     shared_ptr<Object> ret1 = NULL;
     
     for (int i = 0; i < spanCount; i++) {
-        if (!kind.empty() && kind.compare(spans[i]->getType()) != 0) {
+        if (!kind.empty() && !TextUtils::isSpanOfKind(spans[i], kind)) {
             continue;
         }
         
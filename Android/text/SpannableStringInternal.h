@@ -34,7 +34,7 @@ private:
     shared_ptr<String> mText;
     vector<shared_ptr<Object> > mSpans;
     vector<int> mSpanData;
-    int mSpanCount;
+    int mSpanCount = 0;
     
     static vector<shared_ptr<Object> > EMPTY;
     
@@ -75,6 +75,20 @@ public:
         return mText;
     }
     
+    /**
+     * The hash of the chars, cached by the String holding them. Spans are
+     * left out so that it does not change when they do.
+     */
+    int hashCode() const {
+        return mText->hashCode();
+    }
+    
+    /**
+     * Returns whether the object is a Spanned with the same chars and equal
+     * spans over the same ranges.
+     */
+    bool equals(const Object *object) const;
+    
     /* subclasses must do subSequence() to preserve type */
     
     void getChars(int start, int end, UnicodeString &dest, int off);
@@ -40,9 +40,13 @@ class TextDirectionHeuristic;
  * {@link android.graphics.Canvas#drawText(CharSequence, int, int,
  * float, float, android.graphics.Paint)
  * Canvas.drawText()} directly.</p>
+ * <p>Layouts may be built on several threads at once, as long as they do not
+ * share a text or a paint that is being modified.</p>
  */
 class StaticLayout : public Layout {
     
+    friend class DynamicLayout;
+    
 public:
     
     StaticLayout(shared_ptr<CharSequence> source, shared_ptr<TextPaint> paint,
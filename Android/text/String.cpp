@@ -26,6 +26,38 @@ UChar String::charAt(int index) {
     return mValue[index];
 }
 
+int String::hashCode() const {
+    int h = mHash;
+    if (h == 0 && mValue.length() > 0) {
+        const UChar *value = mValue.getBuffer();
+        const int32_t length = mValue.length();
+        
+        // Unsigned so that overflow wraps as it does in Java
+        uint32_t hash = 0;
+        for (int32_t i = 0; i < length; i++) {
+            hash = 31 * hash + value[i];
+        }
+        h = (int) hash;
+        mHash = h;
+    }
+    return h;
+}
+
+bool String::equals(const Object *object) const {
+    if (this == object) {
+        return true;
+    }
+    const String *other = dynamic_cast<const String*>(object);
+    if (other == NULL) {
+        return false;
+    }
+    // Differing cached hashes are a quick way out
+    if (mHash != 0 && other->mHash != 0 && mHash != other->mHash) {
+        return false;
+    }
+    return mValue == other->mValue;
+}
+
 int String::indexOf(shared_ptr<String> str) {
     return indexOf(str, 0);
 }
@@ -29,6 +29,9 @@ private:
     
     UnicodeString mValue;
     
+    // Cache of the hash, 0 until computed
+    mutable int mHash = 0;
+    
     /**
      * Code shared by String and StringBuffer to do searches. The
      * source is the character array being searched, and the target
@@ -224,7 +227,24 @@ public:
     
     const UChar* toCharArray() { return mValue.getBuffer(); }
     
-    UnicodeString &unicodeString() { return mValue; }
+    /**
+     * The value is not to be modified, its hash may be cached.
+     */
+    const UnicodeString &unicodeString() const { return mValue; }
+    
+    /**
+     * Returns the hash of the chars, computed once as
+     * <blockquote><pre>
+     * s[0]*31^(n-1) + s[1]*31^(n-2) + ... + s[n-1]
+     * </pre></blockquote>
+     * so that every CharSequence hashing its content agrees with it.
+     */
+    int hashCode() const;
+    
+    /**
+     * Returns whether the object is a String with the same chars.
+     */
+    bool equals(const Object *object) const;
     
     shared_ptr<String> toString() { return shared_from_this(); }
     
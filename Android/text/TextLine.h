@@ -26,6 +26,7 @@
 #include "Android/text/style/MetricAffectingSpan.h"
 #include "Android/text/style/ReplacementSpan.h"
 #include "Android/utils/ArrayUtils.h"
+#include "Android/utils/Pools.h"
 
 #include <unicode/unistr.h>
 
@@ -35,6 +36,7 @@
 
 using namespace icu;
 using namespace std;
+using namespace android;
 
 ANDROID_BEGIN
 
@@ -76,24 +78,18 @@ private:
     SpanSet<CharacterStyle> mCharacterStyleSpanSet = SpanSet<CharacterStyle>("CharacterStyle");
     SpanSet<ReplacementSpan> mReplacementSpanSpanSet = SpanSet<ReplacementSpan>("ReplacementSpan");
     
-    static vector<shared_ptr<TextLine<T>>> sCached;
+    static Pools::ThreadLocalPool<TextLine<T>> sPool;
     
     /**
-     * Returns a new TextLine from the shared pool.
+     * Returns a new TextLine from the pool of the calling thread.
      *
      * @return an uninitialized TextLine
      */
     static shared_ptr<TextLine<T>> obtain() {
-        shared_ptr<TextLine<T>> tl;
-        //    synchronized (sCached) {
-        for (int i = sCached.size(); --i >= 0;) {
-            if (sCached[i] != NULL) {
-                tl = sCached[i];
-                sCached[i] = NULL;
-                return tl;
-            }
+        shared_ptr<TextLine<T>> tl = sPool.acquire();
+        if (tl != NULL) {
+            return tl;
         }
-        //    }
         tl = make_shared<TextLine<T>>();
         if (DEBUG) {
             //        CCLOG("TLINE", "new: " + tl);
@@ -102,7 +98,7 @@ private:
     }
     
     /**
-     * Puts a TextLine back into the shared pool. Do not use this TextLine once
+     * Puts a TextLine back into the pool of the calling thread. Do not use this TextLine once
      * it has been returned.
      * @param tl the textLine
      * @return NULL, as a convenience from clearing references to the provided
@@ -116,14 +112,7 @@ private:
         tl->mCharacterStyleSpanSet.recycle();
         tl->mReplacementSpanSpanSet.recycle();
         
-        //    synchronized(sCached) {
-        for (int i = 0; i < sCached.size(); ++i) {
-            if (sCached[i] == NULL) {
-                sCached[i] = tl;
-                break;
-            }
-        }
-        //    }
+        sPool.release(tl);
         return NULL;
     }
     
@@ -1043,7 +1032,7 @@ private:
 };
 
 template<class T>
-vector<shared_ptr<TextLine<T>>> TextLine<T>::sCached = vector<shared_ptr<TextLine<T>>>(3);
+Pools::ThreadLocalPool<TextLine<T>> TextLine<T>::sPool(3);
 
 ANDROID_END
 
@@ -14,11 +14,13 @@
 #include "Android/text/SpannedString.h"
 #include "Android/text/SpannableString.h"
 #include "Android/text/SpannableStringBuilder.h"
+#include "Android/text/SpanWatcher.h"
 #include "Android/text/String.h"
 //#include "Android/text/StringBuilder.h"
 #include "Android/text/TextDirectionHeuristic.h"
 #include "Android/text/TextDirectionHeuristics.h"
 #include "Android/text/TextPaint.h"
+#include "Android/text/TextWatcher.h"
 #include "Android/utils/ArrayUtils.h"
 #include "Android/utils/System.h"
 
@@ -29,9 +31,8 @@
 
 ANDROID_BEGIN
 
-Mutex TextUtils::mLock;
 
-UnicodeString *TextUtils::sTemp = NULL;
+Pools::ThreadLocalPool<UnicodeString> TextUtils::sTemp(1);
 
 shared_ptr<TextUtils::TruncateAt> TextUtils::TruncateAt::START = make_shared<TruncateAt>();
 shared_ptr<TextUtils::TruncateAt> TextUtils::TruncateAt::MIDDLE = make_shared<TruncateAt>();
@@ -270,7 +271,7 @@ int TextUtils::indexOf(shared_ptr<CharSequence> s, UChar32 ch, int start) {
 int TextUtils::indexOf(shared_ptr<CharSequence> s, UChar32 ch, int start, int end) {
     
     const int INDEX_INCREMENT = 500;
-    UnicodeString *temp = obtain(INDEX_INCREMENT);
+    shared_ptr<UnicodeString> temp = obtain(INDEX_INCREMENT);
     
     while (start < end) {
         int segend = start + INDEX_INCREMENT;
@@ -294,6 +295,56 @@ int TextUtils::indexOf(shared_ptr<CharSequence> s, UChar32 ch, int start, int en
     return -1;
 }
 
+int TextUtils::lastIndexOf(shared_ptr<CharSequence> s, UChar32 ch, int last) {
+    return lastIndexOf(s, ch, 0, last);
+}
+
+int TextUtils::lastIndexOf(shared_ptr<CharSequence> s, UChar32 ch, int start, int last) {
+    if (last < 0)
+        return -1;
+    if (last >= s->length())
+        last = s->length() - 1;
+    
+    int end = last + 1;
+    
+    const int INDEX_INCREMENT = 500;
+    shared_ptr<UnicodeString> temp = obtain(INDEX_INCREMENT);
+    
+    while (start < end) {
+        int segstart = end - INDEX_INCREMENT;
+        if (segstart < start)
+            segstart = start;
+        
+        getChars(s, segstart, end, *temp, 0);
+        
+        int count = end - segstart;
+        for (int i = count - 1; i >= 0; i--) {
+            if (temp->charAt(i) == ch) {
+                recycle(temp);
+                return i + segstart;
+            }
+        }
+        
+        end = segstart;
+    }
+    
+    recycle(temp);
+    return -1;
+}
+
+bool TextUtils::isSpanOfKind(shared_ptr<Object> span, const string &kind) {
+    if (kind.compare(span->getType()) == 0) {
+        return true;
+    }
+    if (kind.compare("TextWatcher") == 0) {
+        return dynamic_pointer_cast<TextWatcher>(span) != NULL;
+    }
+    if (kind.compare("SpanWatcher") == 0) {
+        return dynamic_pointer_cast<SpanWatcher>(span) != NULL;
+    }
+    return false;
+}
+
 bool TextUtils::isEmpty(shared_ptr<CharSequence> str) {
     if (str == NULL || str->length() == 0)
         return true;
@@ -301,15 +352,30 @@ bool TextUtils::isEmpty(shared_ptr<CharSequence> str) {
         return false;
 }
 
-UnicodeString *TextUtils::obtain(int len) {
-    
-    AutoMutex _l(mLock);
+bool TextUtils::equals(shared_ptr<CharSequence> a, shared_ptr<CharSequence> b) {
+    if (a == b) return true;
+    int length;
+    if (a != NULL && b != NULL && (length = a->length()) == b->length()) {
+        shared_ptr<String> as = dynamic_pointer_cast<String>(a);
+        shared_ptr<String> bs = dynamic_pointer_cast<String>(b);
+        if (as != NULL && bs != NULL) {
+            return as->equals(bs.get());
+        } else {
+            for (int i = 0; i < length; i++) {
+                if (a->charAt(i) != b->charAt(i)) return false;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+shared_ptr<UnicodeString> TextUtils::obtain(int len) {
     
-    UnicodeString *buf = sTemp;
-    sTemp = NULL;
+    shared_ptr<UnicodeString> buf = sTemp.acquire();
     
     if (buf == NULL) {
-        buf = new UnicodeString(len, ' ', 0);
+        buf = make_shared<UnicodeString>(len, ' ', 0);
     }
     
     if (buf->length() < len) {
@@ -322,12 +388,11 @@ UnicodeString *TextUtils::obtain(int len) {
     return buf;
 }
 
-void TextUtils::recycle(UnicodeString *temp) {
+void TextUtils::recycle(shared_ptr<UnicodeString> temp) {
     if (temp->length() > 1000)
         return;
     
-    AutoMutex _l(mLock);
-    sTemp = temp;
+    sTemp.release(temp);
 }
 
 vector<shared_ptr<Object>> TextUtils::removeEmptySpans(vector<shared_ptr<Object>> &spans, shared_ptr<Spanned> spanned, string klass) {
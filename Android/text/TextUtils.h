@@ -15,8 +15,7 @@
 #include "Android/text/Spanned.h"
 #include "Android/text/Spannable.h"
 #include "Android/utils/Object.h"
-
-#include <utils/Mutex.h>
+#include "Android/utils/Pools.h"
 
 #include <unicode/unistr.h>
 
@@ -148,6 +147,16 @@ public:
     static int indexOf(shared_ptr<CharSequence> s, UChar32 ch, int start);
     static int indexOf(shared_ptr<CharSequence> s, UChar32 ch, int start, int end);
     
+    static int lastIndexOf(shared_ptr<CharSequence> s, UChar32 ch, int last);
+    static int lastIndexOf(shared_ptr<CharSequence> s, UChar32 ch, int start, int last);
+    
+    /**
+     * Returns true if the span is of the given kind. Watchers implement
+     * both TextWatcher and SpanWatcher, so those two kinds are matched by
+     * interface rather than by the single name getType() reports.
+     */
+    static bool isSpanOfKind(shared_ptr<Object> span, const string &kind);
+    
     /**
      * Returns true if the string is null or 0-length.
      * @param str the string to be examined
@@ -155,6 +164,16 @@ public:
      */
     static bool isEmpty(shared_ptr<CharSequence> str);
     
+    /**
+     * Returns true if a and b are equal, including if they are both null.
+     * <p><i>Note: In platform versions 1.1 and earlier, this method only worked well if
+     * both the arguments were instances of String.</i></p>
+     * @param a first CharSequence to check
+     * @param b second CharSequence to check
+     * @return true if a and b are equal
+     */
+    static bool equals(shared_ptr<CharSequence> a, shared_ptr<CharSequence> b);
+    
     /**
      * Pack 2 int values into a long, useful as a return value for a range
      * @see #unpackRangeStartFromLong(long)
@@ -165,8 +184,12 @@ public:
         return (((long long) start) << 32) | end;
     }
     
-    static UnicodeString *obtain(int len);
-    static void recycle(UnicodeString *temp);
+    /**
+     * Returns a scratch buffer of at least len characters from the pool of
+     * the calling thread. Return it with recycle().
+     */
+    static shared_ptr<UnicodeString> obtain(int len);
+    static void recycle(shared_ptr<UnicodeString> temp);
     
     /**
      * Removes empty spans from the <code>spans</code> array.
@@ -207,8 +230,7 @@ public:
     
 private:
     
-    static Mutex mLock;
-    static UnicodeString *sTemp;
+    static Pools::ThreadLocalPool<UnicodeString> sTemp;
     
     static const UChar ZWNBS_CHAR = 0xFEFF;
     
@@ -9,6 +9,7 @@
 
 #include "cocos2d.h"
 
+#include "Android/content/res/AssetPack.h"
 #include "Android/content/res/ColorStateList.h"
 #include "Android/internal/R.h"
 #include "Android/view/View.h"
@@ -30,24 +31,21 @@ bool CCPullParser::init(const char *pszFile) {
 
 bool CCPullParser::parse(const char *pszFile) {
     
-    cocos2d::CCFileUtils *fileUtils = cocos2d::CCFileUtils::sharedFileUtils();
     bool bRet = false;
     
-    if (!fileUtils->isFileExist(pszFile)) {
+    // Parsed straight from the resource pack when there is one
+    shared_ptr<AssetPack::Asset> asset = AssetPack::getFileData(pszFile);
+    
+    if (asset == NULL) {
         CCLOG("Could not find %s", pszFile);
         return bRet;
     }
-    
-    unsigned long size = 0;
-
-    char* pBuffer = (char*) fileUtils->getFileData(pszFile, "rt", &size);
 
-    if (pBuffer != NULL && size > 0) {
-        tinyxml2::XMLError result = m_doc.Parse(pBuffer, size);
+    if (asset->getLength() > 0) {
+        tinyxml2::XMLError result = m_doc.Parse(asset->getBuffer(), asset->getLength());
         bRet = tinyxml2::XML_SUCCESS == result;
         setRoot(m_doc.FirstChild()->NextSibling());
     }
-    CC_SAFE_DELETE_ARRAY(pBuffer);
     
     return bRet && m_root;
 }
@@ -210,6 +208,11 @@ int CCPullParser::getDimensionValue(Resources *res, const char *attribute, int d
     if (value.compare(R::layout::wrap_content) == 0) {
         return LayoutParams::WRAP_CONTENT;
     }
+    
+    // Already converted to pixels by the resources
+    if (value.compare(0, 7, "@dimen/") == 0) {
+        return res->getDimensionPixelSize(res->getIdentifier(value));
+    }
 
     string amount = value.substr(0, value.length() - 2);
     
@@ -244,7 +247,7 @@ shared_ptr<ColorStateList> CCPullParser::getAttributeColorStateList(Resources *r
 
 const tinyxml2::XMLAttribute *CCPullParser::getAttribute(const char* name) {
 
-    map<string, const tinyxml2::XMLAttribute*>::iterator it = m_attrs.find(name);
+    HashMap<string, const tinyxml2::XMLAttribute*>::iterator it = m_attrs.find(name);
 
     if (it != m_attrs.end()) {
         return it->second;
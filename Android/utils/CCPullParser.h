@@ -13,10 +13,10 @@
 #include "AndroidMacros.h"
 
 #include "Android/utils/AttributeSet.h"
+#include "Android/utils/HashMap.h"
 
 #include <unicode/unistr.h>
 
-#include <map>
 #include <memory>
 
 using namespace icu;
@@ -63,7 +63,7 @@ private:
     
     tinyxml2::XMLDocument m_doc;
     tinyxml2::XMLNode *m_root;
-    map<string, const tinyxml2::XMLAttribute*> m_attrs;
+    HashMap<string, const tinyxml2::XMLAttribute*> m_attrs;
     vector<string> m_attrsName;
     
     bool m_attrsLoaded;
@@ -0,0 +1,372 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __Androidpp__HashMap__
+#define __Androidpp__HashMap__
+
+#include "AndroidMacros.h"
+
+#include "Android/utils/Object.h"
+
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+ANDROID_BEGIN
+
+/**
+ * The hash and equality of the keys of a HashMap or a HashSet: std::hash and
+ * == by default, Object::hashCode and Object::equals for shared pointers to
+ * objects.
+ */
+template<class K, class Enable = void>
+struct HashTraits {
+
+    static size_t hash(const K &key) {
+        return std::hash<K>()(key);
+    }
+
+    static bool equals(const K &a, const K &b) {
+        return a == b;
+    }
+};
+
+template<class T>
+struct HashTraits<shared_ptr<T>, typename enable_if<is_base_of<Object, T>::value>::type> {
+
+    static size_t hash(const shared_ptr<T> &key) {
+        return key == NULL ? 0 : (size_t) key->hashCode();
+    }
+
+    static bool equals(const shared_ptr<T> &a, const shared_ptr<T> &b) {
+        return a == b || (a != NULL && b != NULL && a->equals(b.get()));
+    }
+};
+
+/**
+ * A hash map with open addressing: the entries are stored in one array and
+ * collisions probe the next slots, so a lookup touches a few adjacent entries
+ * instead of walking the nodes of a tree. Removal shifts the following
+ * entries back rather than leaving tombstones.
+ *
+ * Iterators are invalidated by any insertion or removal. The key of an entry
+ * must not be changed through an iterator.
+ */
+template<class K, class V, class Traits = HashTraits<K>>
+class HashMap {
+
+public:
+
+    typedef pair<K, V> Entry;
+
+    template<class M, class E>
+    class Iterator {
+
+        friend class HashMap;
+
+        template<class, class>
+        friend class Iterator;
+
+    public:
+
+        /**
+         * Converts an iterator to a const_iterator.
+         */
+        template<class OM, class OE>
+        Iterator(const Iterator<OM, OE> &other) : mMap(other.mMap), mIndex(other.mIndex) {}
+
+        E &operator*() const { return mMap->mEntries[mIndex]; }
+        E *operator->() const { return &mMap->mEntries[mIndex]; }
+
+        Iterator &operator++() {
+            mIndex = mMap->next(mIndex + 1);
+            return *this;
+        }
+
+        bool operator==(const Iterator &other) const { return mIndex == other.mIndex; }
+        bool operator!=(const Iterator &other) const { return mIndex != other.mIndex; }
+
+    private:
+
+        Iterator(M *map, size_t index) : mMap(map), mIndex(index) {}
+
+        M *mMap;
+        size_t mIndex;
+    };
+
+    typedef Iterator<HashMap, Entry> iterator;
+    typedef Iterator<const HashMap, const Entry> const_iterator;
+
+    HashMap() : mSize(0), mMask(0) {
+    }
+
+    HashMap(initializer_list<Entry> entries) : mSize(0), mMask(0) {
+        reserve(entries.size());
+        for (const Entry &entry : entries) {
+            insert(entry);
+        }
+    }
+
+    size_t size() const { return mSize; }
+    bool empty() const { return mSize == 0; }
+
+    /**
+     * Returns the number of slots, for memory estimates.
+     */
+    size_t capacity() const { return mHashes.size(); }
+
+    iterator begin() { return iterator(this, next(0)); }
+    iterator end() { return iterator(this, mHashes.size()); }
+    const_iterator begin() const { return const_iterator(this, next(0)); }
+    const_iterator end() const { return const_iterator(this, mHashes.size()); }
+
+    iterator find(const K &key) {
+        return iterator(this, indexOf(key, hash(key)));
+    }
+
+    const_iterator find(const K &key) const {
+        return const_iterator(this, indexOf(key, hash(key)));
+    }
+
+    size_t count(const K &key) const {
+        return indexOf(key, hash(key)) != mHashes.size() ? 1 : 0;
+    }
+
+    V &operator[](const K &key) {
+        return insert(Entry(key, V())).first->second;
+    }
+
+    /**
+     * Adds an entry unless its key is already in the map.
+     *
+     * @return The entry with the key, and whether it was added.
+     */
+    pair<iterator, bool> insert(const Entry &entry) {
+        const uint32_t h = hash(entry.first);
+
+        size_t index = indexOf(entry.first, h);
+        if (index != mHashes.size()) {
+            return make_pair(iterator(this, index), false);
+        }
+
+        if ((mSize + 1) * 4 > mHashes.size() * 3) {
+            rehash(mHashes.empty() ? MIN_CAPACITY : mHashes.size() * 2);
+        }
+
+        index = h & mMask;
+        while (mHashes[index] != 0) {
+            index = (index + 1) & mMask;
+        }
+
+        mHashes[index] = h;
+        mEntries[index] = entry;
+        mSize++;
+        return make_pair(iterator(this, index), true);
+    }
+
+    /**
+     * @return The number of entries removed, 0 or 1.
+     */
+    size_t erase(const K &key) {
+        size_t index = indexOf(key, hash(key));
+        if (index == mHashes.size()) {
+            return 0;
+        }
+
+        // Moves back the entries after it that probed past the slot
+        size_t next = (index + 1) & mMask;
+        while (mHashes[next] != 0) {
+            const size_t ideal = mHashes[next] & mMask;
+            if (((next - ideal) & mMask) >= ((next - index) & mMask)) {
+                mHashes[index] = mHashes[next];
+                mEntries[index] = std::move(mEntries[next]);
+                index = next;
+            }
+            next = (next + 1) & mMask;
+        }
+
+        mHashes[index] = 0;
+        mEntries[index] = Entry();
+        mSize--;
+        return 1;
+    }
+
+    void clear() {
+        mHashes.clear();
+        mEntries.clear();
+        mSize = 0;
+        mMask = 0;
+    }
+
+    /**
+     * Makes room for count entries without growing.
+     */
+    void reserve(size_t count) {
+        size_t capacity = MIN_CAPACITY;
+        while (capacity * 3 < count * 4) {
+            capacity *= 2;
+        }
+        if (capacity > mHashes.size()) {
+            rehash(capacity);
+        }
+    }
+
+private:
+
+    static const size_t MIN_CAPACITY = 8;
+
+    // 0 marks an empty slot
+    vector<uint32_t> mHashes;
+    vector<Entry> mEntries;
+    size_t mSize;
+    size_t mMask;
+
+    static uint32_t hash(const K &key) {
+        // Spreads hashes such as small integers and pointers over the mask
+        uint64_t h = (uint64_t) Traits::hash(key);
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        const uint32_t result = (uint32_t) h;
+        return result != 0 ? result : 1;
+    }
+
+    size_t indexOf(const K &key, uint32_t h) const {
+        if (mSize == 0) {
+            return mHashes.size();
+        }
+
+        size_t index = h & mMask;
+        while (mHashes[index] != 0) {
+            if (mHashes[index] == h && Traits::equals(mEntries[index].first, key)) {
+                return index;
+            }
+            index = (index + 1) & mMask;
+        }
+        return mHashes.size();
+    }
+
+    size_t next(size_t index) const {
+        while (index < mHashes.size() && mHashes[index] == 0) {
+            index++;
+        }
+        return index;
+    }
+
+    void rehash(size_t capacity) {
+        vector<uint32_t> hashes(capacity, 0);
+        vector<Entry> entries(capacity);
+        const size_t mask = capacity - 1;
+
+        for (size_t i = 0; i < mHashes.size(); i++) {
+            if (mHashes[i] == 0) continue;
+
+            size_t index = mHashes[i] & mask;
+            while (hashes[index] != 0) {
+                index = (index + 1) & mask;
+            }
+            hashes[index] = mHashes[i];
+            entries[index] = std::move(mEntries[i]);
+        }
+
+        mHashes.swap(hashes);
+        mEntries.swap(entries);
+        mMask = mask;
+    }
+};
+
+template<class K, class V, class Traits>
+const size_t HashMap<K, V, Traits>::MIN_CAPACITY;
+
+/**
+ * A set of keys stored as a HashMap is.
+ */
+template<class K, class Traits = HashTraits<K>>
+class HashSet {
+
+private:
+
+    typedef HashMap<K, bool, Traits> Map;
+
+    Map mMap;
+
+public:
+
+    class const_iterator {
+
+        friend class HashSet;
+
+    public:
+
+        const K &operator*() const { return mIterator->first; }
+        const K *operator->() const { return &mIterator->first; }
+
+        const_iterator &operator++() {
+            ++mIterator;
+            return *this;
+        }
+
+        bool operator==(const const_iterator &other) const { return mIterator == other.mIterator; }
+        bool operator!=(const const_iterator &other) const { return mIterator != other.mIterator; }
+
+    private:
+
+        const_iterator(typename Map::const_iterator iterator) : mIterator(iterator) {}
+
+        typename Map::const_iterator mIterator;
+    };
+
+    typedef const_iterator iterator;
+
+    HashSet() {
+    }
+
+    HashSet(initializer_list<K> keys) {
+        reserve(keys.size());
+        for (const K &key : keys) {
+            insert(key);
+        }
+    }
+
+    size_t size() const { return mMap.size(); }
+    bool empty() const { return mMap.empty(); }
+    size_t capacity() const { return mMap.capacity(); }
+
+    const_iterator begin() const { return const_iterator(mMap.begin()); }
+    const_iterator end() const { return const_iterator(mMap.end()); }
+
+    const_iterator find(const K &key) const { return const_iterator(mMap.find(key)); }
+    size_t count(const K &key) const { return mMap.count(key); }
+
+    /**
+     * @return Whether the key was added.
+     */
+    bool insert(const K &key) { return mMap.insert(make_pair(key, true)).second; }
+
+    size_t erase(const K &key) { return mMap.erase(key); }
+    void clear() { mMap.clear(); }
+    void reserve(size_t count) { mMap.reserve(count); }
+};
+
+ANDROID_END
+
+#endif /* defined(__Androidpp__HashMap__) */
@@ -11,6 +11,7 @@
 
 #include "AndroidMacros.h"
 
+#include <stdint.h>
 #include <string>
 
 using namespace std;
@@ -23,20 +24,24 @@ class Object {
     
 public:
     
+    /**
+     * Returns a hash of the object. Objects that are equal must have the
+     * same hash, so a subclass overriding equals overrides this too. The
+     * default hashes the identity of the object, as equals compares it.
+     */
     virtual int hashCode() const {
-        return 0;
+        const uint64_t address = (uint64_t) (uintptr_t) this;
+        return (int) (address ^ (address >> 32));
     }
     
     virtual String toString() const;
     
+    /**
+     * Returns whether the object is equal to this one, by default only if
+     * it is this one.
+     */
     virtual bool equals(const Object *object) const {
-        if (this == object) {
-            return true;
-        }
-        if (object == NULL) {
-            return false;
-        }
-        return false;
+        return this == object;
     }
     
     virtual string getType() {
@@ -15,8 +15,11 @@
 
 #include <vector>
 #include <algorithm>
+#include <memory>
 #include <mutex>
 
+#include <pthread.h>
+
 using namespace std;
 
 ANDROID_BEGIN
@@ -164,6 +167,79 @@ public:
             return SimplePool<T>::release(element);
         }
     };
+    
+    /**
+     * Pool of objects kept per thread, so that threads using the pool at the
+     * same time neither wait for each other nor share an instance. Each thread
+     * keeps at most maxPoolSize instances, freed when the thread exits.
+     *
+     * Meant to be static: the thread key lives as long as the process.
+     *
+     * @param <T> The pooled type.
+     */
+    template<class T>
+    class ThreadLocalPool {
+        
+    private:
+        
+        typedef vector<shared_ptr<T>> LocalPool;
+        
+        pthread_key_t mKey;
+        size_t mMaxPoolSize;
+        
+        static void destroyLocalPool(void *pool) {
+            delete static_cast<LocalPool*>(pool);
+        }
+        
+    public:
+        
+        /**
+         * Creates a new instance.
+         *
+         * @param maxPoolSize The max pool size of each thread.
+         *
+         * @throws IllegalArgumentException If the max pool size is less than zero.
+         */
+        ThreadLocalPool(int maxPoolSize) : mMaxPoolSize(maxPoolSize) {
+            if (maxPoolSize <= 0) {
+                throw IllegalArgumentException("The max pool size must be > 0");
+            }
+            pthread_key_create(&mKey, destroyLocalPool);
+        }
+        
+        /**
+         * @return An instance from the pool of the calling thread if such, null otherwise.
+         */
+        shared_ptr<T> acquire() {
+            LocalPool *pool = static_cast<LocalPool*>(pthread_getspecific(mKey));
+            if (pool == NULL || pool->empty()) {
+                return NULL;
+            }
+            shared_ptr<T> instance = pool->back();
+            pool->pop_back();
+            return instance;
+        }
+        
+        /**
+         * Release an instance to the pool of the calling thread.
+         *
+         * @param instance The instance to release.
+         * @return Whether the instance was put in the pool.
+         */
+        bool release(const shared_ptr<T> &instance) {
+            LocalPool *pool = static_cast<LocalPool*>(pthread_getspecific(mKey));
+            if (pool == NULL) {
+                pool = new LocalPool();
+                pool->reserve(mMaxPoolSize);
+                pthread_setspecific(mKey, pool);
+            }
+            if (pool->size() >= mMaxPoolSize) {
+                return false;
+            }
+            pool->push_back(instance);
+            return true;
+        }
+    };
 };
 
 ANDROID_END
@@ -19,6 +19,7 @@
 #include <algorithm>
 
 #include <unicode/unistr.h>
+#include <utils/Unicode.h>
 
 using namespace icu;
 using namespace std;
@@ -42,20 +43,50 @@ public:
         }
     }
     
-    static string convert(UnicodeString value) {
+    static string convert(const UnicodeString &value) {
+        return convert(value.getBuffer(), value.length());
+    }
+    
+    /**
+     * Converts UTF-16 to UTF-8, measured first so that the string is allocated
+     * once. Unpaired surrogates are dropped.
+     */
+    static string convert(const UChar *chars, int32_t length) {
         
-        char buf[value.length()];
-        value.extract(0, value.length(), &buf[0]);
+        const char16_t *src = reinterpret_cast<const char16_t*>(chars);
+        const ssize_t bytes = chars != NULL && length > 0 ? utf16_to_utf8_length(src, length) : 0;
+        if (bytes <= 0) {
+            return string();
+        }
         
-        return string(buf);
+        // utf16_to_utf8 adds a terminator
+        string value(bytes + 1, '\0');
+        utf16_to_utf8(src, length, &value[0]);
+        value.resize(bytes);
+        
+        return value;
     }
     
     static UnicodeString convertChars(const char* value, int32_t length) {
-        UnicodeString val = UnicodeString::fromUTF8(StringPiece(value));
+        
+        const uint8_t *src = reinterpret_cast<const uint8_t*>(value);
+        const ssize_t units = utf8_to_utf16_length(src, length);
+        if (units < 0) {
+            // ICU replaces the invalid sequences with U+FFFD
+            return UnicodeString::fromUTF8(StringPiece(value, length));
+        }
+        
+        UnicodeString val;
+        UChar *buffer = val.getBuffer(units);
+        if (buffer != NULL) {
+            utf8_to_utf16_no_null_terminator(src, length, reinterpret_cast<char16_t*>(buffer));
+            val.releaseBuffer(units);
+        }
+        
         return val;
     }
     
-    static UnicodeString convert(string value) {
+    static UnicodeString convert(const string &value) {
         return convertChars(value.c_str(), value.length());
     }
     
@@ -13,9 +13,10 @@
 
 #include "cocos2d.h"
 
+#include "Android/utils/HashMap.h"
+
 #include <vector>
 #include <string>
-#include <map>
 #include <memory>
 
 using namespace std;
@@ -32,7 +33,7 @@ class instantiator {
 private:
     
     typedef shared_ptr<BaseType> (*factory_type) (androidcpp::Context *context, androidcpp::AttributeSet *attrs); // factory function signature
-    typedef map<string, factory_type> object_factory_map; // key-to-factory map
+    typedef androidcpp::HashMap<string, factory_type> object_factory_map; // key-to-factory map
     
     class ObjectFactory {
     public:
@@ -8,14 +8,18 @@
 #include "GLES20DisplayList.h"
 
 #include "Android/graphics/Canvas.h"
+#include "Android/graphics/HardwareRenderer.h"
 #include <memory.h>
 
 ANDROID_BEGIN
 
-GLES20DisplayList::GLES20DisplayList() : m_canvas(NULL) {
+GLES20DisplayList::GLES20DisplayList(HardwareRenderer *renderer) : m_canvas(NULL), m_renderer(renderer) {
 }
 
 GLES20DisplayList::~GLES20DisplayList() {
+    if (m_renderer) {
+        m_renderer->removeStagedDisplayList(this);
+    }
 }
 
 
@@ -23,6 +27,12 @@ shared_ptr<Canvas> GLES20DisplayList::start(int width, int height) {
 
     m_isValid = false;
 
+    // Recorded again before the renderer synced, the last recording is lost
+    if ((m_stagedChanges & kStagedRecording) != 0) {
+        m_canvas->recycle();
+        m_stagedChanges &= ~kStagedRecording;
+    }
+
     if (!m_canvas) {
         m_canvas = make_shared<Canvas>(this);
     }
@@ -37,11 +47,115 @@ shared_ptr<Canvas> GLES20DisplayList::start(int width, int height) {
 void GLES20DisplayList::end() {
     if (m_canvas) {
         m_canvas->onPostDraw();
-        m_canvas->end(this);
-        m_canvas->recycle();
-        m_canvas = NULL;
         m_isValid = true;
+
+        if (m_renderer) {
+            stage(kStagedRecording);
+        } else {
+            endRecording();
+        }
+    }
+}
+
+void GLES20DisplayList::endRecording() {
+    m_canvas->end(this);
+    m_canvas->recycle();
+    m_canvas = NULL;
+}
+
+void GLES20DisplayList::stage(int changes) {
+    if (!m_isStaged) {
+        m_renderer->addStagedDisplayList(this);
+        m_isStaged = true;
+    }
+    m_stagedChanges |= changes;
+}
+
+void GLES20DisplayList::pushStagingChanges() {
+
+    if ((m_stagedChanges & kStagedRecording) != 0) {
+        endRecording();
+    }
+    if ((m_stagedChanges & kStagedBounds) != 0) {
+        DisplayList::setLeftTopRightBottom(m_left, m_top, m_right, m_bottom);
+    }
+    if ((m_stagedChanges & kStagedHasOverlappingRendering) != 0) {
+        DisplayList::setHasOverlappingRendering(m_hasOverlappingRendering);
+    }
+    if ((m_stagedChanges & kStagedClipChildren) != 0) {
+        DisplayList::setClipChildren(m_clipChildren);
+    }
+    if ((m_stagedChanges & kStagedCaching) != 0) {
+        DisplayList::setCaching(m_caching);
+    }
+
+    m_stagedChanges = 0;
+    m_isStaged = false;
+}
+
+void GLES20DisplayList::setLeftTopRightBottom(int left, int top, int right, int bottom) {
+    if (!m_renderer) {
+        DisplayList::setLeftTopRightBottom(left, top, right, bottom);
+        return;
+    }
+
+    m_left = left;
+    m_top = top;
+    m_right = right;
+    m_bottom = bottom;
+    stage(kStagedBounds);
+}
+
+void GLES20DisplayList::offsetLeftRight(int offset) {
+    if (!m_renderer) {
+        DisplayList::offsetLeftRight(offset);
+        return;
+    }
+
+    m_left += offset;
+    m_right += offset;
+    stage(kStagedBounds);
+}
+
+void GLES20DisplayList::offsetTopBottom(int offset) {
+    if (!m_renderer) {
+        DisplayList::offsetTopBottom(offset);
+        return;
+    }
+
+    m_top += offset;
+    m_bottom += offset;
+    stage(kStagedBounds);
+}
+
+void GLES20DisplayList::setHasOverlappingRendering(bool hasOverlappingRendering) {
+    if (!m_renderer) {
+        DisplayList::setHasOverlappingRendering(hasOverlappingRendering);
+        return;
+    }
+
+    m_hasOverlappingRendering = hasOverlappingRendering;
+    stage(kStagedHasOverlappingRendering);
+}
+
+void GLES20DisplayList::setClipChildren(bool clipChildren) {
+    if (!m_renderer) {
+        DisplayList::setClipChildren(clipChildren);
+        return;
     }
+
+    m_clipChildren = clipChildren;
+    stage(kStagedClipChildren);
+}
+
+void GLES20DisplayList::setCaching(bool caching) {
+    if (!m_renderer) {
+        DisplayList::setCaching(caching);
+        return;
+    }
+
+    m_caching = caching;
+    stage(kStagedCaching);
 }
 
 ANDROID_END
\ No newline at end of file
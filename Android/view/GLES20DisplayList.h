@@ -21,10 +21,18 @@ ANDROID_BEGIN
 using namespace android::uirenderer;
 
 class Canvas;
+class HardwareRenderer;
 
+/**
+ * The display list of a view. Drawn by a render thread, its recording and
+ * the properties set by the view are staged and only pushed to the display
+ * list when the renderer syncs the next frame, as the render thread may be
+ * drawing the previous one meanwhile.
+ */
 class GLES20DisplayList : public DisplayList {
 
     friend class Canvas;
+    friend class HardwareRenderer;
 
 public:
 
@@ -33,7 +41,10 @@ public:
     static const int STATUS_DONE = 0x0;
     static const int STATUS_DRAW = 0x1;
 
-    GLES20DisplayList();
+    /**
+     * Changes are staged with the renderer if there is one.
+     */
+    GLES20DisplayList(HardwareRenderer *renderer = NULL);
     virtual ~GLES20DisplayList();
     
     void clear() {
@@ -43,9 +54,41 @@ public:
     shared_ptr<Canvas> start(int width, int height);
     void end();
     bool isValid() { return m_isValid; }
+
+    // Hide the setters of DisplayList to stage the changes
+    void setLeftTopRightBottom(int left, int top, int right, int bottom);
+    void offsetLeftRight(int offset);
+    void offsetTopBottom(int offset);
+    void setHasOverlappingRendering(bool hasOverlappingRendering);
+    void setClipChildren(bool clipChildren);
+    void setCaching(bool caching);
 private:
+    enum {
+        kStagedRecording = 0x1,
+        kStagedBounds = 0x2,
+        kStagedHasOverlappingRendering = 0x4,
+        kStagedClipChildren = 0x8,
+        kStagedCaching = 0x10
+    };
+
+    void stage(int changes);
+    void pushStagingChanges();
+    void endRecording();
+
     bool m_isValid = false;
     shared_ptr<Canvas> m_canvas;
+
+    HardwareRenderer *m_renderer;
+    bool m_isStaged = false;
+    int m_stagedChanges = 0;
+    // The properties as last set by the view, as DisplayList initializes them
+    int m_left = 0;
+    int m_top = 0;
+    int m_right = 0;
+    int m_bottom = 0;
+    bool m_hasOverlappingRendering = true;
+    bool m_clipChildren = true;
+    bool m_caching = false;
     std::vector<GLES20DisplayList*> mChildrenDisplayLists;
 };
 
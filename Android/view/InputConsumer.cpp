@@ -0,0 +1,167 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "InputConsumer.h"
+
+#include <algorithm>
+
+ANDROID_BEGIN
+
+const nsecs_t InputConsumer::RESAMPLE_LATENCY;
+const nsecs_t InputConsumer::RESAMPLE_MIN_DELTA;
+const nsecs_t InputConsumer::RESAMPLE_MAX_DELTA;
+const nsecs_t InputConsumer::RESAMPLE_MAX_PREDICTION;
+
+void InputConsumer::Sample::set(const MotionEvent &event, size_t historicalIndex) {
+    const size_t pointerCount = event.getPointerCount();
+    const MotionEvent::PointerCoords *coords = event.getHistoricalRawPointerCoords(historicalIndex);
+    
+    eventTime = event.getHistoricalEventTime(historicalIndex);
+    pointerIds.assign(event.getPointerIds(), event.getPointerIds() + pointerCount);
+    pointerCoords.assign(coords, coords + pointerCount);
+}
+
+bool InputConsumer::Sample::hasSamePointers(const MotionEvent &event) const {
+    return pointerIds.size() == (size_t) event.getPointerCount() &&
+            std::equal(pointerIds.begin(), pointerIds.end(), event.getPointerIds());
+}
+
+void InputConsumer::addMove(const MotionEvent &event) {
+    m_batch.push_back(event);
+}
+
+bool InputConsumer::consumeBatch(nsecs_t frameTime, MotionEvent &outEvent) {
+    
+    const bool resampling = frameTime >= 0;
+    const nsecs_t sampleTime = frameTime - RESAMPLE_LATENCY;
+    
+    if (m_batch.empty() || (resampling && m_batch.front().getEventTime() > sampleTime)) {
+        return false;
+    }
+    
+    const MotionEvent &first = m_batch.front();
+    outEvent.initialize(MotionEvent::ACTION_MOVE, first.getPointerCount(), first.getPointerIds(),
+                        first.getEventTime(), rewriteSample(first));
+    m_batch.pop_front();
+    addHistory(outEvent, 0);
+    
+    // The moves left are delivered by a later frame, or in another event if the
+    // pointers changed
+    while (!m_batch.empty()) {
+        const MotionEvent &sample = m_batch.front();
+        if ((resampling && sample.getEventTime() > sampleTime) || !sample.hasSamePointers(outEvent)) {
+            break;
+        }
+        
+        outEvent.addSample(sample.getEventTime(), rewriteSample(sample));
+        m_batch.pop_front();
+        addHistory(outEvent, outEvent.getHistorySize());
+    }
+    
+    if (resampling) {
+        resample(sampleTime, outEvent, m_batch.empty() ? NULL : &m_batch.front());
+    } else {
+        m_hasLastResample = false;
+    }
+    
+    return true;
+}
+
+void InputConsumer::reset() {
+    m_historySize = 0;
+    m_hasLastResample = false;
+}
+
+void InputConsumer::addHistory(const MotionEvent &event, size_t historicalIndex) {
+    std::swap(m_history[0], m_history[1]);
+    m_history[0].set(event, historicalIndex);
+    m_historySize = std::min(m_historySize + 1, 2);
+}
+
+const MotionEvent::PointerCoords *InputConsumer::rewriteSample(const MotionEvent &sample) {
+    
+    // A sample older than the last resampled one would move the pointers back,
+    // the resampled coordinates are repeated instead
+    if (m_hasLastResample && sample.getEventTime() < m_lastResample.eventTime &&
+            m_lastResample.hasSamePointers(sample)) {
+        return m_lastResample.pointerCoords.data();
+    }
+    
+    return sample.getHistoricalRawPointerCoords(0);
+}
+
+void InputConsumer::resample(nsecs_t sampleTime, MotionEvent &event, const MotionEvent *next) {
+    
+    m_hasLastResample = false;
+    
+    const Sample &current = m_history[0];
+    const MotionEvent::PointerCoords *otherCoords;
+    float alpha;
+    
+    if (next != NULL) {
+        // Interpolate with the first move of the next batch
+        if (!next->hasSamePointers(event)) {
+            return;
+        }
+        
+        const nsecs_t delta = next->getEventTime() - current.eventTime;
+        if (delta < RESAMPLE_MIN_DELTA) {
+            return;
+        }
+        
+        alpha = float(sampleTime - current.eventTime) / delta;
+        otherCoords = next->getHistoricalRawPointerCoords(0);
+    } else if (m_historySize == 2) {
+        // Extrapolate from the last two moves
+        const Sample &previous = m_history[1];
+        if (previous.pointerIds != current.pointerIds) {
+            return;
+        }
+        
+        const nsecs_t delta = current.eventTime - previous.eventTime;
+        if (delta < RESAMPLE_MIN_DELTA || delta > RESAMPLE_MAX_DELTA) {
+            return;
+        }
+        
+        const nsecs_t maxPredict = current.eventTime + std::min(delta / 2, RESAMPLE_MAX_PREDICTION);
+        if (sampleTime > maxPredict) {
+            sampleTime = maxPredict;
+        }
+        
+        alpha = float(current.eventTime - sampleTime) / delta;
+        otherCoords = previous.pointerCoords.data();
+    } else {
+        return;
+    }
+    
+    if (sampleTime <= current.eventTime) {
+        return;
+    }
+    
+    const size_t pointerCount = current.pointerIds.size();
+    m_lastResample.eventTime = sampleTime;
+    m_lastResample.pointerIds = current.pointerIds;
+    m_lastResample.pointerCoords.resize(pointerCount);
+    
+    for (size_t i = 0; i < pointerCount; i++) {
+        const MotionEvent::PointerCoords &currentCoords = current.pointerCoords[i];
+        m_lastResample.pointerCoords[i].x = currentCoords.x + alpha * (otherCoords[i].x - currentCoords.x);
+        m_lastResample.pointerCoords[i].y = currentCoords.y + alpha * (otherCoords[i].y - currentCoords.y);
+    }
+    
+    event.addSample(sampleTime, m_lastResample.pointerCoords.data());
+    m_hasLastResample = true;
+}
+
+ANDROID_END
@@ -0,0 +1,107 @@
+/*
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __Androidpp__InputConsumer__
+#define __Androidpp__InputConsumer__
+
+#include "AndroidMacros.h"
+
+#include "Android/view/MotionEvent.h"
+
+#include <deque>
+#include <vector>
+
+using namespace std;
+
+ANDROID_BEGIN
+
+/**
+ * Batches the moves reported by the platform so that they are delivered once
+ * per frame, as a single MotionEvent holding the moves as historical samples.
+ * The current sample of the batch is resampled to the frame time so that
+ * scrolling follows the finger smoothly whatever the touch sampling rate.
+ */
+class InputConsumer {
+public:
+    
+    // Latency added during resampling. A few milliseconds doesn't hurt much but
+    // reduces the impact of mispredicted touch positions.
+    static const nsecs_t RESAMPLE_LATENCY = 5 * 1000000LL;
+    
+    // Minimum time difference between consecutive samples before attempting to resample.
+    static const nsecs_t RESAMPLE_MIN_DELTA = 2 * 1000000LL;
+    
+    // Maximum time difference between consecutive samples before attempting to resample
+    // by extrapolation.
+    static const nsecs_t RESAMPLE_MAX_DELTA = 20 * 1000000LL;
+    
+    // Maximum time to predict forward from the last known state, to avoid predicting too
+    // far into the future.
+    static const nsecs_t RESAMPLE_MAX_PREDICTION = 8 * 1000000LL;
+    
+    /**
+     * Queues a move until the next frame.
+     */
+    void addMove(const MotionEvent &event);
+    
+    bool hasPendingBatch() const { return !m_batch.empty(); }
+    
+    /**
+     * Returns the time of the oldest move queued.
+     */
+    nsecs_t getPendingBatchTime() const { return m_batch.front().getEventTime(); }
+    
+    /**
+     * Merges the queued moves of the same pointers into outEvent. With a frame
+     * time, only the moves older than the frame time less RESAMPLE_LATENCY are
+     * taken and the last one is resampled to that time; with -1 every move is
+     * taken as is. Returns false if there was no move to take.
+     */
+    bool consumeBatch(nsecs_t frameTime, MotionEvent &outEvent);
+    
+    /**
+     * Forgets the moves delivered, once the pointers went down or up.
+     */
+    void reset();
+    
+private:
+    
+    struct Sample {
+        nsecs_t eventTime;
+        vector<int> pointerIds;
+        vector<MotionEvent::PointerCoords> pointerCoords;
+        
+        void set(const MotionEvent &event, size_t historicalIndex);
+        bool hasSamePointers(const MotionEvent &event) const;
+    };
+    
+    void addHistory(const MotionEvent &event, size_t historicalIndex);
+    const MotionEvent::PointerCoords *rewriteSample(const MotionEvent &sample);
+    void resample(nsecs_t sampleTime, MotionEvent &event, const MotionEvent *next);
+    
+    deque<MotionEvent> m_batch;
+    
+    // The last two samples delivered, the most recent first
+    Sample m_history[2];
+    int m_historySize = 0;
+    
+    // The last resampled sample delivered, so that older samples don't move the
+    // pointers back
+    Sample m_lastResample;
+    bool m_hasLastResample = false;
+};
+
+ANDROID_END
+
+#endif /* defined(__Androidpp__InputConsumer__) */
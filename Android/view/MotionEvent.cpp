@@ -14,23 +14,53 @@ MotionEvent::~MotionEvent() {
     
 }
 
+void MotionEvent::init(CCSet *touches, int32_t action, nsecs_t eventTime) {
+    
+    m_action = action;
+    m_pointerIds.clear();
+    m_sampleEventTimes.assign(1, eventTime);
+    m_samplePointerCoords.clear();
+    
+    for (auto it = touches->begin(); it != touches->end(); it++) {
+        
+        CCTouch *touch = (CCTouch *) (*it);
+        const CCPoint location = touch->getLocation();
+        
+        m_pointerIds.push_back(touch->getID());
+        m_samplePointerCoords.push_back({ location.x, location.y });
+    }
+}
+
+void MotionEvent::initialize(int32_t action, size_t pointerCount, const int *pointerIds,
+                             nsecs_t eventTime, const PointerCoords *pointerCoords) {
+    m_action = action;
+    m_pointerIds.assign(pointerIds, pointerIds + pointerCount);
+    m_sampleEventTimes.assign(1, eventTime);
+    m_samplePointerCoords.assign(pointerCoords, pointerCoords + pointerCount);
+}
+
+void MotionEvent::addSample(nsecs_t eventTime, const PointerCoords *pointerCoords) {
+    m_sampleEventTimes.push_back(eventTime);
+    m_samplePointerCoords.insert(m_samplePointerCoords.end(), pointerCoords, pointerCoords + m_pointerIds.size());
+}
+
 int MotionEvent::getX() const {
-    return getDefault()->getLocation().x;
+    return getCurrentPointerCoords(0).x;
 }
 
 int MotionEvent::getY() const {
-    return getDefault()->getLocation().y;
+    return getCurrentPointerCoords(0).y;
 }
 
 int MotionEvent::getPointerId() const {
     
     if (getPointerCount() == 0) return INVALID_POINTER_ID;
     
-    return getDefault()->getID();
+    return m_pointerIds[0];
 }
 
 int MotionEvent::getPointerId(int pointerIndex) const {
-    return getTouchAt(pointerIndex)->getID();
+    return m_pointerIds[pointerIndex];
 }
 
 int MotionEvent::getPointerIdBits() const {
@@ -44,46 +74,29 @@ int MotionEvent::getPointerIdBits() const {
 
 int MotionEvent::findPointerIndex(int pointerId) const {
     
-    int count = 0;
-    
-    for (auto it = m_touches->begin(); it != m_touches->end(); it++) {
-        
-        auto touch = dynamic_cast<CCTouch*>(*it);
-        
-        if(touch == nullptr)
-            return count;
-        
-        count++;
+    const int pointerCount = getPointerCount();
+    for (int i = 0; i < pointerCount; i++) {
+        if (m_pointerIds[i] == pointerId) {
+            return i;
+        }
     }
     
     return -1;
 }
 
 int MotionEvent::getX(int pointerIndex) const {
-    return getTouchAt(pointerIndex)->getLocation().x;
+    return getCurrentPointerCoords(pointerIndex).x;
 }
 
 int MotionEvent::getY(int pointerIndex) const {
-    return getTouchAt(pointerIndex)->getLocation().y;
-}
-
-CCTouch *MotionEvent::getDefault() const {
-    return (CCTouch *)( *m_touches->begin());
-}
-
-CCTouch *MotionEvent::getTouchAt(int index) const {
-    
-    if (getPointerCount() <= index) return NULL;
-    
-    auto it = m_touches->begin();
-    std::advance(it, index);
-    
-    return (CCTouch *) (*it);
+    return getCurrentPointerCoords(pointerIndex).y;
 }
 
 void MotionEvent::offsetLocation(float xOffset, float yOffset) {
-    CCTouch *touch = getTouchAt(0);
-    touch->setTouchInfo(touch->getID(), touch->getLocation().x + xOffset, touch->getLocation().y + yOffset);
+    for (size_t i = 0; i < m_samplePointerCoords.size(); i++) {
+        m_samplePointerCoords[i].x += xOffset;
+        m_samplePointerCoords[i].y += yOffset;
+    }
 }
 
-ANDROID_END
\ No newline at end of file
+ANDROID_END
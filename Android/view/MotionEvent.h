@@ -14,6 +14,8 @@
 
 #include <mindroid/os/Clock.h>
 
+#include <vector>
+
 /*
  * Maximum number of pointers supported per motion event.
  * Smallest number of pointers is 1.
@@ -30,6 +32,7 @@
 #define MAX_POINTER_ID 31
 
 using namespace cocos2d;
+using namespace std;
 
 ANDROID_BEGIN
 
@@ -149,10 +152,37 @@ public:
      */
     static const int ACTION_POINTER_INDEX_SHIFT = 8;
     
+    /**
+     * The coordinates of a pointer in a sample.
+     */
+    struct PointerCoords {
+        float x;
+        float y;
+    };
+    
     void init(CCSet *touches, int32_t action) {
-        m_touches = touches;
-        m_action = action;
-        m_eventTime = mindroid::Clock::monotonicTime();
+        init(touches, action, mindroid::Clock::monotonicTime());
+    }
+    
+    /**
+     * Takes the locations of the touches as the only sample of the event.
+     */
+    void init(CCSet *touches, int32_t action, nsecs_t eventTime);
+    
+    void initialize(int32_t action, size_t pointerCount, const int *pointerIds,
+                    nsecs_t eventTime, const PointerCoords *pointerCoords);
+    
+    /**
+     * Adds a sample of the same pointers, in the order of their indices. The
+     * current sample becomes the most recent historical one.
+     */
+    void addSample(nsecs_t eventTime, const PointerCoords *pointerCoords);
+    
+    /**
+     * Returns true if the other event has the same pointers at the same indices.
+     */
+    bool hasSamePointers(const MotionEvent &other) const {
+        return m_pointerIds == other.m_pointerIds;
     }
     
     int32_t getAction() const {
@@ -170,18 +200,55 @@ public:
     int getX() const;
     int getY() const;
     int getPointerCount() const {
-        return m_touches->count();
+        return m_pointerIds.size();
     }
     
     int getPointerId() const;
     int getPointerId(int pointerIndex) const;
+    const int *getPointerIds() const { return m_pointerIds.data(); }
     int getPointerIdBits() const;
     int findPointerIndex(int pointerId) const;
     int getX(int pointerIndex) const;
     int getY(int pointerIndex) const;
     void offsetLocation(float xOffset, float yOffset);
     
-    inline nsecs_t getEventTime() const { return m_eventTime; }
+    inline nsecs_t getEventTime() const { return m_sampleEventTimes.back(); }
+    
+    /**
+     * Returns the number of samples batched in this event before the current
+     * one, oldest first. Only moves have any.
+     */
+    size_t getHistorySize() const {
+        return m_sampleEventTimes.empty() ? 0 : m_sampleEventTimes.size() - 1;
+    }
+    
+    nsecs_t getHistoricalEventTime(size_t historicalIndex) const {
+        return m_sampleEventTimes[historicalIndex];
+    }
+    
+    float getHistoricalX(size_t historicalIndex) const {
+        return getHistoricalX(0, historicalIndex);
+    }
+    
+    float getHistoricalY(size_t historicalIndex) const {
+        return getHistoricalY(0, historicalIndex);
+    }
+    
+    float getHistoricalX(int pointerIndex, size_t historicalIndex) const {
+        return getHistoricalRawPointerCoords(historicalIndex)[pointerIndex].x;
+    }
+    
+    float getHistoricalY(int pointerIndex, size_t historicalIndex) const {
+        return getHistoricalRawPointerCoords(historicalIndex)[pointerIndex].y;
+    }
+    
+    /**
+     * Returns the coordinates of every pointer in a sample, getHistorySize()
+     * being the current one.
+     */
+    const PointerCoords *getHistoricalRawPointerCoords(size_t historicalIndex) const {
+        return &m_samplePointerCoords[historicalIndex * m_pointerIds.size()];
+    }
     
     void setAction(int action) {
         m_action = action;
@@ -190,11 +257,14 @@ public:
 private:
     
     int32_t m_action = 0;
-    CCSet *m_touches = NULL;
+    vector<int> m_pointerIds;
+    vector<nsecs_t> m_sampleEventTimes;
+    // The coordinates of each pointer, sample after sample
+    vector<PointerCoords> m_samplePointerCoords;
     
-    CCTouch *getDefault() const;
-    CCTouch *getTouchAt(int index) const;
-    nsecs_t m_eventTime = 0;
+    const PointerCoords &getCurrentPointerCoords(int pointerIndex) const {
+        return m_samplePointerCoords[m_samplePointerCoords.size() - m_pointerIds.size() + pointerIndex];
+    }
 };
 
 /*
@@ -364,11 +364,22 @@ void VelocityTracker::addMovement(const MotionEvent* event) {
     nsecs_t eventTime;
     Position positions[pointerCount];
     
+    size_t historySize = event->getHistorySize();
+    for (size_t h = 0; h < historySize; h++) {
+        eventTime = event->getHistoricalEventTime(h);
+        for (size_t i = 0; i < pointerCount; i++) {
+            int32_t index = pointerIndex[i];
+            positions[index].x = event->getHistoricalX(i, h);
+            positions[index].y = event->getHistoricalY(i, h);
+        }
+        addMovement(eventTime, idBits, positions);
+    }
+    
     eventTime = event->getEventTime();
     for (size_t i = 0; i < pointerCount; i++) {
         int32_t index = pointerIndex[i];
-        positions[index].x = event->getX(i);
-        positions[index].y = event->getY(i);
+        positions[index].x = event->getHistoricalX(i, historySize);
+        positions[index].y = event->getHistoricalY(i, historySize);
     }
     addMovement(eventTime, idBits, positions);
 }
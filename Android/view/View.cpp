@@ -24,6 +24,8 @@
 
 #include <ui/PixelFormat.h>
 
+#include <mindroid/util/Log.h>
+
 ANDROID_BEGIN
 
 const vector<int> View::PFLAG2_TEXT_DIRECTION_FLAGS = {
@@ -438,6 +440,8 @@ bool View::draw(shared_ptr<Canvas> canvas, ViewGroup* parent, uint64_t drawingTi
 void View::drawableStateChanged() {
     if (m_background != NULL && m_background->isStateful()) {
         m_background->setState(getDrawableState());
+        // The drawable of the new state may not have the same opacity
+        computeOpaqueFlags();
     }
 }
 
@@ -486,7 +490,7 @@ GLES20DisplayList *View::getDisplayList(GLES20DisplayList *displayList, bool isL
 
     if (!canHaveDisplayList()) {
 
-        CCLOG("cannot have displaylists(%s) %d", m_id.c_str(), (!mAttachInfo));
+        Log::v(VIEW_LOG_TAG, "cannot have displaylists(%s) %d", m_id.c_str(), (!mAttachInfo));
         
         return NULL;
     }
@@ -1155,6 +1159,11 @@ bool View::skipInvalidate() {
 void View::invalidateDrawable(shared_ptr<Drawable> who) {
     
     if (verifyDrawable(who)) {
+        // The background may have changed its color or its alpha
+        if (who == m_background) {
+            computeOpaqueFlags();
+        }
+        
         const Rect dirty = who->getBounds();
         const int scrollX = mScrollX;
         const int scrollY = mScrollY;
@@ -1253,7 +1262,7 @@ void View::measure(int widthMeasureSpec, int heightMeasureSpec) {
 
         bool skipCache = (mPrivateFlags & PFLAG_FORCE_LAYOUT) == PFLAG_FORCE_LAYOUT;
         
-        map<uint64_t, uint64_t>::iterator it = m_measureCache.find(key);
+        HashMap<uint64_t, uint64_t>::iterator it = m_measureCache.find(key);
         
         if (skipCache || it == m_measureCache.end()) {
             // measure ourselves, this should set the measured dimension flag back
@@ -1481,12 +1490,12 @@ void View::onFocusChanged(bool gainFocus, int direction, Rect *previouslyFocused
 }
 
 void View::onLayout(bool changed, int left, int top, int right, int bottom) {
-    CCLOG("onLayout(%s) %d, %d, %d, %d", m_id.c_str(), left, top, right, bottom);
+    Log::v(VIEW_LOG_TAG, "onLayout(%s) %d, %d, %d, %d", m_id.c_str(), left, top, right, bottom);
 }
 
 void View::onMeasure(int widthMeasureSpec, int heightMeasureSpec) {
 
-    CCLOG("onMeasure(%s)", m_id.c_str());
+    Log::v(VIEW_LOG_TAG, "onMeasure(%s)", m_id.c_str());
     
     setMeasuredDimension(getDefaultSize(getSuggestedMinimumWidth(), widthMeasureSpec),
                 getDefaultSize(getSuggestedMinimumHeight(), heightMeasureSpec));
@@ -2226,8 +2235,6 @@ void View::setBackgroundResource(string resid) {
 
 void View::setBackground(shared_ptr<Drawable> background) {
     
-    computeOpaqueFlags();
-    
     if (background == m_background) {
         return;
     }
@@ -2501,7 +2508,7 @@ void View::setLayoutParams(LayoutParams *params) {
 
 void View::setMeasuredDimension(int measuredWidth, int measuredHeight) {
     
-    CCLOG("MeasuredDimensions(%s) %d, %d", m_id.c_str(), measuredWidth, measuredHeight);
+    Log::v(VIEW_LOG_TAG, "MeasuredDimensions(%s) %d, %d", m_id.c_str(), measuredWidth, measuredHeight);
     
     m_measuredWidth = measuredWidth;
     m_measuredHeight = measuredHeight;
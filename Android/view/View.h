@@ -19,6 +19,7 @@
 #include "Android/graphics/Camera.h"
 #include "Android/graphics/Matrix.h"
 #include "Android/utils/AttributeSet.h"
+#include "Android/utils/HashMap.h"
 #include "Android/view/KeyEvent.h"
 #include "Android/view/ViewParent.h"
 #include "Android/view/ViewRootImpl.h"
@@ -84,6 +85,13 @@ private:
      */
     static const int FOCUSABLE_MASK = 0x00000001;
     
+protected:
+    
+    /**
+     * The logging tag used by this class with mindroid::Log.
+     */
+    static constexpr const char* VIEW_LOG_TAG = "View";
+    
 public:
     /**
      * Used to mark a View that has no ID.
@@ -2299,7 +2307,7 @@ private:
     bool m_lastIsOpaque = false;
     LayoutParams *mLayoutParams = NULL;
     Rect mLocalDirtyRect;
-    map<uint64_t, uint64_t> m_measureCache;
+    HashMap<uint64_t, uint64_t> m_measureCache;
     int m_minHeight = 0;
     int mMinimumFlingVelocity = 0;
     int mMaximumFlingVelocity = 0;
@@ -338,6 +338,10 @@ void ViewRootImpl::performTraversals() {
             hwInitialized = mAttachInfo->m_hardwareRenderer->initialize();
         }
 
+        if (hwInitialized) {
+            HardwareRenderer::configureCaches(mContext->getResources()->getDisplayMetrics());
+        }
+
         if (mAttachInfo->m_hardwareRenderer) {
             if (hwInitialized ||
                     m_width != mAttachInfo->m_hardwareRenderer->getWidth() ||
@@ -366,7 +370,8 @@ void ViewRootImpl::performDraw() {
     
     draw(fullRedrawNeeded);
     
-    m_isDirty = true;
+    // A render thread swaps the frame itself
+    m_isDirty = !HardwareRenderer::isThreaded();
     m_isDrawing = false;
 }
 
@@ -17,6 +17,9 @@
 #include "Android/view/VelocityTracker.h"
 #include "Android/widget/Filterable.h"
 
+#include <mindroid/os/Clock.h>
+#include <mindroid/os/Looper.h>
+
 #include <algorithm>
 #include <cmath>
 
@@ -29,6 +32,11 @@ AbsListView::AbsListView(Context *context) : AdapterView<ListAdapter>(context, N
     initializeScrollbars(NULL);
 }
 
+AbsListView::~AbsListView() {
+    Context::unregisterComponentCallbacks(this);
+    cancelPrefetch();
+}
+
 AbsListView::AbsListView(Context *context, AttributeSet *attrs) : AdapterView<ListAdapter>(context, attrs) {
 
     initAbsListView();
@@ -425,6 +433,14 @@ int AbsListView::getListPaddingRight() {
 }
 
 shared_ptr<View> AbsListView::obtainView(int position) {
+    if (!mDataChanged) {
+        shared_ptr<View> prefetchedView = mRecycler.getPrefetchedView(position);
+        if (prefetchedView != NULL) {
+            mPrefetchStats.hits++;
+            return prefetchedView;
+        }
+    }
+    
     shared_ptr<View> scrapView;
     
     scrapView = mRecycler.getScrapView(position);
@@ -653,11 +669,16 @@ void AbsListView::onAttachedToWindow() {
             treeObserver->addOnGlobalLayoutListener(this);
         }
     }
+    
+    Context::registerComponentCallbacks(this);
 }
 
 void AbsListView::onDetachedFromWindow() {
     AdapterView<ListAdapter>::onDetachedFromWindow();
     
+    Context::unregisterComponentCallbacks(this);
+    cancelPrefetch();
+    
     // Dismiss the popup in case onSaveInstanceState() was not invoked
     dismissPopup();
     
@@ -671,6 +692,13 @@ void AbsListView::onDetachedFromWindow() {
     }
 }
 
+void AbsListView::onTrimMemory(int level) {
+    if (level >= TRIM_MEMORY_UI_HIDDEN || level == TRIM_MEMORY_RUNNING_CRITICAL) {
+        cancelPrefetch();
+        mRecycler.clear();
+    }
+}
+
 void AbsListView::onWindowFocusChanged(bool hasWindowFocus) {
     AdapterView<ListAdapter>::onWindowFocusChanged(hasWindowFocus);
     
@@ -1274,6 +1302,10 @@ void AbsListView::addTouchables(vector<shared_ptr<View>> &views) {
 }
 
 void AbsListView::reportScrollStateChange(int newState) {
+    if (newState != OnScrollListener::SCROLL_STATE_IDLE) {
+        schedulePrefetch();
+    }
+    
     if (newState != mLastScrollState) {
         if (mOnScrollListener != NULL) {
             mOnScrollListener->onScrollStateChanged(this, newState);
@@ -1288,6 +1320,7 @@ AbsListView::FlingRunnable::FlingRunnable(AbsListView *absListView) {
 }
 
 void AbsListView::FlingRunnable::start(int initialVelocity) {
+    mAbsListView->mPrefetchDirection = initialVelocity > 0 ? 1 : -1;
     int initialY = initialVelocity < 0 ? INT_MAX : 0;
     mLastFlingY = initialY;
 //    mScroller.fling(0, initialY, 0, initialVelocity,
@@ -1635,6 +1668,8 @@ bool AbsListView::resurrectSelection() {
 }
 
 void AbsListView::handleDataChanged() {
+    mPrefetchStats.wasted += mRecycler.prunePrefetchedViews(0, -1);
+    
     int count = mItemCount;
     if (count > 0) {
         
@@ -2125,6 +2160,111 @@ bool AbsListView::checkScrap(vector<shared_ptr<View>> scrap) {
 void AbsListView::setRecyclerListener(RecyclerListener *listener) {
     mRecycler.mRecyclerListener = listener;
 }
+
+void AbsListView::setPrefetchItemCount(int count) {
+    mPrefetchItemCount = max(count, 0);
+}
+
+void AbsListView::schedulePrefetch() {
+    if (mPrefetchItemCount <= 0) {
+        return;
+    }
+    
+    Looper *looper = Looper::myLooper();
+    if (looper == NULL) {
+        return;
+    }
+    
+    if (mPrefetchIdleHandler == NULL) {
+        mPrefetchIdleHandler = new PrefetchIdleHandler(this);
+    }
+    looper->myMessageQueue()->addIdleHandler(mPrefetchIdleHandler);
+}
+
+void AbsListView::cancelPrefetch() {
+    if (mPrefetchIdleHandler != NULL) {
+        mPrefetchIdleHandler->detach();
+        Looper *looper = Looper::myLooper();
+        if (looper != NULL) {
+            looper->myMessageQueue()->removeIdleHandler(mPrefetchIdleHandler);
+        }
+        mPrefetchIdleHandler = NULL;
+    }
+    mPrefetchStats.wasted += mRecycler.prunePrefetchedViews(0, -1);
+}
+
+bool AbsListView::prefetch(uint64_t deadline) {
+    if (mTouchMode != TOUCH_MODE_SCROLL && mTouchMode != TOUCH_MODE_FLING) {
+        // The list came to rest, keep what was bound for the next scroll
+        return false;
+    }
+    
+    const int childCount = getChildCount();
+    if (mAdapter == NULL || mDataChanged || mItemCount == 0 || childCount == 0) {
+        return true;
+    }
+    
+    if (mVelocityTracker != NULL) {
+        mVelocityTracker->computeCurrentVelocity(1000, mMaximumVelocity);
+        const float velocityY = mVelocityTracker->getYVelocity();
+        if (velocityY != 0) {
+            // A finger moving up scrolls towards higher positions
+            mPrefetchDirection = velocityY < 0 ? 1 : -1;
+        }
+    }
+    if (mPrefetchDirection == 0) {
+        return true;
+    }
+    
+    int first;
+    int last;
+    if (mPrefetchDirection > 0) {
+        first = mFirstPosition + childCount;
+        last = min(first + mPrefetchItemCount, mItemCount) - 1;
+    } else {
+        last = mFirstPosition - 1;
+        first = max(last - mPrefetchItemCount + 1, 0);
+    }
+    mPrefetchStats.wasted += mRecycler.prunePrefetchedViews(first, last);
+    
+    for (int i = 0; i <= last - first; i++) {
+        const int position = mPrefetchDirection > 0 ? first + i : last - i;
+        if (mRecycler.hasPrefetchedView(position)) {
+            continue;
+        }
+        
+        // Headers, footers and ignored views are never recycled
+        if (!mRecycler.shouldRecycleViewType(mAdapter->getItemViewType(position))) {
+            continue;
+        }
+        
+        const uint64_t start = Clock::monotonicTime();
+        if (start + mPrefetchBindTime > deadline) {
+            break;
+        }
+        
+        shared_ptr<View> scrapView = mRecycler.getScrapView(position);
+        shared_ptr<View> child = mAdapter->getView(position, scrapView, this);
+        
+        const uint64_t bindTime = Clock::monotonicTime() - start;
+        mPrefetchBindTime = mPrefetchBindTime == 0 ? bindTime : (3 * mPrefetchBindTime + bindTime) / 4;
+        mPrefetchStats.bindTime += bindTime;
+        
+        if (scrapView != NULL && child != scrapView) {
+            mRecycler.addScrapView(scrapView);
+        }
+        if (child == NULL) {
+            continue;
+        }
+        if (mCacheColorHint != 0) {
+            child->setDrawingCacheBackgroundColor(mCacheColorHint);
+        }
+        mRecycler.addPrefetchedView(position, child, child == scrapView);
+        mPrefetchStats.prefetched++;
+    }
+    
+    return true;
+}
     
 AbsListView::ListViewLayoutParams::ListViewLayoutParams(Context *c, AttributeSet *attrs) :LayoutParams(c, attrs) {
 }
@@ -2158,6 +2298,9 @@ bool AbsListView::RecycleBin::shouldRecycleViewType(int viewType) {
 }
     
 void AbsListView::RecycleBin::clear() {
+    mAbsListView->mPrefetchStats.wasted += mPrefetchedViews.size();
+    mPrefetchedViews.clear();
+    
     if (mViewTypeCount == 1) {
         vector<shared_ptr<View>> &scrap = mCurrentScrap;
         const int scrapCount = scrap.size();
@@ -2299,6 +2442,51 @@ void AbsListView::RecycleBin::scrapActiveViews() {
     pruneScrapViews();
 }
 
+void AbsListView::RecycleBin::addPrefetchedView(int position, shared_ptr<View> view, bool fromScrap) {
+    PrefetchedView prefetchedView;
+    prefetchedView.position = position;
+    prefetchedView.view = view;
+    prefetchedView.fromScrap = fromScrap;
+    mPrefetchedViews.push_back(prefetchedView);
+}
+
+bool AbsListView::RecycleBin::hasPrefetchedView(int position) {
+    for (int i = 0; i < mPrefetchedViews.size(); i++) {
+        if (mPrefetchedViews[i].position == position) {
+            return true;
+        }
+    }
+    return false;
+}
+
+shared_ptr<View> AbsListView::RecycleBin::getPrefetchedView(int position) {
+    for (int i = 0; i < mPrefetchedViews.size(); i++) {
+        if (mPrefetchedViews[i].position == position) {
+            shared_ptr<View> view = mPrefetchedViews[i].view;
+            mPrefetchedViews.erase(mPrefetchedViews.begin() + i);
+            return view;
+        }
+    }
+    return NULL;
+}
+
+int AbsListView::RecycleBin::prunePrefetchedViews(int first, int last) {
+    int dropped = 0;
+    for (int i = mPrefetchedViews.size() - 1; i >= 0; i--) {
+        const PrefetchedView &prefetchedView = mPrefetchedViews[i];
+        if (prefetchedView.position >= first && prefetchedView.position <= last) {
+            continue;
+        }
+        if (prefetchedView.fromScrap) {
+            // Still a perfectly good convert view
+            addScrapView(prefetchedView.view);
+        }
+        mPrefetchedViews.erase(mPrefetchedViews.begin() + i);
+        dropped++;
+    }
+    return dropped;
+}
+
 void AbsListView::RecycleBin::pruneScrapViews() {
     const int maxViews = mActiveViews.size();
     const int viewTypeCount = mViewTypeCount;
@@ -11,6 +11,7 @@
 
 #include "AndroidMacros.h"
 
+#include "Android/content/ComponentCallbacks2.h"
 #include "Android/graphics/Rect.h"
 #include "Android/graphics/drawable/Drawable.h"
 #include "Android/text/TextWatcher.h"
@@ -20,6 +21,7 @@
 #include "Android/widget/Filter.h"
 #include "Android/widget/ListAdapter.h"
 
+#include <mindroid/os/MessageQueue.h>
 #include <mindroid/os/Runnable.h>
 #include <mindroid/os/Ref.h>
 
@@ -58,7 +60,7 @@ class VelocityTracker;
  */
 class AbsListView : public AdapterView<ListAdapter>, public TextWatcher,
 public ViewTreeObserver::OnGlobalLayoutListener, Filter::FilterListener,
-public ViewTreeObserver::OnTouchModeChangeListener {
+public ViewTreeObserver::OnTouchModeChangeListener, public ComponentCallbacks2 {
     
 public:
     
@@ -75,6 +77,7 @@ private:
     class CheckForKeyLongPress;
     class CheckForTap;
     class FlingRunnable;
+    class PrefetchIdleHandler;
     
 public:
     
@@ -308,6 +311,26 @@ private:
      * Handles one frame of a fling
      */
     FlingRunnable *mFlingRunnable = NULL;
+    
+    /**
+     * Binds upcoming rows with the time left over at the end of a frame
+     */
+    sp<PrefetchIdleHandler> mPrefetchIdleHandler;
+    
+    /**
+     * Number of rows to bind ahead of the scroll direction
+     */
+    int mPrefetchItemCount = 2;
+    
+    /**
+     * 1 if the list moves towards higher positions, -1 if it moves towards lower positions
+     */
+    int mPrefetchDirection = 0;
+    
+    /**
+     * Moving average of the time spent in getView() while prefetching (nanoseconds)
+     */
+    uint64_t mPrefetchBindTime = 0;
 
 protected:
     /**
@@ -512,6 +535,8 @@ public:
     
     AbsListView(Context *context, AttributeSet *attrs);
     
+    virtual ~AbsListView();
+    
 private:
     
     void initAbsListView();
@@ -1029,6 +1054,14 @@ protected:
     
 public:
     
+    /**
+     * Drops the recycled and prefetched views once the list is no longer
+     * visible or memory runs critically low. They are inflated again as
+     * the list scrolls.
+     */
+    virtual void onTrimMemory(int level);
+    
+    
     virtual void onWindowFocusChanged(bool hasWindowFocus);
     
 protected:
@@ -1280,6 +1313,40 @@ private:
         void run();
     };
     
+    /**
+     * Registered with the UI thread's message queue while the list scrolls.
+     */
+    class PrefetchIdleHandler : public MessageQueue::IdleHandler {
+        
+    private:
+        
+        AbsListView *mAbsListView = NULL;
+        
+    public:
+        
+        PrefetchIdleHandler(AbsListView *absListView) {
+            mAbsListView = absListView;
+        }
+        
+        void detach() {
+            mAbsListView = NULL;
+        }
+        
+        virtual bool queueIdle(uint64_t deadline) {
+            return mAbsListView != NULL && mAbsListView->prefetch(deadline);
+        }
+    };
+    
+    void schedulePrefetch();
+    
+    void cancelPrefetch();
+    
+    /**
+     * Binds the next rows in the scroll direction until the deadline. Returns
+     * false once the list has stopped moving.
+     */
+    bool prefetch(uint64_t deadline);
+    
     void createScrollingCache();
     
     void clearScrollingCache();
@@ -1547,6 +1614,40 @@ public:
      */
     void setRecyclerListener(RecyclerListener *listener);
     
+    /**
+     * Counters of the idle-time row prefetcher.
+     */
+    struct PrefetchStats {
+        /** Rows bound ahead of time */
+        int prefetched = 0;
+        /** Prefetched rows that were picked up by a layout */
+        int hits = 0;
+        /** Prefetched rows that were dropped before being used */
+        int wasted = 0;
+        /** Time spent in getView() while prefetching (nanoseconds) */
+        uint64_t bindTime = 0;
+    };
+    
+    /**
+     * Sets how many rows ahead of the scroll direction are bound while the UI
+     * thread is idle at the end of a frame. 0 disables prefetching.
+     */
+    void setPrefetchItemCount(int count);
+    
+    int getPrefetchItemCount() {
+        return mPrefetchItemCount;
+    }
+    
+    const PrefetchStats &getPrefetchStats() {
+        return mPrefetchStats;
+    }
+    
+private:
+    
+    PrefetchStats mPrefetchStats;
+    
+public:
+    
     /**
      * AbsListView extends LayoutParams to provide a place to hold the view type.
      */
@@ -1647,6 +1748,17 @@ public:
         
         vector<shared_ptr<View>> mCurrentScrap;
         
+        struct PrefetchedView {
+            int position;
+            shared_ptr<View> view;
+            bool fromScrap;
+        };
+        
+        /**
+         * Views bound ahead of time by the prefetcher for a specific position.
+         */
+        vector<PrefetchedView> mPrefetchedViews;
+        
     public:
         
         RecycleBin(AbsListView *absListView) {
@@ -1699,6 +1811,21 @@ public:
          */
         virtual void scrapActiveViews();
         
+        void addPrefetchedView(int position, shared_ptr<View> view, bool fromScrap);
+        
+        bool hasPrefetchedView(int position);
+        
+        /**
+         * Returns the view prefetched for the position and removes it, or null.
+         */
+        shared_ptr<View> getPrefetchedView(int position);
+        
+        /**
+         * Drops the prefetched views outside of [first, last]. Views that came from the scrap
+         * heap go back to it. Returns the number of dropped views.
+         */
+        int prunePrefetchedViews(int first, int last);
+        
     private:
         
         /**
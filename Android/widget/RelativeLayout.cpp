@@ -20,8 +20,6 @@
 
 ANDROID_BEGIN
 
-vector<RelativeLayout::Node*> RelativeLayout::Node::sPool(100);
-
 const int RelativeLayout::RULES_VERTICAL[] = {
     RelativeLayoutParams::ABOVE, RelativeLayoutParams::BELOW, RelativeLayoutParams::ALIGN_BASELINE, RelativeLayoutParams::ALIGN_TOP, RelativeLayoutParams::ALIGN_BOTTOM
 };
@@ -144,17 +142,13 @@ void RelativeLayout::requestLayout() {
 }
 
 void RelativeLayout::sortChildren() {
+    // The sorted lists stay valid until a child, an id or a rule changes
+    if (!m_graph.update(this)) return;
+    
     int count = getChildCount();
     if (m_sortedVerticalChildren.size() != count) m_sortedVerticalChildren.resize(count);
     if (m_sortedHorizontalChildren.size() != count) m_sortedHorizontalChildren.resize(count);
     
-    m_graph.clear();
-    
-    for (int i = 0; i < count; i++) {
-        shared_ptr<View> child = getChildAt(i);
-        m_graph.add(child);
-    }
-    
     m_graph.getSortedViews(m_sortedVerticalChildren, RULES_VERTICAL, 5);
     m_graph.getSortedViews(m_sortedHorizontalChildren, RULES_HORIZONTAL, 8);
 }
@@ -236,7 +230,7 @@ void RelativeLayout::onMeasure(int widthMeasureSpec, int heightMeasureSpec) {
         shared_ptr<View> child = *it;
         if (child != NULL && child->getVisibility() != GONE) {
             RelativeLayoutParams *params = (RelativeLayoutParams*) child->getLayoutParams();
-            vector<int64_t> rules = params->getRules(layoutDirection);
+            const vector<int64_t> &rules = params->getRules(layoutDirection);
             
             applyHorizontalSizeRules(params, myWidth, rules);
             measureChildHorizontal(child, params, myWidth, myHeight);
@@ -323,7 +317,7 @@ void RelativeLayout::onMeasure(int widthMeasureSpec, int heightMeasureSpec) {
                 shared_ptr<View> child = getChildAt(i);
                 if (child->getVisibility() != GONE) {
                     RelativeLayoutParams *params = static_cast<RelativeLayoutParams*>(child->getLayoutParams());
-                    vector<int64_t> rules = params->getRules(layoutDirection);
+                    const vector<int64_t> &rules = params->getRules(layoutDirection);
                     if (rules[RelativeLayoutParams::CENTER_IN_PARENT] != 0 || rules[RelativeLayoutParams::CENTER_HORIZONTAL] != 0) {
                         centerHorizontal(child, params, width);
                     } else if (rules[RelativeLayoutParams::ALIGN_PARENT_RIGHT] != 0) {
@@ -353,7 +347,7 @@ void RelativeLayout::onMeasure(int widthMeasureSpec, int heightMeasureSpec) {
                 shared_ptr<View> child = getChildAt(i);
                 if (child->getVisibility() != GONE) {
                     RelativeLayoutParams *params = (RelativeLayoutParams*) child->getLayoutParams();
-                    vector<int64_t> rules = params->getRules(layoutDirection);
+                    const vector<int64_t> &rules = params->getRules(layoutDirection);
                     if (rules[RelativeLayoutParams::CENTER_IN_PARENT] != 0 || rules[RelativeLayoutParams::CENTER_VERTICAL] != 0) {
                         centerVertical(child, params, height);
                     } else if (rules[RelativeLayoutParams::ALIGN_PARENT_BOTTOM] != 0) {
@@ -414,7 +408,7 @@ void RelativeLayout::onMeasure(int widthMeasureSpec, int heightMeasureSpec) {
 
 void RelativeLayout::alignBaseline(shared_ptr<View> child, RelativeLayoutParams *params) {
     const int layoutDirection = getLayoutDirection();
-    vector<int64_t> rules = params->getRules(layoutDirection);
+    const vector<int64_t> &rules = params->getRules(layoutDirection);
     int anchorBaseline = getRelatedViewBaseline(rules, RelativeLayoutParams::ALIGN_BASELINE);
     
     if (anchorBaseline != -1) {
@@ -588,7 +582,7 @@ bool RelativeLayout::positionChildHorizontal(shared_ptr<View> child, RelativeLay
                                         bool wrapContent) {
     
     const int layoutDirection = getLayoutDirection();
-    vector<int64_t> rules = params->getRules(layoutDirection);
+    const vector<int64_t> &rules = params->getRules(layoutDirection);
     
     if (params->mLeft < 0 && params->mRight >= 0) {
         // Right is fixed, but left varies
@@ -624,7 +618,7 @@ bool RelativeLayout::positionChildHorizontal(shared_ptr<View> child, RelativeLay
 bool RelativeLayout::positionChildVertical(shared_ptr<View> child, RelativeLayoutParams *params, int myHeight,
                                       bool wrapContent) {
     
-    vector<int64_t> rules = params->getRules();
+    const vector<int64_t> &rules = params->getRules();
     
     if (params->mTop < 0 && params->mBottom >= 0) {
         // Bottom is fixed, but top varies
@@ -650,7 +644,7 @@ bool RelativeLayout::positionChildVertical(shared_ptr<View> child, RelativeLayou
     return rules[RelativeLayoutParams::ALIGN_PARENT_BOTTOM] != 0;
 }
 
-void RelativeLayout::applyHorizontalSizeRules(RelativeLayoutParams *childParams, int myWidth, vector<int64_t> rules) {
+void RelativeLayout::applyHorizontalSizeRules(RelativeLayoutParams *childParams, int myWidth, const vector<int64_t> &rules) {
     RelativeLayoutParams *anchorParams = NULL;
     
     // -1 indicated a "soft requirement" in that direction. For example:
@@ -712,7 +706,7 @@ void RelativeLayout::applyHorizontalSizeRules(RelativeLayoutParams *childParams,
 }
 
 void RelativeLayout::applyVerticalSizeRules(RelativeLayoutParams *childParams, int myHeight) {
-    vector<int64_t> rules = childParams->getRules();
+    const vector<int64_t> &rules = childParams->getRules();
     RelativeLayoutParams *anchorParams = NULL;
     
     childParams->mTop = -1;
@@ -773,20 +767,17 @@ void RelativeLayout::applyVerticalSizeRules(RelativeLayoutParams *childParams, i
     }
 }
 
-shared_ptr<View> RelativeLayout::getRelatedView(vector<int64_t> rules, int relation) {
+shared_ptr<View> RelativeLayout::getRelatedView(const vector<int64_t> &rules, int relation) {
     int64_t id = rules[relation];
     if (id != 0) {
-        Node *node = m_graph.m_keyNodes[id];
-        if (node == NULL) return NULL;
-        shared_ptr<View> v = node->view;
+        shared_ptr<View> v = m_graph.findView(id);
+        if (v == NULL) return NULL;
         
         // Find the first non-GONE view up the chain
         while (v->getVisibility() == View::GONE) {
             RelativeLayoutParams *lp = (RelativeLayoutParams*) v->getLayoutParams();
-            rules = lp->getRules(v->getLayoutDirection());
-            node = m_graph.m_keyNodes[(rules[relation])];
-            if (node == NULL) return NULL;
-            v = node->view;
+            v = m_graph.findView(lp->getRules(v->getLayoutDirection())[relation]);
+            if (v == NULL) return NULL;
         }
         
         return v;
@@ -795,7 +786,7 @@ shared_ptr<View> RelativeLayout::getRelatedView(vector<int64_t> rules, int relat
     return NULL;
 }
 
-RelativeLayoutParams *RelativeLayout::getRelatedViewParams(vector<int64_t> rules, int relation) {
+RelativeLayoutParams *RelativeLayout::getRelatedViewParams(const vector<int64_t> &rules, int relation) {
     shared_ptr<View> v = getRelatedView(rules, relation);
     if (v != NULL) {
         RelativeLayoutParams* params = (RelativeLayoutParams*) v->getLayoutParams();
@@ -806,7 +797,7 @@ RelativeLayoutParams *RelativeLayout::getRelatedViewParams(vector<int64_t> rules
     return NULL;
 }
 
-int RelativeLayout::getRelatedViewBaseline(vector<int64_t> rules, int relation) {
+int RelativeLayout::getRelatedViewBaseline(const vector<int64_t> &rules, int relation) {
     shared_ptr<View> v = getRelatedView(rules, relation);
     if (v != NULL) {
         return v->getBaseline();
@@ -869,4 +860,128 @@ bool RelativeLayout::checkLayoutParams(LayoutParams *p) {
     return dynamic_cast<RelativeLayoutParams*>(p) != 0;
 }
 
+int64_t RelativeLayout::DependencyGraph::getKey(const shared_ptr<View> &view) {
+    return view->getId() != View::NO_ID ? (int64_t) hash<string>()(view->getId()) : 0;
+}
+
+bool RelativeLayout::DependencyGraph::update(ViewGroup *parent) {
+    const int count = parent->getChildCount();
+    const int verbs = RelativeLayoutParams::VERB_COUNT;
+    
+    bool changed = count != m_views.size();
+    for (int i = 0; i < count && !changed; i++) {
+        shared_ptr<View> child = parent->getChildAt(i);
+        const vector<int64_t> &rules = ((RelativeLayoutParams*) child->getLayoutParams())->getRules();
+        changed = child != m_views[i] || getKey(child) != m_keys[i] ||
+                !equal(rules.begin(), rules.end(), m_rules.begin() + i * verbs);
+    }
+    
+    if (!changed) return false;
+    
+    m_views.resize(count);
+    m_keys.resize(count);
+    m_rules.assign(count * verbs, 0);
+    m_keyIndices.clear();
+    m_keyIndices.reserve(count);
+    
+    for (int i = 0; i < count; i++) {
+        shared_ptr<View> child = parent->getChildAt(i);
+        const vector<int64_t> &rules = ((RelativeLayoutParams*) child->getLayoutParams())->getRules();
+        
+        m_views[i] = child;
+        m_keys[i] = getKey(child);
+        copy(rules.begin(), rules.end(), m_rules.begin() + i * verbs);
+        
+        if (m_keys[i] != 0) {
+            m_keyIndices[m_keys[i]] = i;
+        }
+    }
+    
+    return true;
+}
+
+shared_ptr<View> RelativeLayout::DependencyGraph::findView(int64_t key) const {
+    HashMap<int64_t, int>::const_iterator it = m_keyIndices.find(key);
+    return it != m_keyIndices.end() ? m_views[it->second] : NULL;
+}
+
+/**
+ * Returns the position of the node the specified node depends on through
+ * a rule, -1 for no, unknown or self dependencies.
+ */
+int RelativeLayout::DependencyGraph::getDependency(int node, int rule) const {
+    const int64_t key = m_rules[node * RelativeLayoutParams::VERB_COUNT + rule];
+    if (key == 0) return -1;
+    
+    HashMap<int64_t, int>::const_iterator it = m_keyIndices.find(key);
+    if (it == m_keyIndices.end() || it->second == node) return -1;
+    
+    return it->second;
+}
+
+void RelativeLayout::DependencyGraph::getSortedViews(vector<shared_ptr<View>> &sorted, const int rulesFilter[], int rulesCount) {
+    const int count = m_views.size();
+    
+    m_dependencyCounts.assign(count, 0);
+    m_dependentOffsets.assign(count + 1, 0);
+    m_edges.resize(count * rulesCount);
+    
+    // Look only the the rules passed in parameter, this way we build only the
+    // dependencies for a specific set of rules
+    for (int i = 0; i < count; i++) {
+        for (int j = 0; j < rulesCount; j++) {
+            const int dependency = getDependency(i, rulesFilter[j]);
+            m_edges[i * rulesCount + j] = dependency;
+            if (dependency >= 0) {
+                m_dependencyCounts[i]++;
+                m_dependentOffsets[dependency]++;
+            }
+        }
+    }
+    
+    // Lays out the dependents of each node one after the other: the offsets
+    // first hold the end of each run and are moved back to its start as the
+    // runs are filled from the last node to the first one
+    for (int i = 1; i <= count; i++) {
+        m_dependentOffsets[i] += m_dependentOffsets[i - 1];
+    }
+    m_dependents.resize(m_dependentOffsets[count]);
+    
+    for (int i = count - 1; i >= 0; i--) {
+        for (int j = rulesCount - 1; j >= 0; j--) {
+            const int dependency = m_edges[i * rulesCount + j];
+            if (dependency >= 0) {
+                m_dependents[--m_dependentOffsets[dependency]] = i;
+            }
+        }
+    }
+    
+    // Finds all the roots in the graph: all nodes with no dependencies
+    m_roots.clear();
+    for (int i = 0; i < count; i++) {
+        if (m_dependencyCounts[i] == 0) m_roots.push_back(i);
+    }
+    
+    int index = 0;
+    
+    while (!m_roots.empty()) {
+        const int node = m_roots.back();
+        m_roots.pop_back();
+        
+        sorted[index++] = m_views[node];
+        
+        for (int k = m_dependentOffsets[node]; k < m_dependentOffsets[node + 1]; k++) {
+            const int dependent = m_dependents[k];
+            if (--m_dependencyCounts[dependent] == 0) {
+                m_roots.push_back(dependent);
+            }
+        }
+    }
+    
+    if (index < count) {
+        CCLOG("Circular dependencies cannot exist in RelativeLayout");
+        fill(sorted.begin() + index, sorted.end(), shared_ptr<View>());
+    }
+}
+
 ANDROID_END
\ No newline at end of file
@@ -191,13 +191,19 @@ public:
         m_rules = m_initialRules = rules;
     }
     
-    RelativeLayoutParams(int width, int height) : MarginLayoutParams(width, height) {
+    RelativeLayoutParams(int width, int height) : MarginLayoutParams(width, height),
+        m_rules(VERB_COUNT),
+        m_initialRules(VERB_COUNT) {
     }
     
-    RelativeLayoutParams(LayoutParams *p) : MarginLayoutParams(p) {
+    RelativeLayoutParams(LayoutParams *p) : MarginLayoutParams(p),
+        m_rules(VERB_COUNT),
+        m_initialRules(VERB_COUNT) {
     }
     
-    RelativeLayoutParams(MarginLayoutParams *source) : MarginLayoutParams(source) {
+    RelativeLayoutParams(MarginLayoutParams *source) : MarginLayoutParams(source),
+        m_rules(VERB_COUNT),
+        m_initialRules(VERB_COUNT) {
     }
     
     virtual ~RelativeLayoutParams() {}
@@ -215,7 +221,7 @@ public:
     bool m_rulesChanged = false;
     bool m_isRtlCompatibilityMode = false;
     
-    vector<int64_t> getRules(int layoutDirection) {
+    const vector<int64_t> &getRules(int layoutDirection) {
         if (hasRelativeRules() &&
             (m_rulesChanged || layoutDirection != getLayoutDirection())) {
             resolveRules(layoutDirection);
@@ -226,7 +232,7 @@ public:
         return m_rules;
     }
     
-    vector<int64_t> getRules() {
+    const vector<int64_t> &getRules() {
         return m_rules;
     }
     
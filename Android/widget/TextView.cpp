@@ -16,8 +16,10 @@
 #include "Android/graphics/Typeface.h"
 #include "Android/internal/R.h"
 #include "Android/text/Directions.h"
+#include "Android/text/DynamicLayout.h"
 #include "Android/text/InputFilter.h"
 #include "Android/text/InputType.h"
+#include "Android/text/PrecomputedText.h"
 #include "Android/text/Selection.h"
 #include "Android/text/SpannableString.h"
 #include "Android/text/SpannedString.h"
@@ -2031,6 +2033,21 @@ void TextView::setText(shared_ptr<CharSequence> text) {
     setText(text, mBufferType);
 }
 
+void TextView::setText(shared_ptr<PrecomputedText> text) {
+    mPrecomputed = text;
+    setText(text->getText());
+}
+
+PrecomputedText::Params TextView::getTextMetricsParams() {
+    if (mTextDir == NULL) {
+        mTextDir = getTextDirectionHeuristic();
+    }
+    
+    return PrecomputedText::Params(mTextPaint, mLayout != NULL ? mLayout->getWidth() : -1,
+                                   getLayoutAlignment(), mTextDir,
+                                   mSpacingMult, mSpacingAdd, mIncludePad);
+}
+
 void TextView::setText(shared_ptr<CharSequence> text, BufferType type) {
     setText(text, type, true, 0);
     
@@ -2133,6 +2150,13 @@ void TextView::setText(shared_ptr<CharSequence> text, BufferType type,
         mTransformed = mTransformation->getTransformation(text, this);
     }
     
+    // Only keep precomputed measurements for exactly the text they were made
+    // for. Filters, transformations and spannable buffers all replace it.
+    if (mPrecomputed != NULL &&
+        (mPrecomputed->getText() != mTransformed || mTextSpannable != NULL)) {
+        mPrecomputed = NULL;
+    }
+    
     const int textLength = text->length();
     
     shared_ptr<Spannable> sp = dynamic_pointer_cast<Spannable>(text);
@@ -3718,15 +3742,29 @@ shared_ptr<Layout> TextView::makeSingleLayout(int wantWidth, shared_ptr<BoringLa
     shared_ptr<Layout> result;
     
     if (mTextSpannable != NULL) {
-//        result = make_shared<DynamicLayout>(mText, mTransformed, mTextPaint, wantWidth,
-//                                   alignment, mTextDir, mSpacingMult,
-//                                   mSpacingAdd, mIncludePad, getKeyListener() == NULL ? effectiveEllipsize : NULL,
-//                                   ellipsisWidth);
+        result = make_shared<DynamicLayout>(mText, mTransformed, mTextPaint, wantWidth,
+                                   alignment, mTextDir, mSpacingMult,
+                                   mSpacingAdd, mIncludePad, getKeyListener() == NULL ? effectiveEllipsize : NULL,
+                                   ellipsisWidth);
     } else {
+        if (mPrecomputed != NULL && effectiveEllipsize == NULL &&
+            mPrecomputed->getParams().isLayoutCompatible(mTextPaint, wantWidth, alignment, mTextDir,
+                                                         mSpacingMult, mSpacingAdd, mIncludePad)) {
+            result = mPrecomputed->takeLayout(mTextPaint);
+            if (result != NULL) {
+                return result;
+            }
+        }
+        
         if (boring == UNKNOWN_BORING) {
-            boring = BoringLayout::isBoring(mTransformed, mTextPaint, mTextDir, mBoring);
-            if (boring != NULL) {
-                mBoring = boring;
+            if (mPrecomputed != NULL &&
+                mPrecomputed->getParams().isMeasureCompatible(mTextPaint, mTextDir)) {
+                boring = mPrecomputed->getBoring();
+            } else {
+                boring = BoringLayout::isBoring(mTransformed, mTextPaint, mTextDir, mBoring);
+                if (boring != NULL) {
+                    mBoring = boring;
+                }
             }
         }
         
@@ -3870,7 +3908,13 @@ void TextView::onMeasure(int widthMeasureSpec, int heightMeasureSpec) {
             des = desired(mLayout);
         }
         
-        if (des < 0) {
+        if (des < 0 && mPrecomputed != NULL &&
+            mPrecomputed->getParams().isMeasureCompatible(mTextPaint, mTextDir)) {
+            boring = mPrecomputed->getBoring();
+            if (boring == NULL) {
+                des = mPrecomputed->getDesiredWidth();
+            }
+        } else if (des < 0) {
             boring = BoringLayout::isBoring(mTransformed, mTextPaint, mTextDir, mBoring);
             if (boring != NULL) {
                 mBoring = boring;
@@ -4753,7 +4797,7 @@ void TextView::updateAfterEdit() {
 void TextView::handleTextChanged(shared_ptr<CharSequence> buffer, int start, int before, int after) {
 //    const Editor.InputMethodState ims = mEditor == NULL ? NULL : mEditor.mInputMethodState;
 //    if (ims == NULL || ims.mBatchEditNesting == 0) {
-//        updateAfterEdit();
+        updateAfterEdit();
 //    }
 //    if (ims != NULL) {
 //        ims.mContentChanged = true;
@@ -20,6 +20,7 @@
 #include "Android/text/GetChars.h"
 #include "Android/text/GraphicsOperations.h"
 #include "Android/text/Layout.h"
+#include "Android/text/PrecomputedText.h"
 #include "Android/text/Spannable.h"
 #include "Android/text/Spanned.h"
 #include "Android/text/SpanWatcher.h"
@@ -515,6 +516,7 @@ private:
     
     shared_ptr<BoringLayout::Metrics> mBoring, mHintBoring;
     shared_ptr<BoringLayout> mSavedLayout, mSavedHintLayout;
+    shared_ptr<PrecomputedText> mPrecomputed;
     
     shared_ptr<TextDirectionHeuristic> mTextDir;
     
@@ -1943,6 +1945,20 @@ public:
      */
     void setText(shared_ptr<CharSequence> text, BufferType type);
     
+    /**
+     * Sets text whose measurements and line breaks were computed ahead of
+     * time, typically on a background thread. The layout is adopted as-is if
+     * {@link #getTextMetricsParams} still matches the PrecomputedText's
+     * params and the text is not ellipsized; otherwise it is measured again.
+     */
+    void setText(shared_ptr<PrecomputedText> text);
+    
+    /**
+     * Returns the parameters to create a PrecomputedText for this TextView.
+     * The width is the current layout width, or -1 before the first layout.
+     */
+    PrecomputedText::Params getTextMetricsParams();
+    
 private:
     
     void setText(shared_ptr<CharSequence> text, BufferType type,
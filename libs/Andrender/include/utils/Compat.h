@@ -19,9 +19,15 @@
 
 #include <unistd.h>
 
+/* Bionic declares off64_t and lseek64. */
+#if !defined(HAVE_OFF64_T) && defined(__ANDROID__)
+#define HAVE_OFF64_T 1
+#endif
+
 /* Compatibility definitions for non-Linux (i.e., BSD-based) hosts. */
 #ifndef HAVE_OFF64_T
-#if _FILE_OFFSET_BITS < 64
+/* Darwin's off_t is always 64 bits. */
+#if _FILE_OFFSET_BITS < 64 && !defined(__APPLE__)
 #error "_FILE_OFFSET_BITS < 64; large files are not supported on this platform"
 #endif /* _FILE_OFFSET_BITS < 64 */
 
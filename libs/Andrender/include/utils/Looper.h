@@ -18,13 +18,27 @@
 #define UTILS_LOOPER_H
 
 #include <utils/threads.h>
-#include <utils/RefBase.h>
 #include <utils/KeyedVector.h>
 #include <utils/Timers.h>
 
-//#include <android/looper.h>
-
-//#include <sys/epoll.h>
+#include <android/looper.h>
+#include <mindroid/os/Ref.h>
+
+// epoll() is only available on Linux, other systems poll(). Builds may
+// define LOOPER_USES_EPOLL to 0 to run the poll() path on Linux too.
+#ifndef LOOPER_USES_EPOLL
+#ifdef __linux__
+#define LOOPER_USES_EPOLL 1
+#else
+#define LOOPER_USES_EPOLL 0
+#endif
+#endif
+
+#if LOOPER_USES_EPOLL
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
 
 /*
  * Declare a concrete type for the NDK's looper forward declaration.
@@ -54,7 +68,7 @@ struct Message {
  * to remove any pending messages destined for the handler so that the handler
  * can be destroyed.
  */
-class MessageHandler : public virtual RefBase {
+class MessageHandler : public virtual mindroid::Ref {
 protected:
     virtual ~MessageHandler() { }
 
@@ -74,18 +88,18 @@ protected:
     virtual ~WeakMessageHandler();
 
 public:
-    WeakMessageHandler(const wp<MessageHandler>& handler);
+    WeakMessageHandler(const mindroid::wp<MessageHandler>& handler);
     virtual void handleMessage(const Message& message);
 
 private:
-    wp<MessageHandler> mHandler;
+    mindroid::wp<MessageHandler> mHandler;
 };
 
 
 /**
  * A looper callback.
  */
-class LooperCallback : public virtual RefBase {
+class LooperCallback : public virtual mindroid::Ref {
 protected:
     virtual ~LooperCallback() { }
 
@@ -121,11 +135,12 @@ private:
 
 /**
  * A polling loop that supports monitoring file descriptor events, optionally
- * using callbacks.  The implementation uses epoll() internally.
+ * using callbacks.  The implementation uses epoll() internally, or poll() where
+ * epoll() is not available.
  *
  * A looper can be associated with a thread although there is no requirement that it must be.
  */
-class Looper : public ALooper, public RefBase {
+class Looper : public ALooper, public mindroid::Ref {
 protected:
     virtual ~Looper();
 
@@ -226,7 +241,7 @@ public:
      * See removeFd() for details.
      */
     int addFd(int fd, int ident, int events, ALooper_callbackFunc callback, void* data);
-    int addFd(int fd, int ident, int events, const sp<LooperCallback>& callback, void* data);
+    int addFd(int fd, int ident, int events, const mindroid::sp<LooperCallback>& callback, void* data);
 
     /**
      * Removes a previously added file descriptor from the looper.
@@ -240,7 +255,7 @@ public:
      * again at any later time unless registered anew.
      *
      * A simple way to avoid this problem is to use the version of addFd() that takes
-     * a sp<LooperCallback> instead of a bare function pointer.  The LooperCallback will
+     * an sp<LooperCallback> instead of a bare function pointer.  The LooperCallback will
      * be released at the appropriate time by the Looper.
      *
      * Returns 1 if the file descriptor was removed, 0 if none was previously registered.
@@ -256,7 +271,7 @@ public:
      * The handler must not be null.
      * This method can be called on any thread.
      */
-    void sendMessage(const sp<MessageHandler>& handler, const Message& message);
+    void sendMessage(const mindroid::sp<MessageHandler>& handler, const Message& message);
 
     /**
      * Enqueues a message to be processed by the specified handler after all pending messages
@@ -266,7 +281,7 @@ public:
      * The handler must not be null.
      * This method can be called on any thread.
      */
-    void sendMessageDelayed(nsecs_t uptimeDelay, const sp<MessageHandler>& handler,
+    void sendMessageDelayed(nsecs_t uptimeDelay, const mindroid::sp<MessageHandler>& handler,
             const Message& message);
 
     /**
@@ -277,7 +292,7 @@ public:
      * The handler must not be null.
      * This method can be called on any thread.
      */
-    void sendMessageAtTime(nsecs_t uptime, const sp<MessageHandler>& handler,
+    void sendMessageAtTime(nsecs_t uptime, const mindroid::sp<MessageHandler>& handler,
             const Message& message);
 
     /**
@@ -286,7 +301,7 @@ public:
      * The handler must not be null.
      * This method can be called on any thread.
      */
-    void removeMessages(const sp<MessageHandler>& handler);
+    void removeMessages(const mindroid::sp<MessageHandler>& handler);
 
     /**
      * Removes all messages of a particular type for the specified handler from the queue.
@@ -294,7 +309,7 @@ public:
      * The handler must not be null.
      * This method can be called on any thread.
      */
-    void removeMessages(const sp<MessageHandler>& handler, int what);
+    void removeMessages(const mindroid::sp<MessageHandler>& handler, int what);
 
     /**
      * Prepares a looper associated with the calling thread, and returns it.
@@ -303,7 +318,7 @@ public:
      *
      * The opts may be ALOOPER_PREPARE_ALLOW_NON_CALLBACKS or 0.
      */
-    static sp<Looper> prepare(int opts);
+    static mindroid::sp<Looper> prepare(int opts);
 
     /**
      * Sets the given looper to be associated with the calling thread.
@@ -311,19 +326,20 @@ public:
      *
      * If "looper" is NULL, removes the currently associated looper.
      */
-    static void setForThread(const sp<Looper>& looper);
+    static void setForThread(const mindroid::sp<Looper>& looper);
 
     /**
      * Returns the looper associated with the calling thread, or NULL if
      * there is not one.
      */
-    static sp<Looper> getForThread();
+    static mindroid::sp<Looper> getForThread();
 
 private:
     struct Request {
         int fd;
         int ident;
-        sp<LooperCallback> callback;
+        int events;
+        mindroid::sp<LooperCallback> callback;
         void* data;
     };
 
@@ -335,12 +351,12 @@ private:
     struct MessageEnvelope {
         MessageEnvelope() : uptime(0) { }
 
-        MessageEnvelope(nsecs_t uptime, const sp<MessageHandler> handler,
+        MessageEnvelope(nsecs_t uptime, const mindroid::sp<MessageHandler> handler,
                 const Message& message) : uptime(uptime), handler(handler), message(message) {
         }
 
         nsecs_t uptime;
-        sp<MessageHandler> handler;
+        mindroid::sp<MessageHandler> handler;
         Message message;
     };
 
@@ -353,7 +369,13 @@ private:
     Vector<MessageEnvelope> mMessageEnvelopes; // guarded by mLock
     bool mSendingMessage; // guarded by mLock
 
+#if LOOPER_USES_EPOLL
     int mEpollFd; // immutable
+#else
+    // The descriptors of the last poll, the wake pipe first. Only used by
+    // pollOnce, the requests are copied in on every poll.
+    Vector<struct pollfd> mPollFds;
+#endif
 
     // Locked list of file descriptor monitoring requests.
     KeyedVector<int, Request> mRequests;  // guarded by mLock
@@ -365,7 +387,8 @@ private:
     nsecs_t mNextMessageUptime; // set to LLONG_MAX when none
 
     int pollInner(int timeoutMillis);
-    void awoken();
+    bool awoken(); // returns true if wake() was called
+    void writeWakePipe(char signal);
     void pushResponse(int events, const Request& request);
 
     static void initTLSKey();
@@ -103,7 +103,8 @@ int32_t utf32_from_utf8_at(const char *src, size_t src_len, size_t index, size_t
 
 
 /**
- * Returns the UTF-8 length of UTF-16 string "src".
+ * Returns the UTF-8 length of UTF-16 string "src". Unpaired surrogates are
+ * not counted, utf16_to_utf8 drops them.
  */
 ssize_t utf16_to_utf8_length(const char16_t *src, size_t src_len);
 
@@ -145,7 +146,10 @@ size_t utf8_to_utf32_length(const char *src, size_t src_len);
 void utf8_to_utf32(const char* src, size_t src_len, char32_t* dst);
 
 /**
- * Returns the UTF-16 length of UTF-8 string "src".
+ * Returns the UTF-16 length of UTF-8 string "src", or -1 if it is not valid
+ * UTF-8: truncated or overlong sequences, surrogates or code points beyond
+ * U+10FFFF. A string measured this way can be converted with the other
+ * utf8_to_utf16 functions.
  */
 ssize_t utf8_to_utf16_length(const uint8_t* src, size_t srcLen);
 
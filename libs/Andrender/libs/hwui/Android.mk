@@ -7,6 +7,7 @@ LOCAL_SRC_FILES:= \
 	utils/SortedListImpl.cpp \
 	FontRenderer.cpp \
 	GammaFontRenderer.cpp \
+	CacheConfig.cpp \
 	Caches.cpp \
 	DisplayListLogBuffer.cpp \
 	DisplayListRenderer.cpp \
@@ -15,17 +16,22 @@ LOCAL_SRC_FILES:= \
 	LayerCache.cpp \
 	LayerRenderer.cpp \
 	Matrix.cpp \
+	OcclusionTracker.cpp \
 	OpenGLRenderer.cpp \
+	OverdrawCounter.cpp \
 	Patch.cpp \
 	PatchCache.cpp \
 	PathCache.cpp \
+	PathTessellator.cpp \
 	Program.cpp \
+	ProgramBinaryCache.cpp \
 	ProgramCache.cpp \
 	ResourceCache.cpp \
 	ShapeCache.cpp \
 	SkiaColorFilter.cpp \
 	SkiaShader.cpp \
 	Snapshot.cpp \
+	TessellationCache.cpp \
 	TextureCache.cpp \
 	TextDropShadowCache.cpp
 
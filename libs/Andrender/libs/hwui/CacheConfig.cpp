@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "OpenGLRenderer"
+
+#include <math.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <sys/sysctl.h>
+#endif
+
+#include "CacheConfig.h"
+#include "Debug.h"
+#include "Properties.h"
+
+namespace android {
+namespace uirenderer {
+
+///////////////////////////////////////////////////////////////////////////////
+// Defines
+///////////////////////////////////////////////////////////////////////////////
+
+// Number of pixels of the screen the defaults were tuned for (480x800)
+#define REFERENCE_SCREEN_PIXELS (480.0f * 800.0f)
+
+// Bounds of the scale applied to the defaults
+#define MIN_SCREEN_SCALE 0.5f
+#define MAX_SCREEN_SCALE 4.0f
+
+// Fraction of the physical memory the byte-sized caches may use
+#define MAX_MEMORY_FRACTION 0.125f
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructors
+///////////////////////////////////////////////////////////////////////////////
+
+CacheConfig::CacheConfig() {
+    setDefaults();
+    readProperties();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Configuration
+///////////////////////////////////////////////////////////////////////////////
+
+void CacheConfig::setDefaults() {
+    textureCacheSize = DEFAULT_TEXTURE_CACHE_SIZE;
+    layerCacheSize = DEFAULT_LAYER_CACHE_SIZE;
+    gradientCacheSize = DEFAULT_GRADIENT_CACHE_SIZE;
+    pathCacheSize = DEFAULT_PATH_CACHE_SIZE;
+    shapeCacheSize = DEFAULT_SHAPE_CACHE_SIZE;
+    tessellationCacheSize = DEFAULT_TESSELLATION_CACHE_SIZE;
+    dropShadowCacheSize = DEFAULT_DROP_SHADOW_CACHE_SIZE;
+    fboCacheSize = DEFAULT_FBO_CACHE_SIZE;
+    textCacheWidth = DEFAULT_TEXT_CACHE_WIDTH;
+    textCacheHeight = DEFAULT_TEXT_CACHE_HEIGHT;
+}
+
+static void readSize(const char* name, float* size) {
+    char property[PROPERTY_VALUE_MAX];
+    if (property_get(name, property, NULL) > 0) {
+        *size = atof(property);
+    }
+}
+
+static void readCount(const char* name, uint32_t* count) {
+    char property[PROPERTY_VALUE_MAX];
+    if (property_get(name, property, NULL) > 0) {
+        *count = atoi(property);
+    }
+}
+
+void CacheConfig::readProperties() {
+    readSize(PROPERTY_TEXTURE_CACHE_SIZE, &textureCacheSize);
+    readSize(PROPERTY_LAYER_CACHE_SIZE, &layerCacheSize);
+    readSize(PROPERTY_GRADIENT_CACHE_SIZE, &gradientCacheSize);
+    readSize(PROPERTY_PATH_CACHE_SIZE, &pathCacheSize);
+    readSize(PROPERTY_SHAPE_CACHE_SIZE, &shapeCacheSize);
+    readSize(PROPERTY_TESSELLATION_CACHE_SIZE, &tessellationCacheSize);
+    readSize(PROPERTY_DROP_SHADOW_CACHE_SIZE, &dropShadowCacheSize);
+    readCount(PROPERTY_FBO_CACHE_SIZE, &fboCacheSize);
+    readCount(PROPERTY_TEXT_CACHE_WIDTH, &textCacheWidth);
+    readCount(PROPERTY_TEXT_CACHE_HEIGHT, &textCacheHeight);
+}
+
+void CacheConfig::setForDisplay(uint32_t width, uint32_t height, uint64_t memorySize) {
+    setDefaults();
+
+    float scale = (width * height) / REFERENCE_SCREEN_PIXELS;
+    scale = fmaxf(MIN_SCREEN_SCALE, fminf(MAX_SCREEN_SCALE, scale));
+
+    // Bitmaps, layers and rasterized shapes grow with the area of the
+    // screen, gradients and tessellated outlines with its dimensions
+    const float linearScale = sqrtf(scale);
+    textureCacheSize *= scale;
+    layerCacheSize *= scale;
+    pathCacheSize *= scale;
+    shapeCacheSize *= scale;
+    dropShadowCacheSize *= scale;
+    gradientCacheSize *= linearScale;
+    tessellationCacheSize *= linearScale;
+
+    if (scale >= 2.0f) {
+        textCacheHeight *= scale >= MAX_SCREEN_SCALE ? 4 : 2;
+    }
+
+    if (memorySize > 0) {
+        // Shape caches come in five flavors
+        const float total = textureCacheSize + layerCacheSize + gradientCacheSize +
+                pathCacheSize + shapeCacheSize * 5 + tessellationCacheSize + dropShadowCacheSize;
+        const float budget = memorySize * MAX_MEMORY_FRACTION / (1024.0f * 1024.0f);
+        if (total > budget) {
+            const float ratio = budget / total;
+            textureCacheSize *= ratio;
+            layerCacheSize *= ratio;
+            gradientCacheSize *= ratio;
+            pathCacheSize *= ratio;
+            shapeCacheSize *= ratio;
+            tessellationCacheSize *= ratio;
+            dropShadowCacheSize *= ratio;
+        }
+    }
+
+    readProperties();
+
+    INIT_LOGD("Cache configuration for %dx%d, %lluMB of memory:", width, height,
+            (unsigned long long) (memorySize / (1024 * 1024)));
+    INIT_LOGD("  Texture %.2fMB, layer %.2fMB, path %.2fMB, text cache %dx%d",
+            textureCacheSize, layerCacheSize, pathCacheSize, textCacheWidth, textCacheHeight);
+}
+
+uint64_t CacheConfig::getPhysicalMemorySize() {
+#if defined(__APPLE__)
+    uint64_t memorySize = 0;
+    size_t length = sizeof(memorySize);
+    if (sysctlbyname("hw.memsize", &memorySize, &length, NULL, 0) != 0) {
+        return 0;
+    }
+    return memorySize;
+#elif defined(_SC_PHYS_PAGES) && defined(_SC_PAGESIZE)
+    const long pages = sysconf(_SC_PHYS_PAGES);
+    const long pageSize = sysconf(_SC_PAGESIZE);
+    if (pages <= 0 || pageSize <= 0) {
+        return 0;
+    }
+    return (uint64_t) pages * pageSize;
+#else
+    return 0;
+#endif
+}
+
+}; // namespace uirenderer
+}; // namespace android
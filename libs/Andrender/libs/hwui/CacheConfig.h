@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_HWUI_CACHE_CONFIG_H
+#define ANDROID_HWUI_CACHE_CONFIG_H
+
+#include <stdint.h>
+
+namespace android {
+namespace uirenderer {
+
+///////////////////////////////////////////////////////////////////////////////
+// Classes
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Limits of the renderer caches. Sizes are in mega-bytes unless noted.
+ *
+ * The compiled defaults were tuned for a phone screen. setForDisplay()
+ * scales them to the screen and bounds them by the memory of the device.
+ * The ro.hwui.* properties, where the platform has them, always win.
+ */
+struct CacheConfig {
+    /**
+     * Creates a configuration holding the compiled defaults overridden
+     * by the system properties.
+     */
+    CacheConfig();
+
+    /**
+     * Resets every limit to its compiled default.
+     */
+    void setDefaults();
+    /**
+     * Overrides the limits set by the ro.hwui.* system properties.
+     */
+    void readProperties();
+
+    /**
+     * Sizes the caches for a screen of the specified size in pixels. The
+     * byte-sized caches together use at most an eighth of memorySize, in
+     * bytes, unless memorySize is 0. System properties are applied last.
+     */
+    void setForDisplay(uint32_t width, uint32_t height, uint64_t memorySize);
+
+    /**
+     * Returns the physical memory of the device in bytes, or 0 if it
+     * cannot be determined.
+     */
+    static uint64_t getPhysicalMemorySize();
+
+    float textureCacheSize;
+    float layerCacheSize;
+    float gradientCacheSize;
+    float pathCacheSize;
+    float shapeCacheSize;
+    float tessellationCacheSize;
+    float dropShadowCacheSize;
+    // Number of FBOs
+    uint32_t fboCacheSize;
+    // Size of the first font cache page, in pixels
+    uint32_t textCacheWidth;
+    uint32_t textCacheHeight;
+}; // struct CacheConfig
+
+}; // namespace uirenderer
+}; // namespace android
+
+#endif // ANDROID_HWUI_CACHE_CONFIG_H
@@ -53,6 +53,9 @@ Caches::Caches(): Singleton<Caches>(), mInitialized(false) {
     mDebugLevel = readDebugLevel();
     ALOGD("mEnabling debug mode %d", mDebugLevel);
 
+    mOcclusionCulling = readOcclusionCulling();
+    mDebugOverdraw = readDebugOverdraw();
+
 #if RENDER_LAYERS_AS_REGIONS
     INIT_LOGD("Layers will be composited as regions");
 #endif
@@ -83,6 +86,7 @@ void Caches::init() {
     lastSrcMode = GL_ZERO;
     lastDstMode = GL_ZERO;
     currentProgram = NULL;
+    programCache.init(extensions);
 
     mInitialized = true;
 }
@@ -129,12 +133,38 @@ void Caches::terminate() {
 
     fboCache.clear();
 
-    programCache.clear();
+    programCache.terminate();
     currentProgram = NULL;
 
     mInitialized = false;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Configuration
+///////////////////////////////////////////////////////////////////////////////
+
+void Caches::setConfig(const CacheConfig& config) {
+    textureCache.setMaxSize(MB(config.textureCacheSize));
+    gradientCache.setMaxSize(MB(config.gradientCacheSize));
+    pathCache.setMaxSize(MB(config.pathCacheSize));
+    roundRectShapeCache.setMaxSize(MB(config.shapeCacheSize));
+    circleShapeCache.setMaxSize(MB(config.shapeCacheSize));
+    ovalShapeCache.setMaxSize(MB(config.shapeCacheSize));
+    rectShapeCache.setMaxSize(MB(config.shapeCacheSize));
+    arcShapeCache.setMaxSize(MB(config.shapeCacheSize));
+    tessellationCache.setMaxSize(MB(config.tessellationCacheSize));
+    dropShadowCache.setMaxSize(MB(config.dropShadowCacheSize));
+    fboCache.setMaxSize(config.fboCacheSize);
+    fontRenderer.setCacheSize(config.textCacheWidth, config.textCacheHeight);
+
+    // Resizing the layer cache drops every layer
+    if (config.layerCacheSize != mConfig.layerCacheSize) {
+        layerCache.setMaxSize(MB(config.layerCacheSize));
+    }
+
+    mConfig = config;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Debug
 ///////////////////////////////////////////////////////////////////////////////
@@ -146,30 +176,48 @@ void Caches::dumpMemoryUsage() {
 }
 
 void Caches::dumpMemoryUsage(String8 &log) {
-    log.appendFormat("Current memory usage / total memory usage (bytes):\n");
-    log.appendFormat("  TextureCache         %8d / %8d\n",
-            textureCache.getSize(), textureCache.getMaxSize());
-    log.appendFormat("  LayerCache           %8d / %8d\n",
-            layerCache.getSize(), layerCache.getMaxSize());
-    log.appendFormat("  GradientCache        %8d / %8d\n",
-            gradientCache.getSize(), gradientCache.getMaxSize());
-    log.appendFormat("  PathCache            %8d / %8d\n",
-            pathCache.getSize(), pathCache.getMaxSize());
-    log.appendFormat("  CircleShapeCache     %8d / %8d\n",
-            circleShapeCache.getSize(), circleShapeCache.getMaxSize());
-    log.appendFormat("  OvalShapeCache       %8d / %8d\n",
-            ovalShapeCache.getSize(), ovalShapeCache.getMaxSize());
-    log.appendFormat("  RoundRectShapeCache  %8d / %8d\n",
-            roundRectShapeCache.getSize(), roundRectShapeCache.getMaxSize());
-    log.appendFormat("  RectShapeCache       %8d / %8d\n",
-            rectShapeCache.getSize(), rectShapeCache.getMaxSize());
-    log.appendFormat("  ArcShapeCache        %8d / %8d\n",
-            arcShapeCache.getSize(), arcShapeCache.getMaxSize());
-    log.appendFormat("  TextDropShadowCache  %8d / %8d\n", dropShadowCache.getSize(),
-            dropShadowCache.getMaxSize());
+    log.appendFormat("Current memory usage / total memory usage (bytes), evictions:\n");
+    log.appendFormat("  TextureCache         %8d / %8d %8d\n",
+            textureCache.getSize(), textureCache.getMaxSize(), textureCache.getEvictionCount());
+    log.appendFormat("  LayerCache           %8d / %8d %8d\n",
+            layerCache.getSize(), layerCache.getMaxSize(), layerCache.getEvictionCount());
+    log.appendFormat("  GradientCache        %8d / %8d %8d\n",
+            gradientCache.getSize(), gradientCache.getMaxSize(), gradientCache.getEvictionCount());
+    log.appendFormat("  PathCache            %8d / %8d %8d\n",
+            pathCache.getSize(), pathCache.getMaxSize(), pathCache.getEvictionCount());
+    const PathCache::Stats& pathStats = pathCache.getStats();
+    log.appendFormat("    %d hits, %d precached, %d stalls, %d misses\n",
+            pathStats.hitCount, pathStats.precacheHitCount, pathStats.stallCount,
+            pathStats.missCount);
+    log.appendFormat("  CircleShapeCache     %8d / %8d %8d\n",
+            circleShapeCache.getSize(), circleShapeCache.getMaxSize(),
+            circleShapeCache.getEvictionCount());
+    log.appendFormat("  OvalShapeCache       %8d / %8d %8d\n",
+            ovalShapeCache.getSize(), ovalShapeCache.getMaxSize(),
+            ovalShapeCache.getEvictionCount());
+    log.appendFormat("  RoundRectShapeCache  %8d / %8d %8d\n",
+            roundRectShapeCache.getSize(), roundRectShapeCache.getMaxSize(),
+            roundRectShapeCache.getEvictionCount());
+    log.appendFormat("  RectShapeCache       %8d / %8d %8d\n",
+            rectShapeCache.getSize(), rectShapeCache.getMaxSize(),
+            rectShapeCache.getEvictionCount());
+    log.appendFormat("  ArcShapeCache        %8d / %8d %8d\n",
+            arcShapeCache.getSize(), arcShapeCache.getMaxSize(), arcShapeCache.getEvictionCount());
+    log.appendFormat("  TessellationCache    %8d / %8d %8d\n",
+            tessellationCache.getSize(), tessellationCache.getMaxSize(),
+            tessellationCache.getEvictionCount());
+    log.appendFormat("  TextDropShadowCache  %8d / %8d %8d\n", dropShadowCache.getSize(),
+            dropShadowCache.getMaxSize(), dropShadowCache.getEvictionCount());
     for (uint32_t i = 0; i < fontRenderer.getFontRendererCount(); i++) {
         const uint32_t size = fontRenderer.getFontRendererSize(i);
         log.appendFormat("  FontRenderer %d       %8d / %8d\n", i, size, size);
+        FontRenderer::CacheStats stats;
+        if (fontRenderer.getFontRendererStats(i, stats) && stats.allocatedBytes > 0) {
+            log.appendFormat("    %d pages, %d glyphs, %d%% occupied, %d evictions, %d precached\n",
+                    stats.pageCount, stats.glyphCount,
+                    (int) ((uint64_t) stats.usedBytes * 100 / stats.allocatedBytes),
+                    stats.evictionCount, stats.precachedGlyphCount);
+        }
     }
     log.appendFormat("Other:\n");
     log.appendFormat("  FboCache             %8d / %8d\n",
@@ -188,6 +236,7 @@ void Caches::dumpMemoryUsage(String8 &log) {
     total += ovalShapeCache.getSize();
     total += rectShapeCache.getSize();
     total += arcShapeCache.getSize();
+    total += tessellationCache.getSize();
     for (uint32_t i = 0; i < fontRenderer.getFontRendererCount(); i++) {
         total += fontRenderer.getFontRendererSize(i);
     }
@@ -245,6 +294,8 @@ void Caches::flush(FlushMode mode) {
             fontRenderer.clear();
             // fall through
         case kFlushMode_Moderate:
+            // The process may be killed once in the background
+            programCache.saveBinaries();
             fontRenderer.flush();
             textureCache.flush();
             pathCache.clear();
@@ -253,6 +304,7 @@ void Caches::flush(FlushMode mode) {
             ovalShapeCache.clear();
             rectShapeCache.clear();
             arcShapeCache.clear();
+            tessellationCache.clear();
             // fall through
         case kFlushMode_Layers:
             layerCache.clear();
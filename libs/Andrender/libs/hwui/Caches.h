@@ -25,6 +25,7 @@
 
 #include <cutils/compiler.h>
 
+#include "CacheConfig.h"
 #include "Extensions.h"
 #include "FontRenderer.h"
 #include "GammaFontRenderer.h"
@@ -35,6 +36,7 @@
 #include "ProgramCache.h"
 #include "ShapeCache.h"
 #include "PathCache.h"
+#include "TessellationCache.h"
 #include "TextDropShadowCache.h"
 #include "FboCache.h"
 #include "ResourceCache.h"
@@ -68,6 +70,7 @@ static const GLsizei gAAVertexStride = sizeof(AAVertex);
 static const GLsizei gMeshTextureOffset = 2 * sizeof(float);
 static const GLsizei gVertexAAWidthOffset = 2 * sizeof(float);
 static const GLsizei gVertexAALengthOffset = 3 * sizeof(float);
+static const GLsizei gVertexAlphaOffset = 2 * sizeof(float);
 static const GLsizei gMeshCount = 4;
 
 static const GLenum gTextureUnits[] = {
@@ -124,6 +127,20 @@ public:
      */
     void terminate();
 
+    /**
+     * Resizes the caches. Caches larger than their new limit evict their
+     * oldest entries. Must be called on the thread that owns the GL context,
+     * outside of a frame.
+     */
+    void setConfig(const CacheConfig& config);
+
+    /**
+     * Returns the current limits of the caches.
+     */
+    const CacheConfig& getConfig() const {
+        return mConfig;
+    }
+
     /**
      * Indicates whether the renderer is in debug mode.
      * This debug mode provides limited information to app developers.
@@ -132,6 +149,21 @@ public:
         return mDebugLevel;
     }
 
+    /**
+     * Indicates whether display lists skip the ops hidden behind the
+     * opaque ops drawn after them.
+     */
+    bool isOcclusionCullingEnabled() const {
+        return mOcclusionCulling;
+    }
+
+    /**
+     * Indicates whether frames count and show their overdraw.
+     */
+    DebugOverdraw getDebugOverdraw() const {
+        return mDebugOverdraw;
+    }
+
     /**
      * Call this on each frame to ensure that garbage is deleted from
      * GPU memory.
@@ -241,6 +273,7 @@ public:
     OvalShapeCache ovalShapeCache;
     RectShapeCache rectShapeCache;
     ArcShapeCache arcShapeCache;
+    TessellationCache tessellationCache;
     PatchCache patchCache;
     TextDropShadowCache dropShadowCache;
     FboCache fboCache;
@@ -293,7 +326,11 @@ private:
     Vector<Layer*> mLayerGarbage;
     Vector<DisplayList*> mDisplayListGarbage;
 
+    CacheConfig mConfig;
+
     DebugLevel mDebugLevel;
+    bool mOcclusionCulling;
+    DebugOverdraw mDebugOverdraw;
     bool mInitialized;
 }; // class Caches
 
@@ -835,6 +835,40 @@ void DisplayList::setViewProperties(OpenGLRenderer& renderer, uint32_t level) {
     }
 }
 
+/**
+ * Returns how far the shapes drawn with the specified paint extend outside
+ * the geometry they are drawn from.
+ */
+static float getStrokeOutset(const SkPaint* paint) {
+    if (!paint || paint->getStyle() == SkPaint::kFill_Style) {
+        return 0.0f;
+    }
+
+    float outset = paint->getStrokeWidth() * 0.5f;
+    if (paint->getStrokeJoin() == SkPaint::kMiter_Join) {
+        outset *= fmaxf(paint->getStrokeMiter(), 1.0f);
+    }
+    return outset;
+}
+
+/**
+ * Computes the bounds of count coordinates, stored as x, y pairs.
+ */
+static void getPointsBounds(const float* points, int count, Rect& bounds) {
+    if (count < 2) {
+        bounds.setEmpty();
+        return;
+    }
+
+    bounds.set(points[0], points[1], points[0], points[1]);
+    for (int i = 2; i + 1 < count; i += 2) {
+        bounds.left = fminf(bounds.left, points[i]);
+        bounds.right = fmaxf(bounds.right, points[i]);
+        bounds.top = fminf(bounds.top, points[i + 1]);
+        bounds.bottom = fmaxf(bounds.bottom, points[i + 1]);
+    }
+}
+
 /**
  * Changes to replay(), specifically those involving opcode or parameter changes, should be mimicked
  * in the output() function, since that function processes the same list of opcodes for the
@@ -887,10 +921,14 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
         }
         logBuffer.writeCommand(level, op);
 
+        // Identifies the op when the renderer looks for the hidden ones
+        const void* opId = mReader.peek();
+
         switch (op) {
             case DrawGLFunction: {
                 Functor *functor = (Functor *) getInt();
                 DISPLAY_LIST_LOGD("%s%s %p", (char*) indent, OP_NAMES[op], functor);
+                if (renderer.skipDrawOp(opId)) break;
                 renderer.startMark("GL functor");
                 drawGlStatus |= renderer.callDrawGLFunction(functor, dirty);
                 renderer.endMark();
@@ -1010,6 +1048,8 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 }
                 DISPLAY_LIST_LOGD("%s%s %p, %.2f, %.2f, %p", (char*) indent, OP_NAMES[op],
                         layer, x, y, paint);
+                if (layer && renderer.skipDrawOp(opId, x, y, x + layer->layer.getWidth(),
+                        y + layer->layer.getHeight(), paint, false)) break;
                 drawGlStatus |= renderer.drawLayer(layer, x, y, paint);
             }
             break;
@@ -1023,6 +1063,8 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 }
                 DISPLAY_LIST_LOGD("%s%s %p, %.2f, %.2f, %p", (char*) indent, OP_NAMES[op],
                         bitmap, x, y, paint);
+                if (renderer.skipDrawOp(opId, x, y, x + bitmap->width(), y + bitmap->height(),
+                        paint, bitmap->isOpaque())) break;
                 drawGlStatus |= renderer.drawBitmap(bitmap, x, y, paint);
             }
             break;
@@ -1032,6 +1074,10 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 SkPaint* paint = getPaint(renderer);
                 DISPLAY_LIST_LOGD("%s%s %p, %p, %p", (char*) indent, OP_NAMES[op],
                         bitmap, matrix, paint);
+                SkRect bounds = SkRect::MakeWH(bitmap->width(), bitmap->height());
+                if (matrix) matrix->mapRect(&bounds);
+                if (renderer.skipDrawOp(opId, bounds.fLeft, bounds.fTop,
+                        bounds.fRight, bounds.fBottom, paint, false)) break;
                 drawGlStatus |= renderer.drawBitmap(bitmap, matrix, paint);
             }
             break;
@@ -1049,6 +1095,7 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 DISPLAY_LIST_LOGD("%s%s %p, %.2f, %.2f, %.2f, %.2f, %.2f, %.2f, %.2f, %.2f, %p",
                         (char*) indent, OP_NAMES[op], bitmap,
                         f1, f2, f3, f4, f5, f6, f7, f8,paint);
+                if (renderer.skipDrawOp(opId, f5, f6, f7, f8, paint, bitmap->isOpaque())) break;
                 drawGlStatus |= renderer.drawBitmap(bitmap, f1, f2, f3, f4, f5, f6, f7, f8, paint);
             }
             break;
@@ -1059,6 +1106,8 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 SkPaint* paint = getPaint(renderer);
                 DISPLAY_LIST_LOGD("%s%s %p, %.2f, %.2f, %p", (char*) indent, OP_NAMES[op],
                         bitmap, x, y, paint);
+                if (renderer.skipDrawOp(opId, x, y, x + bitmap->width(), y + bitmap->height(),
+                        paint, bitmap->isOpaque())) break;
                 drawGlStatus |= renderer.drawBitmap(bitmap, x, y, paint);
             }
             break;
@@ -1075,6 +1124,10 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 SkPaint* paint = getPaint(renderer);
 
                 DISPLAY_LIST_LOGD("%s%s", (char*) indent, OP_NAMES[op]);
+                Rect bounds;
+                getPointsBounds(vertices, verticesCount, bounds);
+                if (renderer.skipDrawOp(opId, bounds.left, bounds.top,
+                        bounds.right, bounds.bottom, paint, false)) break;
                 drawGlStatus |= renderer.drawBitmapMesh(bitmap, meshWidth, meshHeight, vertices,
                         colors, paint);
             }
@@ -1100,6 +1153,8 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 SkPaint* paint = getPaint(renderer);
 
                 DISPLAY_LIST_LOGD("%s%s", (char*) indent, OP_NAMES[op]);
+                if (renderer.skipDrawOp(opId, left, top, right, bottom,
+                        paint, bitmap->isOpaque())) break;
                 drawGlStatus |= renderer.drawPatch(bitmap, xDivs, yDivs, colors,
                         xDivsCount, yDivsCount, numColors, left, top, right, bottom, paint);
             }
@@ -1108,6 +1163,9 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 int32_t color = getInt();
                 int32_t xferMode = getInt();
                 DISPLAY_LIST_LOGD("%s%s 0x%x %d", (char*) indent, OP_NAMES[op], color, xferMode);
+                const Rect& clip = renderer.getClipBounds();
+                if (renderer.skipDrawOp(opId, clip.left, clip.top, clip.right, clip.bottom,
+                        (color >> 24) & 0xFF, (SkXfermode::Mode) xferMode, true)) break;
                 drawGlStatus |= renderer.drawColor(color, (SkXfermode::Mode) xferMode);
             }
             break;
@@ -1119,6 +1177,9 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 SkPaint* paint = getPaint(renderer);
                 DISPLAY_LIST_LOGD("%s%s %.2f, %.2f, %.2f, %.2f, %p", (char*) indent, OP_NAMES[op],
                         f1, f2, f3, f4, paint);
+                const float outset = getStrokeOutset(paint);
+                if (renderer.skipDrawOp(opId, f1 - outset, f2 - outset, f3 + outset, f4 + outset,
+                        paint, paint->getStyle() == SkPaint::kFill_Style)) break;
                 drawGlStatus |= renderer.drawRect(f1, f2, f3, f4, paint);
             }
             break;
@@ -1132,6 +1193,9 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 SkPaint* paint = getPaint(renderer);
                 DISPLAY_LIST_LOGD("%s%s %.2f, %.2f, %.2f, %.2f, %.2f, %.2f, %p",
                         (char*) indent, OP_NAMES[op], f1, f2, f3, f4, f5, f6, paint);
+                const float outset = getStrokeOutset(paint);
+                if (renderer.skipDrawOp(opId, f1 - outset, f2 - outset, f3 + outset, f4 + outset,
+                        paint, false)) break;
                 drawGlStatus |= renderer.drawRoundRect(f1, f2, f3, f4, f5, f6, paint);
             }
             break;
@@ -1142,6 +1206,9 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 SkPaint* paint = getPaint(renderer);
                 DISPLAY_LIST_LOGD("%s%s %.2f, %.2f, %.2f, %p",
                         (char*) indent, OP_NAMES[op], f1, f2, f3, paint);
+                const float radius = f3 + getStrokeOutset(paint);
+                if (renderer.skipDrawOp(opId, f1 - radius, f2 - radius, f1 + radius, f2 + radius,
+                        paint, false)) break;
                 drawGlStatus |= renderer.drawCircle(f1, f2, f3, paint);
             }
             break;
@@ -1153,6 +1220,9 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 SkPaint* paint = getPaint(renderer);
                 DISPLAY_LIST_LOGD("%s%s %.2f, %.2f, %.2f, %.2f, %p",
                         (char*) indent, OP_NAMES[op], f1, f2, f3, f4, paint);
+                const float outset = getStrokeOutset(paint);
+                if (renderer.skipDrawOp(opId, f1 - outset, f2 - outset, f3 + outset, f4 + outset,
+                        paint, false)) break;
                 drawGlStatus |= renderer.drawOval(f1, f2, f3, f4, paint);
             }
             break;
@@ -1167,6 +1237,9 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 SkPaint* paint = getPaint(renderer);
                 DISPLAY_LIST_LOGD("%s%s %.2f, %.2f, %.2f, %.2f, %.2f, %.2f, %d, %p",
                         (char*) indent, OP_NAMES[op], f1, f2, f3, f4, f5, f6, i1, paint);
+                const float outset = getStrokeOutset(paint);
+                if (renderer.skipDrawOp(opId, f1 - outset, f2 - outset, f3 + outset, f4 + outset,
+                        paint, false)) break;
                 drawGlStatus |= renderer.drawArc(f1, f2, f3, f4, f5, f6, i1 == 1, paint);
             }
             break;
@@ -1174,6 +1247,14 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 SkPath* path = getPath();
                 SkPaint* paint = getPaint(renderer);
                 DISPLAY_LIST_LOGD("%s%s %p, %p", (char*) indent, OP_NAMES[op], path, paint);
+                if (path->isInverseFillType()) {
+                    if (renderer.skipDrawOp(opId)) break;
+                } else {
+                    const SkRect& bounds = path->getBounds();
+                    const float outset = getStrokeOutset(paint);
+                    if (renderer.skipDrawOp(opId, bounds.fLeft - outset, bounds.fTop - outset,
+                            bounds.fRight + outset, bounds.fBottom + outset, paint, false)) break;
+                }
                 drawGlStatus |= renderer.drawPath(path, paint);
             }
             break;
@@ -1182,6 +1263,11 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 float* points = getFloats(count);
                 SkPaint* paint = getPaint(renderer);
                 DISPLAY_LIST_LOGD("%s%s", (char*) indent, OP_NAMES[op]);
+                Rect bounds;
+                getPointsBounds(points, count, bounds);
+                const float outset = fmaxf(paint->getStrokeWidth(), 1.0f);
+                if (renderer.skipDrawOp(opId, bounds.left - outset, bounds.top - outset,
+                        bounds.right + outset, bounds.bottom + outset, paint, false)) break;
                 drawGlStatus |= renderer.drawLines(points, count, paint);
             }
             break;
@@ -1190,6 +1276,11 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 float* points = getFloats(count);
                 SkPaint* paint = getPaint(renderer);
                 DISPLAY_LIST_LOGD("%s%s", (char*) indent, OP_NAMES[op]);
+                Rect bounds;
+                getPointsBounds(points, count, bounds);
+                const float outset = fmaxf(paint->getStrokeWidth(), 1.0f);
+                if (renderer.skipDrawOp(opId, bounds.left - outset, bounds.top - outset,
+                        bounds.right + outset, bounds.bottom + outset, paint, false)) break;
                 drawGlStatus |= renderer.drawPoints(points, count, paint);
             }
             break;
@@ -1202,6 +1293,7 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 float length = getFloat();
                 DISPLAY_LIST_LOGD("%s%s %s, %d, %d, %.2f, %.2f, %p, %.2f", (char*) indent,
                         OP_NAMES[op], text.text(), text.length(), count, x, y, paint, length);
+                if (renderer.skipDrawOp(opId)) break;
                 drawGlStatus |= renderer.drawText(text.text(), text.length(), count, x, y,
                         paint, length);
             }
@@ -1215,6 +1307,7 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 SkPaint* paint = getPaint(renderer);
                 DISPLAY_LIST_LOGD("%s%s %s, %d, %d, %p", (char*) indent, OP_NAMES[op],
                     text.text(), text.length(), count, paint);
+                if (renderer.skipDrawOp(opId)) break;
                 drawGlStatus |= renderer.drawTextOnPath(text.text(), text.length(), count, path,
                         hOffset, vOffset, paint);
             }
@@ -1227,6 +1320,7 @@ status_t DisplayList::replay(OpenGLRenderer& renderer, Rect& dirty, int32_t flag
                 SkPaint* paint = getPaint(renderer);
                 DISPLAY_LIST_LOGD("%s%s %s, %d, %d, %p", (char*) indent,
                         OP_NAMES[op], text.text(), text.length(), count, paint);
+                if (renderer.skipDrawOp(opId)) break;
                 drawGlStatus |= renderer.drawPosText(text.text(), text.length(), count,
                         positions, paint);
             }
@@ -1348,6 +1442,9 @@ void DisplayListRenderer::reset() {
 
     mMatrices.clear();
 
+    mPrecachePaths.clear();
+    mPrecachePaints.clear();
+
     mHasDrawOps = false;
 }
 
@@ -1362,6 +1459,16 @@ DisplayList* DisplayListRenderer::getDisplayList(DisplayList* displayList) {
         displayList->initFromDisplayListRenderer(*this, true);
     }
     displayList->setRenderable(mHasDrawOps);
+
+    // Paths are precached here rather than as they are recorded: the path
+    // cache belongs to the thread that draws, which may not be the one
+    // recording, but it does not draw while a display list is updated
+    for (size_t i = 0; i < mPrecachePaths.size(); i++) {
+        mCaches.pathCache.precache(mPrecachePaths.itemAt(i), mPrecachePaints.itemAt(i));
+    }
+    mPrecachePaths.clear();
+    mPrecachePaints.clear();
+
     return displayList;
 }
 
@@ -1656,6 +1763,16 @@ status_t DisplayListRenderer::drawPath(SkPath* path, SkPaint* paint) {
     addPath(path);
     addPaint(paint);
     addSkip(location);
+
+    // Convex fills are tessellated at draw time and never need a texture
+    const bool convexFill = PathTessellator::isSupported(paint) &&
+            paint->getStyle() == SkPaint::kFill_Style && !path->isInverseFillType() &&
+            path->getConvexity() == SkPath::kConvex_Convexity;
+    if (!reject && !convexFill) {
+        mPrecachePaths.add(mPathMap.valueFor(path));
+        mPrecachePaints.add(mPaintMap.valueFor(paint));
+    }
+
     return DrawGlInfo::kStatusDone;
 }
 
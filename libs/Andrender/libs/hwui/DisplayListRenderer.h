@@ -862,6 +862,10 @@ private:
 
     Vector<SkMatrix*> mMatrices;
 
+    // Recorded paths and paints to precache once recording ends
+    Vector<SkPath*> mPrecachePaths;
+    Vector<SkPaint*> mPrecachePaints;
+
     SkWriter32 mWriter;
     uint32_t mBufferSize;
 
@@ -55,6 +55,15 @@ uint32_t FboCache::getMaxSize() {
     return mMaxSize;
 }
 
+void FboCache::setMaxSize(uint32_t maxSize) {
+    mMaxSize = maxSize;
+    while (mCache.size() > mMaxSize) {
+        const GLuint fbo = mCache.itemAt(mCache.size() - 1);
+        glDeleteFramebuffers(1, &fbo);
+        mCache.removeAt(mCache.size() - 1);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Caching
 ///////////////////////////////////////////////////////////////////////////////
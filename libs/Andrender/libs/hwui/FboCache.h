@@ -63,6 +63,10 @@ public:
      */
     uint32_t getSize();
 
+    /**
+     * Sets the maximum number of FBOs that the cache can hold.
+     */
+    void setMaxSize(uint32_t maxSize);
     /**
      * Returns the maximum number of FBOs that the cache can hold.
      */
@@ -16,6 +16,7 @@
 
 #define LOG_TAG "OpenGLRenderer"
 
+#include <SkGlyphCache.h>
 #include <SkUtils.h>
 
 #include <cutils/properties.h>
@@ -34,31 +35,122 @@ namespace uirenderer {
 // Defines
 ///////////////////////////////////////////////////////////////////////////////
 
-#define DEFAULT_TEXT_CACHE_WIDTH 1024
-#define DEFAULT_TEXT_CACHE_HEIGHT 256
 #define MAX_TEXT_CACHE_WIDTH 2048
 #define TEXTURE_BORDER_SIZE 2
+// Precached glyphs are dropped instead of evicting pages past this occupancy (in %)
+#define MAX_PRECACHE_OCCUPANCY 75
 
 #define AUTO_KERN(prev, next) (((next) - (prev) + 32) >> 6 << 16)
 
 ///////////////////////////////////////////////////////////////////////////////
-// CacheTextureLine
+// CacheTexture
 ///////////////////////////////////////////////////////////////////////////////
 
-bool CacheTextureLine::fitBitmap(const SkGlyph& glyph, uint32_t *retOriginX, uint32_t *retOriginY) {
-    if (glyph.fHeight + TEXTURE_BORDER_SIZE > mMaxHeight) {
+void CacheTexture::reset() {
+    mSkyline.clear();
+    SkylineNode node = { 0, 0, mWidth };
+    mSkyline.push(node);
+    mUsedArea = 0;
+    mGlyphCount = 0;
+}
+
+/**
+ * Returns the y at which a width x height rectangle can be placed with its
+ * left edge on the given skyline node, or -1 if it does not fit there.
+ */
+int32_t CacheTexture::fitsAt(size_t index, int32_t width, int32_t height) const {
+    const int32_t x = mSkyline[index].x;
+    if (x + width > mWidth) {
+        return -1;
+    }
+
+    int32_t y = 0;
+    int32_t widthLeft = width;
+    while (widthLeft > 0) {
+        const SkylineNode& node = mSkyline[index];
+        if (node.y > y) {
+            y = node.y;
+        }
+        if (y + height > mHeight) {
+            return -1;
+        }
+        widthLeft -= node.width;
+        index++;
+    }
+
+    return y;
+}
+
+void CacheTexture::addSkylineLevel(size_t index, int32_t x, int32_t y,
+        int32_t width, int32_t height) {
+    SkylineNode level = { x, y + height, width };
+    mSkyline.insertAt(level, index);
+
+    // Shrink or remove the nodes now hidden under the new level
+    for (size_t i = index + 1; i < mSkyline.size(); ) {
+        const SkylineNode& previous = mSkyline[i - 1];
+        SkylineNode& node = mSkyline.editItemAt(i);
+        const int32_t overlap = previous.x + previous.width - node.x;
+        if (overlap <= 0) {
+            break;
+        }
+        if (overlap < node.width) {
+            node.x += overlap;
+            node.width -= overlap;
+            break;
+        }
+        mSkyline.removeAt(i);
+    }
+
+    // Merge neighbours of the same height
+    for (size_t i = 0; i + 1 < mSkyline.size(); ) {
+        if (mSkyline[i].y == mSkyline[i + 1].y) {
+            mSkyline.editItemAt(i).width += mSkyline[i + 1].width;
+            mSkyline.removeAt(i + 1);
+        } else {
+            i++;
+        }
+    }
+}
+
+bool CacheTexture::fitBitmap(uint32_t width, uint32_t height,
+        uint32_t* retOriginX, uint32_t* retOriginY) {
+    const int32_t slotWidth = width + TEXTURE_BORDER_SIZE;
+    const int32_t slotHeight = height + TEXTURE_BORDER_SIZE;
+    if (slotWidth > mWidth || slotHeight > mHeight) {
         return false;
     }
 
-    if (mCurrentCol + glyph.fWidth + TEXTURE_BORDER_SIZE < mMaxWidth) {
-        *retOriginX = mCurrentCol + 1;
-        *retOriginY = mCurrentRow + 1;
-        mCurrentCol += glyph.fWidth + TEXTURE_BORDER_SIZE;
-        mDirty = true;
-        return true;
+    // Bottom-left rule: lowest position first, then the narrowest node
+    ssize_t bestIndex = -1;
+    int32_t bestY = mHeight;
+    int32_t bestWidth = mWidth + 1;
+    for (size_t i = 0; i < mSkyline.size(); i++) {
+        const int32_t y = fitsAt(i, slotWidth, slotHeight);
+        if (y < 0) {
+            continue;
+        }
+        if (y < bestY || (y == bestY && mSkyline[i].width < bestWidth)) {
+            bestIndex = i;
+            bestY = y;
+            bestWidth = mSkyline[i].width;
+        }
     }
 
-    return false;
+    if (bestIndex < 0) {
+        return false;
+    }
+
+    const int32_t x = mSkyline[bestIndex].x;
+    addSkylineLevel(bestIndex, x, bestY, slotWidth, slotHeight);
+
+    *retOriginX = x + 1;
+    *retOriginY = bestY + 1;
+    markDirty(bestY, bestY + slotHeight);
+    mUsedArea += slotWidth * slotHeight;
+    mGlyphCount++;
+
+    return true;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -87,10 +179,10 @@ Font::~Font() {
     }
 }
 
-void Font::invalidateTextureCache(CacheTextureLine *cacheLine) {
+void Font::invalidateTextureCache(CacheTexture* cacheTexture) {
     for (uint32_t i = 0; i < mCachedGlyphs.size(); i++) {
         CachedGlyphInfo* cachedGlyph = mCachedGlyphs.valueAt(i);
-        if (cacheLine == NULL || cachedGlyph->mCachedTextureLine == cacheLine) {
+        if (cacheTexture == NULL || cachedGlyph->mCacheTexture == cacheTexture) {
             cachedGlyph->mIsValid = false;
         }
     }
@@ -134,7 +226,7 @@ void Font::drawCachedGlyph(CachedGlyphInfo* glyph, int x, int y,
     mState->appendMeshQuad(nPenX, nPenY, u1, v2,
             nPenX + width, nPenY, u2, v2,
             nPenX + width, nPenY - height, u2, v1,
-            nPenX, nPenY - height, u1, v1, glyph->mCachedTextureLine->mCacheTexture);
+            nPenX, nPenY - height, u1, v1, glyph->mCacheTexture);
 }
 
 void Font::drawCachedGlyphBitmap(CachedGlyphInfo* glyph, int x, int y,
@@ -145,7 +237,7 @@ void Font::drawCachedGlyphBitmap(CachedGlyphInfo* glyph, int x, int y,
     uint32_t endX = glyph->mStartX + glyph->mBitmapWidth;
     uint32_t endY = glyph->mStartY + glyph->mBitmapHeight;
 
-    CacheTexture *cacheTexture = glyph->mCachedTextureLine->mCacheTexture;
+    CacheTexture *cacheTexture = glyph->mCacheTexture;
     uint32_t cacheWidth = cacheTexture->mWidth;
     const uint8_t* cacheBuffer = cacheTexture->mTexture;
 
@@ -199,7 +291,7 @@ void Font::drawCachedGlyph(CachedGlyphInfo* glyph, float x, float hOffset, float
             position->fY + destination[2].fY, u2, v1,
             position->fX + destination[3].fX,
             position->fY + destination[3].fY, u1, v1,
-            glyph->mCachedTextureLine->mCacheTexture);
+            glyph->mCacheTexture);
 }
 
 CachedGlyphInfo* Font::getCachedGlyph(SkPaint* paint, glyph_t textUnit) {
@@ -217,6 +309,10 @@ CachedGlyphInfo* Font::getCachedGlyph(SkPaint* paint, glyph_t textUnit) {
         updateGlyphCache(paint, skiaGlyph, cachedGlyph);
     }
 
+    if (cachedGlyph->mIsValid) {
+        cachedGlyph->mCacheTexture->mLastUsed = mState->mGeneration;
+    }
+
     return cachedGlyph;
 }
 
@@ -393,8 +489,10 @@ void Font::updateGlyphCache(SkPaint* paint, const SkGlyph& skiaGlyph, CachedGlyp
     uint32_t startX = 0;
     uint32_t startY = 0;
 
-    // Get the bitmap for the glyph
-    paint->findImage(skiaGlyph);
+    // Get the bitmap for the glyph, unless it was rasterized by the precache thread
+    if (paint != NULL) {
+        paint->findImage(skiaGlyph);
+    }
     mState->cacheBitmap(skiaGlyph, glyph, &startX, &startY);
 
     if (!glyph->mIsValid) {
@@ -409,8 +507,8 @@ void Font::updateGlyphCache(SkPaint* paint, const SkGlyph& skiaGlyph, CachedGlyp
     glyph->mBitmapWidth = skiaGlyph.fWidth;
     glyph->mBitmapHeight = skiaGlyph.fHeight;
 
-    uint32_t cacheWidth = glyph->mCachedTextureLine->mCacheTexture->mWidth;
-    uint32_t cacheHeight = glyph->mCachedTextureLine->mCacheTexture->mHeight;
+    uint32_t cacheWidth = glyph->mCacheTexture->mWidth;
+    uint32_t cacheHeight = glyph->mCacheTexture->mHeight;
 
     glyph->mBitmapMinU = (float) startX / (float) cacheWidth;
     glyph->mBitmapMinV = (float) startY / (float) cacheHeight;
@@ -433,6 +531,25 @@ CachedGlyphInfo* Font::cacheGlyph(SkPaint* paint, glyph_t glyph) {
     return newGlyph;
 }
 
+void Font::cachePrecachedGlyph(glyph_t glyph, const SkGlyph& skiaGlyph) {
+    CachedGlyphInfo* cachedGlyph;
+    ssize_t index = mCachedGlyphs.indexOfKey(glyph);
+    if (index >= 0) {
+        cachedGlyph = mCachedGlyphs.valueAt(index);
+        if (cachedGlyph->mIsValid) {
+            // Already drawn since it was requested
+            return;
+        }
+    } else {
+        cachedGlyph = new CachedGlyphInfo();
+        mCachedGlyphs.add(glyph, cachedGlyph);
+        cachedGlyph->mGlyphIndex = skiaGlyph.fID;
+        cachedGlyph->mIsValid = false;
+    }
+
+    updateGlyphCache(NULL, skiaGlyph, cachedGlyph);
+}
+
 Font* Font::create(FontRenderer* state, uint32_t fontId, float fontSize,
         int flags, uint32_t italicStyle, uint32_t scaleX,
         SkPaint::Style style, uint32_t strokeWidth) {
@@ -454,6 +571,109 @@ Font* Font::create(FontRenderer* state, uint32_t fontId, float fontSize,
     return newFont;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// GlyphPrecacheThread
+///////////////////////////////////////////////////////////////////////////////
+
+GlyphPrecacheThread::GlyphPrecacheThread(): Thread(false) {
+}
+
+GlyphPrecacheThread::~GlyphPrecacheThread() {
+    for (uint32_t i = 0; i < mRequests.size(); i++) {
+        delete mRequests[i];
+    }
+    for (uint32_t i = 0; i < mGlyphs.size(); i++) {
+        recycle(mGlyphs[i]);
+    }
+}
+
+void GlyphPrecacheThread::precache(Font* font, const SkPaint& paint,
+        const glyph_t* glyphs, uint32_t count) {
+    Request* request = new Request();
+    request->font = font;
+    request->paint = paint;
+    request->glyphs.appendArray(glyphs, count);
+
+    Mutex::Autolock _l(mLock);
+    mRequests.push(request);
+    mCondition.signal();
+}
+
+void GlyphPrecacheThread::collect(Vector<Glyph*>& glyphs) {
+    Mutex::Autolock _l(mLock);
+    glyphs.appendVector(mGlyphs);
+    mGlyphs.clear();
+}
+
+void GlyphPrecacheThread::quit() {
+    {
+        Mutex::Autolock _l(mLock);
+        for (uint32_t i = 0; i < mRequests.size(); i++) {
+            delete mRequests[i];
+        }
+        mRequests.clear();
+        requestExit();
+        mCondition.signal();
+    }
+    requestExitAndWait();
+}
+
+void GlyphPrecacheThread::recycle(Glyph* glyph) {
+    delete[] glyph->image;
+    delete glyph;
+}
+
+bool GlyphPrecacheThread::threadLoop() {
+    Request* request;
+    {
+        Mutex::Autolock _l(mLock);
+        while (mRequests.isEmpty()) {
+            if (exitPending()) {
+                return false;
+            }
+            mCondition.wait(mLock);
+        }
+        request = mRequests[0];
+        mRequests.removeAt(0);
+    }
+
+    // Keep the Skia glyph cache detached until every image is copied. The
+    // paint helpers attach it again after each call, and another thread may
+    // then purge the glyphs we still point into.
+    SkAutoGlyphCache autoCache(request->paint, NULL, true);
+    SkGlyphCache* cache = autoCache.getCache();
+
+    Vector<Glyph*> glyphs;
+    for (uint32_t i = 0; i < request->glyphs.size() && !exitPending(); i++) {
+        const glyph_t textUnit = request->glyphs[i];
+        const SkGlyph& skiaGlyph = GET_CACHE_METRICS(cache, textUnit);
+
+        Glyph* glyph = new Glyph();
+        glyph->font = request->font;
+        glyph->glyph = textUnit;
+        glyph->metrics = skiaGlyph;
+        glyph->image = NULL;
+
+        const void* image = cache->findImage(skiaGlyph);
+        if (image != NULL) {
+            const size_t size = skiaGlyph.rowBytes() * skiaGlyph.fHeight;
+            glyph->image = new uint8_t[size];
+            memcpy(glyph->image, image, size);
+        }
+        glyph->metrics.fImage = glyph->image;
+        glyph->metrics.fPath = NULL;
+
+        glyphs.push(glyph);
+    }
+    autoCache.release();
+
+    delete request;
+
+    Mutex::Autolock _l(mLock);
+    mGlyphs.appendVector(glyphs);
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // FontRenderer
 ///////////////////////////////////////////////////////////////////////////////
@@ -473,10 +693,10 @@ FontRenderer::FontRenderer() {
     mTextMeshPtr = NULL;
     mCurrentCacheTexture = NULL;
     mLastCacheTexture = NULL;
-    mCacheTextureSmall = NULL;
-    mCacheTexture128 = NULL;
-    mCacheTexture256 = NULL;
-    mCacheTexture512 = NULL;
+
+    mGeneration = 0;
+    mEvictionCount = 0;
+    mPrecachedGlyphCount = 0;
 
     mLinearFiltering = false;
 
@@ -512,10 +732,17 @@ FontRenderer::FontRenderer() {
 }
 
 FontRenderer::~FontRenderer() {
-    for (uint32_t i = 0; i < mCacheLines.size(); i++) {
-        delete mCacheLines[i];
+    // The precache thread refers to our fonts
+    if (mPrecacheThread != NULL) {
+        mPrecacheThread->quit();
+
+        Vector<GlyphPrecacheThread::Glyph*> glyphs;
+        mPrecacheThread->collect(glyphs);
+        for (uint32_t i = 0; i < glyphs.size(); i++) {
+            GlyphPrecacheThread::recycle(glyphs[i]);
+        }
+        mPrecacheThread.clear();
     }
-    mCacheLines.clear();
 
     if (mInitialized) {
         // Unbinding the buffer shouldn't be necessary but it crashes with some drivers
@@ -523,31 +750,60 @@ FontRenderer::~FontRenderer() {
         glDeleteBuffers(1, &mIndexBufferID);
 
         delete[] mTextMeshPtr;
-        delete mCacheTextureSmall;
-        delete mCacheTexture128;
-        delete mCacheTexture256;
-        delete mCacheTexture512;
     }
 
+    for (uint32_t i = 0; i < mCacheTextures.size(); i++) {
+        delete mCacheTextures[i];
+    }
+    mCacheTextures.clear();
+
     Vector<Font*> fontsToDereference = mActiveFonts;
     for (uint32_t i = 0; i < fontsToDereference.size(); i++) {
         delete fontsToDereference[i];
     }
 }
 
-void FontRenderer::flushAllAndInvalidate() {
+void FontRenderer::invalidateCacheTexture(CacheTexture* cacheTexture) {
+    for (uint32_t i = 0; i < mActiveFonts.size(); i++) {
+        mActiveFonts[i]->invalidateTextureCache(cacheTexture);
+    }
+    cacheTexture->reset();
+}
+
+CacheTexture* FontRenderer::evictCacheTexture(uint32_t width, uint32_t height) {
+    // Evict the least recently used page the glyph can fit in
+    CacheTexture* victim = NULL;
+    for (uint32_t i = 0; i < mCacheTextures.size(); i++) {
+        CacheTexture* cacheTexture = mCacheTextures[i];
+        if (width + TEXTURE_BORDER_SIZE > cacheTexture->mWidth ||
+                height + TEXTURE_BORDER_SIZE > cacheTexture->mHeight) {
+            continue;
+        }
+        if (victim == NULL || cacheTexture->mLastUsed < victim->mLastUsed) {
+            victim = cacheTexture;
+        }
+    }
+
+    if (victim == NULL) {
+        return NULL;
+    }
+
+    // Quads batched so far may sample from the victim
     if (mCurrentQuadIndex != 0) {
         issueDrawCommand();
         mCurrentQuadIndex = 0;
     }
 
-    for (uint32_t i = 0; i < mActiveFonts.size(); i++) {
-        mActiveFonts[i]->invalidateTextureCache();
-    }
+    invalidateCacheTexture(victim);
 
-    for (uint32_t i = 0; i < mCacheLines.size(); i++) {
-        mCacheLines[i]->mCurrentCol = 0;
+    // Clear the old glyphs so they don't bleed into the borders of the new ones
+    if (victim->mTexture != NULL) {
+        memset(victim->mTexture, 0, victim->mWidth * victim->mHeight);
+        victim->markDirty(0, victim->mHeight);
     }
+
+    mEvictionCount++;
+    return victim;
 }
 
 void FontRenderer::deallocateTextureMemory(CacheTexture *cacheTexture) {
@@ -560,39 +816,24 @@ void FontRenderer::deallocateTextureMemory(CacheTexture *cacheTexture) {
 }
 
 void FontRenderer::flushLargeCaches() {
-    if ((!mCacheTexture128 || !mCacheTexture128->mTexture) &&
-            (!mCacheTexture256 || !mCacheTexture256->mTexture) &&
-            (!mCacheTexture512 || !mCacheTexture512->mTexture)) {
-        // Typical case; no large glyph caches allocated
-        return;
-    }
-
-    for (uint32_t i = 0; i < mCacheLines.size(); i++) {
-        CacheTextureLine* cacheLine = mCacheLines[i];
-        if ((cacheLine->mCacheTexture == mCacheTexture128 ||
-                cacheLine->mCacheTexture == mCacheTexture256 ||
-                cacheLine->mCacheTexture == mCacheTexture512) &&
-                cacheLine->mCacheTexture->mTexture != NULL) {
-            cacheLine->mCurrentCol = 0;
-            for (uint32_t i = 0; i < mActiveFonts.size(); i++) {
-                mActiveFonts[i]->invalidateTextureCache(cacheLine);
-            }
+    // The first page stays, the others are allocated again when needed
+    for (uint32_t i = 1; i < mCacheTextures.size(); i++) {
+        CacheTexture* cacheTexture = mCacheTextures[i];
+        if (cacheTexture->mTexture != NULL) {
+            invalidateCacheTexture(cacheTexture);
+            deallocateTextureMemory(cacheTexture);
         }
     }
-
-    deallocateTextureMemory(mCacheTexture128);
-    deallocateTextureMemory(mCacheTexture256);
-    deallocateTextureMemory(mCacheTexture512);
 }
 
 void FontRenderer::allocateTextureMemory(CacheTexture* cacheTexture) {
     int width = cacheTexture->mWidth;
     int height = cacheTexture->mHeight;
 
+    // Glyph borders are never written, they must start out empty
     cacheTexture->mTexture = new uint8_t[width * height];
-#if DEBUG_FONT_RENDERER
     memset(cacheTexture->mTexture, 0, width * height * sizeof(uint8_t));
-#endif
+    cacheTexture->markDirty(0, height);
 
     if (!cacheTexture->mTextureId) {
         glGenTextures(1, &cacheTexture->mTextureId);
@@ -616,47 +857,38 @@ void FontRenderer::allocateTextureMemory(CacheTexture* cacheTexture) {
 void FontRenderer::cacheBitmap(const SkGlyph& glyph, CachedGlyphInfo* cachedGlyph,
         uint32_t* retOriginX, uint32_t* retOriginY) {
     cachedGlyph->mIsValid = false;
-    // If the glyph is too tall, don't cache it
-    if (glyph.fHeight + TEXTURE_BORDER_SIZE > mCacheLines[mCacheLines.size() - 1]->mMaxHeight) {
-        ALOGE("Font size to large to fit in cache. width, height = %i, %i",
-                (int) glyph.fWidth, (int) glyph.fHeight);
-        return;
-    }
 
     // Now copy the bitmap into the cache texture
     uint32_t startX = 0;
     uint32_t startY = 0;
 
-    bool bitmapFit = false;
-    CacheTextureLine *cacheLine;
-    for (uint32_t i = 0; i < mCacheLines.size(); i++) {
-        bitmapFit = mCacheLines[i]->fitBitmap(glyph, &startX, &startY);
-        if (bitmapFit) {
-            cacheLine = mCacheLines[i];
-            break;
-        }
-    }
-
-    // If the new glyph didn't fit, flush the state so far and invalidate everything
-    if (!bitmapFit) {
-        flushAllAndInvalidate();
-
-        // Try to fit it again
-        for (uint32_t i = 0; i < mCacheLines.size(); i++) {
-            bitmapFit = mCacheLines[i]->fitBitmap(glyph, &startX, &startY);
-            if (bitmapFit) {
-                cacheLine = mCacheLines[i];
+    // Try the pages in use first, then the ones not allocated yet
+    CacheTexture* cacheTexture = NULL;
+    for (int pass = 0; pass < 2 && cacheTexture == NULL; pass++) {
+        for (uint32_t i = 0; i < mCacheTextures.size(); i++) {
+            CacheTexture* page = mCacheTextures[i];
+            if ((page->mTexture != NULL) == (pass == 0) &&
+                    page->fitBitmap(glyph.fWidth, glyph.fHeight, &startX, &startY)) {
+                cacheTexture = page;
                 break;
             }
         }
+    }
 
-        // if we still don't fit, something is wrong and we shouldn't draw
-        if (!bitmapFit) {
+    // If the new glyph didn't fit, make room in the least recently used page
+    if (cacheTexture == NULL) {
+        cacheTexture = evictCacheTexture(glyph.fWidth, glyph.fHeight);
+
+        // If the glyph is too large for any page, don't cache it
+        if (cacheTexture == NULL ||
+                !cacheTexture->fitBitmap(glyph.fWidth, glyph.fHeight, &startX, &startY)) {
+            ALOGE("Font size to large to fit in cache. width, height = %i, %i",
+                    (int) glyph.fWidth, (int) glyph.fHeight);
             return;
         }
     }
 
-    cachedGlyph->mCachedTextureLine = cacheLine;
+    cachedGlyph->mCacheTexture = cacheTexture;
 
     *retOriginX = startX;
     *retOriginY = startY;
@@ -664,9 +896,8 @@ void FontRenderer::cacheBitmap(const SkGlyph& glyph, CachedGlyphInfo* cachedGlyp
     uint32_t endX = startX + glyph.fWidth;
     uint32_t endY = startY + glyph.fHeight;
 
-    uint32_t cacheWidth = cacheLine->mMaxWidth;
+    uint32_t cacheWidth = cacheTexture->mWidth;
 
-    CacheTexture* cacheTexture = cacheLine->mCacheTexture;
     if (!cacheTexture->mTexture) {
         // Large-glyph texture memory is allocated only as needed
         allocateTextureMemory(cacheTexture);
@@ -676,11 +907,14 @@ void FontRenderer::cacheBitmap(const SkGlyph& glyph, CachedGlyphInfo* cachedGlyp
     uint8_t* bitmapBuffer = (uint8_t*) glyph.fImage;
     unsigned int stride = glyph.rowBytes();
 
-    uint32_t cacheX = 0, bX = 0, cacheY = 0, bY = 0;
-    for (cacheX = startX, bX = 0; cacheX < endX; cacheX++, bX++) {
+    if (bitmapBuffer != NULL) {
+        uint32_t cacheX = 0, bX = 0, cacheY = 0, bY = 0;
         for (cacheY = startY, bY = 0; cacheY < endY; cacheY++, bY++) {
-            uint8_t tempCol = bitmapBuffer[bY * stride + bX];
-            cacheBuffer[cacheY * cacheWidth + cacheX] = mGammaTable[tempCol];
+            uint8_t* cacheRow = cacheBuffer + cacheY * cacheWidth;
+            const uint8_t* bitmapRow = bitmapBuffer + bY * stride;
+            for (cacheX = startX, bX = 0; cacheX < endX; cacheX++, bX++) {
+                cacheRow[cacheX] = mGammaTable[bitmapRow[bX]];
+            }
         }
     }
 
@@ -699,17 +933,10 @@ CacheTexture* FontRenderer::createCacheTexture(int width, int height, bool alloc
 }
 
 void FontRenderer::initTextTexture() {
-    for (uint32_t i = 0; i < mCacheLines.size(); i++) {
-        delete mCacheLines[i];
-    }
-    mCacheLines.clear();
-
-    if (mCacheTextureSmall) {
-        delete mCacheTextureSmall;
-        delete mCacheTexture128;
-        delete mCacheTexture256;
-        delete mCacheTexture512;
+    for (uint32_t i = 0; i < mCacheTextures.size(); i++) {
+        delete mCacheTextures[i];
     }
+    mCacheTextures.clear();
 
     // Next, use other, separate caches for large glyphs.
     uint16_t maxWidth = 0;
@@ -721,35 +948,14 @@ void FontRenderer::initTextTexture() {
         maxWidth = MAX_TEXT_CACHE_WIDTH;
     }
 
-    mCacheTextureSmall = createCacheTexture(mSmallCacheWidth, mSmallCacheHeight, true);
-    mCacheTexture128 = createCacheTexture(maxWidth, 256, false);
-    mCacheTexture256 = createCacheTexture(maxWidth, 256, false);
-    mCacheTexture512 = createCacheTexture(maxWidth, 512, false);
-    mCurrentCacheTexture = mCacheTextureSmall;
+    // Glyphs of any size are packed into the first page that has room
+    mCacheTextures.push(createCacheTexture(mSmallCacheWidth, mSmallCacheHeight, true));
+    mCacheTextures.push(createCacheTexture(maxWidth, 256, false));
+    mCacheTextures.push(createCacheTexture(maxWidth, 256, false));
+    mCacheTextures.push(createCacheTexture(maxWidth, 512, false));
+    mCurrentCacheTexture = mCacheTextures[0];
 
     mUploadTexture = false;
-    // Split up our default cache texture into lines of certain widths
-    int nextLine = 0;
-    mCacheLines.push(new CacheTextureLine(mSmallCacheWidth, 18, nextLine, 0, mCacheTextureSmall));
-    nextLine += mCacheLines.top()->mMaxHeight;
-    mCacheLines.push(new CacheTextureLine(mSmallCacheWidth, 26, nextLine, 0, mCacheTextureSmall));
-    nextLine += mCacheLines.top()->mMaxHeight;
-    mCacheLines.push(new CacheTextureLine(mSmallCacheWidth, 26, nextLine, 0, mCacheTextureSmall));
-    nextLine += mCacheLines.top()->mMaxHeight;
-    mCacheLines.push(new CacheTextureLine(mSmallCacheWidth, 34, nextLine, 0, mCacheTextureSmall));
-    nextLine += mCacheLines.top()->mMaxHeight;
-    mCacheLines.push(new CacheTextureLine(mSmallCacheWidth, 34, nextLine, 0, mCacheTextureSmall));
-    nextLine += mCacheLines.top()->mMaxHeight;
-    mCacheLines.push(new CacheTextureLine(mSmallCacheWidth, 42, nextLine, 0, mCacheTextureSmall));
-    nextLine += mCacheLines.top()->mMaxHeight;
-    mCacheLines.push(new CacheTextureLine(mSmallCacheWidth, mSmallCacheHeight - nextLine,
-            nextLine, 0, mCacheTextureSmall));
-
-    //  The first cache is split into 2 lines of height 128, the rest have just one cache line.
-    mCacheLines.push(new CacheTextureLine(maxWidth, 128, 0, 0, mCacheTexture128));
-    mCacheLines.push(new CacheTextureLine(maxWidth, 128, 128, 0, mCacheTexture128));
-    mCacheLines.push(new CacheTextureLine(maxWidth, 256, 0, 0, mCacheTexture256));
-    mCacheLines.push(new CacheTextureLine(maxWidth, 512, 0, 0, mCacheTexture512));
 }
 
 // Avoid having to reallocate memory and render quad by quad
@@ -804,15 +1010,14 @@ void FontRenderer::checkTextureUpdate() {
 
     Caches& caches = Caches::getInstance();
     GLuint lastTextureId = 0;
-    // Iterate over all the cache lines and see which ones need to be updated
-    for (uint32_t i = 0; i < mCacheLines.size(); i++) {
-        CacheTextureLine* cl = mCacheLines[i];
-        if (cl->mDirty && cl->mCacheTexture->mTexture != NULL) {
-            CacheTexture* cacheTexture = cl->mCacheTexture;
+    // Iterate over all the pages and upload the rows that changed
+    for (uint32_t i = 0; i < mCacheTextures.size(); i++) {
+        CacheTexture* cacheTexture = mCacheTextures[i];
+        if (cacheTexture->mDirty && cacheTexture->mTexture != NULL) {
             uint32_t xOffset = 0;
-            uint32_t yOffset = cl->mCurrentRow;
-            uint32_t width   = cl->mMaxWidth;
-            uint32_t height  = cl->mMaxHeight;
+            uint32_t yOffset = cacheTexture->mDirtyTop;
+            uint32_t width   = cacheTexture->mWidth;
+            uint32_t height  = cacheTexture->mDirtyBottom - cacheTexture->mDirtyTop;
             void* textureData = cacheTexture->mTexture + (yOffset * width);
 
             if (cacheTexture->mTextureId != lastTextureId) {
@@ -823,7 +1028,7 @@ void FontRenderer::checkTextureUpdate() {
             glTexSubImage2D(GL_TEXTURE_2D, 0, xOffset, yOffset, width, height,
                     GL_ALPHA, GL_UNSIGNED_BYTE, textureData);
 
-            cl->mDirty = false;
+            cacheTexture->mDirty = false;
         }
     }
 
@@ -943,21 +1148,39 @@ void FontRenderer::appendRotatedMeshQuad(float x1, float y1, float u1, float v1,
     }
 }
 
-uint32_t FontRenderer::getRemainingCacheCapacity() {
-    uint32_t remainingCapacity = 0;
-    float totalPixels = 0;
-    for(uint32_t i = 0; i < mCacheLines.size(); i ++) {
-         remainingCapacity += (mCacheLines[i]->mMaxWidth - mCacheLines[i]->mCurrentCol);
-         totalPixels += mCacheLines[i]->mMaxWidth;
+uint32_t FontRenderer::getCacheOccupancy() const {
+    uint32_t usedArea = 0;
+    uint32_t totalArea = 0;
+    for (uint32_t i = 0; i < mCacheTextures.size(); i++) {
+        CacheTexture* cacheTexture = mCacheTextures[i];
+        if (cacheTexture->mTexture != NULL) {
+            usedArea += cacheTexture->getUsedArea();
+            totalArea += cacheTexture->mWidth * cacheTexture->mHeight;
+        }
+    }
+    return totalArea > 0 ? (uint64_t) usedArea * 100 / totalArea : 0;
+}
+
+void FontRenderer::getCacheStats(CacheStats& stats) const {
+    memset(&stats, 0, sizeof(CacheStats));
+    for (uint32_t i = 0; i < mCacheTextures.size(); i++) {
+        CacheTexture* cacheTexture = mCacheTextures[i];
+        if (cacheTexture->mTexture != NULL) {
+            stats.pageCount++;
+            stats.allocatedBytes += cacheTexture->mWidth * cacheTexture->mHeight;
+            stats.usedBytes += cacheTexture->getUsedArea();
+            stats.glyphCount += cacheTexture->getGlyphCount();
+        }
     }
-    remainingCapacity = (remainingCapacity * 100) / totalPixels;
-    return remainingCapacity;
+    stats.evictionCount = mEvictionCount;
+    stats.precachedGlyphCount = mPrecachedGlyphCount;
 }
 
 void FontRenderer::precacheLatin(SkPaint* paint) {
-    // Remaining capacity is measured in %
-    uint32_t remainingCapacity = getRemainingCacheCapacity();
-    uint32_t precacheIndex = 0;
+    // Only warm up the cache while it has room to spare
+    if (getCacheOccupancy() > MAX_PRECACHE_OCCUPANCY) {
+        return;
+    }
 
     // We store a string with letters in a rough frequency of occurrence
     String16 l("eisarntolcdugpmhbyfvkwzxjq EISARNTOLCDUGPMHBYFVKWZXJQ,.?!()-+@;:'0123456789");
@@ -966,10 +1189,34 @@ void FontRenderer::precacheLatin(SkPaint* paint) {
     uint16_t latin[size];
     paint->utfToGlyphs(l.string(), SkPaint::kUTF16_TextEncoding, size * sizeof(char16_t), latin);
 
-    while (remainingCapacity > 25 && precacheIndex < size) {
-        mCurrentFont->getCachedGlyph(paint, TO_GLYPH(latin[precacheIndex]));
-        remainingCapacity = getRemainingCacheCapacity();
-        precacheIndex++;
+    glyph_t glyphs[size];
+    for (size_t i = 0; i < size; i++) {
+        glyphs[i] = TO_GLYPH(latin[i]);
+    }
+
+    if (mPrecacheThread == NULL) {
+        mPrecacheThread = new GlyphPrecacheThread();
+        mPrecacheThread->run("hwuiGlyphPrecache", PRIORITY_BACKGROUND);
+    }
+    mPrecacheThread->precache(mCurrentFont, *paint, glyphs, size);
+}
+
+void FontRenderer::flushPrecachedGlyphs() {
+    if (mPrecacheThread == NULL) {
+        return;
+    }
+
+    Vector<GlyphPrecacheThread::Glyph*> glyphs;
+    mPrecacheThread->collect(glyphs);
+
+    for (uint32_t i = 0; i < glyphs.size(); i++) {
+        GlyphPrecacheThread::Glyph* glyph = glyphs[i];
+        // Never evict glyphs in use for glyphs that may not be drawn
+        if (getCacheOccupancy() <= MAX_PRECACHE_OCCUPANCY) {
+            glyph->font->cachePrecachedGlyph(glyph->glyph, glyph->metrics);
+            mPrecachedGlyphCount++;
+        }
+        GlyphPrecacheThread::recycle(glyph);
     }
 }
 
@@ -1012,6 +1259,7 @@ FontRenderer::DropShadow FontRenderer::renderDropShadow(SkPaint* paint, const ch
         return image;
     }
 
+    mGeneration++;
     mDrawn = false;
     mClip = NULL;
     mBounds = NULL;
@@ -1046,7 +1294,9 @@ FontRenderer::DropShadow FontRenderer::renderDropShadow(SkPaint* paint, const ch
 
 void FontRenderer::initRender(const Rect* clip, Rect* bounds) {
     checkInit();
+    flushPrecachedGlyphs();
 
+    mGeneration++;
     mDrawn = false;
     mBounds = bounds;
     mClip = clip;
@@ -17,8 +17,11 @@
 #ifndef ANDROID_HWUI_FONT_RENDERER_H
 #define ANDROID_HWUI_FONT_RENDERER_H
 
+#include <utils/Condition.h>
+#include <utils/Mutex.h>
 #include <utils/String8.h>
 #include <utils/String16.h>
+#include <utils/Thread.h>
 #include <utils/Vector.h>
 #include <utils/KeyedVector.h>
 
@@ -43,12 +46,14 @@ namespace uirenderer {
     typedef uint16_t glyph_t;
     #define TO_GLYPH(g) g
     #define GET_METRICS(paint, glyph) paint->getGlyphMetrics(glyph)
+    #define GET_CACHE_METRICS(cache, glyph) cache->getGlyphIDMetrics(glyph)
     #define GET_GLYPH(text) nextGlyph((const uint16_t**) &text)
     #define IS_END_OF_STRING(glyph) false
 #else
     typedef SkUnichar glyph_t;
     #define TO_GLYPH(g) ((SkUnichar) g)
     #define GET_METRICS(paint, glyph) paint->getUnicharMetrics(glyph)
+    #define GET_CACHE_METRICS(cache, glyph) cache->getUnicharMetrics(glyph)
     #define GET_GLYPH(text) SkUTF16_NextUnichar((const uint16_t**) &text)
     #define IS_END_OF_STRING(glyph) glyph < 0
 #endif
@@ -59,12 +64,20 @@ namespace uirenderer {
 
 class FontRenderer;
 
+/**
+ * A page of the glyph atlas. Glyphs are packed with a skyline (bottom-left)
+ * allocator, which keeps glyphs of mixed sizes tightly packed instead of
+ * wasting the height of fixed rows. A page is evicted as a whole when the
+ * atlas is full; it is never partially freed.
+ */
 class CacheTexture {
 public:
-    CacheTexture() { }
     CacheTexture(uint8_t* texture, uint16_t width, uint16_t height) :
             mTexture(texture), mTextureId(0), mWidth(width), mHeight(height),
-            mLinearFiltering(false) { }
+            mLinearFiltering(false), mDirty(false), mDirtyTop(0), mDirtyBottom(0),
+            mLastUsed(0), mUsedArea(0), mGlyphCount(0) {
+        reset();
+    }
     ~CacheTexture() {
         if (mTexture) {
             delete[] mTexture;
@@ -74,33 +87,68 @@ public:
         }
     }
 
+    /**
+     * Finds room for a width x height bitmap plus its border. Returns false
+     * if the page is too full.
+     */
+    bool fitBitmap(uint32_t width, uint32_t height, uint32_t* retOriginX, uint32_t* retOriginY);
+
+    /**
+     * Forgets every glyph packed in this page. The caller must invalidate
+     * the glyphs that pointed into it.
+     */
+    void reset();
+
+    /**
+     * Marks rows [top, bottom) as needing an upload.
+     */
+    void markDirty(uint32_t top, uint32_t bottom) {
+        if (!mDirty) {
+            mDirtyTop = top;
+            mDirtyBottom = bottom;
+            mDirty = true;
+        } else {
+            if (top < mDirtyTop) mDirtyTop = top;
+            if (bottom > mDirtyBottom) mDirtyBottom = bottom;
+        }
+    }
+
+    uint32_t getUsedArea() const {
+        return mUsedArea;
+    }
+
+    uint32_t getGlyphCount() const {
+        return mGlyphCount;
+    }
+
     uint8_t* mTexture;
     GLuint mTextureId;
     uint16_t mWidth;
     uint16_t mHeight;
     bool mLinearFiltering;
-};
 
-class CacheTextureLine {
-public:
-    CacheTextureLine(uint16_t maxWidth, uint16_t maxHeight, uint32_t currentRow,
-            uint32_t currentCol, CacheTexture* cacheTexture):
-                mMaxHeight(maxHeight),
-                mMaxWidth(maxWidth),
-                mCurrentRow(currentRow),
-                mCurrentCol(currentCol),
-                mDirty(false),
-                mCacheTexture(cacheTexture) {
-    }
+    // Rows modified since the last upload
+    bool mDirty;
+    uint32_t mDirtyTop;
+    uint32_t mDirtyBottom;
+
+    // Generation of the last draw that used a glyph of this page, for LRU eviction
+    uint32_t mLastUsed;
+
+private:
+    // A horizontal segment of the skyline: the page is filled up to y over [x, x + width)
+    struct SkylineNode {
+        int32_t x;
+        int32_t y;
+        int32_t width;
+    };
 
-    bool fitBitmap(const SkGlyph& glyph, uint32_t *retOriginX, uint32_t *retOriginY);
+    int32_t fitsAt(size_t index, int32_t width, int32_t height) const;
+    void addSkylineLevel(size_t index, int32_t x, int32_t y, int32_t width, int32_t height);
 
-    uint16_t mMaxHeight;
-    uint16_t mMaxWidth;
-    uint32_t mCurrentRow;
-    uint32_t mCurrentCol;
-    bool mDirty;
-    CacheTexture* mCacheTexture;
+    Vector<SkylineNode> mSkyline;
+    uint32_t mUsedArea;
+    uint32_t mGlyphCount;
 };
 
 struct CachedGlyphInfo {
@@ -128,7 +176,7 @@ struct CachedGlyphInfo {
     // Auto-kerning
     SkFixed mLsbDelta;
     SkFixed mRsbDelta;
-    CacheTextureLine* mCachedTextureLine;
+    CacheTexture* mCacheTexture;
 };
 
 
@@ -193,9 +241,10 @@ protected:
     // Cache of glyphs
     DefaultKeyedVector<glyph_t, CachedGlyphInfo*> mCachedGlyphs;
 
-    void invalidateTextureCache(CacheTextureLine *cacheLine = NULL);
+    void invalidateTextureCache(CacheTexture* cacheTexture = NULL);
 
     CachedGlyphInfo* cacheGlyph(SkPaint* paint, glyph_t glyph);
+    void cachePrecachedGlyph(glyph_t glyph, const SkGlyph& skiaGlyph);
     void updateGlyphCache(SkPaint* paint, const SkGlyph& skiaGlyph, CachedGlyphInfo* glyph);
 
     void measureCachedGlyph(CachedGlyphInfo* glyph, int x, int y,
@@ -229,6 +278,61 @@ protected:
     uint32_t mStrokeWidth = 0;
 };
 
+///////////////////////////////////////////////////////////////////////////////
+// Precaching
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Rasterizes glyphs on a background thread before they are drawn. The images
+ * are copied into the atlas on the GL thread by the FontRenderer, which then
+ * only costs a copy instead of a rasterization.
+ */
+class GlyphPrecacheThread: public Thread {
+public:
+    struct Glyph {
+        Font* font;
+        glyph_t glyph;
+        // fImage points to image
+        SkGlyph metrics;
+        uint8_t* image;
+    };
+
+    GlyphPrecacheThread();
+    virtual ~GlyphPrecacheThread();
+
+    /**
+     * Queues glyphs of the specified font for rasterization with a copy of paint.
+     */
+    void precache(Font* font, const SkPaint& paint, const glyph_t* glyphs, uint32_t count);
+
+    /**
+     * Moves the glyphs rasterized so far to the end of glyphs. The caller
+     * must release each one with recycle().
+     */
+    void collect(Vector<Glyph*>& glyphs);
+
+    /**
+     * Drops all queued requests and waits for the thread to exit.
+     */
+    void quit();
+
+    static void recycle(Glyph* glyph);
+
+private:
+    struct Request {
+        Font* font;
+        SkPaint paint;
+        Vector<glyph_t> glyphs;
+    };
+
+    virtual bool threadLoop();
+
+    Mutex mLock;
+    Condition mCondition;
+    Vector<Request*> mRequests;
+    Vector<Glyph*> mGlyphs;
+};
+
 ///////////////////////////////////////////////////////////////////////////////
 // Renderer
 ///////////////////////////////////////////////////////////////////////////////
@@ -244,6 +348,17 @@ public:
         mGammaTable = gammaTable;
     }
 
+    /**
+     * Sets the size of the first cache page. Ignored once the renderer
+     * has drawn text, the page is already allocated.
+     */
+    void setCacheSize(uint32_t width, uint32_t height) {
+        if (!mInitialized) {
+            mSmallCacheWidth = width;
+            mSmallCacheHeight = height;
+        }
+    }
+
     void setFont(SkPaint* paint, uint32_t fontId, float fontSize);
     // bounds is an out parameter
     bool renderText(SkPaint* paint, const Rect* clip, const char *text, uint32_t startIndex,
@@ -294,21 +409,30 @@ public:
 
     uint32_t getCacheSize() const {
         uint32_t size = 0;
-        if (mCacheTextureSmall != NULL && mCacheTextureSmall->mTexture != NULL) {
-            size += mCacheTextureSmall->mWidth * mCacheTextureSmall->mHeight;
-        }
-        if (mCacheTexture128 != NULL && mCacheTexture128->mTexture != NULL) {
-            size += mCacheTexture128->mWidth * mCacheTexture128->mHeight;
-        }
-        if (mCacheTexture256 != NULL && mCacheTexture256->mTexture != NULL) {
-            size += mCacheTexture256->mWidth * mCacheTexture256->mHeight;
-        }
-        if (mCacheTexture512 != NULL && mCacheTexture512->mTexture != NULL) {
-            size += mCacheTexture512->mWidth * mCacheTexture512->mHeight;
+        for (uint32_t i = 0; i < mCacheTextures.size(); i++) {
+            CacheTexture* cacheTexture = mCacheTextures[i];
+            if (cacheTexture->mTexture != NULL) {
+                size += cacheTexture->mWidth * cacheTexture->mHeight;
+            }
         }
         return size;
     }
 
+    struct CacheStats {
+        // Pages with allocated memory
+        uint32_t pageCount;
+        uint32_t allocatedBytes;
+        // Area covered by packed glyphs, borders included
+        uint32_t usedBytes;
+        uint32_t glyphCount;
+        // Pages dropped to make room for new glyphs
+        uint32_t evictionCount;
+        // Glyphs rasterized by the precache thread
+        uint32_t precachedGlyphCount;
+    };
+
+    void getCacheStats(CacheStats& stats) const;
+
 protected:
     friend class Font;
 
@@ -320,8 +444,9 @@ protected:
     CacheTexture* createCacheTexture(int width, int height, bool allocate);
     void cacheBitmap(const SkGlyph& glyph, CachedGlyphInfo* cachedGlyph,
             uint32_t *retOriginX, uint32_t *retOriginY);
+    CacheTexture* evictCacheTexture(uint32_t width, uint32_t height);
+    void invalidateCacheTexture(CacheTexture* cacheTexture);
 
-    void flushAllAndInvalidate();
     void initVertexArrayBuffers();
 
     void checkInit();
@@ -329,6 +454,7 @@ protected:
     void finishRender();
 
     void precacheLatin(SkPaint* paint);
+    void flushPrecachedGlyphs();
 
     void issueDrawCommand();
     void appendMeshQuadNoClip(float x1, float y1, float u1, float v1,
@@ -347,18 +473,23 @@ protected:
     uint32_t mSmallCacheWidth;
     uint32_t mSmallCacheHeight;
 
-    Vector<CacheTextureLine*> mCacheLines;
-    uint32_t getRemainingCacheCapacity();
+    // Occupancy of the allocated pages, in %
+    uint32_t getCacheOccupancy() const;
 
     Font* mCurrentFont;
     Vector<Font*> mActiveFonts;
 
     CacheTexture* mCurrentCacheTexture;
     CacheTexture* mLastCacheTexture;
-    CacheTexture* mCacheTextureSmall;
-    CacheTexture* mCacheTexture128;
-    CacheTexture* mCacheTexture256;
-    CacheTexture* mCacheTexture512;
+    // The first page is always allocated, the others only when needed
+    Vector<CacheTexture*> mCacheTextures;
+
+    // Incremented for every draw, stamped on the pages it uses
+    uint32_t mGeneration;
+    uint32_t mEvictionCount;
+    uint32_t mPrecachedGlyphCount;
+
+    mindroid::sp<GlyphPrecacheThread> mPrecacheThread;
 
     void checkTextureUpdate();
     bool mUploadTexture;
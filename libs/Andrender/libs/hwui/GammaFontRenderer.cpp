@@ -78,6 +78,9 @@ GammaFontRenderer::GammaFontRenderer() {
         mGammaTable[512 + i] = uint8_t((float)::floor(white * 255.0f + 0.5f));
     }
 
+    mCacheWidth = 0;
+    mCacheHeight = 0;
+
     memset(mRenderers, 0, sizeof(FontRenderer*) * kGammaCount);
     memset(mRenderersUsageCount, 0, sizeof(uint32_t) * kGammaCount);
 }
@@ -123,12 +126,23 @@ void GammaFontRenderer::flush() {
     }
 }
 
+void GammaFontRenderer::setCacheSize(uint32_t width, uint32_t height) {
+    if (width == mCacheWidth && height == mCacheHeight) return;
+
+    mCacheWidth = width;
+    mCacheHeight = height;
+    clear();
+}
+
 FontRenderer* GammaFontRenderer::getRenderer(Gamma gamma) {
     FontRenderer* renderer = mRenderers[gamma];
     if (!renderer) {
         renderer = new FontRenderer();
         mRenderers[gamma] = renderer;
         renderer->setGammaTable(&mGammaTable[gamma * 256]);
+        if (mCacheWidth > 0 && mCacheHeight > 0) {
+            renderer->setCacheSize(mCacheWidth, mCacheHeight);
+        }
     }
     mRenderersUsageCount[gamma]++;
     return renderer;
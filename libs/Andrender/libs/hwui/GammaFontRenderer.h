@@ -38,6 +38,13 @@ struct GammaFontRenderer {
     void clear();
     void flush();
 
+    /**
+     * Sets the size of the first cache page of the font renderers. The
+     * renderers are dropped when the size changes and created again with
+     * the new size when text is drawn.
+     */
+    void setCacheSize(uint32_t width, uint32_t height);
+
     FontRenderer& getFontRenderer(const SkPaint* paint);
 
     uint32_t getFontRendererCount() const {
@@ -53,6 +60,16 @@ struct GammaFontRenderer {
         return renderer->getCacheSize();
     }
 
+    bool getFontRendererStats(uint32_t fontRenderer, FontRenderer::CacheStats& stats) const {
+        if (fontRenderer >= kGammaCount) return false;
+
+        FontRenderer* renderer = mRenderers[fontRenderer];
+        if (!renderer) return false;
+
+        renderer->getCacheStats(stats);
+        return true;
+    }
+
 private:
     FontRenderer* getRenderer(Gamma gamma);
 
@@ -62,6 +79,10 @@ private:
     int mBlackThreshold;
     int mWhiteThreshold;
 
+    // 0 when the renderers use their default size
+    uint32_t mCacheWidth;
+    uint32_t mCacheHeight;
+
     uint8_t mGammaTable[256 * kGammaCount];
 };
 
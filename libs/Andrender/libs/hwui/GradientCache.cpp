@@ -36,7 +36,7 @@ namespace uirenderer {
 
 GradientCache::GradientCache():
         mCache(GenerationCache<GradientCacheEntry, Texture*>::kUnlimitedCapacity),
-        mSize(0), mMaxSize(MB(DEFAULT_GRADIENT_CACHE_SIZE)) {
+        mSize(0), mMaxSize(MB(DEFAULT_GRADIENT_CACHE_SIZE)), mEvictionCount(0) {
     char property[PROPERTY_VALUE_MAX];
     if (property_get(PROPERTY_GRADIENT_CACHE_SIZE, property, NULL) > 0) {
         INIT_LOGD("  Setting gradient cache size to %sMB", property);
@@ -50,7 +50,7 @@ GradientCache::GradientCache():
 
 GradientCache::GradientCache(uint32_t maxByteSize):
         mCache(GenerationCache<GradientCacheEntry, Texture*>::kUnlimitedCapacity),
-        mSize(0), mMaxSize(maxByteSize) {
+        mSize(0), mMaxSize(maxByteSize), mEvictionCount(0) {
     mCache.setOnEntryRemovedListener(this);
 }
 
@@ -74,6 +74,7 @@ void GradientCache::setMaxSize(uint32_t maxSize) {
     mMaxSize = maxSize;
     while (mSize > mMaxSize) {
         mCache.removeOldest();
+        mEvictionCount++;
     }
 }
 
@@ -140,6 +141,7 @@ Texture* GradientCache::addLinearGradient(GradientCacheEntry& gradient,
     const uint32_t size = bitmap.rowBytes() * bitmap.height();
     while (mSize + size > mMaxSize) {
         mCache.removeOldest();
+        mEvictionCount++;
     }
 
     Texture* texture = new Texture;
@@ -135,6 +135,12 @@ public:
      * Returns the current size of the cache in bytes.
      */
     uint32_t getSize();
+    /**
+     * Returns the number of entries removed to make room for new ones.
+     */
+    uint32_t getEvictionCount() const {
+        return mEvictionCount;
+    }
 
 private:
     /**
@@ -151,6 +157,7 @@ private:
 
     uint32_t mSize;
     uint32_t mMaxSize;
+    uint32_t mEvictionCount;
 
     Vector<SkShader*> mGarbage;
     mutable Mutex mLock;
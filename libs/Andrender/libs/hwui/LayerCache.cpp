@@ -32,7 +32,8 @@ namespace uirenderer {
 // Constructors/destructor
 ///////////////////////////////////////////////////////////////////////////////
 
-LayerCache::LayerCache(): mSize(0), mMaxSize(MB(DEFAULT_LAYER_CACHE_SIZE)) {
+LayerCache::LayerCache(): mSize(0), mMaxSize(MB(DEFAULT_LAYER_CACHE_SIZE)),
+        mEvictionCount(0) {
     char property[PROPERTY_VALUE_MAX];
     if (property_get(PROPERTY_LAYER_CACHE_SIZE, property, NULL) > 0) {
         INIT_LOGD("  Setting layer cache size to %sMB", property);
@@ -173,6 +174,7 @@ bool LayerCache::put(Layer* layer) {
             Layer* victim = mCache.itemAt(position).mLayer;
             deleteLayer(victim);
             mCache.removeAt(position);
+            mEvictionCount++;
 
             LAYER_LOGD("  Deleting layer %.2fx%.2f", victim->layer.getWidth(),
                     victim->layer.getHeight());
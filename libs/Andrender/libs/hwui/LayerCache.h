@@ -96,6 +96,12 @@ public:
      * Returns the current size of the cache in bytes.
      */
     uint32_t getSize();
+    /**
+     * Returns the number of entries removed to make room for new ones.
+     */
+    uint32_t getEvictionCount() const {
+        return mEvictionCount;
+    }
 
     /**
      * Prints out the content of the cache.
@@ -139,6 +145,7 @@ private:
 
     uint32_t mSize;
     uint32_t mMaxSize;
+    uint32_t mEvictionCount;
 }; // class LayerCache
 
 }; // namespace uirenderer
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "OpenGLRenderer"
+
+#include <math.h>
+
+#include <SkRegion.h>
+
+#include "OcclusionTracker.h"
+#include "Snapshot.h"
+
+namespace android {
+namespace uirenderer {
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructors
+///////////////////////////////////////////////////////////////////////////////
+
+OcclusionTracker::OcclusionTracker(): mRecording(false) {
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Recording
+///////////////////////////////////////////////////////////////////////////////
+
+void OcclusionTracker::begin() {
+    mOps.clear();
+    mCulled.clear();
+    mRecording = true;
+}
+
+void OcclusionTracker::toIRect(const Rect& r, SkIRect& ir) {
+    if (r.isEmpty()) {
+        ir.setEmpty();
+    } else {
+        ir.set((int32_t) r.left, (int32_t) r.top, (int32_t) r.right, (int32_t) r.bottom);
+    }
+}
+
+void OcclusionTracker::add(const void* op, const Rect& bounds, const Rect& opaqueBounds) {
+    Op entry;
+    entry.key = op;
+    toIRect(bounds, entry.bounds);
+    toIRect(opaqueBounds, entry.opaqueBounds);
+    entry.bounded = true;
+    mOps.add(entry);
+}
+
+void OcclusionTracker::addUnbounded(const void* op) {
+    Op entry;
+    entry.key = op;
+    entry.bounds.setEmpty();
+    entry.opaqueBounds.setEmpty();
+    entry.bounded = false;
+    mOps.add(entry);
+}
+
+void OcclusionTracker::end() {
+    mRecording = false;
+
+    SkRegion covered;
+    SortedVector<const void*> drawn;
+
+    // Back to front: an op is hidden if the opaque ops after it cover it
+    for (ssize_t i = mOps.size() - 1; i >= 0; i--) {
+        const Op& op = mOps.itemAt(i);
+        if (op.bounded && (op.bounds.isEmpty() || covered.contains(op.bounds))) {
+            mCulled.add(op.key);
+        } else {
+            drawn.add(op.key);
+            if (!op.opaqueBounds.isEmpty()) {
+                covered.op(op.opaqueBounds, SkRegion::kUnion_Op);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < drawn.size() && !mCulled.isEmpty(); i++) {
+        mCulled.remove(drawn.itemAt(i));
+    }
+
+    mOps.clear();
+}
+
+void OcclusionTracker::clear() {
+    mCulled.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Bounds
+///////////////////////////////////////////////////////////////////////////////
+
+void OcclusionTracker::getBounds(const Snapshot& snapshot, float left, float top,
+        float right, float bottom, int alpha, SkXfermode::Mode mode, bool opaque,
+        Rect& bounds, Rect& opaqueBounds) {
+    Rect clip(*snapshot.clipRect);
+    clip.snapToPixelBoundaries();
+
+    bounds.set(left, top, right, bottom);
+    snapshot.transform->mapRect(bounds);
+
+    if ((snapshot.flags & Snapshot::kFlagInLayer) || !snapshot.transform->isSimple() ||
+            snapshot.isIgnored() || snapshot.alpha < 1.0f) {
+        opaque = false;
+    } else if (mode != SkXfermode::kSrc_Mode) {
+        opaque = opaque && mode == SkXfermode::kSrcOver_Mode && alpha >= 255;
+    }
+
+    // Pixels entirely covered by the op
+    opaqueBounds.setEmpty();
+    if (opaque) {
+        opaqueBounds.set(ceilf(bounds.left - 0.01f), ceilf(bounds.top - 0.01f),
+                floorf(bounds.right + 0.01f), floorf(bounds.bottom + 0.01f));
+        if (!opaqueBounds.intersect(clip)) {
+            opaqueBounds.setEmpty();
+        }
+    }
+
+    // Pixels touched by the op, antialiasing included
+    bounds.set(floorf(bounds.left) - 1.0f, floorf(bounds.top) - 1.0f,
+            ceilf(bounds.right) + 1.0f, ceilf(bounds.bottom) + 1.0f);
+    if (snapshot.isIgnored() || !bounds.intersect(clip)) {
+        bounds.setEmpty();
+    }
+}
+
+}; // namespace uirenderer
+}; // namespace android
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_HWUI_OCCLUSION_TRACKER_H
+#define ANDROID_HWUI_OCCLUSION_TRACKER_H
+
+#include <SkRect.h>
+#include <SkXfermode.h>
+
+#include <utils/SortedVector.h>
+#include <utils/Vector.h>
+
+#include "Rect.h"
+
+namespace android {
+namespace uirenderer {
+
+class Snapshot;
+
+///////////////////////////////////////////////////////////////////////////////
+// Classes
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Finds the draw ops of a frame hidden behind the opaque ops drawn after
+ * them. The display lists of the frame are replayed once without drawing,
+ * recording the window bounds of each op, then walked back to front while
+ * accumulating the area covered by opaque ops.
+ *
+ * Ops are identified by their address in their display list. An op
+ * replayed more than once in a frame is culled only if it is hidden every
+ * time.
+ */
+class OcclusionTracker {
+public:
+    OcclusionTracker();
+
+    /**
+     * Starts recording the ops of a frame.
+     */
+    void begin();
+
+    /**
+     * Records an op.
+     *
+     * @param op Identifies the op
+     * @param bounds The pixels the op may touch, in window coordinates,
+     *        empty if it draws nothing
+     * @param opaqueBounds The pixels the op replaces with opaque pixels,
+     *        in window coordinates, can be empty
+     */
+    void add(const void* op, const Rect& bounds, const Rect& opaqueBounds);
+
+    /**
+     * Records an op whose bounds are not known. Such an op is never culled.
+     */
+    void addUnbounded(const void* op);
+
+    /**
+     * Stops recording and finds the culled ops.
+     */
+    void end();
+
+    /**
+     * Forgets the culled ops.
+     */
+    void clear();
+
+    /**
+     * Indicates whether ops are being recorded.
+     */
+    bool isRecording() const {
+        return mRecording;
+    }
+
+    /**
+     * Indicates whether the specified op is hidden.
+     */
+    bool isCulled(const void* op) const {
+        return !mCulled.isEmpty() && mCulled.indexOf(op) >= 0;
+    }
+
+    /**
+     * Returns the number of ops found hidden by the last call to end().
+     */
+    size_t getCulledCount() const {
+        return mCulled.size();
+    }
+
+    /**
+     * Computes the window bounds of an op drawn in the specified snapshot.
+     * Only ops drawn opaque, outside of layers and with a transform that
+     * keeps them axis aligned hide the ops below them: the content of
+     * layers is blended when they are composed, and the window bounds of
+     * rotated ops are not exact.
+     *
+     * @param left, top, right, bottom The bounds of the op in local coordinates
+     * @param alpha, mode How the op is blended
+     * @param opaque True if the op fills its bounds with opaque pixels
+     * @param bounds Receives the pixels the op may touch, antialiasing
+     *        included, empty if the op is clipped out
+     * @param opaqueBounds Receives the pixels the op replaces with opaque
+     *        pixels, empty if it replaces none
+     */
+    static void getBounds(const Snapshot& snapshot, float left, float top,
+            float right, float bottom, int alpha, SkXfermode::Mode mode, bool opaque,
+            Rect& bounds, Rect& opaqueBounds);
+
+private:
+    struct Op {
+        const void* key;
+        SkIRect bounds;
+        SkIRect opaqueBounds;
+        bool bounded;
+    }; // struct Op
+
+    static void toIRect(const Rect& r, SkIRect& ir);
+
+    Vector<Op> mOps;
+    SortedVector<const void*> mCulled;
+    bool mRecording;
+}; // class OcclusionTracker
+
+}; // namespace uirenderer
+}; // namespace android
+
+#endif // ANDROID_HWUI_OCCLUSION_TRACKER_H
@@ -113,6 +113,8 @@ OpenGLRenderer::OpenGLRenderer(): mCaches(Caches::getInstance()) {
     mColorFilter = NULL;
     mHasShadow = false;
     mHasDrawFilter = false;
+    mCountOverdraw = false;
+    mOverdrawRatio = 0.0f;
 
     memcpy(mMeshVertices, gMeshVertices, sizeof(gMeshVertices));
 
@@ -179,6 +181,13 @@ int OpenGLRenderer::prepareDirty(float left, float top, float right, float botto
     mSnapshot->setClip(left, top, right, bottom);
     mDirtyClip = opaque;
 
+    // Layers are drawn in their own frames, only the window is counted
+    mCountOverdraw = mCaches.getDebugOverdraw() != kDebugOverdrawDisabled &&
+            getTargetFbo() == 0;
+    if (mCountOverdraw) {
+        mOverdraw.reset(mWidth, mHeight, Rect(left, top, right, bottom));
+    }
+
     syncState();
 
     if (!opaque) {
@@ -203,6 +212,15 @@ void OpenGLRenderer::syncState() {
 }
 
 void OpenGLRenderer::finish() {
+    if (mCountOverdraw) {
+        mOverdrawRatio = mOverdraw.getRatio();
+        ALOGD("Overdraw: %.2fx", mOverdrawRatio);
+        if (mCaches.getDebugOverdraw() == kDebugOverdrawShow) {
+            drawOverdraw();
+        }
+        mCountOverdraw = false;
+    }
+
 #if DEBUG_OPENGL
     GLenum status = GL_NO_ERROR;
     while ((status = glGetError()) != GL_NO_ERROR) {
@@ -421,6 +439,12 @@ int OpenGLRenderer::saveLayer(float left, float top, float right, float bottom,
         SkPaint* p, int flags) {
     const GLuint previousFbo = mSnapshot->fbo;
     const int count = saveSnapshot(flags);
+    mSnapshot->flags |= Snapshot::kFlagInLayer;
+
+    // Only the state matters while the ops are recorded
+    if (mOcclusion.isRecording()) {
+        return count;
+    }
 
     if (!mSnapshot->isIgnored()) {
         int alpha = 255;
@@ -1138,6 +1162,10 @@ void OpenGLRenderer::setupDrawAALine() {
     mDescription.isAA = true;
 }
 
+void OpenGLRenderer::setupDrawVertexAlpha() {
+    mDescription.hasVertexAlpha = true;
+}
+
 void OpenGLRenderer::setupDrawPoint(float pointSize) {
     mDescription.isPoint = true;
     mDescription.pointSize = pointSize;
@@ -1419,7 +1447,18 @@ status_t OpenGLRenderer::drawDisplayList(DisplayList* displayList,
     // All the usual checks and setup operations (quickReject, setupDraw, etc.)
     // will be performed by the display list itself
     if (displayList && displayList->isRenderable()) {
-        return displayList->replay(*this, dirty, flags, level);
+        if (level > 0 || mOcclusion.isRecording() || !mCaches.isOcclusionCullingEnabled()) {
+            return displayList->replay(*this, dirty, flags, level);
+        }
+
+        // Replays the whole tree once without drawing to find the hidden ops
+        mOcclusion.begin();
+        displayList->replay(*this, dirty, flags, level);
+        mOcclusion.end();
+
+        status_t status = displayList->replay(*this, dirty, flags, level);
+        mOcclusion.clear();
+        return status;
     }
 
     return DrawGlInfo::kStatusDone;
@@ -1431,6 +1470,80 @@ void OpenGLRenderer::outputDisplayList(DisplayList* displayList, uint32_t level)
     }
 }
 
+bool OpenGLRenderer::skipDrawOp(const void* op, float left, float top, float right, float bottom,
+        SkPaint* paint, bool opaque) {
+    if (!mOcclusion.isRecording() && !mCountOverdraw) {
+        return mOcclusion.isCulled(op);
+    }
+
+    int alpha;
+    SkXfermode::Mode mode;
+    getAlphaAndMode(paint, &alpha, &mode);
+
+    if (paint && (paint->getMaskFilter() || paint->getPathEffect())) {
+        opaque = false;
+    }
+
+    return skipDrawOp(op, left, top, right, bottom, alpha, mode, opaque);
+}
+
+bool OpenGLRenderer::skipDrawOp(const void* op, float left, float top, float right, float bottom,
+        int alpha, SkXfermode::Mode mode, bool opaque) {
+    const bool recording = mOcclusion.isRecording();
+    if (!recording) {
+        if (mOcclusion.isCulled(op)) return true;
+        if (!mCountOverdraw) return false;
+    }
+
+    Rect bounds;
+    Rect opaqueBounds;
+    OcclusionTracker::getBounds(*mSnapshot, left, top, right, bottom, alpha, mode,
+            recording && opaque && !mShader && !mColorFilter, bounds, opaqueBounds);
+
+    if (recording) {
+        mOcclusion.add(op, bounds, opaqueBounds);
+        return true;
+    }
+
+    if (mSnapshot->fbo == 0 && !bounds.isEmpty()) {
+        mOverdraw.count(bounds);
+    }
+    return false;
+}
+
+bool OpenGLRenderer::skipDrawOp(const void* op) {
+    if (mOcclusion.isRecording()) {
+        mOcclusion.addUnbounded(op);
+        return true;
+    }
+    return false;
+}
+
+void OpenGLRenderer::drawOverdraw() {
+    // Drawn once, twice, three times, four times or more on top of the first draw
+    static const int colors[] = { 0x2f0000ff, 0x2f00ff00, 0x3fff0000, 0x7fff0000 };
+    static const int size = OverdrawCounter::kCellSize;
+
+    const int columns = mOverdraw.getColumns();
+    const int rows = mOverdraw.getRows();
+
+    for (int y = 0; y < rows; y++) {
+        int x = 0;
+        while (x < columns) {
+            const int count = mOverdraw.getCount(x, y);
+            const int start = x;
+            while (++x < columns && mOverdraw.getCount(x, y) == count) {
+            }
+
+            if (count > 1) {
+                const int color = colors[count - 2 < 3 ? count - 2 : 3];
+                drawColorRect(start * size, y * size, x * size, (y + 1) * size,
+                        color, SkXfermode::kSrcOver_Mode, true);
+            }
+        }
+    }
+}
+
 void OpenGLRenderer::drawAlphaBitmap(Texture* texture, float left, float top, SkPaint* paint) {
     int alpha;
     SkXfermode::Mode mode;
@@ -2187,10 +2300,111 @@ status_t OpenGLRenderer::drawShape(float left, float top, const PathTexture* tex
     return DrawGlInfo::kStatusDrew;
 }
 
+bool OpenGLRenderer::canTessellate(SkPaint* paint, float& scaleX, float& scaleY) {
+    if (!PathTessellator::isSupported(paint)) return false;
+
+    const Matrix4& transform = *mSnapshot->transform;
+    if (transform.data[Matrix4::kPerspective0] != 0.0f ||
+            transform.data[Matrix4::kPerspective1] != 0.0f ||
+            transform.data[Matrix4::kPerspective2] != 1.0f) {
+        return false;
+    }
+
+    // Length of the transformed unit vectors, the fringe must be one pixel
+    // wide once transformed
+    const float m00 = transform.data[Matrix4::kScaleX];
+    const float m01 = transform.data[Matrix4::kSkewY];
+    const float m10 = transform.data[Matrix4::kSkewX];
+    const float m11 = transform.data[Matrix4::kScaleY];
+    scaleX = sqrtf(m00 * m00 + m01 * m01);
+    scaleY = sqrtf(m10 * m10 + m11 * m11);
+
+    return scaleX > 0.0f && scaleY > 0.0f;
+}
+
+status_t OpenGLRenderer::drawVertexBuffer(float left, float top, const VertexBuffer* buffer,
+        SkPaint* paint) {
+    if (!buffer) return DrawGlInfo::kStatusDone;
+    return drawAlphaVertices(left, top, buffer->bounds, NULL, buffer->id,
+            buffer->vertexCount, paint);
+}
+
+status_t OpenGLRenderer::drawAlphaVertices(float left, float top, const Rect& bounds,
+        GLvoid* vertices, GLuint vbo, GLsizei count, SkPaint* paint) {
+    if (quickReject(left + bounds.left, top + bounds.top,
+            left + bounds.right, top + bounds.bottom)) {
+        return DrawGlInfo::kStatusDone;
+    }
+
+    int alpha;
+    SkXfermode::Mode mode;
+    getAlphaAndMode(paint, &alpha, &mode);
+
+    // If a shader is set, preserve only the alpha
+    int color = paint->getColor();
+    if (mShader) {
+        color |= 0x00ffffff;
+    }
+
+    const bool isAA = paint->isAntiAlias();
+
+    setupDraw();
+    setupDrawNoTexture();
+    if (isAA) setupDrawVertexAlpha();
+    setupDrawColor(color);
+    setupDrawColorFilter();
+    setupDrawShader();
+    setupDrawBlending(isAA, mode);
+    setupDrawProgram();
+    setupDrawDirtyRegionsDisabled();
+    setupDrawModelViewTranslate(left, top, left, top);
+    setupDrawColorUniforms();
+    setupDrawColorFilterUniforms();
+    setupDrawShaderUniforms();
+
+    if (vbo) {
+        mCaches.bindMeshBuffer(vbo);
+    } else {
+        mCaches.unbindMeshBuffer();
+    }
+    mCaches.bindPositionVertexPointer(true, mCaches.currentProgram->position,
+            vertices, gAlphaVertexStride);
+    mCaches.resetTexCoordsVertexPointer();
+    mCaches.unbindIndicesBuffer();
+
+    int alphaSlot = -1;
+    if (isAA) {
+        alphaSlot = mCaches.currentProgram->getAttrib("vtxAlpha");
+        glEnableVertexAttribArray(alphaSlot);
+        glVertexAttribPointer(alphaSlot, 1, GL_FLOAT, GL_FALSE, gAlphaVertexStride,
+                ((GLbyte*) vertices) + gVertexAlphaOffset);
+    }
+
+    dirtyLayer(left + bounds.left, top + bounds.top,
+            left + bounds.right, top + bounds.bottom, *mSnapshot->transform);
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, count);
+
+    if (alphaSlot >= 0) {
+        glDisableVertexAttribArray(alphaSlot);
+    }
+    // The position pointer was set with a different stride
+    mCaches.resetVertexPointers();
+
+    return DrawGlInfo::kStatusDrew;
+}
+
 status_t OpenGLRenderer::drawRoundRect(float left, float top, float right, float bottom,
         float rx, float ry, SkPaint* paint) {
     if (mSnapshot->isIgnored()) return DrawGlInfo::kStatusDone;
 
+    float scaleX, scaleY;
+    if (canTessellate(paint, scaleX, scaleY) && PathTessellator::isSupported(
+            right - left, bottom - top, rx, ry, paint, scaleX, scaleY)) {
+        const VertexBuffer* buffer = mCaches.tessellationCache.getRoundRect(
+                right - left, bottom - top, rx, ry, paint, scaleX, scaleY);
+        return drawVertexBuffer(left, top, buffer, paint);
+    }
+
     mCaches.activeTexture(0);
     const PathTexture* texture = mCaches.roundRectShapeCache.getRoundRect(
             right - left, bottom - top, rx, ry, paint);
@@ -2200,6 +2414,14 @@ status_t OpenGLRenderer::drawRoundRect(float left, float top, float right, float
 status_t OpenGLRenderer::drawCircle(float x, float y, float radius, SkPaint* paint) {
     if (mSnapshot->isIgnored()) return DrawGlInfo::kStatusDone;
 
+    float scaleX, scaleY;
+    if (canTessellate(paint, scaleX, scaleY) && PathTessellator::isSupported(
+            radius * 2.0f, radius * 2.0f, radius, radius, paint, scaleX, scaleY)) {
+        const VertexBuffer* buffer = mCaches.tessellationCache.getOval(
+                radius * 2.0f, radius * 2.0f, paint, scaleX, scaleY);
+        return drawVertexBuffer(x - radius, y - radius, buffer, paint);
+    }
+
     mCaches.activeTexture(0);
     const PathTexture* texture = mCaches.circleShapeCache.getCircle(radius, paint);
     return drawShape(x - radius, y - radius, texture, paint);
@@ -2209,6 +2431,16 @@ status_t OpenGLRenderer::drawOval(float left, float top, float right, float bott
         SkPaint* paint) {
     if (mSnapshot->isIgnored()) return DrawGlInfo::kStatusDone;
 
+    float scaleX, scaleY;
+    const float width = right - left;
+    const float height = bottom - top;
+    if (canTessellate(paint, scaleX, scaleY) && PathTessellator::isSupported(
+            width, height, width * 0.5f, height * 0.5f, paint, scaleX, scaleY)) {
+        const VertexBuffer* buffer = mCaches.tessellationCache.getOval(
+                width, height, paint, scaleX, scaleY);
+        return drawVertexBuffer(left, top, buffer, paint);
+    }
+
     mCaches.activeTexture(0);
     const PathTexture* texture = mCaches.ovalShapeCache.getOval(right - left, bottom - top, paint);
     return drawShape(left, top, texture, paint);
@@ -2232,6 +2464,14 @@ status_t OpenGLRenderer::drawRectAsShape(float left, float top, float right, flo
         SkPaint* paint) {
     if (mSnapshot->isIgnored()) return DrawGlInfo::kStatusDone;
 
+    // The corners of a tessellated rect are mitered
+    float scaleX, scaleY;
+    if (paint->getStrokeJoin() == SkPaint::kMiter_Join && canTessellate(paint, scaleX, scaleY)) {
+        const VertexBuffer* buffer = mCaches.tessellationCache.getRoundRect(
+                right - left, bottom - top, 0.0f, 0.0f, paint, scaleX, scaleY);
+        return drawVertexBuffer(left, top, buffer, paint);
+    }
+
     mCaches.activeTexture(0);
     const PathTexture* texture = mCaches.rectShapeCache.getRect(right - left, bottom - top, paint);
     return drawShape(left, top, texture, paint);
@@ -2524,6 +2764,19 @@ status_t OpenGLRenderer::drawTextOnPath(const char* text, int bytesCount, int co
 status_t OpenGLRenderer::drawPath(SkPath* path, SkPaint* paint) {
     if (mSnapshot->isIgnored()) return DrawGlInfo::kStatusDone;
 
+    // Paths can be modified in place, convex ones are cheap enough to
+    // tessellate on every draw instead of being cached
+    float scaleX, scaleY;
+    if (canTessellate(paint, scaleX, scaleY)) {
+        Vector<AlphaVertex> mesh;
+        Rect bounds;
+        if (PathTessellator::tessellateConvexPath(*path, paint, scaleX, scaleY, mesh, bounds)) {
+            if (mesh.isEmpty()) return DrawGlInfo::kStatusDone;
+            return drawAlphaVertices(0.0f, 0.0f, bounds, (GLvoid*) mesh.array(), 0,
+                    mesh.size(), paint);
+        }
+    }
+
     mCaches.activeTexture(0);
 
     // TODO: Perform early clip test before we rasterize the path
@@ -36,6 +36,8 @@
 #include "Debug.h"
 #include "Extensions.h"
 #include "Matrix.h"
+#include "OcclusionTracker.h"
+#include "OverdrawCounter.h"
 #include "Program.h"
 #include "Rect.h"
 #include "Snapshot.h"
@@ -154,6 +156,42 @@ public:
 
     SkPaint* filterPaint(SkPaint* paint);
 
+    /**
+     * Called by display lists before each draw op, with the bounds of the
+     * op in local coordinates. While the ops of a frame are recorded to
+     * find the hidden ones, records the op and returns true. Otherwise
+     * returns true if the op is hidden behind opaque ops drawn after it,
+     * and counts the op when the overdraw is debugged.
+     *
+     * @param op Identifies the op in its display list
+     * @param paint The paint of the op, can be NULL
+     * @param opaque True if the op fills its bounds with opaque pixels
+     *        when drawn with an opaque paint
+     */
+    bool skipDrawOp(const void* op, float left, float top, float right, float bottom,
+            SkPaint* paint, bool opaque);
+
+    /**
+     * Same as skipDrawOp(const void*, float, float, float, float, SkPaint*, bool)
+     * for ops drawn with a color and a mode instead of a paint.
+     */
+    bool skipDrawOp(const void* op, float left, float top, float right, float bottom,
+            int alpha, SkXfermode::Mode mode, bool opaque);
+
+    /**
+     * Same as skipDrawOp(const void*, float, float, float, float, SkPaint*, bool)
+     * for ops whose bounds are not known. These ops are never hidden.
+     */
+    bool skipDrawOp(const void* op);
+
+    /**
+     * Returns the number of times each pixel of the last frame was drawn
+     * on average, or 0 if the overdraw is not debugged.
+     */
+    float getOverdrawRatio() const {
+        return mOverdrawRatio;
+    }
+
     ANDROID_API static uint32_t getStencilSize();
 
     void startMark(const char* name) const;
@@ -308,6 +346,11 @@ private:
     void dirtyLayer(const float left, const float top,
             const float right, const float bottom);
 
+    /**
+     * Tints the pixels of the frame by the number of times they were drawn.
+     */
+    void drawOverdraw();
+
     /**
      * Draws a colored rectangle with the specified color. The specified coordinates
      * are transformed by the current snapshot's transform matrix.
@@ -337,6 +380,31 @@ private:
      */
     status_t drawShape(float left, float top, const PathTexture* texture, SkPaint* paint);
 
+    /**
+     * Indicates whether shapes drawn with the specified paint under the
+     * current transform can be tessellated instead of rasterized into a
+     * path texture. If so, returns the scale of the transform, which sets
+     * the precision of the tessellation.
+     */
+    bool canTessellate(SkPaint* paint, float& scaleX, float& scaleY);
+
+    /**
+     * Draws a tessellated shape from the tessellation cache.
+     *
+     * @param left The left coordinate of the shape to render
+     * @param top The top coordinate of the shape to render
+     * @param buffer The VBO holding the tessellated shape, can be NULL
+     * @param paint The paint to draw the shape with
+     */
+    status_t drawVertexBuffer(float left, float top, const VertexBuffer* buffer, SkPaint* paint);
+
+    /**
+     * Draws a triangle strip of AlphaVertex, translated by left and top.
+     * The vertices are read from the specified VBO when vbo is not 0.
+     */
+    status_t drawAlphaVertices(float left, float top, const Rect& bounds,
+            GLvoid* vertices, GLuint vbo, GLsizei count, SkPaint* paint);
+
     /**
      * Renders the rect defined by the specified bounds as a shape.
      * This will render the rect using a path texture, which is used to render
@@ -531,6 +599,7 @@ private:
     void setupDrawWithExternalTexture();
     void setupDrawNoTexture();
     void setupDrawAALine();
+    void setupDrawVertexAlpha();
     void setupDrawPoint(float pointSize);
     void setupDrawColor(int color);
     void setupDrawColor(int color, int alpha);
@@ -644,6 +713,13 @@ private:
     // Track dirty regions, true by default
     bool mTrackDirtyRegions;
 
+    // Finds the ops of a frame hidden behind opaque ops
+    OcclusionTracker mOcclusion;
+    // Counts the overdraw of a frame when debugged
+    bool mCountOverdraw;
+    OverdrawCounter mOverdraw;
+    float mOverdrawRatio;
+
     friend class DisplayListRenderer;
 
 }; // class OpenGLRenderer
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "OpenGLRenderer"
+
+#include <math.h>
+#include <string.h>
+
+#include "OverdrawCounter.h"
+
+namespace android {
+namespace uirenderer {
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructors
+///////////////////////////////////////////////////////////////////////////////
+
+OverdrawCounter::OverdrawCounter(): mColumns(0), mRows(0) {
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Counting
+///////////////////////////////////////////////////////////////////////////////
+
+void OverdrawCounter::reset(int width, int height, const Rect& area) {
+    mColumns = (width + kCellSize - 1) / kCellSize;
+    mRows = (height + kCellSize - 1) / kCellSize;
+    mArea.set(area);
+
+    mCounts.resize(mColumns * mRows);
+    if (!mCounts.isEmpty()) {
+        memset(mCounts.editArray(), 0, mCounts.size());
+    }
+}
+
+/**
+ * Returns the range [first, last) of the cells whose center lies
+ * within [start, end).
+ */
+static inline void getCells(float start, float end, int count, int& first, int& last) {
+    first = (int) ceilf(start / OverdrawCounter::kCellSize - 0.5f);
+    last = (int) ceilf(end / OverdrawCounter::kCellSize - 0.5f);
+    if (first < 0) first = 0;
+    if (last > count) last = count;
+}
+
+void OverdrawCounter::count(const Rect& bounds) {
+    int left, right, top, bottom;
+    getCells(bounds.left, bounds.right, mColumns, left, right);
+    getCells(bounds.top, bounds.bottom, mRows, top, bottom);
+
+    for (int y = top; y < bottom; y++) {
+        uint8_t* cell = mCounts.editArray() + y * mColumns + left;
+        for (int x = left; x < right; x++, cell++) {
+            if (*cell < 255) (*cell)++;
+        }
+    }
+}
+
+float OverdrawCounter::getRatio() const {
+    int left, right, top, bottom;
+    getCells(mArea.left, mArea.right, mColumns, left, right);
+    getCells(mArea.top, mArea.bottom, mRows, top, bottom);
+
+    uint32_t total = 0;
+    uint32_t cells = 0;
+    for (int y = top; y < bottom; y++) {
+        const uint8_t* cell = mCounts.array() + y * mColumns + left;
+        for (int x = left; x < right; x++, cell++) {
+            total += *cell;
+            cells++;
+        }
+    }
+
+    return cells > 0 ? total / (float) cells : 0.0f;
+}
+
+}; // namespace uirenderer
+}; // namespace android
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_HWUI_OVERDRAW_COUNTER_H
+#define ANDROID_HWUI_OVERDRAW_COUNTER_H
+
+#include <stdint.h>
+
+#include <utils/Vector.h>
+
+#include "Rect.h"
+
+namespace android {
+namespace uirenderer {
+
+///////////////////////////////////////////////////////////////////////////////
+// Classes
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Counts how many times the pixels of a frame are drawn. The window is
+ * divided in square cells and every op drawn increments the cells whose
+ * center lies within its bounds.
+ */
+class OverdrawCounter {
+public:
+    /**
+     * Size of the cells in pixels.
+     */
+    static const int kCellSize = 8;
+
+    OverdrawCounter();
+
+    /**
+     * Starts counting a frame.
+     *
+     * @param width The width of the window
+     * @param height The height of the window
+     * @param area The part of the window redrawn by the frame
+     */
+    void reset(int width, int height, const Rect& area);
+
+    /**
+     * Counts an op drawn within the specified window bounds.
+     */
+    void count(const Rect& bounds);
+
+    /**
+     * Returns the number of times each pixel redrawn by the frame was
+     * drawn on average, 1 if each was drawn once.
+     */
+    float getRatio() const;
+
+    int getColumns() const {
+        return mColumns;
+    }
+
+    int getRows() const {
+        return mRows;
+    }
+
+    /**
+     * Returns the number of times the specified cell was drawn.
+     */
+    uint8_t getCount(int column, int row) const {
+        return mCounts[row * mColumns + column];
+    }
+
+private:
+    int mColumns;
+    int mRows;
+    Rect mArea;
+    Vector<uint8_t> mCounts;
+}; // class OverdrawCounter
+
+}; // namespace uirenderer
+}; // namespace android
+
+#endif // ANDROID_HWUI_OVERDRAW_COUNTER_H
@@ -18,6 +18,8 @@
 
 #include <utils/threads.h>
 
+#include <SkCanvas.h>
+
 #include "PathCache.h"
 #include "Properties.h"
 
@@ -46,15 +48,131 @@ void computeBounds(const SkRect& bounds, const SkPaint* paint,
     height = uint32_t(pathHeight + offset * 2.0 + 0.5);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Path tasks
+///////////////////////////////////////////////////////////////////////////////
+
+PathCache::PathTask::PathTask(const SkPath* path, const SkPaint* paint):
+        mPath(*path), mPaint(*paint), mState(kStateQueued) {
+    generation = path->getGenerationID();
+    computePathBounds(path, paint, left, top, offset, width, height);
+}
+
+bool PathCache::PathTask::claim() {
+    Mutex::Autolock _l(mLock);
+    if (mState != kStateQueued) {
+        return false;
+    }
+    mState = kStateRunning;
+    return true;
+}
+
+void PathCache::PathTask::draw() {
+    initBitmap(mBitmap, width, height);
+    initPaint(mPaint);
+
+    SkCanvas canvas(mBitmap);
+    canvas.translate(-left + offset, -top + offset);
+    canvas.drawPath(mPath, mPaint);
+
+    Mutex::Autolock _l(mLock);
+    mState = kStateDone;
+    mCondition.broadcast();
+}
+
+void PathCache::PathTask::rasterize() {
+    if (claim()) {
+        draw();
+    }
+}
+
+SkBitmap& PathCache::PathTask::getBitmap(Origin& origin) {
+    if (claim()) {
+        draw();
+        origin = kOriginCaller;
+        return mBitmap;
+    }
+
+    Mutex::Autolock _l(mLock);
+    origin = mState == kStateDone ? kOriginWorker : kOriginWaited;
+    while (mState == kStateRunning) {
+        mCondition.wait(mLock);
+    }
+    return mBitmap;
+}
+
+void PathCache::PathTask::cancel() {
+    Mutex::Autolock _l(mLock);
+    if (mState == kStateQueued) {
+        mState = kStateCancelled;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Path rasterizer
+///////////////////////////////////////////////////////////////////////////////
+
+PathCache::PathRasterizer::PathRasterizer(): Thread(false) {
+}
+
+void PathCache::PathRasterizer::add(const mindroid::sp<PathTask>& task) {
+    Mutex::Autolock _l(mLock);
+    mTasks.push(task);
+    mCondition.signal();
+}
+
+void PathCache::PathRasterizer::quit() {
+    {
+        Mutex::Autolock _l(mLock);
+        mTasks.clear();
+        requestExit();
+        mCondition.signal();
+    }
+    requestExitAndWait();
+}
+
+bool PathCache::PathRasterizer::threadLoop() {
+    mindroid::sp<PathTask> task;
+    {
+        Mutex::Autolock _l(mLock);
+        while (mTasks.isEmpty()) {
+            if (exitPending()) {
+                return false;
+            }
+            mCondition.wait(mLock);
+        }
+        task = mTasks[0];
+        mTasks.removeAt(0);
+    }
+
+    task->rasterize();
+    return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Path cache
 ///////////////////////////////////////////////////////////////////////////////
 
 PathCache::PathCache(): ShapeCache<PathCacheEntry>("path",
-        PROPERTY_PATH_CACHE_SIZE, DEFAULT_PATH_CACHE_SIZE) {
+        PROPERTY_PATH_CACHE_SIZE, DEFAULT_PATH_CACHE_SIZE), mPendingSize(0) {
+}
+
+PathCache::~PathCache() {
+    if (mRasterizer != NULL) {
+        mRasterizer->quit();
+        mRasterizer.clear();
+    }
+    clearPending();
+}
+
+void PathCache::clear() {
+    clearPending();
+    ShapeCache<PathCacheEntry>::clear();
 }
 
 void PathCache::remove(SkPath* path) {
+    removePending(path);
+
     // TODO: Linear search...
     Vector<size_t> pathsToRemove;
     for (size_t i = 0; i < mCache.size(); i++) {
@@ -96,18 +214,141 @@ PathTexture* PathCache::get(SkPath* path, SkPaint* paint) {
     PathCacheEntry entry(path, paint);
     PathTexture* texture = mCache.get(entry);
 
-    float left, top, offset;
-    uint32_t width, height;
+    if (texture && path->getGenerationID() != texture->generation) {
+        mCache.remove(entry);
+        texture = NULL;
+    }
 
+    if (texture) {
+        mStats.hitCount++;
+        return texture;
+    }
+
+    texture = addPrecachedTexture(entry, path);
     if (!texture) {
-        texture = addTexture(entry, path, paint);
-    } else if (path->getGenerationID() != texture->generation) {
-        mCache.remove(entry);
+        mStats.missCount++;
         texture = addTexture(entry, path, paint);
     }
 
     return texture;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Precaching
+///////////////////////////////////////////////////////////////////////////////
+
+void PathCache::precache(SkPath* path, SkPaint* paint) {
+    const SkPath* sourcePath = path->getSourcePath();
+    if (sourcePath && sourcePath->getGenerationID() == path->getGenerationID()) {
+        path = const_cast<SkPath*>(sourcePath);
+    }
+
+    PathCacheEntry entry(path, paint);
+    PathTexture* texture = mCache.get(entry);
+    if (texture && texture->generation == path->getGenerationID()) {
+        return;
+    }
+
+    mindroid::sp<PathTask> task = new PathTask(path, paint);
+    // Textures that would not be kept are not worth the extra copy
+    if (task->getSize() >= mMaxSize || task->width > mMaxTextureSize ||
+            task->height > mMaxTextureSize) {
+        return;
+    }
+
+    {
+        Mutex::Autolock _l(mPendingLock);
+        ssize_t index = mPending.indexOfKey(entry);
+        if (index >= 0) {
+            const mindroid::sp<PathTask>& pending = mPending.valueAt(index);
+            if (pending->generation == task->generation) {
+                return;
+            }
+            pending->cancel();
+            mPendingSize -= pending->getSize();
+            mPending.removeItemsAt(index);
+        }
+
+        // Bitmaps waiting for an upload must not use more than the cache itself
+        if (mPendingSize + task->getSize() > mMaxSize) {
+            return;
+        }
+
+        mPending.add(entry, task);
+        mPendingSize += task->getSize();
+    }
+
+    if (mRasterizer == NULL) {
+        mRasterizer = new PathRasterizer();
+        mRasterizer->run("hwuiPathRasterizer", PRIORITY_BACKGROUND);
+    }
+    mRasterizer->add(task);
+}
+
+PathTexture* PathCache::addPrecachedTexture(const PathCacheEntry& entry, const SkPath* path) {
+    mindroid::sp<PathTask> task;
+    {
+        Mutex::Autolock _l(mPendingLock);
+        ssize_t index = mPending.indexOfKey(entry);
+        if (index < 0) {
+            return NULL;
+        }
+        task = mPending.valueAt(index);
+        mPendingSize -= task->getSize();
+        mPending.removeItemsAt(index);
+    }
+
+    // The path was modified after it was recorded
+    if (task->generation != path->getGenerationID()) {
+        task->cancel();
+        return NULL;
+    }
+
+    PathTask::Origin origin;
+    SkBitmap& bitmap = task->getBitmap(origin);
+    switch (origin) {
+        case PathTask::kOriginWorker:
+            mStats.precacheHitCount++;
+            break;
+        case PathTask::kOriginWaited:
+            mStats.stallCount++;
+            break;
+        case PathTask::kOriginCaller:
+            mStats.missCount++;
+            break;
+    }
+
+    purgeCache(task->width, task->height);
+
+    PathTexture* texture = createTexture(task->left, task->top, task->offset,
+            task->width, task->height, task->generation);
+    addTexture(entry, &bitmap, texture);
+
+    return texture;
+}
+
+void PathCache::removePending(SkPath* path) {
+    Mutex::Autolock _l(mPendingLock);
+    for (size_t i = 0; i < mPending.size(); ) {
+        if (mPending.keyAt(i).path == path) {
+            const mindroid::sp<PathTask>& task = mPending.valueAt(i);
+            task->cancel();
+            mPendingSize -= task->getSize();
+            mPending.removeItemsAt(i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void PathCache::clearPending() {
+    Mutex::Autolock _l(mPendingLock);
+    for (size_t i = 0; i < mPending.size(); i++) {
+        mPending.valueAt(i)->cancel();
+    }
+    mPending.clear();
+    mPendingSize = 0;
+}
+
 }; // namespace uirenderer
 }; // namespace android
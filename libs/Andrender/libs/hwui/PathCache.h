@@ -17,6 +17,10 @@
 #ifndef ANDROID_HWUI_PATH_CACHE_H
 #define ANDROID_HWUI_PATH_CACHE_H
 
+#include <utils/Condition.h>
+#include <utils/KeyedVector.h>
+#include <utils/Mutex.h>
+#include <utils/Thread.h>
 #include <utils/Vector.h>
 
 #include "Debug.h"
@@ -57,16 +61,42 @@ struct PathCacheEntry: public ShapeCacheEntry {
  * A simple LRU path cache. The cache has a maximum size expressed in bytes.
  * Any texture added to the cache causing the cache to grow beyond the maximum
  * allowed size will also cause the oldest texture to be kicked out.
+ *
+ * Paths recorded in display lists can be precached: they are then rasterized
+ * by a background thread and only uploaded when the display list is drawn.
  */
 class PathCache: public ShapeCache<PathCacheEntry> {
 public:
     PathCache();
+    ~PathCache();
+
+    /**
+     * Counters reported by Caches::dumpMemoryUsage().
+     */
+    struct Stats {
+        Stats(): hitCount(0), precacheHitCount(0), stallCount(0), missCount(0) {
+        }
+
+        // Textures found in the cache
+        uint32_t hitCount;
+        // Textures uploaded from a bitmap rasterized by the background thread
+        uint32_t precacheHitCount;
+        // Draws that had to wait for the background thread
+        uint32_t stallCount;
+        // Paths rasterized on the calling thread
+        uint32_t missCount;
+    };
 
     /**
      * Returns the texture associated with the specified path. If the texture
      * cannot be found in the cache, a new texture is generated.
      */
     PathTexture* get(SkPath* path, SkPaint* paint);
+    /**
+     * Queues the specified path for rasterization on a background thread.
+     * The path and the paint are copied.
+     */
+    void precache(SkPath* path, SkPaint* paint);
     /**
      * Removes an entry.
      */
@@ -80,10 +110,110 @@ public:
      * Process deferred removals.
      */
     void clearGarbage();
+    /**
+     * Clears the cache and drops the pending rasterizations.
+     */
+    void clear();
+
+    const Stats& getStats() const {
+        return mStats;
+    }
 
 private:
+    /**
+     * A path waiting to be rasterized, or rasterized, by the background thread.
+     */
+    class PathTask: public mindroid::Ref {
+    public:
+        enum Origin {
+            // Rasterized by the background thread before it was needed
+            kOriginWorker,
+            // Rasterized by the background thread while the caller waited
+            kOriginWaited,
+            // Rasterized by the caller, the background thread had not started
+            kOriginCaller
+        };
+
+        PathTask(const SkPath* path, const SkPaint* paint);
+
+        /**
+         * Rasterizes the path unless the task was cancelled or already
+         * claimed. Called by the background thread.
+         */
+        void rasterize();
+        /**
+         * Returns the rasterized path. Rasterizes it on the calling thread
+         * if the background thread has not started, waits for it otherwise.
+         */
+        SkBitmap& getBitmap(Origin& origin);
+        /**
+         * Prevents the background thread from rasterizing the path.
+         */
+        void cancel();
+
+        uint32_t getSize() const {
+            return width * height;
+        }
+
+        uint32_t generation;
+        float left;
+        float top;
+        float offset;
+        uint32_t width;
+        uint32_t height;
+
+    private:
+        enum State {
+            kStateQueued,
+            kStateRunning,
+            kStateDone,
+            kStateCancelled
+        };
+
+        bool claim();
+        void draw();
+
+        SkPath mPath;
+        SkPaint mPaint;
+        SkBitmap mBitmap;
+
+        State mState;
+        Mutex mLock;
+        Condition mCondition;
+    }; // class PathTask
+
+    class PathRasterizer: public Thread {
+    public:
+        PathRasterizer();
+
+        void add(const mindroid::sp<PathTask>& task);
+        /**
+         * Drops all queued tasks and waits for the thread to exit.
+         */
+        void quit();
+
+    private:
+        virtual bool threadLoop();
+
+        Mutex mLock;
+        Condition mCondition;
+        Vector<mindroid::sp<PathTask> > mTasks;
+    }; // class PathRasterizer
+
+    PathTexture* addPrecachedTexture(const PathCacheEntry& entry, const SkPath* path);
+    void removePending(SkPath* path);
+    void clearPending();
+
     Vector<SkPath*> mGarbage;
     mutable Mutex mLock;
+
+    mindroid::sp<PathRasterizer> mRasterizer;
+    KeyedVector<PathCacheEntry, mindroid::sp<PathTask> > mPending;
+    // Sum of the sizes of the bitmaps in mPending
+    uint32_t mPendingSize;
+    Mutex mPendingLock;
+
+    Stats mStats;
 }; // class PathCache
 
 }; // namespace uirenderer
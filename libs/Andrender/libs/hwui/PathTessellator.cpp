@@ -0,0 +1,470 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "OpenGLRenderer"
+
+#include <math.h>
+
+#include "PathTessellator.h"
+
+namespace android {
+namespace uirenderer {
+
+///////////////////////////////////////////////////////////////////////////////
+// Defines
+///////////////////////////////////////////////////////////////////////////////
+
+// Maximum distance, in pixels, between a curve and its approximation
+#define CURVE_TOLERANCE 0.25f
+
+#define MAX_ARC_SEGMENTS 64
+#define MAX_CURVE_SEGMENTS 32
+
+// Sharp corners are beveled past this miter length, like Skia's default miter
+#define MAX_MITER 4.0f
+
+///////////////////////////////////////////////////////////////////////////////
+// Helpers
+///////////////////////////////////////////////////////////////////////////////
+
+static inline void addPoint(Vector<Vertex>& outline, float x, float y) {
+    Vertex vertex;
+    Vertex::set(&vertex, x, y);
+    outline.push(vertex);
+}
+
+/**
+ * Adds a vertex offset from the outline point p along its normal m. The offset
+ * is made of a distance in local coordinates and of a number of half pixels
+ * on screen, used to place the antialiasing fringe.
+ */
+static inline void addVertex(Vector<AlphaVertex>& mesh, const Vertex& p, const Vertex& m,
+        float offset, float aaX, float aaY, float halfPixels, float alpha) {
+    AlphaVertex vertex;
+    AlphaVertex::set(&vertex,
+            p.position[0] + m.position[0] * (offset + aaX * halfPixels),
+            p.position[1] + m.position[1] * (offset + aaY * halfPixels),
+            alpha);
+    mesh.push(vertex);
+}
+
+/**
+ * Adds a closed strip between two rings offset from the outline, joined to
+ * the previous strip with degenerate triangles.
+ */
+static void addRingStrip(Vector<AlphaVertex>& mesh,
+        const Vector<Vertex>& outline, const Vector<Vertex>& normals, float aaX, float aaY,
+        float offsetA, float halfPixelsA, float alphaA,
+        float offsetB, float halfPixelsB, float alphaB) {
+    const size_t count = outline.size();
+
+    if (!mesh.isEmpty()) {
+        AlphaVertex last = mesh.top();
+        mesh.push(last);
+        addVertex(mesh, outline[0], normals[0], offsetA, aaX, aaY, halfPixelsA, alphaA);
+    }
+
+    for (size_t i = 0; i <= count; i++) {
+        const size_t j = i % count;
+        addVertex(mesh, outline[j], normals[j], offsetA, aaX, aaY, halfPixelsA, alphaA);
+        addVertex(mesh, outline[j], normals[j], offsetB, aaX, aaY, halfPixelsB, alphaB);
+    }
+}
+
+static inline float distance(const SkPoint& a, const SkPoint& b) {
+    return SkScalarToFloat(SkPoint::Distance(a, b));
+}
+
+static int computeCurveSegments(float length, float scale) {
+    int segments = (int) ceilf(sqrtf(length * scale / (8.0f * CURVE_TOLERANCE)));
+    if (segments < 1) return 1;
+    if (segments > MAX_CURVE_SEGMENTS) return MAX_CURVE_SEGMENTS;
+    return segments;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Shapes
+///////////////////////////////////////////////////////////////////////////////
+
+bool PathTessellator::isSupported(const SkPaint* paint) {
+    return !paint->getPathEffect() && !paint->getMaskFilter() && !paint->getRasterizer();
+}
+
+bool PathTessellator::isSupported(float width, float height, float rx, float ry,
+        const SkPaint* paint, float scaleX, float scaleY) {
+    if (computeShapeStyle(width, height, paint, scaleX, scaleY) != SkPaint::kStroke_Style) {
+        return true;
+    }
+
+    rx = fminf(fmaxf(rx, 0.0f), width * 0.5f);
+    ry = fminf(fmaxf(ry, 0.0f), height * 0.5f);
+    if (rx == 0.0f || ry == 0.0f) {
+        // Mitered corners stay sharp on the inner edge
+        return true;
+    }
+
+    // Smallest radius of curvature of the elliptical corners, the inner
+    // edge folds over itself once it is pushed in further than that
+    const float radius = fminf(rx, ry) * fminf(rx, ry) / fmaxf(rx, ry);
+    return computeStrokeInset(paint, scaleX, scaleY) <= radius;
+}
+
+/**
+ * Returns how far inside the outline the inner edge of a stroke goes,
+ * antialiasing fringe included.
+ */
+float PathTessellator::computeStrokeInset(const SkPaint* paint, float scaleX, float scaleY) {
+    const float minScale = fminf(scaleX, scaleY);
+    const float halfStrokeWidth = paint->getStrokeWidth() * 0.5f;
+    return (halfStrokeWidth > 0.0f ? halfStrokeWidth : 0.5f / minScale) +
+            (paint->isAntiAlias() ? 0.5f / minScale : 0.0f);
+}
+
+/**
+ * Returns the style to tessellate a shape with. A stroke whose inner edge
+ * reaches the middle of the shape covers all of it; it is drawn as a fill
+ * pushed out by half the stroke width, instead of as a ring whose inner
+ * side would overlap itself.
+ */
+SkPaint::Style PathTessellator::computeShapeStyle(float width, float height,
+        const SkPaint* paint, float scaleX, float scaleY) {
+    const SkPaint::Style style = paint->getStyle();
+    if (style == SkPaint::kStroke_Style &&
+            computeStrokeInset(paint, scaleX, scaleY) >= fminf(width, height) * 0.5f) {
+        return SkPaint::kStrokeAndFill_Style;
+    }
+    return style;
+}
+
+int PathTessellator::computeArcSegments(float rx, float ry, float scaleX, float scaleY,
+        float sweepAngle) {
+    const float radius = fmaxf(rx * scaleX, ry * scaleY);
+    if (radius <= CURVE_TOLERANCE) {
+        return radius > 0.0f ? 1 : 0;
+    }
+
+    const float step = 2.0f * acosf(1.0f - CURVE_TOLERANCE / radius);
+    int segments = (int) ceilf(fabsf(sweepAngle) / step);
+    if (segments < 1) return 1;
+    if (segments > MAX_ARC_SEGMENTS) return MAX_ARC_SEGMENTS;
+    return segments;
+}
+
+void PathTessellator::addArc(float cx, float cy, float rx, float ry,
+        float startAngle, float sweepAngle, int segments, Vector<Vertex>& outline) {
+    if (segments == 0) {
+        addPoint(outline, cx, cy);
+        return;
+    }
+
+    for (int i = 0; i <= segments; i++) {
+        const float angle = startAngle + sweepAngle * i / segments;
+        addPoint(outline, cx + cosf(angle) * rx, cy + sinf(angle) * ry);
+    }
+}
+
+void PathTessellator::tessellateRoundRect(float width, float height, float rx, float ry,
+        const SkPaint* paint, float scaleX, float scaleY,
+        Vector<AlphaVertex>& mesh, Rect& bounds) {
+    rx = fminf(fmaxf(rx, 0.0f), width * 0.5f);
+    ry = fminf(fmaxf(ry, 0.0f), height * 0.5f);
+    if (rx == 0.0f || ry == 0.0f) {
+        rx = ry = 0.0f;
+    }
+
+    const int segments = computeArcSegments(rx, ry, scaleX, scaleY, M_PI_2);
+
+    // Clockwise on screen, starting with the top right corner
+    Vector<Vertex> outline;
+    addArc(width - rx, ry, rx, ry, -M_PI_2, M_PI_2, segments, outline);
+    addArc(width - rx, height - ry, rx, ry, 0.0f, M_PI_2, segments, outline);
+    addArc(rx, height - ry, rx, ry, M_PI_2, M_PI_2, segments, outline);
+    addArc(rx, ry, rx, ry, M_PI, M_PI_2, segments, outline);
+
+    tessellateOutline(outline, paint, computeShapeStyle(width, height, paint, scaleX, scaleY),
+            scaleX, scaleY, mesh, bounds);
+}
+
+void PathTessellator::tessellateOval(float width, float height,
+        const SkPaint* paint, float scaleX, float scaleY,
+        Vector<AlphaVertex>& mesh, Rect& bounds) {
+    const float rx = width * 0.5f;
+    const float ry = height * 0.5f;
+
+    const int segments = computeArcSegments(rx, ry, scaleX, scaleY, 2.0f * M_PI);
+
+    Vector<Vertex> outline;
+    addArc(rx, ry, rx, ry, 0.0f, 2.0f * M_PI, segments < 3 ? 3 : segments, outline);
+
+    tessellateOutline(outline, paint, computeShapeStyle(width, height, paint, scaleX, scaleY),
+            scaleX, scaleY, mesh, bounds);
+}
+
+bool PathTessellator::tessellateConvexPath(const SkPath& path,
+        const SkPaint* paint, float scaleX, float scaleY,
+        Vector<AlphaVertex>& mesh, Rect& bounds) {
+    if (paint->getStyle() != SkPaint::kFill_Style || path.isInverseFillType() ||
+            path.getConvexity() != SkPath::kConvex_Convexity) {
+        return false;
+    }
+
+    const float scale = fmaxf(scaleX, scaleY);
+
+    Vector<Vertex> outline;
+    SkPath::Iter iter(path, true);
+    SkPoint pts[4];
+    SkPath::Verb verb;
+    bool hasContour = false;
+
+    while ((verb = iter.next(pts)) != SkPath::kDone_Verb) {
+        switch (verb) {
+            case SkPath::kMove_Verb:
+                // Only a single contour can be tessellated as one polygon
+                if (hasContour && outline.size() > 1) return false;
+                hasContour = true;
+                outline.clear();
+                addPoint(outline, pts[0].fX, pts[0].fY);
+                break;
+            case SkPath::kLine_Verb:
+                addPoint(outline, pts[1].fX, pts[1].fY);
+                break;
+            case SkPath::kQuad_Verb: {
+                const int segments = computeCurveSegments(
+                        distance(pts[0], pts[1]) + distance(pts[1], pts[2]), scale);
+                for (int i = 1; i <= segments; i++) {
+                    const float t = float(i) / segments;
+                    const float u = 1.0f - t;
+                    addPoint(outline,
+                            u * u * pts[0].fX + 2.0f * u * t * pts[1].fX + t * t * pts[2].fX,
+                            u * u * pts[0].fY + 2.0f * u * t * pts[1].fY + t * t * pts[2].fY);
+                }
+                break;
+            }
+            case SkPath::kCubic_Verb: {
+                const int segments = computeCurveSegments(distance(pts[0], pts[1]) +
+                        distance(pts[1], pts[2]) + distance(pts[2], pts[3]), scale);
+                for (int i = 1; i <= segments; i++) {
+                    const float t = float(i) / segments;
+                    const float u = 1.0f - t;
+                    const float a = u * u * u;
+                    const float b = 3.0f * u * u * t;
+                    const float c = 3.0f * u * t * t;
+                    const float d = t * t * t;
+                    addPoint(outline,
+                            a * pts[0].fX + b * pts[1].fX + c * pts[2].fX + d * pts[3].fX,
+                            a * pts[0].fY + b * pts[1].fY + c * pts[2].fY + d * pts[3].fY);
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    tessellateOutline(outline, paint, paint->getStyle(), scaleX, scaleY, mesh, bounds);
+    return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Tessellation
+///////////////////////////////////////////////////////////////////////////////
+
+void PathTessellator::tessellateOutline(const Vector<Vertex>& points,
+        const SkPaint* paint, SkPaint::Style style, float scaleX, float scaleY,
+        Vector<AlphaVertex>& mesh, Rect& bounds) {
+    mesh.clear();
+    bounds.setEmpty();
+
+    // Drop repeated points, they have no normal
+    Vector<Vertex> outline;
+    const float epsilon = 0.01f / fmaxf(scaleX, scaleY);
+    for (size_t i = 0; i < points.size(); i++) {
+        const Vertex& p = points[i];
+        const Vertex* last = outline.isEmpty() ? NULL : &outline.top();
+        if (last && fabsf(last->position[0] - p.position[0]) < epsilon &&
+                fabsf(last->position[1] - p.position[1]) < epsilon) {
+            continue;
+        }
+        outline.push(p);
+    }
+    while (outline.size() > 1 &&
+            fabsf(outline.top().position[0] - outline[0].position[0]) < epsilon &&
+            fabsf(outline.top().position[1] - outline[0].position[1]) < epsilon) {
+        outline.pop();
+    }
+    if (outline.size() < 3) return;
+
+    // The normals computed below point outward for a clockwise outline
+    float area = 0.0f;
+    const size_t count = outline.size();
+    for (size_t i = 0; i < count; i++) {
+        const Vertex& a = outline[i];
+        const Vertex& b = outline[(i + 1) % count];
+        area += a.position[0] * b.position[1] - b.position[0] * a.position[1];
+    }
+    if (fabsf(area) * scaleX * scaleY < epsilon) return;
+    if (area < 0.0f) {
+        Vector<Vertex> reversed;
+        reversed.setCapacity(count);
+        for (size_t i = count; i > 0; i--) {
+            reversed.push(outline[i - 1]);
+        }
+        outline = reversed;
+    }
+
+    Vector<Vertex> normals;
+    computeNormals(outline, normals);
+
+    const bool isAA = paint->isAntiAlias();
+    const float aaX = 0.5f / scaleX;
+    const float aaY = 0.5f / scaleY;
+    const float minScale = fminf(scaleX, scaleY);
+    const float halfStrokeWidth = paint->getStrokeWidth() * 0.5f;
+
+    switch (style) {
+        case SkPaint::kFill_Style:
+            tessellateFill(outline, normals, 0.0f, isAA, aaX, aaY, mesh);
+            break;
+        case SkPaint::kStrokeAndFill_Style:
+            tessellateFill(outline, normals, halfStrokeWidth, isAA, aaX, aaY, mesh);
+            break;
+        default:
+            // Hairlines are one pixel wide whatever the scale
+            tessellateStroke(outline, normals,
+                    halfStrokeWidth > 0.0f ? halfStrokeWidth : 0.5f / minScale,
+                    isAA, aaX, aaY, minScale, mesh);
+            break;
+    }
+
+    if (mesh.isEmpty()) return;
+
+    bounds.set(mesh[0].position[0], mesh[0].position[1],
+            mesh[0].position[0], mesh[0].position[1]);
+    for (size_t i = 1; i < mesh.size(); i++) {
+        const float x = mesh[i].position[0];
+        const float y = mesh[i].position[1];
+        if (x < bounds.left) bounds.left = x;
+        if (x > bounds.right) bounds.right = x;
+        if (y < bounds.top) bounds.top = y;
+        if (y > bounds.bottom) bounds.bottom = y;
+    }
+}
+
+void PathTessellator::computeNormals(const Vector<Vertex>& outline, Vector<Vertex>& normals) {
+    const size_t count = outline.size();
+    normals.setCapacity(count);
+
+    for (size_t i = 0; i < count; i++) {
+        const Vertex& previous = outline[(i + count - 1) % count];
+        const Vertex& current = outline[i];
+        const Vertex& next = outline[(i + 1) % count];
+
+        float x1 = current.position[0] - previous.position[0];
+        float y1 = current.position[1] - previous.position[1];
+        float x2 = next.position[0] - current.position[0];
+        float y2 = next.position[1] - current.position[1];
+
+        float length1 = sqrtf(x1 * x1 + y1 * y1);
+        float length2 = sqrtf(x2 * x2 + y2 * y2);
+
+        // Outward normals of the two edges meeting at this point
+        const float nx1 = y1 / length1;
+        const float ny1 = -x1 / length1;
+        const float nx2 = y2 / length2;
+        const float ny2 = -x2 / length2;
+
+        float nx = nx1 + nx2;
+        float ny = ny1 + ny2;
+        float length = sqrtf(nx * nx + ny * ny);
+        if (length < 0.0001f) {
+            nx = nx2;
+            ny = ny2;
+        } else {
+            nx /= length;
+            ny /= length;
+        }
+
+        // Lengthen the bisector so offset edges stay parallel to the outline
+        float cosine = nx * nx2 + ny * ny2;
+        if (cosine < 1.0f / MAX_MITER) cosine = 1.0f / MAX_MITER;
+
+        Vertex normal;
+        Vertex::set(&normal, nx / cosine, ny / cosine);
+        normals.push(normal);
+    }
+}
+
+/**
+ * Fills the outline, pushed out by outset. The interior is a single strip
+ * zig-zagging between both sides of the polygon. With antialiasing the
+ * interior is pulled in by half a pixel and surrounded by a fringe one
+ * pixel wide.
+ */
+void PathTessellator::tessellateFill(const Vector<Vertex>& outline, const Vector<Vertex>& normals,
+        float outset, bool isAA, float aaX, float aaY, Vector<AlphaVertex>& mesh) {
+    const size_t count = outline.size();
+    const float inner = isAA ? -1.0f : 0.0f;
+
+    mesh.setCapacity(isAA ? count + 2 + (count + 1) * 2 : count);
+
+    size_t low = 1;
+    size_t high = count - 1;
+    bool fromLow = true;
+    addVertex(mesh, outline[0], normals[0], outset, aaX, aaY, inner, 1.0f);
+    while (low <= high) {
+        const size_t i = fromLow ? low++ : high--;
+        addVertex(mesh, outline[i], normals[i], outset, aaX, aaY, inner, 1.0f);
+        fromLow = !fromLow;
+    }
+
+    if (isAA) {
+        addRingStrip(mesh, outline, normals, aaX, aaY,
+                outset, -1.0f, 1.0f, outset, 1.0f, 0.0f);
+    }
+}
+
+/**
+ * Strokes the outline with a ring centered on it. With antialiasing the
+ * ring gets a fringe one pixel wide on both sides; strokes thinner than a
+ * pixel become a two pixels wide ring whose alpha peaks at the stroke width
+ * in the middle, which keeps the coverage of the stroke.
+ */
+void PathTessellator::tessellateStroke(const Vector<Vertex>& outline,
+        const Vector<Vertex>& normals, float halfStrokeWidth, bool isAA,
+        float aaX, float aaY, float minScale, Vector<AlphaVertex>& mesh) {
+    const float hs = halfStrokeWidth;
+
+    if (!isAA) {
+        addRingStrip(mesh, outline, normals, aaX, aaY, hs, 0.0f, 1.0f, -hs, 0.0f, 1.0f);
+        return;
+    }
+
+    const float widthInPixels = 2.0f * hs * minScale;
+    if (widthInPixels < 1.0f) {
+        addRingStrip(mesh, outline, normals, aaX, aaY,
+                0.0f, 2.0f, 0.0f, 0.0f, 0.0f, widthInPixels);
+        addRingStrip(mesh, outline, normals, aaX, aaY,
+                0.0f, 0.0f, widthInPixels, 0.0f, -2.0f, 0.0f);
+        return;
+    }
+
+    addRingStrip(mesh, outline, normals, aaX, aaY, hs, 1.0f, 0.0f, hs, -1.0f, 1.0f);
+    addRingStrip(mesh, outline, normals, aaX, aaY, hs, -1.0f, 1.0f, -hs, 1.0f, 1.0f);
+    addRingStrip(mesh, outline, normals, aaX, aaY, -hs, 1.0f, 1.0f, -hs, -1.0f, 0.0f);
+}
+
+}; // namespace uirenderer
+}; // namespace android
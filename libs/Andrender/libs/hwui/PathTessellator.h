@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_HWUI_PATH_TESSELLATOR_H
+#define ANDROID_HWUI_PATH_TESSELLATOR_H
+
+#include <SkPaint.h>
+#include <SkPath.h>
+
+#include <utils/Vector.h>
+
+#include "Rect.h"
+#include "Vertex.h"
+
+namespace android {
+namespace uirenderer {
+
+///////////////////////////////////////////////////////////////////////////////
+// Classes
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Turns convex shapes into triangle strips of AlphaVertex that can be drawn
+ * without a texture. Antialiasing is done with a fringe one pixel wide along
+ * the outline whose vertex alpha fades from 1 to 0; the fringe is sized for
+ * the specified scale so it stays one pixel wide on screen.
+ *
+ * Each mesh is a single triangle strip, separate strips being joined with
+ * degenerate triangles.
+ */
+class PathTessellator {
+public:
+    /**
+     * Returns true if shapes drawn with the specified paint can be tessellated
+     * by the methods below.
+     */
+    static bool isSupported(const SkPaint* paint);
+
+    /**
+     * Returns true if a round rect (or an oval, whose radii are half its
+     * size) can be tessellated with the specified paint. A stroke wider than
+     * the curvature of the corners, but not wide enough to cover the whole
+     * shape, has an inner edge with sharp corners that the tessellator does
+     * not build; such shapes must be drawn from a path texture.
+     */
+    static bool isSupported(float width, float height, float rx, float ry,
+            const SkPaint* paint, float scaleX, float scaleY);
+
+    /**
+     * Tessellates a round rect whose top-left corner is at the origin.
+     */
+    static void tessellateRoundRect(float width, float height, float rx, float ry,
+            const SkPaint* paint, float scaleX, float scaleY,
+            Vector<AlphaVertex>& mesh, Rect& bounds);
+
+    /**
+     * Tessellates an oval whose top-left corner is at the origin.
+     */
+    static void tessellateOval(float width, float height,
+            const SkPaint* paint, float scaleX, float scaleY,
+            Vector<AlphaVertex>& mesh, Rect& bounds);
+
+    /**
+     * Tessellates a filled convex path, in the coordinates of the path.
+     * Returns false, leaving mesh empty, if the path is not a single convex
+     * contour or cannot be drawn with this paint.
+     */
+    static bool tessellateConvexPath(const SkPath& path,
+            const SkPaint* paint, float scaleX, float scaleY,
+            Vector<AlphaVertex>& mesh, Rect& bounds);
+
+private:
+    static void addArc(float cx, float cy, float rx, float ry,
+            float startAngle, float sweepAngle, int segments, Vector<Vertex>& outline);
+    static int computeArcSegments(float rx, float ry, float scaleX, float scaleY,
+            float sweepAngle);
+
+    static float computeStrokeInset(const SkPaint* paint, float scaleX, float scaleY);
+    static SkPaint::Style computeShapeStyle(float width, float height,
+            const SkPaint* paint, float scaleX, float scaleY);
+
+    static void tessellateOutline(const Vector<Vertex>& outline,
+            const SkPaint* paint, SkPaint::Style style, float scaleX, float scaleY,
+            Vector<AlphaVertex>& mesh, Rect& bounds);
+    static void tessellateFill(const Vector<Vertex>& outline, const Vector<Vertex>& normals,
+            float outset, bool isAA, float aaX, float aaY, Vector<AlphaVertex>& mesh);
+    static void tessellateStroke(const Vector<Vertex>& outline, const Vector<Vertex>& normals,
+            float halfStrokeWidth, bool isAA, float aaX, float aaY, float minScale,
+            Vector<AlphaVertex>& mesh);
+
+    static void computeNormals(const Vector<Vertex>& outline, Vector<Vertex>& normals);
+}; // class PathTessellator
+
+}; // namespace uirenderer
+}; // namespace android
+
+#endif // ANDROID_HWUI_PATH_TESSELLATOR_H
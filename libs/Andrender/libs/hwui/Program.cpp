@@ -84,13 +84,37 @@ Program::Program(const ProgramDescription& description, const char* vertex, cons
     }
 }
 
+Program::Program(GLuint programId, bool hasTexCoords) {
+    mProgramId = programId;
+    mVertexShader = 0;
+    mFragmentShader = 0;
+    mInitialized = true;
+    mHasColorUniform = false;
+    mHasSampler = false;
+    mUse = false;
+
+    mAttributes.add("position", kBindingPosition);
+    position = kBindingPosition;
+    if (hasTexCoords) {
+        mAttributes.add("texCoords", kBindingTexCoords);
+        texCoords = kBindingTexCoords;
+    } else {
+        texCoords = -1;
+    }
+
+    transform = addUniform("transform");
+}
+
 Program::~Program() {
     if (mInitialized) {
-        glDetachShader(mProgramId, mVertexShader);
-        glDetachShader(mProgramId, mFragmentShader);
+        // Programs linked from a binary have no shaders
+        if (mVertexShader) {
+            glDetachShader(mProgramId, mVertexShader);
+            glDetachShader(mProgramId, mFragmentShader);
 
-        glDeleteShader(mVertexShader);
-        glDeleteShader(mFragmentShader);
+            glDeleteShader(mVertexShader);
+            glDeleteShader(mFragmentShader);
+        }
 
         glDeleteProgram(mProgramId);
     }
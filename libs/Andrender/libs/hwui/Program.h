@@ -76,6 +76,8 @@ namespace uirenderer {
 #define PROGRAM_HAS_EXTERNAL_TEXTURE_SHIFT 38
 #define PROGRAM_HAS_TEXTURE_TRANSFORM_SHIFT 39
 
+#define PROGRAM_HAS_VERTEX_ALPHA_SHIFT 40
+
 ///////////////////////////////////////////////////////////////////////////////
 // Types
 ///////////////////////////////////////////////////////////////////////////////
@@ -124,6 +126,9 @@ struct ProgramDescription {
 
     bool isAA;
 
+    // Per-vertex coverage, used by tessellated shapes
+    bool hasVertexAlpha;
+
     bool hasGradient;
     Gradient gradientType;
 
@@ -156,6 +161,7 @@ struct ProgramDescription {
         hasTextureTransform = false;
 
         isAA = false;
+        hasVertexAlpha = false;
 
         modulate = false;
 
@@ -245,6 +251,7 @@ struct ProgramDescription {
         if (isAA) key |= programid(0x1) << PROGRAM_HAS_AA_SHIFT;
         if (hasExternalTexture) key |= programid(0x1) << PROGRAM_HAS_EXTERNAL_TEXTURE_SHIFT;
         if (hasTextureTransform) key |= programid(0x1) << PROGRAM_HAS_TEXTURE_TRANSFORM_SHIFT;
+        if (hasVertexAlpha) key |= programid(0x1) << PROGRAM_HAS_VERTEX_ALPHA_SHIFT;
         return key;
     }
 
@@ -290,6 +297,11 @@ public:
      * shaders sources.
      */
     Program(const ProgramDescription& description, const char* vertex, const char* fragment);
+    /**
+     * Wraps a program already linked, for instance from a binary. The
+     * attributes must have been bound as in the constructor above.
+     */
+    Program(GLuint programId, bool hasTexCoords);
     virtual ~Program();
 
     /**
@@ -328,6 +340,13 @@ public:
         return mInitialized;
     }
 
+    /**
+     * Returns the OpenGL name of this program.
+     */
+    inline GLuint getId() const {
+        return mProgramId;
+    }
+
     /**
      * Binds the program with the specified projection, modelView and
      * transform matrices.
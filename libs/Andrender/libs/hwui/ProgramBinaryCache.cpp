@@ -0,0 +1,298 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "OpenGLRenderer"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <utils/Errors.h>
+#include <utils/Log.h>
+#include <utils/threads.h>
+
+#include "Debug.h"
+#include "ProgramBinaryCache.h"
+#include "Properties.h"
+
+namespace android {
+namespace uirenderer {
+
+///////////////////////////////////////////////////////////////////////////////
+// Defines
+///////////////////////////////////////////////////////////////////////////////
+
+// The extension entry points are only declared when prototypes are requested
+#if defined(GL_OES_get_program_binary) && defined(GL_GLEXT_PROTOTYPES)
+    #define PROGRAM_BINARY_SUPPORTED 1
+#else
+    #define PROGRAM_BINARY_SUPPORTED 0
+#endif
+
+// Must be incremented whenever ProgramCache generates different shaders
+// for the same description
+#define PROGRAM_BINARY_VERSION 1
+
+// Type, version, program key and driver id
+#define PROGRAM_BINARY_MAX_KEY_SIZE 1024
+// Binary format followed by the binary
+#define PROGRAM_BINARY_MAX_VALUE_SIZE (128 * 1024)
+
+///////////////////////////////////////////////////////////////////////////////
+// Cache file
+///////////////////////////////////////////////////////////////////////////////
+
+static Mutex sFilenameLock;
+static String8 sFilename;
+
+void ProgramBinaryCache::setCacheFilename(const char* filename) {
+    Mutex::Autolock _l(sFilenameLock);
+    sFilename.setTo(filename);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructors/destructor
+///////////////////////////////////////////////////////////////////////////////
+
+ProgramBinaryCache::ProgramBinaryCache(): mDirty(false) {
+}
+
+ProgramBinaryCache::~ProgramBinaryCache() {
+    terminate();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Initialization
+///////////////////////////////////////////////////////////////////////////////
+
+void ProgramBinaryCache::init(const Extensions& extensions) {
+    if (mBlobCache != NULL) return;
+
+#if PROGRAM_BINARY_SUPPORTED
+    {
+        Mutex::Autolock _l(sFilenameLock);
+        mFilename = sFilename;
+    }
+    if (mFilename.isEmpty()) {
+        INIT_LOGD("  Program binary cache disabled, no cache file");
+        return;
+    }
+
+    GLint formatCount = 0;
+    if (extensions.hasExtension("GL_OES_get_program_binary")) {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &formatCount);
+    }
+    if (formatCount <= 0) {
+        INIT_LOGD("  Program binary cache disabled, no binary format");
+        return;
+    }
+
+    mDriverId.setTo((const char*) glGetString(GL_VENDOR));
+    mDriverId.append("/");
+    mDriverId.append((const char*) glGetString(GL_RENDERER));
+    mDriverId.append("/");
+    mDriverId.append((const char*) glGetString(GL_VERSION));
+
+    float maxSize = DEFAULT_PROGRAM_BINARY_CACHE_SIZE;
+    char property[PROPERTY_VALUE_MAX];
+    if (property_get(PROPERTY_PROGRAM_BINARY_CACHE_SIZE, property, NULL) > 0) {
+        INIT_LOGD("  Setting program binary cache size to %sMB", property);
+        maxSize = atof(property);
+    } else {
+        INIT_LOGD("  Using default program binary cache size of %.2fMB", maxSize);
+    }
+
+    mBlobCache = new BlobCache(PROGRAM_BINARY_MAX_KEY_SIZE, PROGRAM_BINARY_MAX_VALUE_SIZE,
+            MB(maxSize));
+    mDirty = false;
+
+    FILE* file = fopen(mFilename.string(), "rb");
+    if (!file) {
+        return;
+    }
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    if (size > 0) {
+        uint8_t* buffer = new uint8_t[size];
+        if (fread(buffer, 1, size, file) != size_t(size) ||
+                mBlobCache->unflatten(buffer, size, NULL, 0) != OK) {
+            // unflatten() leaves the cache empty, it will be rewritten
+            ALOGW("Discarding invalid program binary cache %s", mFilename.string());
+            mDirty = true;
+        }
+        delete[] buffer;
+    }
+
+    fclose(file);
+#endif
+}
+
+void ProgramBinaryCache::terminate() {
+    save();
+    mBlobCache.clear();
+}
+
+void ProgramBinaryCache::save() {
+    if (mBlobCache == NULL || !mDirty) return;
+
+    const size_t size = mBlobCache->getFlattenedSize();
+    uint8_t* buffer = new uint8_t[size];
+    if (mBlobCache->flatten(buffer, size, NULL, 0) != OK) {
+        ALOGE("Could not flatten the program binary cache");
+        delete[] buffer;
+        return;
+    }
+
+    // Write to a temporary file so a crash never leaves a truncated cache
+    String8 temporary(mFilename);
+    temporary.append(".tmp");
+
+    FILE* file = fopen(temporary.string(), "wb");
+    if (!file) {
+        ALOGE("Could not create the program binary cache %s", temporary.string());
+        delete[] buffer;
+        return;
+    }
+
+    const bool written = fwrite(buffer, 1, size, file) == size;
+    fclose(file);
+    delete[] buffer;
+
+    if (!written || rename(temporary.string(), mFilename.string()) != 0) {
+        ALOGE("Could not write the program binary cache %s", mFilename.string());
+        remove(temporary.string());
+        return;
+    }
+
+    mDirty = false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Programs
+///////////////////////////////////////////////////////////////////////////////
+
+void ProgramBinaryCache::buildKey(EntryType type, programid key,
+        Vector<uint8_t>& blobKey) const {
+    const uint32_t entryType = type;
+    const uint32_t version = PROGRAM_BINARY_VERSION;
+    blobKey.clear();
+    blobKey.appendArray((const uint8_t*) &entryType, sizeof(entryType));
+    blobKey.appendArray((const uint8_t*) &version, sizeof(version));
+    blobKey.appendArray((const uint8_t*) &key, sizeof(key));
+    blobKey.appendArray((const uint8_t*) mDriverId.string(), mDriverId.length());
+}
+
+GLuint ProgramBinaryCache::loadProgram(programid key) {
+#if PROGRAM_BINARY_SUPPORTED
+    if (mBlobCache == NULL) return 0;
+
+    Vector<uint8_t> blobKey;
+    buildKey(kEntryProgram, key, blobKey);
+
+    const size_t size = mBlobCache->get(blobKey.array(), blobKey.size(), NULL, 0);
+    if (size <= sizeof(GLenum)) return 0;
+
+    uint8_t* value = new uint8_t[size];
+    if (mBlobCache->get(blobKey.array(), blobKey.size(), value, size) != size) {
+        delete[] value;
+        return 0;
+    }
+
+    GLenum format;
+    memcpy(&format, value, sizeof(GLenum));
+
+    GLuint programId = glCreateProgram();
+    glProgramBinaryOES(programId, format, value + sizeof(GLenum), size - sizeof(GLenum));
+    delete[] value;
+
+    // Drivers reject binaries they no longer understand
+    GLint status;
+    glGetProgramiv(programId, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        PROGRAM_LOGD("Program binary rejected by the driver");
+        glDeleteProgram(programId);
+        return 0;
+    }
+
+    return programId;
+#else
+    return 0;
+#endif
+}
+
+void ProgramBinaryCache::storeProgram(programid key, GLuint programId) {
+#if PROGRAM_BINARY_SUPPORTED
+    if (mBlobCache == NULL) return;
+
+    GLint length = 0;
+    glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+    if (length <= 0 || sizeof(GLenum) + length > PROGRAM_BINARY_MAX_VALUE_SIZE) return;
+
+    uint8_t* value = new uint8_t[sizeof(GLenum) + length];
+    GLenum format = 0;
+    GLsizei written = 0;
+    glGetProgramBinaryOES(programId, length, &written, &format, value + sizeof(GLenum));
+
+    if (written > 0) {
+        memcpy(value, &format, sizeof(GLenum));
+
+        Vector<uint8_t> blobKey;
+        buildKey(kEntryProgram, key, blobKey);
+        mBlobCache->set(blobKey.array(), blobKey.size(), value, sizeof(GLenum) + written);
+        mDirty = true;
+    }
+
+    delete[] value;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Precaching
+///////////////////////////////////////////////////////////////////////////////
+
+void ProgramBinaryCache::getPrecacheKeys(Vector<programid>& keys) {
+    keys.clear();
+    if (mBlobCache == NULL) return;
+
+    Vector<uint8_t> blobKey;
+    buildKey(kEntryPrecacheKeys, 0, blobKey);
+
+    const size_t size = mBlobCache->get(blobKey.array(), blobKey.size(), NULL, 0);
+    const size_t count = size / sizeof(programid);
+    if (count == 0 || size % sizeof(programid) != 0) return;
+
+    keys.insertAt(programid(0), 0, count);
+    if (mBlobCache->get(blobKey.array(), blobKey.size(), keys.editArray(),
+            count * sizeof(programid)) != size) {
+        keys.clear();
+    }
+}
+
+void ProgramBinaryCache::setPrecacheKeys(const Vector<programid>& keys) {
+    if (mBlobCache == NULL || keys.isEmpty()) return;
+
+    Vector<uint8_t> blobKey;
+    buildKey(kEntryPrecacheKeys, 0, blobKey);
+    mBlobCache->set(blobKey.array(), blobKey.size(), keys.array(),
+            keys.size() * sizeof(programid));
+    mDirty = true;
+}
+
+}; // namespace uirenderer
+}; // namespace android
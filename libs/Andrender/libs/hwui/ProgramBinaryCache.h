@@ -0,0 +1,113 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_HWUI_PROGRAM_BINARY_CACHE_H
+#define ANDROID_HWUI_PROGRAM_BINARY_CACHE_H
+
+#include <utils/BlobCache.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
+
+#include <xp-macros.h>
+
+#include "Extensions.h"
+#include "Program.h"
+
+namespace android {
+namespace uirenderer {
+
+///////////////////////////////////////////////////////////////////////////////
+// Classes
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * Stores linked program binaries in a BlobCache persisted to disk, so that
+ * programs created in a previous session do not have to be compiled again.
+ * Binaries are keyed by program description and driver: a driver update
+ * makes the stored binaries unreachable and they are evicted over time.
+ *
+ * The cache is disabled when the driver does not expose program binaries
+ * (GL_OES_get_program_binary) or when no file was set.
+ */
+class ProgramBinaryCache {
+public:
+    ProgramBinaryCache();
+    ~ProgramBinaryCache();
+
+    /**
+     * Sets the file the cache is persisted to, typically in the cache
+     * directory of the application. Must be called before the caches
+     * are initialized.
+     */
+    static void setCacheFilename(const char* filename);
+
+    /**
+     * Loads the cache from disk. Must be called with a GL context.
+     */
+    void init(const Extensions& extensions);
+    /**
+     * Writes the cache to disk if it changed and releases it.
+     */
+    void terminate();
+    /**
+     * Writes the cache to disk if it changed.
+     */
+    void save();
+
+    inline bool isEnabled() const {
+        return mBlobCache != NULL;
+    }
+
+    /**
+     * Creates and links a program from its stored binary. Returns 0 if
+     * there is no binary for this key or if the driver rejects it.
+     */
+    GLuint loadProgram(programid key);
+    /**
+     * Stores the binary of a linked program.
+     */
+    void storeProgram(programid key, GLuint programId);
+
+    /**
+     * Returns the keys of the programs saved with setPrecacheKeys() in the
+     * previous session.
+     */
+    void getPrecacheKeys(Vector<programid>& keys);
+    /**
+     * Records the keys of the programs to link as soon as the next session
+     * starts, most important first.
+     */
+    void setPrecacheKeys(const Vector<programid>& keys);
+
+private:
+    enum EntryType {
+        kEntryProgram = 1,
+        kEntryPrecacheKeys
+    };
+
+    void buildKey(EntryType type, programid key, Vector<uint8_t>& blobKey) const;
+
+    mindroid::sp<BlobCache> mBlobCache;
+    String8 mFilename;
+    // Identifies the driver, part of every key
+    String8 mDriverId;
+    bool mDirty;
+}; // class ProgramBinaryCache
+
+}; // namespace uirenderer
+}; // namespace android
+
+#endif // ANDROID_HWUI_PROGRAM_BINARY_CACHE_H
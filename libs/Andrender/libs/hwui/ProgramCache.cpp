@@ -43,6 +43,8 @@ const char* gVS_Header_Attributes_TexCoords =
 const char* gVS_Header_Attributes_AAParameters =
         "attribute float vtxWidth;\n"
         "attribute float vtxLength;\n";
+const char* gVS_Header_Attributes_VertexAlpha =
+        "attribute float vtxAlpha;\n";
 const char* gVS_Header_Uniforms_TextureTransform =
         "uniform mat4 mainTextureTransform;\n";
 const char* gVS_Header_Uniforms =
@@ -65,6 +67,8 @@ const char* gVS_Header_Varyings_HasTexture =
 const char* gVS_Header_Varyings_IsAA =
         "varying float widthProportion;\n"
         "varying float lengthProportion;\n";
+const char* gVS_Header_Varyings_HasVertexAlpha =
+        "varying float alpha;\n";
 const char* gVS_Header_Varyings_HasBitmap[2] = {
         // Default precision
         "varying vec2 outBitmapTexCoords;\n",
@@ -110,6 +114,8 @@ const char* gVS_Main_PointSize =
 const char* gVS_Main_AA =
         "    widthProportion = vtxWidth;\n"
         "    lengthProportion = vtxLength;\n";
+const char* gVS_Main_VertexAlpha =
+        "    alpha = vtxAlpha;\n";
 const char* gVS_Footer =
         "}\n\n";
 
@@ -213,6 +219,8 @@ const char* gFS_Main_AccountForAA =
         "    } else if (lengthProportion > (1.0 - boundaryLength)) {\n"
         "        fragColor *= ((1.0 - lengthProportion) * inverseBoundaryLength);\n"
         "    }\n";
+const char* gFS_Main_ApplyVertexAlpha =
+        "    fragColor *= alpha;\n";
 const char* gFS_Main_FetchTexture[2] = {
         // Don't modulate
         "    fragColor = texture2D(sampler, outTexCoords);\n",
@@ -345,13 +353,31 @@ const char* gBlendOps[18] = {
 // Constructors/destructors
 ///////////////////////////////////////////////////////////////////////////////
 
-ProgramCache::ProgramCache() {
+ProgramCache::ProgramCache(): mPrecacheCount(DEFAULT_PROGRAM_PRECACHE_COUNT) {
+    char property[PROPERTY_VALUE_MAX];
+    if (property_get(PROPERTY_PROGRAM_PRECACHE_COUNT, property, NULL) > 0) {
+        INIT_LOGD("  Setting program precache count to %s", property);
+        mPrecacheCount = atoi(property);
+    } else {
+        INIT_LOGD("  Using default program precache count of %d", mPrecacheCount);
+    }
 }
 
 ProgramCache::~ProgramCache() {
     clear();
 }
 
+void ProgramCache::init(const Extensions& extensions) {
+    mBinaryCache.init(extensions);
+    precachePrograms();
+}
+
+void ProgramCache::terminate() {
+    saveBinaries();
+    mBinaryCache.terminate();
+    clear();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Cache management
 ///////////////////////////////////////////////////////////////////////////////
@@ -364,6 +390,7 @@ void ProgramCache::clear() {
         delete mCache.valueAt(i);
     }
     mCache.clear();
+    mUseCounts.clear();
 }
 
 Program* ProgramCache::get(const ProgramDescription& description) {
@@ -374,21 +401,81 @@ Program* ProgramCache::get(const ProgramDescription& description) {
         description.log("Could not find program");
         program = generateProgram(description, key);
         mCache.add(key, program);
+        mUseCounts.add(key, 1);
     } else {
         program = mCache.valueAt(index);
+        mUseCounts.editValueAt(index)++;
     }
     return program;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Program binaries
+///////////////////////////////////////////////////////////////////////////////
+
+bool ProgramCache::hasTexCoords(programid key) {
+    return (key & PROGRAM_KEY_TEXTURE) ||
+            (key & (programid(0x1) << PROGRAM_HAS_EXTERNAL_TEXTURE_SHIFT));
+}
+
+void ProgramCache::precachePrograms() {
+    if (!mBinaryCache.isEnabled()) return;
+
+    Vector<programid> keys;
+    mBinaryCache.getPrecacheKeys(keys);
+
+    for (size_t i = 0; i < keys.size() && i < mPrecacheCount; i++) {
+        const programid key = keys[i];
+        if (mCache.indexOfKey(key) >= 0) continue;
+
+        GLuint programId = mBinaryCache.loadProgram(key);
+        if (programId) {
+            mCache.add(key, new Program(programId, hasTexCoords(key)));
+            mUseCounts.add(key, 0);
+        }
+    }
+
+    PROGRAM_LOGD("Precached %d programs", mCache.size());
+}
+
+void ProgramCache::saveBinaries() {
+    if (!mBinaryCache.isEnabled()) return;
+
+    // Selects the most used programs, few enough to sort them naively
+    KeyedVector<programid, uint32_t> counts(mUseCounts);
+    Vector<programid> keys;
+    while (keys.size() < mPrecacheCount && !counts.isEmpty()) {
+        size_t best = 0;
+        for (size_t i = 1; i < counts.size(); i++) {
+            if (counts.valueAt(i) > counts.valueAt(best)) {
+                best = i;
+            }
+        }
+        keys.add(counts.keyAt(best));
+        counts.removeItemsAt(best);
+    }
+
+    mBinaryCache.setPrecacheKeys(keys);
+    mBinaryCache.save();
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Program generation
 ///////////////////////////////////////////////////////////////////////////////
 
 Program* ProgramCache::generateProgram(const ProgramDescription& description, programid key) {
+    GLuint programId = mBinaryCache.loadProgram(key);
+    if (programId) {
+        return new Program(programId, description.hasTexture || description.hasExternalTexture);
+    }
+
     String8 vertexShader = generateVertexShader(description);
     String8 fragmentShader = generateFragmentShader(description);
 
     Program* program = new Program(description, vertexShader.string(), fragmentShader.string());
+    if (program->isInitialized()) {
+        mBinaryCache.storeProgram(key, program->getId());
+    }
     return program;
 }
 
@@ -401,6 +488,9 @@ String8 ProgramCache::generateVertexShader(const ProgramDescription& description
     if (description.isAA) {
         shader.append(gVS_Header_Attributes_AAParameters);
     }
+    if (description.hasVertexAlpha) {
+        shader.append(gVS_Header_Attributes_VertexAlpha);
+    }
     // Uniforms
     shader.append(gVS_Header_Uniforms);
     if (description.hasTextureTransform) {
@@ -422,6 +512,9 @@ String8 ProgramCache::generateVertexShader(const ProgramDescription& description
     if (description.isAA) {
         shader.append(gVS_Header_Varyings_IsAA);
     }
+    if (description.hasVertexAlpha) {
+        shader.append(gVS_Header_Varyings_HasVertexAlpha);
+    }
     if (description.hasGradient) {
         shader.append(gVS_Header_Varyings_HasGradient[description.gradientType]);
     }
@@ -442,6 +535,9 @@ String8 ProgramCache::generateVertexShader(const ProgramDescription& description
         if (description.isAA) {
             shader.append(gVS_Main_AA);
         }
+        if (description.hasVertexAlpha) {
+            shader.append(gVS_Main_VertexAlpha);
+        }
         if (description.hasGradient) {
             shader.append(gVS_Main_OutGradient[description.gradientType]);
         }
@@ -484,6 +580,9 @@ String8 ProgramCache::generateFragmentShader(const ProgramDescription& descripti
     if (description.isAA) {
         shader.append(gVS_Header_Varyings_IsAA);
     }
+    if (description.hasVertexAlpha) {
+        shader.append(gVS_Header_Varyings_HasVertexAlpha);
+    }
     if (description.hasGradient) {
         shader.append(gVS_Header_Varyings_HasGradient[description.gradientType]);
     }
@@ -519,7 +618,7 @@ String8 ProgramCache::generateFragmentShader(const ProgramDescription& descripti
     }
 
     // Optimization for common cases
-    if (!description.isAA && !blendFramebuffer &&
+    if (!description.isAA && !description.hasVertexAlpha && !blendFramebuffer &&
             description.colorOp == ProgramDescription::kColorNone && !description.isPoint) {
         bool fast = false;
 
@@ -647,6 +746,10 @@ String8 ProgramCache::generateFragmentShader(const ProgramDescription& descripti
         }
         // Apply the color op if needed
         shader.append(gFS_Main_ApplyColorOp[description.colorOp]);
+        // Apply the coverage last, after any color op
+        if (description.hasVertexAlpha) {
+            shader.append(gFS_Main_ApplyVertexAlpha);
+        }
         // Output the fragment
         if (!blendFramebuffer) {
             shader.append(gFS_Main_FragColor);
@@ -24,7 +24,9 @@
 #include <xp-macros.h>
 
 #include "Debug.h"
+#include "Extensions.h"
 #include "Program.h"
+#include "ProgramBinaryCache.h"
 #include "Properties.h"
 
 namespace android {
@@ -48,17 +50,38 @@ namespace uirenderer {
 /**
  * Generates and caches program. Programs are generated based on
  * ProgramDescriptions.
+ *
+ * The binaries of linked programs are kept in a ProgramBinaryCache so that
+ * the next session does not have to compile them again.
  */
 class ProgramCache {
 public:
     ProgramCache();
     ~ProgramCache();
 
+    /**
+     * Loads the program binaries of the previous session and links the
+     * programs it used the most. Must be called with a GL context.
+     */
+    void init(const Extensions& extensions);
+    /**
+     * Saves the program binaries and deletes all programs.
+     */
+    void terminate();
+    /**
+     * Writes the program binaries created so far to disk, along with the
+     * list of the most used programs.
+     */
+    void saveBinaries();
+
     Program* get(const ProgramDescription& description);
 
     void clear();
 
 private:
+    static bool hasTexCoords(programid key);
+
+    void precachePrograms();
     Program* generateProgram(const ProgramDescription& description, programid key);
     String8 generateVertexShader(const ProgramDescription& description);
     String8 generateFragmentShader(const ProgramDescription& description);
@@ -68,6 +91,11 @@ private:
     void printLongString(const String8& shader) const;
 
     KeyedVector<programid, Program*> mCache;
+    // Number of get() calls per program, same keys as mCache
+    KeyedVector<programid, uint32_t> mUseCounts;
+
+    ProgramBinaryCache mBinaryCache;
+    uint32_t mPrecacheCount;
 }; // class ProgramCache
 
 }; // namespace uirenderer
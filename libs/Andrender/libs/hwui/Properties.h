@@ -19,6 +19,7 @@
 
 #include <cutils/properties.h>
 #include <stdlib.h>
+#include <string.h>
 
 /**
  * This file contains the list of system properties used to configure
@@ -57,14 +58,41 @@ enum DebugLevel {
     kDebugMoreCaches = kDebugMemory | kDebugCaches
 };
 
+/**
+ * Set to "false" to draw the ops of display lists hidden behind the opaque
+ * ops drawn after them.
+ */
+#define PROPERTY_OCCLUSION_CULLING "debug.hwui.occlusion_culling"
+
+/**
+ * Set to "show" to tint the frame by overdraw count and log the overdraw
+ * ratio of each frame, or to "count" to only log the ratio.
+ */
+#define PROPERTY_DEBUG_OVERDRAW "debug.hwui.overdraw"
+
+/**
+ * Overdraw debug modes.
+ */
+enum DebugOverdraw {
+    kDebugOverdrawDisabled = 0,
+    kDebugOverdrawCount,
+    kDebugOverdrawShow
+};
+
 // These properties are defined in mega-bytes
 #define PROPERTY_TEXTURE_CACHE_SIZE "ro.hwui.texture_cache_size"
 #define PROPERTY_LAYER_CACHE_SIZE "ro.hwui.layer_cache_size"
 #define PROPERTY_GRADIENT_CACHE_SIZE "ro.hwui.gradient_cache_size"
 #define PROPERTY_PATH_CACHE_SIZE "ro.hwui.path_cache_size"
 #define PROPERTY_SHAPE_CACHE_SIZE "ro.hwui.shape_cache_size"
+#define PROPERTY_TESSELLATION_CACHE_SIZE "ro.hwui.tessellation_cache_size"
 #define PROPERTY_DROP_SHADOW_CACHE_SIZE "ro.hwui.drop_shadow_cache_size"
 #define PROPERTY_FBO_CACHE_SIZE "ro.hwui.fbo_cache_size"
+#define PROPERTY_PROGRAM_BINARY_CACHE_SIZE "ro.hwui.program_binary_cache_size"
+
+// Number of programs, the most used in the previous session, linked from
+// their binaries when the caches are initialized
+#define PROPERTY_PROGRAM_PRECACHE_COUNT "ro.hwui.program_precache_count"
 
 // These properties are defined in percentage (range 0..1)
 #define PROPERTY_TEXTURE_CACHE_FLUSH_RATE "ro.hwui.texture_cache_flush_rate"
@@ -88,13 +116,19 @@ enum DebugLevel {
 #define DEFAULT_LAYER_CACHE_SIZE 16.0f
 #define DEFAULT_PATH_CACHE_SIZE 4.0f
 #define DEFAULT_SHAPE_CACHE_SIZE 1.0f
+#define DEFAULT_TESSELLATION_CACHE_SIZE 1.0f
 #define DEFAULT_PATCH_CACHE_SIZE 512
 #define DEFAULT_GRADIENT_CACHE_SIZE 0.5f
 #define DEFAULT_DROP_SHADOW_CACHE_SIZE 2.0f
 #define DEFAULT_FBO_CACHE_SIZE 16
+#define DEFAULT_PROGRAM_BINARY_CACHE_SIZE 2.0f
+#define DEFAULT_PROGRAM_PRECACHE_COUNT 16
 
 #define DEFAULT_TEXTURE_CACHE_FLUSH_RATE 0.6f
 
+#define DEFAULT_TEXT_CACHE_WIDTH 1024
+#define DEFAULT_TEXT_CACHE_HEIGHT 256
+
 #define DEFAULT_TEXT_GAMMA 1.4f
 #define DEFAULT_TEXT_BLACK_GAMMA_THRESHOLD 64
 #define DEFAULT_TEXT_WHITE_GAMMA_THRESHOLD 192
@@ -107,4 +141,21 @@ static DebugLevel readDebugLevel() {
     return kDebugDisabled;
 }
 
+static bool readOcclusionCulling() {
+    char property[PROPERTY_VALUE_MAX];
+    if (property_get(PROPERTY_OCCLUSION_CULLING, property, NULL) > 0) {
+        return strcmp(property, "false") != 0;
+    }
+    return true;
+}
+
+static DebugOverdraw readDebugOverdraw() {
+    char property[PROPERTY_VALUE_MAX];
+    if (property_get(PROPERTY_DEBUG_OVERDRAW, property, NULL) > 0) {
+        if (!strcmp(property, "show")) return kDebugOverdrawShow;
+        if (!strcmp(property, "count")) return kDebugOverdrawCount;
+    }
+    return kDebugOverdrawDisabled;
+}
+
 #endif // ANDROID_HWUI_PROPERTIES_H
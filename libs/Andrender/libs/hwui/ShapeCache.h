@@ -333,6 +333,12 @@ public:
      * Returns the current size of the cache in bytes.
      */
     uint32_t getSize();
+    /**
+     * Returns the number of entries removed to make room for new ones.
+     */
+    uint32_t getEvictionCount() const {
+        return mEvictionCount;
+    }
 
 protected:
     PathTexture* addTexture(const Entry& entry, const SkPath *path, const SkPaint* paint);
@@ -345,8 +351,8 @@ protected:
      */
     void purgeCache(uint32_t width, uint32_t height);
 
-    void initBitmap(SkBitmap& bitmap, uint32_t width, uint32_t height);
-    void initPaint(SkPaint& paint);
+    static void initBitmap(SkBitmap& bitmap, uint32_t width, uint32_t height);
+    static void initPaint(SkPaint& paint);
 
     bool checkTextureSize(uint32_t width, uint32_t height);
 
@@ -359,6 +365,7 @@ protected:
     GenerationCache<Entry, PathTexture*> mCache;
     uint32_t mSize;
     uint32_t mMaxSize;
+    uint32_t mEvictionCount;
     GLuint mMaxTextureSize;
 
     char* mName;
@@ -416,7 +423,7 @@ public:
 template<class Entry>
 ShapeCache<Entry>::ShapeCache(const char* name, const char* propertyName, float defaultSize):
         mCache(GenerationCache<ShapeCacheEntry, PathTexture*>::kUnlimitedCapacity),
-        mSize(0), mMaxSize(MB(defaultSize)) {
+        mSize(0), mMaxSize(MB(defaultSize)), mEvictionCount(0) {
     char property[PROPERTY_VALUE_MAX];
     if (property_get(propertyName, property, NULL) > 0) {
         INIT_LOGD("  Setting %s cache size to %sMB", name, property);
@@ -469,6 +476,7 @@ void ShapeCache<Entry>::setMaxSize(uint32_t maxSize) {
     mMaxSize = maxSize;
     while (mSize > mMaxSize) {
         mCache.removeOldest();
+        mEvictionCount++;
     }
 }
 
@@ -528,6 +536,7 @@ void ShapeCache<Entry>::purgeCache(uint32_t width, uint32_t height) {
     if (size < mMaxSize) {
         while (mSize + size > mMaxSize) {
             mCache.removeOldest();
+            mEvictionCount++;
         }
     }
 }
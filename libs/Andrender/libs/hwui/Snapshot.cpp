@@ -74,6 +74,10 @@ Snapshot::Snapshot(): flags(0), previous(NULL), layer(NULL), fbo(0),
     } else {
         region = NULL;
     }
+
+    if (s->flags & Snapshot::kFlagInLayer) {
+        flags |= Snapshot::kFlagInLayer;
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -75,7 +75,12 @@ public:
          * Indicates that this snapshot or an ancestor snapshot is
          * an FBO layer.
          */
-        kFlagFboTarget = 0x10
+        kFlagFboTarget = 0x10,
+        /**
+         * Indicates that this snapshot or an ancestor snapshot was
+         * saved as a layer.
+         */
+        kFlagInLayer = 0x20
     };
 
     /**
@@ -0,0 +1,169 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "OpenGLRenderer"
+
+#include <xp-macros.h>
+
+#include <math.h>
+
+#include "Caches.h"
+#include "Debug.h"
+#include "Properties.h"
+#include "TessellationCache.h"
+
+namespace android {
+namespace uirenderer {
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructors/destructor
+///////////////////////////////////////////////////////////////////////////////
+
+TessellationCache::TessellationCache():
+        mCache(GenerationCache<TessellationCacheEntry, VertexBuffer*>::kUnlimitedCapacity),
+        mSize(0), mMaxSize(MB(DEFAULT_TESSELLATION_CACHE_SIZE)), mEvictionCount(0) {
+    char property[PROPERTY_VALUE_MAX];
+    if (property_get(PROPERTY_TESSELLATION_CACHE_SIZE, property, NULL) > 0) {
+        INIT_LOGD("  Setting tessellation cache size to %sMB", property);
+        setMaxSize(MB(atof(property)));
+    } else {
+        INIT_LOGD("  Using default tessellation cache size of %.2fMB",
+                DEFAULT_TESSELLATION_CACHE_SIZE);
+    }
+
+    mCache.setOnEntryRemovedListener(this);
+}
+
+TessellationCache::~TessellationCache() {
+    mCache.clear();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Size management
+///////////////////////////////////////////////////////////////////////////////
+
+uint32_t TessellationCache::getSize() {
+    return mSize;
+}
+
+uint32_t TessellationCache::getMaxSize() {
+    return mMaxSize;
+}
+
+void TessellationCache::setMaxSize(uint32_t maxSize) {
+    mMaxSize = maxSize;
+    while (mSize > mMaxSize) {
+        mCache.removeOldest();
+        mEvictionCount++;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Callbacks
+///////////////////////////////////////////////////////////////////////////////
+
+void TessellationCache::operator()(TessellationCacheEntry& entry, VertexBuffer*& buffer) {
+    if (buffer) {
+        mSize -= buffer->getSize();
+
+        // The name may be reused by the next VBO, which must then be bound again
+        Caches::getInstance().unbindMeshBuffer();
+        glDeleteBuffers(1, &buffer->id);
+        delete buffer;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Caching
+///////////////////////////////////////////////////////////////////////////////
+
+float TessellationCache::quantizeScale(float scale) {
+    // A sixteenth changes the fringe by less than a thirtieth of a pixel
+    const float quantized = roundf(scale * 16.0f) / 16.0f;
+    return quantized > 0.0f ? quantized : 1.0f / 16.0f;
+}
+
+const VertexBuffer* TessellationCache::getRoundRect(float width, float height,
+        float rx, float ry, SkPaint* paint, float scaleX, float scaleY) {
+    scaleX = quantizeScale(scaleX);
+    scaleY = quantizeScale(scaleY);
+
+    TessellationCacheEntry entry(TessellationCacheEntry::kShapeRoundRect,
+            width, height, rx, ry, paint, scaleX, scaleY);
+    VertexBuffer* buffer = mCache.get(entry);
+
+    if (!buffer) {
+        Vector<AlphaVertex> mesh;
+        Rect bounds;
+        PathTessellator::tessellateRoundRect(width, height, rx, ry, paint, scaleX, scaleY,
+                mesh, bounds);
+        buffer = addVertexBuffer(entry, mesh, bounds);
+    }
+
+    return buffer;
+}
+
+const VertexBuffer* TessellationCache::getOval(float width, float height,
+        SkPaint* paint, float scaleX, float scaleY) {
+    scaleX = quantizeScale(scaleX);
+    scaleY = quantizeScale(scaleY);
+
+    TessellationCacheEntry entry(TessellationCacheEntry::kShapeOval,
+            width, height, 0.0f, 0.0f, paint, scaleX, scaleY);
+    VertexBuffer* buffer = mCache.get(entry);
+
+    if (!buffer) {
+        Vector<AlphaVertex> mesh;
+        Rect bounds;
+        PathTessellator::tessellateOval(width, height, paint, scaleX, scaleY, mesh, bounds);
+        buffer = addVertexBuffer(entry, mesh, bounds);
+    }
+
+    return buffer;
+}
+
+VertexBuffer* TessellationCache::addVertexBuffer(const TessellationCacheEntry& entry,
+        const Vector<AlphaVertex>& mesh, const Rect& bounds) {
+    if (mesh.isEmpty()) {
+        return NULL;
+    }
+
+    VertexBuffer* buffer = new VertexBuffer;
+    buffer->vertexCount = mesh.size();
+    buffer->bounds.set(bounds);
+
+    const uint32_t size = buffer->getSize();
+    while (mSize + size > mMaxSize && mCache.size() > 0) {
+        mCache.removeOldest();
+        mEvictionCount++;
+    }
+
+    glGenBuffers(1, &buffer->id);
+    Caches::getInstance().bindMeshBuffer(buffer->id);
+    glBufferData(GL_ARRAY_BUFFER, size, mesh.array(), GL_STATIC_DRAW);
+
+    mSize += size;
+    mCache.put(entry, buffer);
+
+    return buffer;
+}
+
+void TessellationCache::clear() {
+    mCache.clear();
+}
+
+}; // namespace uirenderer
+}; // namespace android
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2012 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_HWUI_TESSELLATION_CACHE_H
+#define ANDROID_HWUI_TESSELLATION_CACHE_H
+
+#include <xp-macros.h>
+
+#include <SkPaint.h>
+
+#include "PathTessellator.h"
+#include "Rect.h"
+#include "utils/Compare.h"
+#include "utils/GenerationCache.h"
+
+namespace android {
+namespace uirenderer {
+
+///////////////////////////////////////////////////////////////////////////////
+// Classes
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * A tessellated shape stored in a VBO, as a triangle strip of AlphaVertex.
+ */
+struct VertexBuffer {
+    VertexBuffer(): id(0), vertexCount(0) {
+    }
+
+    uint32_t getSize() const {
+        return vertexCount * sizeof(AlphaVertex);
+    }
+
+    /**
+     * Name of the VBO.
+     */
+    GLuint id;
+    /**
+     * Number of vertices in the triangle strip.
+     */
+    uint32_t vertexCount;
+    /**
+     * Bounds of the mesh, antialiasing fringe included.
+     */
+    Rect bounds;
+}; // struct VertexBuffer
+
+/**
+ * Describes a shape in the tessellation cache. Everything that changes the
+ * mesh is part of the key, the scale included since it sets the number of
+ * segments and the width of the antialiasing fringe.
+ */
+struct TessellationCacheEntry {
+    enum ShapeType {
+        kShapeNone,
+        kShapeRoundRect,
+        kShapeOval
+    };
+
+    TessellationCacheEntry() {
+        shapeType = kShapeNone;
+        width = height = rx = ry = 0.0f;
+        style = SkPaint::kFill_Style;
+        strokeWidth = 0.0f;
+        antiAlias = false;
+        scaleX = scaleY = 1.0f;
+    }
+
+    TessellationCacheEntry(ShapeType type, float width, float height, float rx, float ry,
+            SkPaint* paint, float scaleX, float scaleY) {
+        shapeType = type;
+        this->width = width;
+        this->height = height;
+        this->rx = rx;
+        this->ry = ry;
+        style = paint->getStyle();
+        strokeWidth = paint->getStrokeWidth();
+        antiAlias = paint->isAntiAlias();
+        this->scaleX = scaleX;
+        this->scaleY = scaleY;
+    }
+
+    ShapeType shapeType;
+    float width;
+    float height;
+    float rx;
+    float ry;
+    SkPaint::Style style;
+    float strokeWidth;
+    bool antiAlias;
+    float scaleX;
+    float scaleY;
+
+    bool operator<(const TessellationCacheEntry& rhs) const {
+        LTE_INT(shapeType) {
+            LTE_FLOAT(width) {
+                LTE_FLOAT(height) {
+                    LTE_FLOAT(rx) {
+                        LTE_FLOAT(ry) {
+                            LTE_INT(style) {
+                                LTE_FLOAT(strokeWidth) {
+                                    LTE_INT(antiAlias) {
+                                        LTE_FLOAT(scaleX) {
+                                            LTE_FLOAT(scaleY) {
+                                                return false;
+                                            }
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return false;
+    }
+}; // struct TessellationCacheEntry
+
+/**
+ * A simple LRU cache of tessellated shapes. The cache has a maximum size
+ * expressed in bytes of vertex data. Any mesh added to the cache causing
+ * the cache to grow beyond the maximum allowed size will also cause the
+ * oldest mesh to be kicked out.
+ *
+ * Unlike ShapeCache, resizing a shape only costs a tessellation and a small
+ * upload, no rasterization.
+ */
+class TessellationCache: public OnEntryRemoved<TessellationCacheEntry, VertexBuffer*> {
+public:
+    TessellationCache();
+    ~TessellationCache();
+
+    /**
+     * Used as a callback when an entry is removed from the cache.
+     * Do not invoke directly.
+     */
+    void operator()(TessellationCacheEntry& entry, VertexBuffer*& buffer);
+
+    /**
+     * Returns the mesh of a round rect whose top-left corner is at the origin,
+     * or NULL if the shape is empty.
+     */
+    const VertexBuffer* getRoundRect(float width, float height, float rx, float ry,
+            SkPaint* paint, float scaleX, float scaleY);
+    /**
+     * Returns the mesh of an oval whose top-left corner is at the origin,
+     * or NULL if the shape is empty.
+     */
+    const VertexBuffer* getOval(float width, float height,
+            SkPaint* paint, float scaleX, float scaleY);
+
+    /**
+     * Clears the cache. This causes all VBOs to be deleted.
+     */
+    void clear();
+
+    /**
+     * Sets the maximum size of the cache in bytes.
+     */
+    void setMaxSize(uint32_t maxSize);
+    /**
+     * Returns the maximum size of the cache in bytes.
+     */
+    uint32_t getMaxSize();
+    /**
+     * Returns the current size of the cache in bytes.
+     */
+    uint32_t getSize();
+    /**
+     * Returns the number of entries removed to make room for new ones.
+     */
+    uint32_t getEvictionCount() const {
+        return mEvictionCount;
+    }
+
+private:
+    VertexBuffer* addVertexBuffer(const TessellationCacheEntry& entry,
+            const Vector<AlphaVertex>& mesh, const Rect& bounds);
+
+    /**
+     * Rounds a scale so that a shape animating its scale does not create
+     * a new mesh on every frame.
+     */
+    static float quantizeScale(float scale);
+
+    GenerationCache<TessellationCacheEntry, VertexBuffer*> mCache;
+    uint32_t mSize;
+    uint32_t mMaxSize;
+    uint32_t mEvictionCount;
+}; // class TessellationCache
+
+}; // namespace uirenderer
+}; // namespace android
+
+#endif // ANDROID_HWUI_TESSELLATION_CACHE_H
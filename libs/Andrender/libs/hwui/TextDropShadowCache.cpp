@@ -29,7 +29,7 @@ namespace uirenderer {
 
 TextDropShadowCache::TextDropShadowCache():
         mCache(GenerationCache<ShadowText, ShadowTexture*>::kUnlimitedCapacity),
-        mSize(0), mMaxSize(MB(DEFAULT_DROP_SHADOW_CACHE_SIZE)) {
+        mSize(0), mMaxSize(MB(DEFAULT_DROP_SHADOW_CACHE_SIZE)), mEvictionCount(0) {
     char property[PROPERTY_VALUE_MAX];
     if (property_get(PROPERTY_DROP_SHADOW_CACHE_SIZE, property, NULL) > 0) {
         INIT_LOGD("  Setting drop shadow cache size to %sMB", property);
@@ -44,7 +44,7 @@ TextDropShadowCache::TextDropShadowCache():
 
 TextDropShadowCache::TextDropShadowCache(uint32_t maxByteSize):
         mCache(GenerationCache<ShadowText, ShadowTexture*>::kUnlimitedCapacity),
-        mSize(0), mMaxSize(maxByteSize) {
+        mSize(0), mMaxSize(maxByteSize), mEvictionCount(0) {
     init();
 }
 
@@ -73,6 +73,7 @@ void TextDropShadowCache::setMaxSize(uint32_t maxSize) {
     mMaxSize = maxSize;
     while (mSize > mMaxSize) {
         mCache.removeOldest();
+        mEvictionCount++;
     }
 }
 
@@ -125,6 +126,7 @@ ShadowTexture* TextDropShadowCache::get(SkPaint* paint, const char* text, uint32
         if (size < mMaxSize) {
             while (mSize + size > mMaxSize) {
                 mCache.removeOldest();
+                mEvictionCount++;
             }
         }
 
@@ -140,6 +140,12 @@ public:
      * Returns the current size of the cache in bytes.
      */
     uint32_t getSize();
+    /**
+     * Returns the number of entries removed to make room for new ones.
+     */
+    uint32_t getEvictionCount() const {
+        return mEvictionCount;
+    }
 
 private:
     void init();
@@ -148,6 +154,7 @@ private:
 
     uint32_t mSize;
     uint32_t mMaxSize;
+    uint32_t mEvictionCount;
     FontRenderer* mRenderer;
     bool mDebugEnabled;
 }; // class TextDropShadowCache
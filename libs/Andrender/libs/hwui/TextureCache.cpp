@@ -34,7 +34,7 @@ namespace uirenderer {
 
 TextureCache::TextureCache():
         mCache(GenerationCache<SkBitmap*, Texture*>::kUnlimitedCapacity),
-        mSize(0), mMaxSize(MB(DEFAULT_TEXTURE_CACHE_SIZE)),
+        mSize(0), mMaxSize(MB(DEFAULT_TEXTURE_CACHE_SIZE)), mEvictionCount(0),
         mFlushRate(DEFAULT_TEXTURE_CACHE_FLUSH_RATE) {
     char property[PROPERTY_VALUE_MAX];
     if (property_get(PROPERTY_TEXTURE_CACHE_SIZE, property, NULL) > 0) {
@@ -58,7 +58,7 @@ TextureCache::TextureCache():
 
 TextureCache::TextureCache(uint32_t maxByteSize):
         mCache(GenerationCache<SkBitmap*, Texture*>::kUnlimitedCapacity),
-        mSize(0), mMaxSize(maxByteSize) {
+        mSize(0), mMaxSize(maxByteSize), mEvictionCount(0) {
     init();
 }
 
@@ -91,6 +91,7 @@ void TextureCache::setMaxSize(uint32_t maxSize) {
     mMaxSize = maxSize;
     while (mSize > mMaxSize) {
         mCache.removeOldest();
+        mEvictionCount++;
     }
 }
 
@@ -139,6 +140,7 @@ Texture* TextureCache::get(SkBitmap* bitmap) {
         if (size < mMaxSize) {
             while (mSize + size > mMaxSize) {
                 mCache.removeOldest();
+                mEvictionCount++;
             }
         }
 
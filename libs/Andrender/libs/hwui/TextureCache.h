@@ -103,6 +103,12 @@ public:
      * Returns the current size of the cache in bytes.
      */
     uint32_t getSize();
+    /**
+     * Returns the number of entries removed to make room for new ones.
+     */
+    uint32_t getEvictionCount() const {
+        return mEvictionCount;
+    }
 
     /**
      * Partially flushes the cache. The amount of memory freed by a flush
@@ -134,6 +140,7 @@ private:
 
     uint32_t mSize;
     uint32_t mMaxSize;
+    uint32_t mEvictionCount;
     GLint mMaxTextureSize;
 
     float mFlushRate;
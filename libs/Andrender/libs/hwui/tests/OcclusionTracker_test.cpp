@@ -0,0 +1,356 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include "OcclusionTracker.h"
+#include "OverdrawCounter.h"
+#include "Snapshot.h"
+
+namespace android {
+namespace uirenderer {
+
+class OcclusionTrackerTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        mSnapshot = new Snapshot();
+        mSnapshot->clipRect->set(0, 0, WIDTH, HEIGHT);
+    }
+
+    virtual void TearDown() {
+    }
+
+    /**
+     * Records an op drawn in the current snapshot, as
+     * OpenGLRenderer::skipDrawOp() does.
+     */
+    void draw(const void* op, float left, float top, float right, float bottom,
+            int alpha = 255, SkXfermode::Mode mode = SkXfermode::kSrcOver_Mode) {
+        Rect bounds;
+        Rect opaqueBounds;
+        OcclusionTracker::getBounds(*mSnapshot, left, top, right, bottom, alpha, mode, true,
+                bounds, opaqueBounds);
+        mTracker.add(op, bounds, opaqueBounds);
+    }
+
+    static const int WIDTH = 480;
+    static const int HEIGHT = 800;
+
+    mindroid::sp<Snapshot> mSnapshot;
+    OcclusionTracker mTracker;
+};
+
+// Stand for ops in a display list, only their addresses matter
+static const char OPS[8] = { 0 };
+static const void* const OP_A = &OPS[0];
+static const void* const OP_B = &OPS[1];
+static const void* const OP_C = &OPS[2];
+
+static void expectRect(float left, float top, float right, float bottom, const Rect& r) {
+    EXPECT_EQ(left, r.left);
+    EXPECT_EQ(top, r.top);
+    EXPECT_EQ(right, r.right);
+    EXPECT_EQ(bottom, r.bottom);
+}
+
+TEST_F(OcclusionTrackerTest, FullyCoveredOpIsCulled) {
+    mTracker.begin();
+    EXPECT_TRUE(mTracker.isRecording());
+    mTracker.add(OP_A, Rect(10, 10, 100, 100), Rect(10, 10, 100, 100));
+    mTracker.add(OP_B, Rect(0, 0, 200, 200), Rect(0, 0, 200, 200));
+    mTracker.end();
+    EXPECT_FALSE(mTracker.isRecording());
+
+    EXPECT_TRUE(mTracker.isCulled(OP_A));
+    EXPECT_FALSE(mTracker.isCulled(OP_B));
+    EXPECT_EQ(1U, mTracker.getCulledCount());
+
+    // Two occluders side by side hide what neither hides alone
+    mTracker.begin();
+    mTracker.add(OP_A, Rect(10, 10, 100, 100), Rect());
+    mTracker.add(OP_B, Rect(0, 0, 50, 200), Rect(0, 0, 50, 200));
+    mTracker.add(OP_C, Rect(50, 0, 200, 200), Rect(50, 0, 200, 200));
+    mTracker.end();
+    EXPECT_TRUE(mTracker.isCulled(OP_A));
+
+    mTracker.clear();
+    EXPECT_FALSE(mTracker.isCulled(OP_A));
+    EXPECT_EQ(0U, mTracker.getCulledCount());
+}
+
+TEST_F(OcclusionTrackerTest, PartiallyCoveredOpIsKept) {
+    mTracker.begin();
+    mTracker.add(OP_A, Rect(10, 10, 100, 100), Rect());
+    mTracker.add(OP_B, Rect(11, 0, 200, 200), Rect(11, 0, 200, 200));
+    mTracker.end();
+    EXPECT_FALSE(mTracker.isCulled(OP_A)) << "one column of the op is still visible";
+    EXPECT_EQ(0U, mTracker.getCulledCount());
+
+    // An occluder drawn before the op is below it
+    mTracker.begin();
+    mTracker.add(OP_B, Rect(0, 0, 200, 200), Rect(0, 0, 200, 200));
+    mTracker.add(OP_A, Rect(10, 10, 100, 100), Rect());
+    mTracker.end();
+    EXPECT_FALSE(mTracker.isCulled(OP_A));
+    EXPECT_FALSE(mTracker.isCulled(OP_B));
+
+    // Only the opaque bounds of an op hide the ones below it
+    mTracker.begin();
+    mTracker.add(OP_A, Rect(10, 10, 100, 100), Rect());
+    mTracker.add(OP_B, Rect(0, 0, 200, 200), Rect(20, 20, 200, 200));
+    mTracker.end();
+    EXPECT_FALSE(mTracker.isCulled(OP_A));
+}
+
+TEST_F(OcclusionTrackerTest, ReplayedOpIsCulledOnlyIfAlwaysHidden) {
+    // Drawn twice, once under the occluder and once above it
+    mTracker.begin();
+    mTracker.add(OP_A, Rect(10, 10, 100, 100), Rect());
+    mTracker.add(OP_B, Rect(0, 0, 200, 200), Rect(0, 0, 200, 200));
+    mTracker.add(OP_A, Rect(10, 10, 100, 100), Rect());
+    mTracker.end();
+    EXPECT_FALSE(mTracker.isCulled(OP_A));
+
+    // Drawn twice at different places, hidden the first time only
+    mTracker.begin();
+    mTracker.add(OP_A, Rect(10, 10, 100, 100), Rect());
+    mTracker.add(OP_A, Rect(300, 300, 400, 400), Rect());
+    mTracker.add(OP_B, Rect(0, 0, 200, 200), Rect(0, 0, 200, 200));
+    mTracker.end();
+    EXPECT_FALSE(mTracker.isCulled(OP_A));
+
+    // Hidden both times
+    mTracker.begin();
+    mTracker.add(OP_A, Rect(10, 10, 100, 100), Rect());
+    mTracker.add(OP_A, Rect(300, 300, 400, 400), Rect());
+    mTracker.add(OP_B, Rect(0, 0, WIDTH, HEIGHT), Rect(0, 0, WIDTH, HEIGHT));
+    mTracker.end();
+    EXPECT_TRUE(mTracker.isCulled(OP_A));
+    EXPECT_EQ(1U, mTracker.getCulledCount());
+}
+
+TEST_F(OcclusionTrackerTest, UnboundedOpsAreNeverCulled) {
+    mTracker.begin();
+    mTracker.addUnbounded(OP_A);
+    mTracker.add(OP_B, Rect(0, 0, WIDTH, HEIGHT), Rect(0, 0, WIDTH, HEIGHT));
+    mTracker.end();
+    EXPECT_FALSE(mTracker.isCulled(OP_A));
+
+    // Nor do they hide the ops below them
+    mTracker.begin();
+    mTracker.add(OP_B, Rect(10, 10, 100, 100), Rect(10, 10, 100, 100));
+    mTracker.addUnbounded(OP_A);
+    mTracker.end();
+    EXPECT_FALSE(mTracker.isCulled(OP_B));
+
+    // An op clipped out draws nothing and is always culled
+    mTracker.begin();
+    mTracker.add(OP_C, Rect(), Rect());
+    mTracker.end();
+    EXPECT_TRUE(mTracker.isCulled(OP_C));
+}
+
+TEST_F(OcclusionTrackerTest, Bounds) {
+    Rect bounds;
+    Rect opaqueBounds;
+    OcclusionTracker::getBounds(*mSnapshot, 10, 10, 110, 60, 255, SkXfermode::kSrcOver_Mode,
+            true, bounds, opaqueBounds);
+    expectRect(9, 9, 111, 61, bounds);
+    expectRect(10, 10, 110, 60, opaqueBounds);
+
+    // Only the pixels entirely covered are opaque
+    mSnapshot->transform->loadTranslate(5.5f, 0.0f, 0.0f);
+    OcclusionTracker::getBounds(*mSnapshot, 10, 10, 110, 60, 255, SkXfermode::kSrcOver_Mode,
+            true, bounds, opaqueBounds);
+    expectRect(14, 9, 117, 61, bounds);
+    expectRect(16, 10, 115, 60, opaqueBounds);
+    mSnapshot->transform->loadIdentity();
+
+    // Both are clipped
+    mSnapshot->clipRect->set(0, 0, 50, 50);
+    OcclusionTracker::getBounds(*mSnapshot, 10, 10, 110, 60, 255, SkXfermode::kSrcOver_Mode,
+            true, bounds, opaqueBounds);
+    expectRect(9, 9, 50, 50, bounds);
+    expectRect(10, 10, 50, 50, opaqueBounds);
+
+    OcclusionTracker::getBounds(*mSnapshot, 60, 60, 110, 110, 255, SkXfermode::kSrcOver_Mode,
+            true, bounds, opaqueBounds);
+    EXPECT_TRUE(bounds.isEmpty());
+    EXPECT_TRUE(opaqueBounds.isEmpty());
+}
+
+TEST_F(OcclusionTrackerTest, TranslucentOpsDoNotOcclude) {
+    Rect bounds;
+    Rect opaqueBounds;
+    OcclusionTracker::getBounds(*mSnapshot, 10, 10, 110, 60, 254, SkXfermode::kSrcOver_Mode,
+            true, bounds, opaqueBounds);
+    expectRect(9, 9, 111, 61, bounds);
+    EXPECT_TRUE(opaqueBounds.isEmpty());
+
+    OcclusionTracker::getBounds(*mSnapshot, 10, 10, 110, 60, 255, SkXfermode::kSrcOver_Mode,
+            false, bounds, opaqueBounds);
+    EXPECT_TRUE(opaqueBounds.isEmpty()) << "an op that does not fill its bounds";
+
+    OcclusionTracker::getBounds(*mSnapshot, 10, 10, 110, 60, 255, SkXfermode::kMultiply_Mode,
+            true, bounds, opaqueBounds);
+    EXPECT_TRUE(opaqueBounds.isEmpty()) << "an op blended with the pixels below it";
+
+    // kSrc replaces the pixels below whatever the alpha
+    OcclusionTracker::getBounds(*mSnapshot, 10, 10, 110, 60, 128, SkXfermode::kSrc_Mode,
+            true, bounds, opaqueBounds);
+    expectRect(10, 10, 110, 60, opaqueBounds);
+
+    mSnapshot->alpha = 0.5f;
+    OcclusionTracker::getBounds(*mSnapshot, 10, 10, 110, 60, 255, SkXfermode::kSrcOver_Mode,
+            true, bounds, opaqueBounds);
+    EXPECT_TRUE(opaqueBounds.isEmpty()) << "an op drawn with a translucent save layer";
+
+    mTracker.begin();
+    mSnapshot->alpha = 1.0f;
+    draw(OP_A, 10, 10, 100, 100);
+    mSnapshot->alpha = 0.5f;
+    draw(OP_B, 0, 0, WIDTH, HEIGHT);
+    mSnapshot->alpha = 1.0f;
+    draw(OP_C, 0, 0, WIDTH, HEIGHT, 128);
+    mTracker.end();
+    EXPECT_FALSE(mTracker.isCulled(OP_A));
+    EXPECT_EQ(0U, mTracker.getCulledCount());
+}
+
+TEST_F(OcclusionTrackerTest, OpsInLayersDoNotOcclude) {
+    mSnapshot->flags |= Snapshot::kFlagInLayer;
+    Rect bounds;
+    Rect opaqueBounds;
+    OcclusionTracker::getBounds(*mSnapshot, 10, 10, 110, 60, 255, SkXfermode::kSrcOver_Mode,
+            true, bounds, opaqueBounds);
+    expectRect(9, 9, 111, 61, bounds);
+    EXPECT_TRUE(opaqueBounds.isEmpty());
+
+    mTracker.begin();
+    mSnapshot->flags &= ~Snapshot::kFlagInLayer;
+    draw(OP_A, 10, 10, 100, 100);
+    mSnapshot->flags |= Snapshot::kFlagInLayer;
+    draw(OP_B, 0, 0, WIDTH, HEIGHT);
+    mTracker.end();
+    EXPECT_FALSE(mTracker.isCulled(OP_A));
+}
+
+TEST_F(OcclusionTrackerTest, RotatedOpsDoNotOcclude) {
+    mSnapshot->transform->loadRotate(30.0f, 0.0f, 0.0f, 1.0f);
+    Rect bounds;
+    Rect opaqueBounds;
+    OcclusionTracker::getBounds(*mSnapshot, 100, 100, 200, 200, 255, SkXfermode::kSrcOver_Mode,
+            true, bounds, opaqueBounds);
+    EXPECT_FALSE(bounds.isEmpty());
+    EXPECT_TRUE(opaqueBounds.isEmpty());
+
+    // Even a quarter turn, which keeps the op axis aligned
+    mSnapshot->transform->loadRotate(90.0f, 0.0f, 0.0f, 1.0f);
+    OcclusionTracker::getBounds(*mSnapshot, 100, -200, 200, -100, 255, SkXfermode::kSrcOver_Mode,
+            true, bounds, opaqueBounds);
+    EXPECT_FALSE(bounds.isEmpty());
+    EXPECT_TRUE(opaqueBounds.isEmpty());
+
+    mTracker.begin();
+    mSnapshot->transform->loadIdentity();
+    draw(OP_A, 200, 200, 210, 210);
+    mSnapshot->transform->loadRotate(30.0f, 0.0f, 0.0f, 1.0f);
+    draw(OP_B, 0, -WIDTH, 2 * HEIGHT, 2 * HEIGHT);
+    mTracker.end();
+    EXPECT_FALSE(mTracker.isCulled(OP_A));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// OverdrawCounter
+///////////////////////////////////////////////////////////////////////////////
+
+class OverdrawCounterTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+    }
+
+    virtual void TearDown() {
+    }
+
+    OverdrawCounter mCounter;
+};
+
+TEST_F(OverdrawCounterTest, CellsCountWhenTheirCenterIsCovered) {
+    // 5 columns, and a third row for the last 4 pixels
+    mCounter.reset(40, 20, Rect(0, 0, 40, 20));
+    EXPECT_EQ(5, mCounter.getColumns());
+    EXPECT_EQ(3, mCounter.getRows());
+
+    // The center of the first cell is (4, 4): covered from 4 inclusive to
+    // 5, not up to 4 exclusive
+    mCounter.count(Rect(0, 0, 4, 4));
+    EXPECT_EQ(0, mCounter.getCount(0, 0));
+    mCounter.count(Rect(4, 4, 5, 5));
+    EXPECT_EQ(1, mCounter.getCount(0, 0));
+    EXPECT_EQ(0, mCounter.getCount(1, 0));
+    EXPECT_EQ(0, mCounter.getCount(0, 1));
+
+    // Covers the centers 12 and 20 of columns 1 and 2, and row 1
+    mCounter.count(Rect(9, 9, 20.5f, 16));
+    for (int row = 0; row < mCounter.getRows(); row++) {
+        for (int column = 0; column < mCounter.getColumns(); column++) {
+            const int expected = (row == 0 && column == 0) ||
+                    (row == 1 && (column == 1 || column == 2)) ? 1 : 0;
+            EXPECT_EQ(expected, mCounter.getCount(column, row))
+                    << "column " << column << " row " << row;
+        }
+    }
+
+    // Bounds past the window count its edges
+    mCounter.reset(40, 20, Rect(0, 0, 40, 20));
+    mCounter.count(Rect(-100, -100, 1000, 1000));
+    for (int row = 0; row < mCounter.getRows(); row++) {
+        for (int column = 0; column < mCounter.getColumns(); column++) {
+            EXPECT_EQ(1, mCounter.getCount(column, row)) << "column " << column << " row " << row;
+        }
+    }
+}
+
+TEST_F(OverdrawCounterTest, CountsSaturate) {
+    mCounter.reset(8, 8, Rect(0, 0, 8, 8));
+    for (int i = 0; i < 300; i++) {
+        mCounter.count(Rect(0, 0, 8, 8));
+    }
+    EXPECT_EQ(255, mCounter.getCount(0, 0));
+}
+
+TEST_F(OverdrawCounterTest, Ratio) {
+    // Redraws 5 x 2 cells
+    mCounter.reset(40, 20, Rect(0, 0, 40, 16));
+    EXPECT_EQ(0.0f, mCounter.getRatio());
+
+    mCounter.count(Rect(0, 0, 40, 20));
+    EXPECT_FLOAT_EQ(1.0f, mCounter.getRatio());
+
+    // Twice more over 2 x 2 of the 10 cells, and outside of the redrawn area
+    mCounter.count(Rect(0, 0, 20, 16));
+    mCounter.count(Rect(0, 0, 20, 16));
+    mCounter.count(Rect(0, 16, 40, 40));
+    EXPECT_FLOAT_EQ(1.8f, mCounter.getRatio());
+
+    // Nothing redrawn
+    mCounter.reset(40, 20, Rect());
+    mCounter.count(Rect(0, 0, 40, 20));
+    EXPECT_EQ(0.0f, mCounter.getRatio());
+}
+
+}; // namespace uirenderer
+}; // namespace android
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <SkBitmap.h>
+#include <SkCanvas.h>
+#include <SkPaint.h>
+#include <SkPath.h>
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <time.h>
+
+#include "PathTessellator.h"
+
+namespace android {
+namespace uirenderer {
+
+class PathTessellatorTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        mPaint.setAntiAlias(true);
+        mPaint.setStyle(SkPaint::kStroke_Style);
+    }
+
+    virtual void TearDown() {
+    }
+
+    SkPaint mPaint;
+};
+
+static float cross(const AlphaVertex& a, const AlphaVertex& b, float x, float y) {
+    return (b.position[0] - a.position[0]) * (y - a.position[1]) -
+            (b.position[1] - a.position[1]) * (x - a.position[0]);
+}
+
+/**
+ * Returns the largest number of triangles of the strip covering the same
+ * point, sampled on a grid over the bounds. Anything above 1 means the mesh
+ * overlaps itself and blends translucent colors twice.
+ */
+static int maxOverlap(const Vector<AlphaVertex>& mesh, const Rect& bounds) {
+    int result = 0;
+    // The odd step keeps the samples off the edges shared by two triangles
+    for (float y = bounds.top + 0.013f; y < bounds.bottom; y += 0.37f) {
+        for (float x = bounds.left + 0.011f; x < bounds.right; x += 0.37f) {
+            int count = 0;
+            for (size_t i = 2; i < mesh.size(); i++) {
+                const AlphaVertex& a = mesh[i - 2];
+                const AlphaVertex& b = mesh[i - 1];
+                const AlphaVertex& c = mesh[i];
+                const float d1 = cross(a, b, x, y);
+                const float d2 = cross(b, c, x, y);
+                const float d3 = cross(c, a, x, y);
+                if ((d1 > 0.0f && d2 > 0.0f && d3 > 0.0f) ||
+                        (d1 < 0.0f && d2 < 0.0f && d3 < 0.0f)) {
+                    count++;
+                }
+            }
+            if (count > result) result = count;
+        }
+    }
+    return result;
+}
+
+TEST_F(PathTessellatorTest, ThinStrokeDoesNotOverlap) {
+    mPaint.setStrokeWidth(4.0f);
+    Vector<AlphaVertex> mesh;
+    Rect bounds;
+
+    PathTessellator::tessellateRoundRect(60.0f, 30.0f, 8.0f, 8.0f, &mPaint, 1.0f, 1.0f,
+            mesh, bounds);
+    ASSERT_FALSE(mesh.isEmpty());
+    EXPECT_EQ(1, maxOverlap(mesh, bounds));
+
+    PathTessellator::tessellateOval(40.0f, 30.0f, &mPaint, 1.0f, 1.0f, mesh, bounds);
+    ASSERT_FALSE(mesh.isEmpty());
+    EXPECT_EQ(1, maxOverlap(mesh, bounds));
+}
+
+TEST_F(PathTessellatorTest, StrokeCoveringShapeIsFilled) {
+    // The stroke is wider than the circle, its inner edge would cross the center
+    mPaint.setStrokeWidth(24.0f);
+    Vector<AlphaVertex> mesh;
+    Rect bounds;
+    PathTessellator::tessellateOval(20.0f, 20.0f, &mPaint, 1.0f, 1.0f, mesh, bounds);
+    ASSERT_FALSE(mesh.isEmpty());
+    EXPECT_EQ(1, maxOverlap(mesh, bounds));
+
+    SkPaint fill(mPaint);
+    fill.setStyle(SkPaint::kStrokeAndFill_Style);
+    Vector<AlphaVertex> expected;
+    Rect expectedBounds;
+    PathTessellator::tessellateOval(20.0f, 20.0f, &fill, 1.0f, 1.0f, expected, expectedBounds);
+
+    ASSERT_EQ(expected.size(), mesh.size());
+    for (size_t i = 0; i < mesh.size(); i++) {
+        EXPECT_EQ(expected[i].position[0], mesh[i].position[0]) << "vertex " << i;
+        EXPECT_EQ(expected[i].position[1], mesh[i].position[1]) << "vertex " << i;
+        EXPECT_EQ(expected[i].alpha, mesh[i].alpha) << "vertex " << i;
+    }
+}
+
+TEST_F(PathTessellatorTest, StrokeTooWideForCornersIsNotSupported) {
+    mPaint.setStrokeWidth(2.0f);
+    EXPECT_TRUE(PathTessellator::isSupported(100.0f, 40.0f, 4.0f, 4.0f, &mPaint, 1.0f, 1.0f));
+
+    // Wider than the corners, narrower than the shape
+    mPaint.setStrokeWidth(12.0f);
+    EXPECT_FALSE(PathTessellator::isSupported(100.0f, 40.0f, 4.0f, 4.0f, &mPaint, 1.0f, 1.0f));
+    EXPECT_FALSE(PathTessellator::isSupported(100.0f, 40.0f, 50.0f, 20.0f, &mPaint, 1.0f, 1.0f))
+            << "the flat sides of an oval curve less than its radii";
+
+    // Sharp corners, or a stroke covering the whole shape, tessellate fine
+    EXPECT_TRUE(PathTessellator::isSupported(100.0f, 40.0f, 0.0f, 0.0f, &mPaint, 1.0f, 1.0f));
+    mPaint.setStrokeWidth(40.0f);
+    EXPECT_TRUE(PathTessellator::isSupported(100.0f, 40.0f, 4.0f, 4.0f, &mPaint, 1.0f, 1.0f));
+
+    mPaint.setStyle(SkPaint::kFill_Style);
+    mPaint.setStrokeWidth(12.0f);
+    EXPECT_TRUE(PathTessellator::isSupported(100.0f, 40.0f, 4.0f, 4.0f, &mPaint, 1.0f, 1.0f));
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+TEST_F(PathTessellatorTest, ResizeAnimation) {
+    const int frames = 500;
+    mPaint.setStyle(SkPaint::kFill_Style);
+
+    // Every frame of a growing card is a new shape, neither route gets cache hits
+    Vector<AlphaVertex> mesh;
+    Rect bounds;
+    size_t vertices = 0;
+    double start = now();
+    for (int i = 0; i < frames; i++) {
+        PathTessellator::tessellateRoundRect(100.0f + i * 0.5f, 60.0f + i * 0.25f,
+                12.0f, 12.0f, &mPaint, 1.0f, 1.0f, mesh, bounds);
+        vertices += mesh.size();
+    }
+    const double tessellated = now() - start;
+
+    // What ShapeCache::addTexture does before uploading the alpha texture
+    SkPaint pathPaint(mPaint);
+    pathPaint.setColor(0xff000000);
+    uint32_t pixels = 0;
+    start = now();
+    for (int i = 0; i < frames; i++) {
+        const float width = 100.0f + i * 0.5f;
+        const float height = 60.0f + i * 0.25f;
+        SkPath path;
+        SkRect r;
+        r.set(0.0f, 0.0f, width, height);
+        path.addRoundRect(r, 12.0f, 12.0f, SkPath::kCW_Direction);
+
+        SkBitmap bitmap;
+        bitmap.setConfig(SkBitmap::kA8_Config, (int) width + 2, (int) height + 2);
+        bitmap.allocPixels();
+        bitmap.eraseColor(0);
+        SkCanvas canvas(bitmap);
+        canvas.translate(1.0f, 1.0f);
+        canvas.drawPath(path, pathPaint);
+        pixels += bitmap.width() * bitmap.height();
+    }
+    const double rasterized = now() - start;
+
+    EXPECT_NE(0U, vertices);
+    printf("Round rect resize: tessellate %.1f us/frame (%u vertices), "
+            "rasterize %.1f us/frame (%u pixels, before upload)\n",
+            tessellated * 1e6 / frames, (uint32_t) (vertices / frames),
+            rasterized * 1e6 / frames, pixels / frames);
+}
+
+}; // namespace uirenderer
+}; // namespace android
@@ -29,11 +29,13 @@ commonSources:= \
 	BufferedTextOutput.cpp \
 	CallStack.cpp \
 	Debug.cpp \
+	FileMap.cpp \
 	Flattenable.cpp \
 	JenkinsHash.cpp \
 	LinearAllocator.cpp \
 	LinearTransform.cpp \
 	Log.cpp \
+	Looper.cpp \
 	PropertyMap.cpp \
 	SharedBuffer.cpp \
 	Static.cpp \
@@ -48,13 +50,17 @@ commonSources:= \
 	Unicode.cpp \
 	VectorImpl.cpp \
 	WorkQueue.cpp \
+	ZipFileRO.cpp \
+	ZipUtils.cpp \
 	misc.cpp
 
 LOCAL_SRC_FILES:= $(commonSources)
 
-LOCAL_CFLAGS += -DHAVE_PTHREADS=1 -DBUILD_FOR_ANDROID
+LOCAL_CFLAGS += -DHAVE_PTHREADS=1 -DBUILD_FOR_ANDROID -DHAVE_POSIX_FILEMAP -DHAVE_MADVISE=1
 LOCAL_CPPFLAGS += -std=c++11
 
+LOCAL_EXPORT_LDLIBS := -lz
+
 LOCAL_STATIC_LIBRARIES += cutils_static \
 						mindroid_static
 
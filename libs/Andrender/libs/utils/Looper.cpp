@@ -1,7 +1,7 @@
 //
 // Copyright 2010 The Android Open Source Project
 //
-// A looper implementation based on epoll().
+// A looper implementation based on epoll(), or poll() where it is not available.
 //
 #define LOG_TAG "Looper"
 
@@ -20,13 +20,21 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <stdlib.h>
+
+#ifndef BUILD_FOR_ANDROID
+// __android_log_assert() is only available on Android
+#undef LOG_ALWAYS_FATAL_IF
+#define LOG_ALWAYS_FATAL_IF(cond, ...) \
+    ( (CONDITION(cond)) ? ((void)ALOGE(__VA_ARGS__), abort()) : (void)0 )
+#endif
 
 
 namespace android {
 
 // --- WeakMessageHandler ---
 
-WeakMessageHandler::WeakMessageHandler(const wp<MessageHandler>& handler) :
+WeakMessageHandler::WeakMessageHandler(const mindroid::wp<MessageHandler>& handler) :
         mHandler(handler) {
 }
 
@@ -34,7 +42,7 @@ WeakMessageHandler::~WeakMessageHandler() {
 }
 
 void WeakMessageHandler::handleMessage(const Message& message) {
-    sp<MessageHandler> handler = mHandler.promote();
+    mindroid::sp<MessageHandler> handler = mHandler.toStrongRef();
     if (handler != NULL) {
         handler->handleMessage(message);
     }
@@ -57,11 +65,18 @@ int SimpleLooperCallback::handleEvent(int fd, int events, void* data) {
 
 // --- Looper ---
 
+#if LOOPER_USES_EPOLL
 // Hint for number of file descriptors to be associated with the epoll instance.
 static const int EPOLL_SIZE_HINT = 8;
 
 // Maximum number of file descriptors for which to retrieve poll events each iteration.
 static const int EPOLL_MAX_EVENTS = 16;
+#endif
+
+// Written to the wake pipe by wake(), and by addFd() and removeFd() to make
+// the poll() fallback pick up the descriptors again without returning.
+static const char WAKE_SIGNAL = 'W';
+static const char REFRESH_SIGNAL = 'R';
 
 static pthread_once_t gTLSOnce = PTHREAD_ONCE_INIT;
 static pthread_key_t gTLSKey = 0;
@@ -84,6 +99,7 @@ Looper::Looper(bool allowNonCallbacks) :
     LOG_ALWAYS_FATAL_IF(result != 0, "Could not make wake write pipe non-blocking.  errno=%d",
             errno);
 
+#if LOOPER_USES_EPOLL
     // Allocate the epoll instance and register the wake pipe.
     mEpollFd = epoll_create(EPOLL_SIZE_HINT);
     LOG_ALWAYS_FATAL_IF(mEpollFd < 0, "Could not create epoll instance.  errno=%d", errno);
@@ -95,12 +111,15 @@ Looper::Looper(bool allowNonCallbacks) :
     result = epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mWakeReadPipeFd, & eventItem);
     LOG_ALWAYS_FATAL_IF(result != 0, "Could not add wake read pipe to epoll instance.  errno=%d",
             errno);
+#endif
 }
 
 Looper::~Looper() {
     close(mWakeReadPipeFd);
     close(mWakeWritePipeFd);
+#if LOOPER_USES_EPOLL
     close(mEpollFd);
+#endif
 }
 
 void Looper::initTLSKey() {
@@ -111,34 +130,34 @@ void Looper::initTLSKey() {
 void Looper::threadDestructor(void *st) {
     Looper* const self = static_cast<Looper*>(st);
     if (self != NULL) {
-        self->decStrong((void*)threadDestructor);
+        self->decStrongRef((void*)threadDestructor);
     }
 }
 
-void Looper::setForThread(const sp<Looper>& looper) {
-    sp<Looper> old = getForThread(); // also has side-effect of initializing TLS
+void Looper::setForThread(const mindroid::sp<Looper>& looper) {
+    mindroid::sp<Looper> old = getForThread(); // also has side-effect of initializing TLS
 
     if (looper != NULL) {
-        looper->incStrong((void*)threadDestructor);
+        looper->incStrongRef((void*)threadDestructor);
     }
 
-    pthread_setspecific(gTLSKey, looper.get());
+    pthread_setspecific(gTLSKey, looper.getPointer());
 
     if (old != NULL) {
-        old->decStrong((void*)threadDestructor);
+        old->decStrongRef((void*)threadDestructor);
     }
 }
 
-sp<Looper> Looper::getForThread() {
+mindroid::sp<Looper> Looper::getForThread() {
     int result = pthread_once(& gTLSOnce, initTLSKey);
     LOG_ALWAYS_FATAL_IF(result != 0, "pthread_once failed");
 
     return (Looper*)pthread_getspecific(gTLSKey);
 }
 
-sp<Looper> Looper::prepare(int opts) {
+mindroid::sp<Looper> Looper::prepare(int opts) {
     bool allowNonCallbacks = opts & ALOOPER_PREPARE_ALLOW_NON_CALLBACKS;
-    sp<Looper> looper = Looper::getForThread();
+    mindroid::sp<Looper> looper = Looper::getForThread();
     if (looper == NULL) {
         looper = new Looper(allowNonCallbacks);
         Looper::setForThread(looper);
@@ -214,8 +233,68 @@ int Looper::pollInner(int timeoutMillis) {
     mResponses.clear();
     mResponseIndex = 0;
 
+#if LOOPER_USES_EPOLL
     struct epoll_event eventItems[EPOLL_MAX_EVENTS];
     int eventCount = epoll_wait(mEpollFd, eventItems, EPOLL_MAX_EVENTS, timeoutMillis);
+#else
+    // The requests are copied in on every poll: addFd() and removeFd() wake
+    // the poll so that changes are picked up, and events of a descriptor
+    // removed meanwhile are dropped below.
+    const nsecs_t pollEndTime = timeoutMillis > 0 ? systemTime(SYSTEM_TIME_MONOTONIC)
+            + milliseconds_to_nanoseconds(timeoutMillis) : 0;
+    int eventCount;
+    for (;;) {
+        mLock.lock();
+        mPollFds.clear();
+        struct pollfd wakeItem;
+        wakeItem.fd = mWakeReadPipeFd;
+        wakeItem.events = POLLIN;
+        wakeItem.revents = 0;
+        mPollFds.push(wakeItem);
+        for (size_t i = 0; i < mRequests.size(); i++) {
+            const Request& request = mRequests.valueAt(i);
+            struct pollfd pollItem;
+            pollItem.fd = request.fd;
+            pollItem.events = 0;
+            if (request.events & ALOOPER_EVENT_INPUT) pollItem.events |= POLLIN;
+            if (request.events & ALOOPER_EVENT_OUTPUT) pollItem.events |= POLLOUT;
+            pollItem.revents = 0;
+            mPollFds.push(pollItem);
+        }
+        mLock.unlock();
+
+        eventCount = poll(mPollFds.editArray(), mPollFds.size(), timeoutMillis);
+        if (eventCount <= 0) {
+            break;
+        }
+
+        // Unless wake() was called or a watched descriptor is ready, the
+        // descriptors only changed: poll them again for the rest of the timeout.
+        bool ready;
+        if (mPollFds[0].revents == POLLIN) {
+            ready = awoken();
+            mPollFds.editItemAt(0).revents = 0;
+        } else {
+            ready = mPollFds[0].revents != 0;
+        }
+        mLock.lock();
+        for (size_t i = 1; i < mPollFds.size() && !ready; i++) {
+            ready = mPollFds[i].revents != 0 && mRequests.indexOfKey(mPollFds[i].fd) >= 0;
+        }
+        mLock.unlock();
+        if (ready) {
+            break;
+        }
+        if (timeoutMillis > 0) {
+            timeoutMillis = toMillisecondTimeoutDelay(systemTime(SYSTEM_TIME_MONOTONIC),
+                    pollEndTime);
+        }
+        if (timeoutMillis == 0) {
+            eventCount = 0;
+            break;
+        }
+    }
+#endif
 
     // Acquire lock.
     mLock.lock();
@@ -244,6 +323,7 @@ int Looper::pollInner(int timeoutMillis) {
     ALOGD("%p ~ pollOnce - handling events from %d fds", this, eventCount);
 #endif
 
+#if LOOPER_USES_EPOLL
     for (int i = 0; i < eventCount; i++) {
         int fd = eventItems[i].data.fd;
         uint32_t epollEvents = eventItems[i].events;
@@ -268,6 +348,38 @@ int Looper::pollInner(int timeoutMillis) {
             }
         }
     }
+#else
+    for (size_t i = 0; i < mPollFds.size(); i++) {
+        const struct pollfd& pollItem = mPollFds.itemAt(i);
+        short pollEvents = pollItem.revents;
+        if (pollEvents == 0) {
+            continue;
+        }
+
+        int fd = pollItem.fd;
+        if (fd == mWakeReadPipeFd) {
+            if (pollEvents & POLLIN) {
+                awoken();
+            } else {
+                ALOGW("Ignoring unexpected poll events 0x%x on wake read pipe.", pollEvents);
+            }
+        } else {
+            ssize_t requestIndex = mRequests.indexOfKey(fd);
+            if (requestIndex >= 0) {
+                int events = 0;
+                if (pollEvents & POLLIN) events |= ALOOPER_EVENT_INPUT;
+                if (pollEvents & POLLOUT) events |= ALOOPER_EVENT_OUTPUT;
+                if (pollEvents & POLLERR) events |= ALOOPER_EVENT_ERROR;
+                if (pollEvents & POLLHUP) events |= ALOOPER_EVENT_HANGUP;
+                if (pollEvents & POLLNVAL) events |= ALOOPER_EVENT_INVALID;
+                pushResponse(events, mRequests.valueAt(requestIndex));
+            } else {
+                ALOGW("Ignoring unexpected poll events 0x%x on fd %d that is "
+                        "no longer registered.", pollEvents, fd);
+            }
+        }
+    }
+#endif
 Done: ;
 
     // Invoke pending message callbacks.
@@ -281,7 +393,7 @@ Done: ;
             // finishes.  Then we drop it so that the handler can be deleted *before*
             // we reacquire our lock.
             { // obtain handler
-                sp<MessageHandler> handler = messageEnvelope.handler;
+                mindroid::sp<MessageHandler> handler = messageEnvelope.handler;
                 Message message = messageEnvelope.message;
                 mMessageEnvelopes.removeAt(0);
                 mSendingMessage = true;
@@ -289,7 +401,7 @@ Done: ;
 
 #if DEBUG_POLL_AND_WAKE || DEBUG_CALLBACKS
                 ALOGD("%p ~ pollOnce - sending message: handler=%p, what=%d",
-                        this, handler.get(), message.what);
+                        this, handler.getPointer(), message.what);
 #endif
                 handler->handleMessage(message);
             } // release handler
@@ -316,7 +428,7 @@ Done: ;
             void* data = response.request.data;
 #if DEBUG_POLL_AND_WAKE || DEBUG_CALLBACKS
             ALOGD("%p ~ pollOnce - invoking fd event callback %p: fd=%d, events=0x%x, data=%p",
-                    this, response.request.callback.get(), fd, events, data);
+                    this, response.request.callback.getPointer(), fd, events, data);
 #endif
             int callbackResult = response.request.callback->handleEvent(fd, events, data);
             if (callbackResult == 0) {
@@ -362,9 +474,13 @@ void Looper::wake() {
     ALOGD("%p ~ wake", this);
 #endif
 
+    writeWakePipe(WAKE_SIGNAL);
+}
+
+void Looper::writeWakePipe(char signal) {
     ssize_t nWrite;
     do {
-        nWrite = write(mWakeWritePipeFd, "W", 1);
+        nWrite = write(mWakeWritePipeFd, &signal, 1);
     } while (nWrite == -1 && errno == EINTR);
 
     if (nWrite != 1) {
@@ -374,16 +490,21 @@ void Looper::wake() {
     }
 }
 
-void Looper::awoken() {
+bool Looper::awoken() {
 #if DEBUG_POLL_AND_WAKE
     ALOGD("%p ~ awoken", this);
 #endif
 
     char buffer[16];
+    bool woken = false;
     ssize_t nRead;
     do {
         nRead = read(mWakeReadPipeFd, buffer, sizeof(buffer));
+        for (ssize_t i = 0; i < nRead; i++) {
+            woken |= buffer[i] == WAKE_SIGNAL;
+        }
     } while ((nRead == -1 && errno == EINTR) || nRead == sizeof(buffer));
+    return woken;
 }
 
 void Looper::pushResponse(int events, const Request& request) {
@@ -397,13 +518,13 @@ int Looper::addFd(int fd, int ident, int events, ALooper_callbackFunc callback,
     return addFd(fd, ident, events, callback ? new SimpleLooperCallback(callback) : NULL, data);
 }
 
-int Looper::addFd(int fd, int ident, int events, const sp<LooperCallback>& callback, void* data) {
+int Looper::addFd(int fd, int ident, int events, const mindroid::sp<LooperCallback>& callback, void* data) {
 #if DEBUG_CALLBACKS
     ALOGD("%p ~ addFd - fd=%d, ident=%d, events=0x%x, callback=%p, data=%p", this, fd, ident,
-            events, callback.get(), data);
+            events, callback.getPointer(), data);
 #endif
 
-    if (!callback.get()) {
+    if (callback == NULL) {
         if (! mAllowNonCallbacks) {
             ALOGE("Invalid attempt to set NULL callback but not allowed for this looper.");
             return -1;
@@ -417,9 +538,11 @@ int Looper::addFd(int fd, int ident, int events, const sp<LooperCallback>& callb
         ident = ALOOPER_POLL_CALLBACK;
     }
 
+#if LOOPER_USES_EPOLL
     int epollEvents = 0;
     if (events & ALOOPER_EVENT_INPUT) epollEvents |= EPOLLIN;
     if (events & ALOOPER_EVENT_OUTPUT) epollEvents |= EPOLLOUT;
+#endif
 
     { // acquire lock
         AutoMutex _l(mLock);
@@ -427,9 +550,11 @@ int Looper::addFd(int fd, int ident, int events, const sp<LooperCallback>& callb
         Request request;
         request.fd = fd;
         request.ident = ident;
+        request.events = events;
         request.callback = callback;
         request.data = data;
 
+#if LOOPER_USES_EPOLL
         struct epoll_event eventItem;
         memset(& eventItem, 0, sizeof(epoll_event)); // zero out unused members of data field union
         eventItem.events = epollEvents;
@@ -451,7 +576,20 @@ int Looper::addFd(int fd, int ident, int events, const sp<LooperCallback>& callb
             }
             mRequests.replaceValueAt(requestIndex, request);
         }
+#else
+        ssize_t requestIndex = mRequests.indexOfKey(fd);
+        if (requestIndex < 0) {
+            mRequests.add(fd, request);
+        } else {
+            mRequests.replaceValueAt(requestIndex, request);
+        }
+#endif
     } // release lock
+
+#if !LOOPER_USES_EPOLL
+    // Polled from the next iteration on
+    writeWakePipe(REFRESH_SIGNAL);
+#endif
     return 1;
 }
 
@@ -467,33 +605,40 @@ int Looper::removeFd(int fd) {
             return 0;
         }
 
+#if LOOPER_USES_EPOLL
         int epollResult = epoll_ctl(mEpollFd, EPOLL_CTL_DEL, fd, NULL);
         if (epollResult < 0) {
             ALOGE("Error removing epoll events for fd %d, errno=%d", fd, errno);
             return -1;
         }
+#endif
 
         mRequests.removeItemsAt(requestIndex);
     } // release lock
+
+#if !LOOPER_USES_EPOLL
+    // No longer polled from the next iteration on
+    writeWakePipe(REFRESH_SIGNAL);
+#endif
     return 1;
 }
 
-void Looper::sendMessage(const sp<MessageHandler>& handler, const Message& message) {
+void Looper::sendMessage(const mindroid::sp<MessageHandler>& handler, const Message& message) {
     nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
     sendMessageAtTime(now, handler, message);
 }
 
-void Looper::sendMessageDelayed(nsecs_t uptimeDelay, const sp<MessageHandler>& handler,
+void Looper::sendMessageDelayed(nsecs_t uptimeDelay, const mindroid::sp<MessageHandler>& handler,
         const Message& message) {
     nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
     sendMessageAtTime(now + uptimeDelay, handler, message);
 }
 
-void Looper::sendMessageAtTime(nsecs_t uptime, const sp<MessageHandler>& handler,
+void Looper::sendMessageAtTime(nsecs_t uptime, const mindroid::sp<MessageHandler>& handler,
         const Message& message) {
 #if DEBUG_CALLBACKS
     ALOGD("%p ~ sendMessageAtTime - uptime=%lld, handler=%p, what=%d",
-            this, uptime, handler.get(), message.what);
+            this, uptime, handler.getPointer(), message.what);
 #endif
 
     size_t i = 0;
@@ -523,9 +668,9 @@ void Looper::sendMessageAtTime(nsecs_t uptime, const sp<MessageHandler>& handler
     }
 }
 
-void Looper::removeMessages(const sp<MessageHandler>& handler) {
+void Looper::removeMessages(const mindroid::sp<MessageHandler>& handler) {
 #if DEBUG_CALLBACKS
-    ALOGD("%p ~ removeMessages - handler=%p", this, handler.get());
+    ALOGD("%p ~ removeMessages - handler=%p", this, handler.getPointer());
 #endif
 
     { // acquire lock
@@ -540,9 +685,9 @@ void Looper::removeMessages(const sp<MessageHandler>& handler) {
     } // release lock
 }
 
-void Looper::removeMessages(const sp<MessageHandler>& handler, int what) {
+void Looper::removeMessages(const mindroid::sp<MessageHandler>& handler, int what) {
 #if DEBUG_CALLBACKS
-    ALOGD("%p ~ removeMessages - handler=%p, what=%d", this, handler.get(), what);
+    ALOGD("%p ~ removeMessages - handler=%p, what=%d", this, handler.getPointer(), what);
 #endif
 
     { // acquire lock
@@ -17,6 +17,17 @@
 #include <utils/Unicode.h>
 
 #include <stddef.h>
+#include <string.h>
+
+// ASCII runs, which most text is made of, are scanned and copied with vector
+// instructions where available
+#if defined(__ARM_NEON__) || defined(__ARM_NEON)
+# define UNICODE_NEON 1
+# include <arm_neon.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+# define UNICODE_SSE2 1
+# include <emmintrin.h>
+#endif
 
 #ifdef HAVE_WINSOCK
 # undef  nhtol
@@ -68,6 +79,131 @@ static const char32_t kFirstByteMark[] = {
     0x00000000, 0x00000000, 0x000000C0, 0x000000E0, 0x000000F0
 };
 
+// --------------------------------------------------------------------------
+// ASCII runs
+// --------------------------------------------------------------------------
+
+/**
+ * Returns the number of ASCII bytes "src" starts with.
+ */
+static size_t utf8_ascii_length(const uint8_t* src, size_t len)
+{
+    size_t i = 0;
+#if UNICODE_SSE2
+    for (; i + 16 <= len; i += 16) {
+        const int mask = _mm_movemask_epi8(_mm_loadu_si128((const __m128i*) (src + i)));
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#elif UNICODE_NEON
+    for (; i + 16 <= len; i += 16) {
+        const uint8x16_t bytes = vld1q_u8(src + i);
+        const uint8x8_t folded = vorr_u8(vget_low_u8(bytes), vget_high_u8(bytes));
+        if (vget_lane_u64(vreinterpret_u64_u8(vand_u8(folded, vdup_n_u8(0x80))), 0) != 0) {
+            break;
+        }
+    }
+#endif
+    for (; i + 8 <= len; i += 8) {
+        uint64_t word;
+        memcpy(&word, src + i, sizeof(word));
+        if ((word & 0x8080808080808080ULL) != 0) {
+            break;
+        }
+    }
+    while (i < len && src[i] < 0x80) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * Returns the number of ASCII units "src" starts with.
+ */
+static size_t utf16_ascii_length(const char16_t* src, size_t len)
+{
+    size_t i = 0;
+#if UNICODE_SSE2
+    const __m128i nonAscii = _mm_set1_epi16((short) 0xFF80);
+    for (; i + 8 <= len; i += 8) {
+        const __m128i units = _mm_loadu_si128((const __m128i*) (src + i));
+        const __m128i ascii = _mm_cmpeq_epi16(_mm_and_si128(units, nonAscii), _mm_setzero_si128());
+        if (_mm_movemask_epi8(ascii) != 0xFFFF) {
+            break;
+        }
+    }
+#elif UNICODE_NEON
+    for (; i + 8 <= len; i += 8) {
+        const uint16x8_t units = vld1q_u16((const uint16_t*) (src + i));
+        const uint16x4_t folded = vorr_u16(vget_low_u16(units), vget_high_u16(units));
+        if (vget_lane_u64(vreinterpret_u64_u16(vand_u16(folded, vdup_n_u16(0xFF80))), 0) != 0) {
+            break;
+        }
+    }
+#endif
+    for (; i + 4 <= len; i += 4) {
+        uint64_t word;
+        memcpy(&word, src + i, sizeof(word));
+        if ((word & 0xFF80FF80FF80FF80ULL) != 0) {
+            break;
+        }
+    }
+    while (i < len && src[i] < 0x80) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * Widens "len" ASCII bytes to UTF-16.
+ */
+static void utf8_ascii_to_utf16(const uint8_t* src, size_t len, char16_t* dst)
+{
+    size_t i = 0;
+#if UNICODE_SSE2
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= len; i += 16) {
+        const __m128i bytes = _mm_loadu_si128((const __m128i*) (src + i));
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128((__m128i*) (dst + i + 8), _mm_unpackhi_epi8(bytes, zero));
+    }
+#elif UNICODE_NEON
+    for (; i + 16 <= len; i += 16) {
+        const uint8x16_t bytes = vld1q_u8(src + i);
+        vst1q_u16((uint16_t*) (dst + i), vmovl_u8(vget_low_u8(bytes)));
+        vst1q_u16((uint16_t*) (dst + i + 8), vmovl_u8(vget_high_u8(bytes)));
+    }
+#endif
+    for (; i < len; i++) {
+        dst[i] = src[i];
+    }
+}
+
+/**
+ * Narrows "len" ASCII units to UTF-8.
+ */
+static void utf16_ascii_to_utf8(const char16_t* src, size_t len, char* dst)
+{
+    size_t i = 0;
+#if UNICODE_SSE2
+    for (; i + 16 <= len; i += 16) {
+        const __m128i low = _mm_loadu_si128((const __m128i*) (src + i));
+        const __m128i high = _mm_loadu_si128((const __m128i*) (src + i + 8));
+        _mm_storeu_si128((__m128i*) (dst + i), _mm_packus_epi16(low, high));
+    }
+#elif UNICODE_NEON
+    for (; i + 16 <= len; i += 16) {
+        const uint16x8_t low = vld1q_u16((const uint16_t*) (src + i));
+        const uint16x8_t high = vld1q_u16((const uint16_t*) (src + i + 8));
+        vst1q_u8((uint8_t*) (dst + i), vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+    }
+#endif
+    for (; i < len; i++) {
+        dst[i] = (char) src[i];
+    }
+}
+
 // --------------------------------------------------------------------------
 // UTF-32
 // --------------------------------------------------------------------------
@@ -340,18 +476,25 @@ void utf16_to_utf8(const char16_t* src, size_t src_len, char* dst)
     const char16_t* const end_utf16 = src + src_len;
     char *cur = dst;
     while (cur_utf16 < end_utf16) {
-        char32_t utf32;
-        // surrogate pairs
-        if ((*cur_utf16 & 0xFC00) == 0xD800) {
-            utf32 = (*cur_utf16++ - 0xD800) << 10;
-            utf32 |= *cur_utf16++ - 0xDC00;
-            utf32 += 0x10000;
-        } else {
-            utf32 = (char32_t) *cur_utf16++;
+        const size_t ascii = utf16_ascii_length(cur_utf16, end_utf16 - cur_utf16);
+        utf16_ascii_to_utf8(cur_utf16, ascii, cur);
+        cur_utf16 += ascii;
+        cur += ascii;
+
+        while (cur_utf16 < end_utf16 && *cur_utf16 >= 0x80) {
+            char32_t utf32 = (char32_t) *cur_utf16++;
+            if ((utf32 & 0xF800) == 0xD800) {
+                // surrogate pairs, unpaired surrogates are dropped
+                if ((utf32 & 0xFC00) != 0xD800 || cur_utf16 == end_utf16
+                        || (*cur_utf16 & 0xFC00) != 0xDC00) {
+                    continue;
+                }
+                utf32 = ((utf32 - 0xD800) << 10) + (*cur_utf16++ - 0xDC00) + 0x10000;
+            }
+            const size_t len = utf32_codepoint_utf8_length(utf32);
+            utf32_codepoint_to_utf8((uint8_t*)cur, utf32, len);
+            cur += len;
         }
-        const size_t len = utf32_codepoint_utf8_length(utf32);
-        utf32_codepoint_to_utf8((uint8_t*)cur, utf32, len);
-        cur += len;
     }
     *cur = '\0';
 }
@@ -412,13 +555,22 @@ ssize_t utf16_to_utf8_length(const char16_t *src, size_t src_len)
     size_t ret = 0;
     const char16_t* const end = src + src_len;
     while (src < end) {
-        if ((*src & 0xFC00) == 0xD800 && (src + 1) < end
-                && (*++src & 0xFC00) == 0xDC00) {
-            // surrogate pairs are always 4 bytes.
-            ret += 4;
-            src++;
-        } else {
-            ret += utf32_codepoint_utf8_length((char32_t) *src++);
+        const size_t ascii = utf16_ascii_length(src, end - src);
+        ret += ascii;
+        src += ascii;
+
+        while (src < end && *src >= 0x80) {
+            const char16_t unit = *src++;
+            if (unit < 0x800) {
+                ret += 2;
+            } else if ((unit & 0xF800) != 0xD800) {
+                ret += 3;
+            } else if ((unit & 0xFC00) == 0xD800 && src < end && (*src & 0xFC00) == 0xDC00) {
+                // surrogate pairs are always 4 bytes.
+                ret += 4;
+                src++;
+            }
+            // unpaired surrogates are dropped by utf16_to_utf8
         }
     }
     return ret;
@@ -516,27 +668,72 @@ static inline uint32_t utf8_to_utf32_codepoint(const uint8_t *src, size_t length
     //printf("Char at %p: len=%d, utf-16=%p\n", src, length, (void*)result);
 }
 
+/**
+ * Decodes the multibyte sequence "src" starts with. Returns its length, or 0
+ * if it is truncated, overlong, a surrogate or beyond U+10FFFF.
+ */
+static inline size_t utf8_decode_valid(const uint8_t* src, size_t len, uint32_t* codePoint)
+{
+    const uint8_t lead = src[0];
+    uint32_t unicode;
+
+    if (lead < 0xC2) {
+        // continuation byte or overlong 2 bytes sequence
+        return 0;
+    } else if (lead < 0xE0) {
+        if (len < 2 || (src[1] & 0xC0) != 0x80) {
+            return 0;
+        }
+        *codePoint = ((lead & 0x1F) << 6) | (src[1] & 0x3F);
+        return 2;
+    } else if (lead < 0xF0) {
+        if (len < 3 || (src[1] & 0xC0) != 0x80 || (src[2] & 0xC0) != 0x80) {
+            return 0;
+        }
+        unicode = ((lead & 0x0F) << 12) | ((src[1] & 0x3F) << 6) | (src[2] & 0x3F);
+        if (unicode < 0x800 || (unicode >= kUnicodeSurrogateStart && unicode <= kUnicodeSurrogateEnd)) {
+            return 0;
+        }
+        *codePoint = unicode;
+        return 3;
+    } else if (lead < 0xF5) {
+        if (len < 4 || (src[1] & 0xC0) != 0x80 || (src[2] & 0xC0) != 0x80
+                || (src[3] & 0xC0) != 0x80) {
+            return 0;
+        }
+        unicode = ((lead & 0x07) << 18) | ((src[1] & 0x3F) << 12) | ((src[2] & 0x3F) << 6)
+                | (src[3] & 0x3F);
+        if (unicode < 0x10000 || unicode > kUnicodeMaxCodepoint) {
+            return 0;
+        }
+        *codePoint = unicode;
+        return 4;
+    }
+
+    return 0;
+}
+
 ssize_t utf8_to_utf16_length(const uint8_t* u8str, size_t u8len)
 {
     const uint8_t* const u8end = u8str + u8len;
     const uint8_t* u8cur = u8str;
 
-    /* Validate that the UTF-8 is the correct len */
+    /* Validate the UTF-8 while measuring it */
     size_t u16measuredLen = 0;
     while (u8cur < u8end) {
-        u16measuredLen++;
-        int u8charLen = utf8_codepoint_len(*u8cur);
-        uint32_t codepoint = utf8_to_utf32_codepoint(u8cur, u8charLen);
-        if (codepoint > 0xFFFF) u16measuredLen++; // this will be a surrogate pair in utf16
-        u8cur += u8charLen;
-    }
-
-    /**
-     * Make sure that we ended where we thought we would and the output UTF-16
-     * will be exactly how long we were told it would be.
-     */
-    if (u8cur != u8end) {
-        return -1;
+        const size_t ascii = utf8_ascii_length(u8cur, u8end - u8cur);
+        u16measuredLen += ascii;
+        u8cur += ascii;
+
+        while (u8cur < u8end && *u8cur >= 0x80) {
+            uint32_t codepoint;
+            const size_t u8charLen = utf8_decode_valid(u8cur, u8end - u8cur, &codepoint);
+            if (u8charLen == 0) {
+                return -1;
+            }
+            u16measuredLen += codepoint > 0xFFFF ? 2 : 1; // surrogate pair in utf16
+            u8cur += u8charLen;
+        }
     }
 
     return u16measuredLen;
@@ -549,21 +746,32 @@ char16_t* utf8_to_utf16_no_null_terminator(const uint8_t* u8str, size_t u8len, c
     char16_t* u16cur = u16str;
 
     while (u8cur < u8end) {
-        size_t u8len = utf8_codepoint_len(*u8cur);
-        uint32_t codepoint = utf8_to_utf32_codepoint(u8cur, u8len);
+        const size_t ascii = utf8_ascii_length(u8cur, u8end - u8cur);
+        utf8_ascii_to_utf16(u8cur, ascii, u16cur);
+        u8cur += ascii;
+        u16cur += ascii;
+
+        while (u8cur < u8end && *u8cur >= 0x80) {
+            size_t u8len = utf8_codepoint_len(*u8cur);
+            if (u8len > (size_t) (u8end - u8cur)) {
+                // truncated, never read past the end
+                u8len = u8end - u8cur;
+            }
+            uint32_t codepoint = utf8_to_utf32_codepoint(u8cur, u8len);
+
+            // Convert the UTF32 codepoint to one or more UTF16 codepoints
+            if (codepoint <= 0xFFFF) {
+                // Single UTF16 character
+                *u16cur++ = (char16_t) codepoint;
+            } else {
+                // Multiple UTF16 characters with surrogates
+                codepoint = codepoint - 0x10000;
+                *u16cur++ = (char16_t) ((codepoint >> 10) + 0xD800);
+                *u16cur++ = (char16_t) ((codepoint & 0x3FF) + 0xDC00);
+            }
 
-        // Convert the UTF32 codepoint to one or more UTF16 codepoints
-        if (codepoint <= 0xFFFF) {
-            // Single UTF16 character
-            *u16cur++ = (char16_t) codepoint;
-        } else {
-            // Multiple UTF16 characters with surrogates
-            codepoint = codepoint - 0x10000;
-            *u16cur++ = (char16_t) ((codepoint >> 10) + 0xD800);
-            *u16cur++ = (char16_t) ((codepoint & 0x3FF) + 0xDC00);
+            u8cur += u8len;
         }
-
-        u8cur += u8len;
     }
     return u16cur;
 }
@@ -4,10 +4,14 @@ include $(CLEAR_VARS)
 
 # Build the unit tests.
 test_src_files := \
+    AsyncLogger_test.cpp \
     BasicHashtable_test.cpp \
     BlobCache_test.cpp \
+    Bundle_test.cpp \
+    Future_test.cpp \
     Looper_test.cpp \
     LruCache_test.cpp \
+    Ref_test.cpp \
     String8_test.cpp \
     Unicode_test.cpp \
     Vector_test.cpp \
@@ -21,6 +25,7 @@ shared_libraries := \
     libstlport
 
 static_libraries := \
+    mindroid_static \
     libgtest \
     libgtest_main
 
@@ -32,3 +37,12 @@ $(foreach file,$(test_src_files), \
     $(eval LOCAL_MODULE := $(notdir $(file:%.cpp=%))) \
     $(eval include $(BUILD_NATIVE_TEST)) \
 )
+
+# Runs the Looper tests again against the poll() fallback used off Linux.
+include $(CLEAR_VARS)
+LOCAL_SHARED_LIBRARIES := $(shared_libraries)
+LOCAL_STATIC_LIBRARIES := $(static_libraries)
+LOCAL_SRC_FILES := Looper_test.cpp ../Looper.cpp
+LOCAL_CFLAGS := -DLOOPER_USES_EPOLL=0
+LOCAL_MODULE := LooperPoll_test
+include $(BUILD_NATIVE_TEST)
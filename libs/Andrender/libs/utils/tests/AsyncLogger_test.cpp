@@ -0,0 +1,277 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mindroid/util/AsyncLogger.h>
+#include <mindroid/util/Log.h>
+
+#include <gtest/gtest.h>
+
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <string>
+#include <vector>
+
+namespace mindroid {
+
+// Keeps the printed records instead of writing them to stdout
+class CapturingLogger : public Logger {
+public:
+    virtual int println(int bufferId, uint8_t priority, const char* tag, const char* msg) {
+        AutoLock autoLock(mLock);
+        mTags.push_back(tag);
+        mMessages.push_back(msg);
+        return 0;
+    }
+
+    std::vector<std::string> messages() {
+        AutoLock autoLock(mLock);
+        return mMessages;
+    }
+
+    std::vector<std::string> tags() {
+        AutoLock autoLock(mLock);
+        return mTags;
+    }
+
+    void clear() {
+        AutoLock autoLock(mLock);
+        mTags.clear();
+        mMessages.clear();
+    }
+
+private:
+    Lock mLock;
+    std::vector<std::string> mTags;
+    std::vector<std::string> mMessages;
+};
+
+class AsyncLoggerTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+        mAsyncLogger = new AsyncLogger(mLogger);
+    }
+
+    virtual void TearDown() {
+        delete mAsyncLogger;
+    }
+
+    bool log(const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        bool result = mAsyncLogger->log(0, Log::INFO, "tag", format, args);
+        va_end(args);
+        return result;
+    }
+
+    // Logs the message and checks that it prints as vsnprintf formats it
+    void expectRoundTrip(const char* format, ...) {
+        char expected[AsyncLogger::MESSAGE_SIZE];
+        va_list args;
+        va_start(args, format);
+        va_list argsCopy;
+        va_copy(argsCopy, args);
+        vsnprintf(expected, sizeof(expected), format, argsCopy);
+        va_end(argsCopy);
+        EXPECT_TRUE(mAsyncLogger->log(0, Log::INFO, "tag", format, args)) << format;
+        va_end(args);
+
+        mLogger.clear();
+        mAsyncLogger->flush();
+        std::vector<std::string> messages = mLogger.messages();
+        ASSERT_EQ(1U, messages.size()) << format;
+        EXPECT_EQ(std::string(expected), messages[0]) << format;
+    }
+
+    CapturingLogger mLogger;
+    AsyncLogger* mAsyncLogger;
+};
+
+TEST_F(AsyncLoggerTest, PackedArgumentsRoundTrip) {
+    expectRoundTrip("no arguments");
+    expectRoundTrip("%d %i %u %x %X %o %c", -42, 7, 3000000000U, 0xbeef, 0xBEEF, 8, 'z');
+    expectRoundTrip("%ld %lld %zu %jd %td", -1L << 40, -1LL << 60, (size_t) 12345,
+            (intmax_t) -9, (ptrdiff_t) -3);
+    expectRoundTrip("%hd %hhu", (short) -5, (unsigned char) 200);
+    expectRoundTrip("%.2f %e %g %10.3f %-8.1f|", 3.14159, 1e-10, 0.5, -2.5, 9.25);
+    expectRoundTrip("%Lf", (long double) 1.25);
+    expectRoundTrip("%s and %s", "first", "second");
+    expectRoundTrip("%*d|%-*d|%.*s", 6, 42, 4, 7, 3, "abcdef");
+    expectRoundTrip("%p", (void*) &mLogger);
+    expectRoundTrip("100%% %d%%", 5);
+}
+
+TEST_F(AsyncLoggerTest, StringsAreCopied) {
+    char buffer[16];
+    strcpy(buffer, "before");
+    ASSERT_TRUE(log("%s", buffer));
+    strcpy(buffer, "after");
+
+    mAsyncLogger->flush();
+    std::vector<std::string> messages = mLogger.messages();
+    ASSERT_EQ(1U, messages.size());
+    EXPECT_EQ("before", messages[0]);
+    EXPECT_EQ("tag", mLogger.tags()[0]);
+
+    mLogger.clear();
+    ASSERT_TRUE(log("[%s]", (const char*) NULL));
+    mAsyncLogger->flush();
+    EXPECT_EQ("[(null)]", mLogger.messages()[0]);
+}
+
+TEST_F(AsyncLoggerTest, LongSpecSkipsItsArguments) {
+    // 70 '0' flags make the spec longer than the 64 chars formatRecord copies
+    std::string spec = "%" + std::string(70, '0') + "5d";
+    std::string format = "[%s] " + spec + " [%d] [%s]";
+    ASSERT_GE(spec.size(), 64U);
+
+    ASSERT_TRUE(log(format.c_str(), "a", 42, 7, "b"));
+    mAsyncLogger->flush();
+    std::vector<std::string> messages = mLogger.messages();
+    ASSERT_EQ(1U, messages.size());
+    EXPECT_EQ("[a] " + spec + " [7] [b]", messages[0])
+            << "the specs after the long one should print their own arguments";
+}
+
+static const uint32_t RING_SIZE = AsyncLogger::RING_BUFFER_SIZE;
+
+// A record of the fixture's "tag" and one %d argument: the header, the tag
+// and the value, each 8-byte aligned
+static const uint32_t INT_RECORD_SIZE = 16 + 16 + 8;
+
+TEST_F(AsyncLoggerTest, DropsRecordsWhenTheRingIsFull) {
+    uint32_t written = 0;
+    while (log("%d", written)) {
+        written++;
+        ASSERT_LE(written, RING_SIZE / INT_RECORD_SIZE)
+                << "the ring should not take more than it holds";
+    }
+    EXPECT_EQ(RING_SIZE / INT_RECORD_SIZE, written);
+    EXPECT_EQ(1U, mAsyncLogger->getDroppedRecordCount());
+
+    EXPECT_FALSE(log("%d", -1));
+    EXPECT_FALSE(log("%d", -1));
+    EXPECT_EQ(3U, mAsyncLogger->getDroppedRecordCount());
+
+    // Everything that was taken prints in order, nothing that was dropped does
+    mAsyncLogger->flush();
+    std::vector<std::string> messages = mLogger.messages();
+    ASSERT_EQ(written, messages.size());
+    for (uint32_t i = 0; i < written; i++) {
+        char expected[16];
+        snprintf(expected, sizeof(expected), "%u", i);
+        EXPECT_EQ(expected, messages[i]);
+    }
+
+    EXPECT_TRUE(log("%d", 0)) << "a drained ring should take records again";
+    EXPECT_EQ(3U, mAsyncLogger->getDroppedRecordCount());
+}
+
+// The odd records add a %s of 40 chars
+static const uint32_t STRING_RECORD_SIZE = INT_RECORD_SIZE + 8 + 48;
+static const char* const PADDING = "forty characters of padding to vary size";
+
+TEST_F(AsyncLoggerTest, MemoryStaysBounded) {
+    // Records of two sizes wrap around the end of the ring at different
+    // offsets every round: the ring takes no more than its size, and no less
+    // than its size minus the padding at the end and the record that failed
+    uint32_t sequence = 0;
+    uint32_t printed = 0;
+    for (int round = 0; round < 20; round++) {
+        uint32_t bytes = 0;
+        uint32_t written = 0;
+        while (log((sequence & 1) ? "%d %s" : "%d", sequence, PADDING)) {
+            bytes += (sequence & 1) ? STRING_RECORD_SIZE : INT_RECORD_SIZE;
+            sequence++;
+            written++;
+            ASSERT_LE(bytes, RING_SIZE) << "round " << round;
+        }
+        EXPECT_GT(bytes + 2 * STRING_RECORD_SIZE, RING_SIZE)
+                << "round " << round;
+
+        mAsyncLogger->flush();
+        printed += written;
+        ASSERT_EQ(printed, mLogger.messages().size()) << "round " << round;
+    }
+    EXPECT_EQ(20U, mAsyncLogger->getDroppedRecordCount());
+
+    std::vector<std::string> messages = mLogger.messages();
+    for (uint32_t i = 0; i < messages.size(); i++) {
+        EXPECT_EQ(i, (uint32_t) atoi(messages[i].c_str())) << "record " << i;
+    }
+}
+
+static const int THREADS = 4;
+static const int THREAD_RECORDS = 100;
+
+static bool logRecord(AsyncLogger* asyncLogger, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    bool result = asyncLogger->log(0, Log::INFO, "thread", format, args);
+    va_end(args);
+    return result;
+}
+
+static void* logFromThread(void* arg) {
+    // Each thread logs into a ring of its own
+    AsyncLogger* asyncLogger = (AsyncLogger*) arg;
+    for (int i = 0; i < THREAD_RECORDS; i++) {
+        if (!logRecord(asyncLogger, "record %d", i)) {
+            return NULL;
+        }
+    }
+    return arg;
+}
+
+TEST_F(AsyncLoggerTest, ExitedThreadsAreDrained) {
+    pthread_t threads[THREADS];
+    for (int i = 0; i < THREADS; i++) {
+        ASSERT_EQ(0, pthread_create(&threads[i], NULL, logFromThread, mAsyncLogger));
+    }
+    for (int i = 0; i < THREADS; i++) {
+        void* result;
+        pthread_join(threads[i], &result);
+        EXPECT_TRUE(result != NULL) << "thread " << i;
+    }
+
+    // The rings of the exited threads print their records and are freed
+    mAsyncLogger->flush();
+    EXPECT_EQ((size_t) THREADS * THREAD_RECORDS, mLogger.messages().size());
+    mAsyncLogger->flush();
+    EXPECT_EQ((size_t) THREADS * THREAD_RECORDS, mLogger.messages().size());
+    EXPECT_EQ(0U, mAsyncLogger->getDroppedRecordCount());
+}
+
+TEST_F(AsyncLoggerTest, FlushThreadPrintsRecords) {
+    ASSERT_TRUE(mAsyncLogger->start());
+    EXPECT_TRUE(mAsyncLogger->isStarted());
+    ASSERT_TRUE(log("%s %d", "printed", 1));
+
+    for (int i = 0; i < 100 && mLogger.messages().empty(); i++) {
+        usleep(AsyncLogger::FLUSH_INTERVAL * 1000);
+    }
+    ASSERT_EQ(1U, mLogger.messages().size());
+    EXPECT_EQ("printed 1", mLogger.messages()[0]);
+
+    mAsyncLogger->stop();
+    EXPECT_FALSE(mAsyncLogger->isStarted());
+}
+
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mindroid/os/Bundle.h>
+#include <mindroid/util/Buffer.h>
+
+#include <gtest/gtest.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+namespace mindroid {
+
+class BundleTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+    }
+
+    virtual void TearDown() {
+    }
+};
+
+static const char* const KEYS[] = {
+    "what", "x", "y", "pointerId", "timestamp", "pressure", "text", "scale"
+};
+static const int KEY_COUNT = sizeof(KEYS) / sizeof(KEYS[0]);
+
+// Fills a bundle the way a touch or text message would be filled
+static void fill(const sp<Bundle>& bundle, int32_t value) {
+    bundle->putInt32(KEYS[0], value);
+    bundle->putFloat(KEYS[1], value * 0.5f);
+    bundle->putFloat(KEYS[2], value * 0.25f);
+    bundle->putInt32(KEYS[3], value & 7);
+    bundle->putInt64(KEYS[4], value * 1000000LL);
+    bundle->putDouble(KEYS[5], value / 3.0);
+    bundle->putString(KEYS[6], "hello");
+    bundle->putBool(KEYS[7], (value & 1) != 0);
+}
+
+static void expectFilled(const sp<Bundle>& bundle, int32_t value) {
+    EXPECT_EQ(value, bundle->getInt32(KEYS[0], -1));
+    EXPECT_EQ(value * 0.5f, bundle->getFloat(KEYS[1], -1));
+    EXPECT_EQ(value * 0.25f, bundle->getFloat(KEYS[2], -1));
+    EXPECT_EQ(value & 7, bundle->getInt32(KEYS[3], -1));
+    EXPECT_EQ(value * 1000000LL, bundle->getInt64(KEYS[4], -1));
+    EXPECT_EQ(value / 3.0, bundle->getDouble(KEYS[5], -1));
+    sp<String> text = bundle->getString(KEYS[6]);
+    ASSERT_TRUE(text != NULL);
+    EXPECT_STREQ("hello", text->c_str());
+    EXPECT_EQ((value & 1) != 0, bundle->getBool(KEYS[7], (value & 1) == 0));
+}
+
+TEST_F(BundleTest, PutGet) {
+    sp<Bundle> bundle = new Bundle();
+    fill(bundle, 42);
+    EXPECT_EQ((size_t) KEY_COUNT, bundle->size());
+    expectFilled(bundle, 42);
+}
+
+TEST_F(BundleTest, PutReplacesValue) {
+    sp<Bundle> bundle = new Bundle();
+    bundle->putInt32("key", 1);
+    bundle->putString("key", "value");
+    EXPECT_EQ(1U, bundle->size());
+    EXPECT_EQ(-1, bundle->getInt32("key", -1))
+            << "the old value should be gone";
+    EXPECT_STREQ("value", bundle->getString("key")->c_str());
+}
+
+TEST_F(BundleTest, RemoveKeepsOtherKeys) {
+    sp<Bundle> bundle = new Bundle();
+    char key[16];
+    for (int i = 0; i < 100; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        bundle->putInt32(key, i);
+    }
+    for (int i = 0; i < 100; i += 2) {
+        snprintf(key, sizeof(key), "key%d", i);
+        bundle->remove(key);
+    }
+    EXPECT_EQ(50U, bundle->size());
+    for (int i = 0; i < 100; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        EXPECT_EQ((i & 1) ? i : -1, bundle->getInt32(key, -1)) << key;
+    }
+}
+
+TEST_F(BundleTest, SerializeRoundTrip) {
+    sp<Bundle> bundle = new Bundle();
+    fill(bundle, -12345);
+    bundle->putUInt64("big", 0xFFFFFFFFFFFFFFFFULL);
+
+    sp<Buffer> buffer = bundle->serialize();
+    ASSERT_TRUE(buffer != NULL);
+    EXPECT_EQ(bundle->getSerializedSize(), buffer->size());
+
+    sp<Bundle> copy = Bundle::deserialize(buffer->data(), buffer->size());
+    ASSERT_TRUE(copy != NULL);
+    EXPECT_EQ(bundle->size(), copy->size());
+    expectFilled(copy, -12345);
+    EXPECT_EQ(0xFFFFFFFFFFFFFFFFULL, copy->getUInt64("big", 0));
+
+    EXPECT_TRUE(Bundle::deserialize(buffer->data(), buffer->size() - 1) == NULL)
+            << "truncated data should be rejected";
+}
+
+static const int INTERN_THREADS = 4;
+static const int INTERN_KEYS = 2000;
+
+static void* putKeys(void* arg) {
+    const int thread = (int) (intptr_t) arg;
+    sp<Bundle> bundle = new Bundle();
+    char key[32];
+    for (int i = 0; i < INTERN_KEYS; i++) {
+        // Every thread shares half of its keys with the others
+        snprintf(key, sizeof(key), (i & 1) ? "shared%d" : "thread%d.%d", i, thread);
+        bundle->putInt32(key, i);
+    }
+    bool ok = bundle->size() == (size_t) INTERN_KEYS;
+    for (int i = 0; i < INTERN_KEYS && ok; i++) {
+        snprintf(key, sizeof(key), (i & 1) ? "shared%d" : "thread%d.%d", i, thread);
+        ok = bundle->getInt32(key, -1) == i;
+    }
+    return (void*) (intptr_t) ok;
+}
+
+TEST_F(BundleTest, ConcurrentPutsInternKeys) {
+    pthread_t threads[INTERN_THREADS];
+    for (int i = 0; i < INTERN_THREADS; i++) {
+        ASSERT_EQ(0, pthread_create(&threads[i], NULL, putKeys, (void*) (intptr_t) i));
+    }
+    for (int i = 0; i < INTERN_THREADS; i++) {
+        void* result;
+        pthread_join(threads[i], &result);
+        EXPECT_TRUE(result != NULL) << "thread " << i;
+    }
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static const int THROUGHPUT_KEY_COUNTS[] = { 1, 8, 32, 100 };
+static const int MAX_THROUGHPUT_KEYS = 100;
+
+// Puts keyCount generated keys with the value types a message carries
+static void fillGenerated(const sp<Bundle>& bundle, char keys[][16], int keyCount, int32_t value) {
+    for (int k = 0; k < keyCount; k++) {
+        switch (k % 4) {
+            case 0:
+                bundle->putInt32(keys[k], value);
+                break;
+            case 1:
+                bundle->putFloat(keys[k], value * 0.5f);
+                break;
+            case 2:
+                bundle->putInt64(keys[k], value * 1000000LL);
+                break;
+            default:
+                bundle->putString(keys[k], "hello");
+                break;
+        }
+    }
+}
+
+static void measureThroughput(int keyCount) {
+    char keys[MAX_THROUGHPUT_KEYS][16];
+    for (int k = 0; k < keyCount; k++) {
+        snprintf(keys[k], sizeof(keys[k]), "key%d", k);
+    }
+
+    // Fewer bundles for more keys, so that every count puts about as many
+    const int iterations = 100000;
+    const int bundles = keyCount <= 8 ? iterations : iterations * 8 / keyCount;
+    int64_t checksum = 0;
+
+    double start = now();
+    for (int i = 0; i < bundles; i++) {
+        sp<Bundle> bundle = new Bundle();
+        fillGenerated(bundle, keys, keyCount, i);
+    }
+    const double put = now() - start;
+
+    sp<Bundle> bundle = new Bundle();
+    fillGenerated(bundle, keys, keyCount, 7);
+    ASSERT_EQ((size_t) keyCount, bundle->size());
+    start = now();
+    for (int i = 0; i < iterations; i++) {
+        checksum += bundle->getInt32(keys[i % keyCount], i);
+    }
+    const double get = now() - start;
+
+    const size_t size = bundle->getSerializedSize();
+    std::vector<uint8_t> data(size);
+    ASSERT_EQ(size, bundle->serialize(&data[0], size));
+    start = now();
+    for (int i = 0; i < bundles; i++) {
+        bundle->serialize(&data[0], size);
+        sp<Bundle> copy = Bundle::deserialize(&data[0], size);
+        checksum += copy->size();
+    }
+    const double serialize = now() - start;
+
+    EXPECT_NE(0, checksum);
+    printf("Bundle: %3d keys, put %.0f ns/bundle, get %.0f ns, "
+            "serialize+deserialize %.0f ns (%zu bytes)\n",
+            keyCount, put * 1e9 / bundles, get * 1e9 / iterations,
+            serialize * 1e9 / bundles, size);
+}
+
+TEST_F(BundleTest, Throughput) {
+    const int counts = sizeof(THROUGHPUT_KEY_COUNTS) / sizeof(THROUGHPUT_KEY_COUNTS[0]);
+    for (int i = 0; i < counts; i++) {
+        SCOPED_TRACE(THROUGHPUT_KEY_COUNTS[i]);
+        measureThroughput(THROUGHPUT_KEY_COUNTS[i]);
+    }
+}
+
+}
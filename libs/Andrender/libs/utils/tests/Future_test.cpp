@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mindroid/os/Future.h>
+#include <mindroid/os/Clock.h>
+#include <mindroid/os/Handler.h>
+#include <mindroid/os/LooperThread.h>
+#include <mindroid/os/ThreadPoolExecutor.h>
+
+#include <gtest/gtest.h>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <vector>
+
+namespace mindroid {
+
+class FutureTest : public testing::Test {
+protected:
+    virtual void SetUp() {
+    }
+
+    virtual void TearDown() {
+    }
+};
+
+static uint64_t elapsedMillis(uint64_t start) {
+    return (Clock::monotonicTime() - start) / 1000000;
+}
+
+// The weak references held on top of the strong ones, such as the one of the
+// listener that cancels a future with its token
+static int32_t getExtraWeakRefs(const sp< Future<int> >& future) {
+    return future->getWeakRef()->getWeakRefCount() - future->getStrongRefCount();
+}
+
+TEST_F(FutureTest, ThenRunsInlineWhenComplete) {
+    sp< Promise<int> > promise = new Promise<int>();
+    ASSERT_TRUE(promise->set(2));
+    EXPECT_FALSE(promise->set(3)) << "a future completes only once";
+
+    pthread_t thread = 0;
+    sp< Future<int> > future = promise->getFuture()->then([&thread] (int value) {
+        thread = pthread_self();
+        return value * 3;
+    });
+    EXPECT_TRUE(future->isDone()) << "the continuation should have run right away";
+    EXPECT_TRUE(pthread_equal(thread, pthread_self()));
+    EXPECT_EQ(6, future->get());
+}
+
+TEST_F(FutureTest, ThenRunsOnTheCompletingThread) {
+    sp< Promise<int> > promise = new Promise<int>();
+    pthread_t thread = 0;
+    sp< Future<int> > future = promise->getFuture()->then([&thread] (int value) {
+        thread = pthread_self();
+        return value + 1;
+    });
+    EXPECT_FALSE(future->isDone());
+
+    // set() runs the continuation before it returns
+    ASSERT_TRUE(promise->set(41));
+    EXPECT_TRUE(future->isDone());
+    EXPECT_TRUE(pthread_equal(thread, pthread_self()));
+    EXPECT_EQ(42, future->get());
+}
+
+TEST_F(FutureTest, ThenLandsOnTheChosenLooper) {
+    sp< LooperThread<Handler> > looperThread = new LooperThread<Handler>();
+    looperThread->start();
+    Looper* looper = looperThread->getLooper();
+    ASSERT_TRUE(looper != NULL);
+    ASSERT_TRUE(Looper::myLooper() != looper);
+
+    sp< Promise<int> > promise = new Promise<int>();
+    Looper* first = NULL;
+    Looper* second = NULL;
+    sp< Future<int> > future = promise->getFuture()
+            ->then(*looper, [&first] (int value) {
+                first = Looper::myLooper();
+                return value * 2;
+            })
+            ->then(*looper, [&second] (int value) {
+                second = Looper::myLooper();
+                return value + 1;
+            });
+
+    ASSERT_TRUE(promise->set(10));
+    int result = 0;
+    ASSERT_TRUE(future->get(result, 1000));
+    EXPECT_EQ(21, result);
+    EXPECT_EQ(looper, first);
+    EXPECT_EQ(looper, second);
+
+    // Already completed, the continuation still goes to the looper
+    Looper* third = NULL;
+    ASSERT_TRUE(future->then(*looper, [&third] (int value) {
+        third = Looper::myLooper();
+        return value;
+    })->get(result, 1000));
+    EXPECT_EQ(looper, third);
+
+    looper->quit();
+    looperThread->join();
+}
+
+TEST_F(FutureTest, ThenRunsOnTheExecutor) {
+    ThreadPoolExecutor executor(2);
+    sp< Future<int> > future = Future<int>::async(executor, [] () {
+        return 5;
+    })->then(executor, [] (int value) {
+        return value * value;
+    });
+
+    int result = 0;
+    ASSERT_TRUE(future->get(result, 1000));
+    EXPECT_EQ(25, result);
+}
+
+TEST_F(FutureTest, WhenAllCollectsResultsInOrder) {
+    std::vector< sp< Promise<int> > > promises;
+    std::vector< sp< Future<int> > > futures;
+    for (int i = 0; i < 4; i++) {
+        promises.push_back(new Promise<int>());
+        futures.push_back(promises[i]->getFuture());
+    }
+    sp< Future< std::vector<int> > > all = whenAll(futures);
+
+    for (int i = 3; i > 0; i--) {
+        promises[i]->set(i * 10);
+        EXPECT_FALSE(all->isDone()) << "input " << i;
+    }
+    promises[0]->set(0);
+    ASSERT_TRUE(all->isDone());
+    EXPECT_FALSE(all->isCancelled());
+
+    std::vector<int> results = all->get();
+    ASSERT_EQ(4U, results.size());
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(i * 10, results[i]);
+    }
+
+    sp< Future< std::vector<int> > > none = whenAll(std::vector< sp< Future<int> > >());
+    ASSERT_TRUE(none->isDone());
+    EXPECT_TRUE(none->get().empty());
+}
+
+TEST_F(FutureTest, WhenAllFansInFromExecutorThreads) {
+    ThreadPoolExecutor executor(4);
+    std::vector< sp< Future<int> > > futures;
+    for (int i = 0; i < 32; i++) {
+        futures.push_back(Future<int>::async(executor, [i] () {
+            usleep((i % 4) * 1000);
+            return i;
+        }));
+    }
+
+    std::vector<int> results;
+    ASSERT_TRUE(whenAll(futures)->get(results, 2000));
+    ASSERT_EQ(32U, results.size());
+    for (int i = 0; i < 32; i++) {
+        EXPECT_EQ(i, results[i]);
+    }
+}
+
+TEST_F(FutureTest, WhenAllIsCancelledByOneInput) {
+    std::vector< sp< Promise<int> > > promises;
+    std::vector< sp< Future<int> > > futures;
+    for (int i = 0; i < 3; i++) {
+        promises.push_back(new Promise<int>());
+        futures.push_back(promises[i]->getFuture());
+    }
+    sp< Future< std::vector<int> > > all = whenAll(futures);
+
+    promises[0]->set(1);
+    promises[1]->cancel();
+    EXPECT_TRUE(all->isCancelled()) << "should not wait for the remaining inputs";
+    EXPECT_TRUE(all->get().empty());
+
+    promises[2]->set(3);
+    EXPECT_TRUE(all->isCancelled());
+
+    // An input that was cancelled before whenAll() was called
+    sp< Promise<int> > pending = new Promise<int>();
+    futures[0] = pending->getFuture();
+    futures[2] = pending->getFuture();
+    EXPECT_TRUE(whenAll(futures)->isCancelled());
+}
+
+TEST_F(FutureTest, TokenCancelsEveryStage) {
+    sp<CancellationToken> token = new CancellationToken();
+    sp< Promise<int> > promise = new Promise<int>(token);
+    bool ran = false;
+    sp< Future<int> > future = promise->getFuture()->then([&ran] (int value) {
+        ran = true;
+        return value;
+    });
+    EXPECT_TRUE(future->getCancellationToken() == token);
+
+    token->cancel();
+    EXPECT_TRUE(token->isCancelled());
+    EXPECT_TRUE(promise->getFuture()->isCancelled());
+    EXPECT_TRUE(future->isCancelled());
+    EXPECT_EQ(0, future->get());
+
+    EXPECT_FALSE(promise->set(1)) << "a cancelled future takes no value";
+    EXPECT_FALSE(ran);
+
+    // Work started with a cancelled token is skipped
+    ThreadPoolExecutor executor(1);
+    sp< Future<int> > skipped = Future<int>::async(executor, [&ran] () {
+        ran = true;
+        return 1;
+    }, token);
+    EXPECT_TRUE(skipped->isCancelled());
+    int result = 0;
+    EXPECT_FALSE(skipped->get(result, 100));
+    EXPECT_FALSE(ran);
+}
+
+TEST_F(FutureTest, ListenersAreRemovedAfterCompletion) {
+    sp<CancellationToken> token = new CancellationToken();
+    sp< Promise<int> > promise = new Promise<int>(token);
+    sp< Future<int> > future = promise->getFuture();
+    EXPECT_EQ(1, getExtraWeakRefs(future)) << "the token should hold the future's listener";
+
+    ASSERT_TRUE(promise->set(7));
+    EXPECT_EQ(0, getExtraWeakRefs(future)) << "the listener should go once the future completes";
+
+    // Cancelling the token later leaves the result alone
+    token->cancel();
+    EXPECT_FALSE(future->isCancelled());
+    EXPECT_EQ(7, future->get());
+
+    // A cancelled future has no listener left either
+    sp<CancellationToken> other = new CancellationToken();
+    sp< Promise<int> > cancelled = new Promise<int>(other);
+    ASSERT_TRUE(cancelled->cancel());
+    EXPECT_EQ(0, getExtraWeakRefs(cancelled->getFuture()));
+
+    // Nor does one created with a token that was already cancelled
+    sp< Promise<int> > late = new Promise<int>(token);
+    EXPECT_TRUE(late->isCancelled());
+    EXPECT_EQ(0, getExtraWeakRefs(late->getFuture()));
+}
+
+struct DelayedSet {
+    sp< Promise<int> > promise;
+    uint32_t delay;
+};
+
+static void* setAfterDelay(void* arg) {
+    DelayedSet* delayedSet = (DelayedSet*) arg;
+    usleep(delayedSet->delay * 1000);
+    delayedSet->promise->set(9);
+    return NULL;
+}
+
+TEST_F(FutureTest, TimedGetHonorsTheDeadline) {
+    sp< Promise<int> > promise = new Promise<int>();
+    int result = -1;
+    uint64_t start = Clock::monotonicTime();
+    EXPECT_FALSE(promise->getFuture()->get(result, 50));
+    EXPECT_GE(elapsedMillis(start), 50U) << "should not give up before the deadline";
+    EXPECT_LT(elapsedMillis(start), 1000U);
+    EXPECT_EQ(-1, result) << "the result should be left alone";
+
+    // Completed before the deadline, get() returns as soon as the value is set
+    DelayedSet delayedSet = { promise, 20 };
+    pthread_t thread;
+    start = Clock::monotonicTime();
+    ASSERT_EQ(0, pthread_create(&thread, NULL, setAfterDelay, &delayedSet));
+    EXPECT_TRUE(promise->getFuture()->get(result, 5000));
+    EXPECT_LT(elapsedMillis(start), 2000U);
+    EXPECT_EQ(9, result);
+    pthread_join(thread, NULL);
+
+    // A completed future answers even without a timeout
+    EXPECT_TRUE(promise->getFuture()->get(result, 0));
+
+    // A cancelled one fails right away
+    sp< Promise<int> > cancelled = new Promise<int>();
+    cancelled->cancel();
+    start = Clock::monotonicTime();
+    EXPECT_FALSE(cancelled->getFuture()->get(result, 5000));
+    EXPECT_LT(elapsedMillis(start), 1000U);
+}
+
+}
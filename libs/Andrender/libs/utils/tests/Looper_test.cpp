@@ -24,10 +24,10 @@ enum {
 };
 
 class DelayedWake : public DelayedTask {
-    sp<Looper> mLooper;
+    mindroid::sp<Looper> mLooper;
 
 public:
-    DelayedWake(int delayMillis, const sp<Looper> looper) :
+    DelayedWake(int delayMillis, const mindroid::sp<Looper> looper) :
         DelayedTask(delayMillis), mLooper(looper) {
     }
 
@@ -53,7 +53,7 @@ protected:
 
 class CallbackHandler {
 public:
-    void setCallback(const sp<Looper>& looper, int fd, int events) {
+    void setCallback(const mindroid::sp<Looper>& looper, int fd, int events) {
         looper->addFd(fd, 0, events, staticHandler, this);
     }
 
@@ -89,6 +89,57 @@ protected:
     }
 };
 
+class RemovingCallbackHandler : public CallbackHandler {
+public:
+    mindroid::sp<Looper> looper;
+    int callbackCount;
+
+    RemovingCallbackHandler(const mindroid::sp<Looper>& looper) : looper(looper),
+            callbackCount(0) {
+    }
+
+protected:
+    virtual int handler(int fd, int events) {
+        callbackCount += 1;
+        looper->removeFd(fd);
+        return 1; // keep the callback, removeFd should win
+    }
+};
+
+class DelayedAddFd : public DelayedTask {
+    mindroid::sp<Looper> mLooper;
+    CallbackHandler* mHandler;
+    Pipe* mPipe;
+
+public:
+    DelayedAddFd(int delayMillis, const mindroid::sp<Looper>& looper,
+            CallbackHandler* handler, Pipe* pipe) :
+        DelayedTask(delayMillis), mLooper(looper), mHandler(handler), mPipe(pipe) {
+    }
+
+protected:
+    virtual void doTask() {
+        mHandler->setCallback(mLooper, mPipe->receiveFd, ALOOPER_EVENT_INPUT);
+    }
+};
+
+class DelayedRemoveFdThenWriteSignal : public DelayedTask {
+    mindroid::sp<Looper> mLooper;
+    Pipe* mPipe;
+
+public:
+    DelayedRemoveFdThenWriteSignal(int delayMillis, const mindroid::sp<Looper>& looper,
+            Pipe* pipe) :
+        DelayedTask(delayMillis), mLooper(looper), mPipe(pipe) {
+    }
+
+protected:
+    virtual void doTask() {
+        mLooper->removeFd(mPipe->receiveFd);
+        mPipe->writeSignal();
+    }
+};
+
 class StubMessageHandler : public MessageHandler {
 public:
     Vector<Message> messages;
@@ -100,7 +151,7 @@ public:
 
 class LooperTest : public testing::Test {
 protected:
-    sp<Looper> mLooper;
+    mindroid::sp<Looper> mLooper;
 
     virtual void SetUp() {
         mLooper = new Looper(true);
@@ -137,7 +188,7 @@ TEST_F(LooperTest, PollOnce_WhenNonZeroTimeoutAndAwokenBeforeWaiting_Immediately
 }
 
 TEST_F(LooperTest, PollOnce_WhenNonZeroTimeoutAndAwokenWhileWaiting_PromptlyReturns) {
-    sp<DelayedWake> delayedWake = new DelayedWake(100, mLooper);
+    mindroid::sp<DelayedWake> delayedWake = new DelayedWake(100, mLooper);
     delayedWake->run();
 
     StopWatch stopWatch("pollOnce");
@@ -248,7 +299,7 @@ TEST_F(LooperTest, PollOnce_WhenNonZeroTimeoutAndSignalledFDBeforeWaiting_Immedi
 TEST_F(LooperTest, PollOnce_WhenNonZeroTimeoutAndSignalledFDWhileWaiting_PromptlyInvokesCallbackAndReturns) {
     Pipe pipe;
     StubCallbackHandler handler(true);
-    sp<DelayedWriteSignal> delayedWriteSignal = new DelayedWriteSignal(100, & pipe);
+    mindroid::sp<DelayedWriteSignal> delayedWriteSignal = new DelayedWriteSignal(100, & pipe);
 
     handler.setCallback(mLooper, pipe.receiveFd, ALOOPER_EVENT_INPUT);
     delayedWriteSignal->run();
@@ -380,7 +431,7 @@ TEST_F(LooperTest, AddFd_WhenIdentIsNegativeAndCallbackIsNull_ReturnsError) {
 
 TEST_F(LooperTest, AddFd_WhenNoCallbackAndAllowNonCallbacksIsFalse_ReturnsError) {
     Pipe pipe;
-    sp<Looper> looper = new Looper(false /*allowNonCallbacks*/);
+    mindroid::sp<Looper> looper = new Looper(false /*allowNonCallbacks*/);
     int result = looper->addFd(pipe.receiveFd, 0, 0, NULL, NULL);
 
     EXPECT_EQ(-1, result)
@@ -437,8 +488,83 @@ TEST_F(LooperTest, PollOnce_WhenCallbackAddedTwice_OnlySecondCallbackShouldBeInv
             << "replacement handler callback should be invoked";
 }
 
+// The poll() fallback has to poll again to see added or removed fds, which
+// must not end pollOnce early. These cases change them while the looper
+// waits; LooperPoll_test in Android.mk runs every case against poll().
+
+TEST_F(LooperTest, PollOnce_WhenFdAddedWhilePolling_PromptlyInvokesCallback) {
+    Pipe pipe;
+    StubCallbackHandler handler(true);
+    pipe.writeSignal(); // signalled before it is watched
+    mindroid::sp<DelayedAddFd> delayedAddFd = new DelayedAddFd(100, mLooper, &handler, &pipe);
+    delayedAddFd->run();
+
+    StopWatch stopWatch("pollOnce");
+    int result = mLooper->pollOnce(1000);
+    int32_t elapsedMillis = ns2ms(stopWatch.elapsedTime());
+
+    ASSERT_EQ(OK, pipe.readSignal())
+            << "signal should actually have been written";
+    EXPECT_NEAR(100, elapsedMillis, TIMING_TOLERANCE_MS)
+            << "elapsed time should approx. equal the delay before the FD was added";
+    EXPECT_EQ(ALOOPER_POLL_CALLBACK, result)
+            << "pollOnce result should be ALOOPER_POLL_CALLBACK because FD was signalled";
+    EXPECT_EQ(1, handler.callbackCount)
+            << "callback should be invoked exactly once";
+    EXPECT_EQ(pipe.receiveFd, handler.fd)
+            << "callback should have received pipe fd as parameter";
+}
+
+TEST_F(LooperTest, PollOnce_WhenFdRemovedWhilePolling_CallbackShouldNotBeInvoked) {
+    Pipe pipe;
+    StubCallbackHandler handler(true);
+    handler.setCallback(mLooper, pipe.receiveFd, ALOOPER_EVENT_INPUT);
+    mindroid::sp<DelayedRemoveFdThenWriteSignal> delayedRemove =
+            new DelayedRemoveFdThenWriteSignal(100, mLooper, &pipe);
+    delayedRemove->run();
+
+    StopWatch stopWatch("pollOnce");
+    int result = mLooper->pollOnce(300);
+    int32_t elapsedMillis = ns2ms(stopWatch.elapsedTime());
+
+    ASSERT_EQ(OK, pipe.readSignal())
+            << "signal should actually have been written";
+    EXPECT_NEAR(300, elapsedMillis, TIMING_TOLERANCE_MS)
+            << "elapsed time should approx. equal timeout because FD was no longer registered";
+    EXPECT_EQ(ALOOPER_POLL_TIMEOUT, result)
+            << "pollOnce result should be ALOOPER_POLL_TIMEOUT";
+    EXPECT_EQ(0, handler.callbackCount)
+            << "callback should not be invoked";
+}
+
+TEST_F(LooperTest, PollOnce_WhenCallbackRemovesItsFd_CallbackShouldNotBeInvokedAgainLater) {
+    Pipe pipe;
+    RemovingCallbackHandler handler(mLooper);
+    handler.setCallback(mLooper, pipe.receiveFd, ALOOPER_EVENT_INPUT);
+
+    pipe.writeSignal();
+    int result = mLooper->pollOnce(0);
+
+    EXPECT_EQ(ALOOPER_POLL_CALLBACK, result)
+            << "pollOnce result should be ALOOPER_POLL_CALLBACK because FD was signalled";
+    EXPECT_EQ(1, handler.callbackCount)
+            << "callback should be invoked";
+
+    // The signal is still unread, a watched FD would fire again
+    result = mLooper->pollOnce(100);
+
+    ASSERT_EQ(OK, pipe.readSignal())
+            << "signal should actually have been written";
+    EXPECT_EQ(ALOOPER_POLL_TIMEOUT, result)
+            << "pollOnce result should be ALOOPER_POLL_TIMEOUT";
+    EXPECT_EQ(1, handler.callbackCount)
+            << "callback should not be invoked after it removed its FD";
+    EXPECT_EQ(0, mLooper->removeFd(pipe.receiveFd))
+            << "FD should no longer be registered";
+}
+
 TEST_F(LooperTest, SendMessage_WhenOneMessageIsEnqueue_ShouldInvokeHandlerDuringNextPoll) {
-    sp<StubMessageHandler> handler = new StubMessageHandler();
+    mindroid::sp<StubMessageHandler> handler = new StubMessageHandler();
     mLooper->sendMessage(handler, Message(MSG_TEST1));
 
     StopWatch stopWatch("pollOnce");
@@ -456,8 +582,8 @@ TEST_F(LooperTest, SendMessage_WhenOneMessageIsEnqueue_ShouldInvokeHandlerDuring
 }
 
 TEST_F(LooperTest, SendMessage_WhenMultipleMessagesAreEnqueued_ShouldInvokeHandlersInOrderDuringNextPoll) {
-    sp<StubMessageHandler> handler1 = new StubMessageHandler();
-    sp<StubMessageHandler> handler2 = new StubMessageHandler();
+    mindroid::sp<StubMessageHandler> handler1 = new StubMessageHandler();
+    mindroid::sp<StubMessageHandler> handler2 = new StubMessageHandler();
     mLooper->sendMessage(handler1, Message(MSG_TEST1));
     mLooper->sendMessage(handler2, Message(MSG_TEST2));
     mLooper->sendMessage(handler1, Message(MSG_TEST3));
@@ -486,7 +612,7 @@ TEST_F(LooperTest, SendMessage_WhenMultipleMessagesAreEnqueued_ShouldInvokeHandl
 }
 
 TEST_F(LooperTest, SendMessageDelayed_WhenSentToTheFuture_ShouldInvokeHandlerAfterDelayTime) {
-    sp<StubMessageHandler> handler = new StubMessageHandler();
+    mindroid::sp<StubMessageHandler> handler = new StubMessageHandler();
     mLooper->sendMessageDelayed(ms2ns(100), handler, Message(MSG_TEST1));
 
     StopWatch stopWatch("pollOnce");
@@ -522,7 +648,7 @@ TEST_F(LooperTest, SendMessageDelayed_WhenSentToTheFuture_ShouldInvokeHandlerAft
 }
 
 TEST_F(LooperTest, SendMessageDelayed_WhenSentToThePast_ShouldInvokeHandlerDuringNextPoll) {
-    sp<StubMessageHandler> handler = new StubMessageHandler();
+    mindroid::sp<StubMessageHandler> handler = new StubMessageHandler();
     mLooper->sendMessageDelayed(ms2ns(-1000), handler, Message(MSG_TEST1));
 
     StopWatch stopWatch("pollOnce");
@@ -540,7 +666,7 @@ TEST_F(LooperTest, SendMessageDelayed_WhenSentToThePast_ShouldInvokeHandlerDurin
 }
 
 TEST_F(LooperTest, SendMessageDelayed_WhenSentToThePresent_ShouldInvokeHandlerDuringNextPoll) {
-    sp<StubMessageHandler> handler = new StubMessageHandler();
+    mindroid::sp<StubMessageHandler> handler = new StubMessageHandler();
     mLooper->sendMessageDelayed(0, handler, Message(MSG_TEST1));
 
     StopWatch stopWatch("pollOnce");
@@ -559,7 +685,7 @@ TEST_F(LooperTest, SendMessageDelayed_WhenSentToThePresent_ShouldInvokeHandlerDu
 
 TEST_F(LooperTest, SendMessageAtTime_WhenSentToTheFuture_ShouldInvokeHandlerAfterDelayTime) {
     nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
-    sp<StubMessageHandler> handler = new StubMessageHandler();
+    mindroid::sp<StubMessageHandler> handler = new StubMessageHandler();
     mLooper->sendMessageAtTime(now + ms2ns(100), handler, Message(MSG_TEST1));
 
     StopWatch stopWatch("pollOnce");
@@ -596,7 +722,7 @@ TEST_F(LooperTest, SendMessageAtTime_WhenSentToTheFuture_ShouldInvokeHandlerAfte
 
 TEST_F(LooperTest, SendMessageAtTime_WhenSentToThePast_ShouldInvokeHandlerDuringNextPoll) {
     nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
-    sp<StubMessageHandler> handler = new StubMessageHandler();
+    mindroid::sp<StubMessageHandler> handler = new StubMessageHandler();
     mLooper->sendMessageAtTime(now - ms2ns(1000), handler, Message(MSG_TEST1));
 
     StopWatch stopWatch("pollOnce");
@@ -615,7 +741,7 @@ TEST_F(LooperTest, SendMessageAtTime_WhenSentToThePast_ShouldInvokeHandlerDuring
 
 TEST_F(LooperTest, SendMessageAtTime_WhenSentToThePresent_ShouldInvokeHandlerDuringNextPoll) {
     nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
-    sp<StubMessageHandler> handler = new StubMessageHandler();
+    mindroid::sp<StubMessageHandler> handler = new StubMessageHandler();
     mLooper->sendMessageAtTime(now, handler, Message(MSG_TEST1));
 
     StopWatch stopWatch("pollOnce");
@@ -633,7 +759,7 @@ TEST_F(LooperTest, SendMessageAtTime_WhenSentToThePresent_ShouldInvokeHandlerDur
 }
 
 TEST_F(LooperTest, RemoveMessage_WhenRemovingAllMessagesForHandler_ShouldRemoveThoseMessage) {
-    sp<StubMessageHandler> handler = new StubMessageHandler();
+    mindroid::sp<StubMessageHandler> handler = new StubMessageHandler();
     mLooper->sendMessage(handler, Message(MSG_TEST1));
     mLooper->sendMessage(handler, Message(MSG_TEST2));
     mLooper->sendMessage(handler, Message(MSG_TEST3));
@@ -659,7 +785,7 @@ TEST_F(LooperTest, RemoveMessage_WhenRemovingAllMessagesForHandler_ShouldRemoveT
 }
 
 TEST_F(LooperTest, RemoveMessage_WhenRemovingSomeMessagesForHandler_ShouldRemoveThoseMessage) {
-    sp<StubMessageHandler> handler = new StubMessageHandler();
+    mindroid::sp<StubMessageHandler> handler = new StubMessageHandler();
     mLooper->sendMessage(handler, Message(MSG_TEST1));
     mLooper->sendMessage(handler, Message(MSG_TEST2));
     mLooper->sendMessage(handler, Message(MSG_TEST3));
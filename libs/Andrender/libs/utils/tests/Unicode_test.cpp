@@ -20,6 +20,11 @@
 
 #include <gtest/gtest.h>
 
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+
 namespace android {
 
 class UnicodeTest : public testing::Test {
@@ -112,4 +117,171 @@ TEST_F(UnicodeTest, UTF8toUTF16Normal) {
             << "should be NULL terminated";
 }
 
+TEST_F(UnicodeTest, UTF8toUTF16InvalidLength) {
+    // C0 80, overlong U+0000
+    const uint8_t overlong[] = { 0xC0, 0x80 };
+    EXPECT_EQ(-1, utf8_to_utf16_length(overlong, sizeof(overlong)))
+            << "Overlong UTF-8 should return -1 to indicate invalid";
+
+    // U+D800
+    const uint8_t surrogate[] = { 0x30, 0xED, 0xA0, 0x80 };
+    EXPECT_EQ(-1, utf8_to_utf16_length(surrogate, sizeof(surrogate)))
+            << "Surrogates encoded in UTF-8 should return -1 to indicate invalid";
+
+    const uint8_t continuation[] = { 0x30, 0x80, 0x30 };
+    EXPECT_EQ(-1, utf8_to_utf16_length(continuation, sizeof(continuation)))
+            << "A continuation byte without a lead byte should return -1 to indicate invalid";
+
+    // U+110000
+    const uint8_t beyond[] = { 0xF4, 0x90, 0x80, 0x80 };
+    EXPECT_EQ(-1, utf8_to_utf16_length(beyond, sizeof(beyond)))
+            << "Code points beyond U+10FFFF should return -1 to indicate invalid";
+
+    // Truncated U+2323 SMILE after an ASCII run
+    uint8_t truncated[40];
+    memset(truncated, 0x30, sizeof(truncated));
+    truncated[38] = 0xE2;
+    truncated[39] = 0x8C;
+    EXPECT_EQ(-1, utf8_to_utf16_length(truncated, sizeof(truncated)))
+            << "Truncated UTF-8 after ASCII should return -1 to indicate invalid";
+}
+
+TEST_F(UnicodeTest, UTF8toUTF16ASCIIRuns) {
+    // U+0100 at every position of an ASCII string longer than a vector
+    for (size_t pos = 0; pos < 40; pos++) {
+        uint8_t str[41];
+        char16_t output[41];
+
+        for (size_t i = 0; i < sizeof(str); i++) {
+            str[i] = 'a' + (i % 26);
+        }
+        str[pos] = 0xC4;
+        str[pos + 1] = 0x80;
+
+        ASSERT_EQ(40, utf8_to_utf16_length(str, sizeof(str)))
+                << "U+0100 at " << pos << " should have a length of 1 char16_t";
+
+        utf8_to_utf16(str, sizeof(str), output);
+
+        for (size_t i = 0; i < 40; i++) {
+            const char16_t expected = i < pos ? str[i] : (i == pos ? 0x0100 : str[i + 1]);
+            EXPECT_EQ(expected, output[i])
+                    << "char16_t " << i << " with U+0100 at " << pos;
+        }
+        EXPECT_EQ(0, output[40])
+                << "should be NULL terminated";
+    }
+}
+
+TEST_F(UnicodeTest, UTF16toUTF8Normal) {
+    const char16_t str[] = {
+        0x0030, // U+0030, 1 UTF-8 byte
+        0x0100, // U+0100, 2 UTF-8 bytes
+        0x2323, // U+2323, 3 UTF-8 bytes
+        0xD800, 0xDC00, // U+10000, 4 UTF-8 bytes
+        0xDC00, // unpaired, dropped
+        0x0031,
+    };
+
+    const uint8_t expected[] = {
+        0x30, 0xC4, 0x80, 0xE2, 0x8C, 0xA3, 0xF0, 0x90, 0x80, 0x80, 0x31, 0x00
+    };
+
+    const size_t len = sizeof(str) / sizeof(str[0]);
+    ASSERT_EQ((ssize_t) sizeof(expected) - 1, utf16_to_utf8_length(str, len))
+            << "Unpaired surrogates should not be measured";
+
+    char output[sizeof(expected)];
+    utf16_to_utf8(str, len, output);
+
+    EXPECT_EQ(0, memcmp(expected, output, sizeof(expected)))
+            << "should be U+0030 U+0100 U+2323 U+10000 U+0031";
+}
+
+TEST_F(UnicodeTest, UTF16toUTF8ASCIIRuns) {
+    // U+2323 at every position of an ASCII string longer than a vector
+    for (size_t pos = 0; pos < 40; pos++) {
+        char16_t str[40];
+        char output[43];
+
+        for (size_t i = 0; i < 40; i++) {
+            str[i] = 'a' + (i % 26);
+        }
+        str[pos] = 0x2323;
+
+        ASSERT_EQ(42, utf16_to_utf8_length(str, 40))
+                << "U+2323 at " << pos << " should have a length of 3 bytes";
+
+        utf16_to_utf8(str, 40, output);
+
+        EXPECT_EQ((char) 0xE2, output[pos]);
+        EXPECT_EQ((char) 0x8C, output[pos + 1]);
+        EXPECT_EQ((char) 0xA3, output[pos + 2]);
+        for (size_t i = 0; i < 40; i++) {
+            if (i != pos) {
+                EXPECT_EQ((char) str[i], output[i < pos ? i : i + 2])
+                        << "byte for " << i << " with U+2323 at " << pos;
+            }
+        }
+        EXPECT_EQ(0, output[42])
+                << "should be NULL terminated";
+    }
+}
+
+static double now() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Round trips "sample" repeated to 1MB and prints the throughput of each way
+static void measureThroughput(const char* name, const uint8_t* sample, size_t sampleLen) {
+    std::vector<uint8_t> u8;
+    while (u8.size() < 1024 * 1024) {
+        u8.insert(u8.end(), sample, sample + sampleLen);
+    }
+
+    const ssize_t u16len = utf8_to_utf16_length(&u8[0], u8.size());
+    ASSERT_LT(0, u16len);
+
+    std::vector<char16_t> u16(u16len + 1);
+    std::vector<char> back(u8.size() + 1);
+    const int iterations = 20;
+
+    double start = now();
+    for (int i = 0; i < iterations; i++) {
+        utf8_to_utf16_length(&u8[0], u8.size());
+        utf8_to_utf16(&u8[0], u8.size(), &u16[0]);
+    }
+    const double toUtf16 = now() - start;
+
+    start = now();
+    for (int i = 0; i < iterations; i++) {
+        utf16_to_utf8_length(&u16[0], u16len);
+        utf16_to_utf8(&u16[0], u16len, &back[0]);
+    }
+    const double toUtf8 = now() - start;
+
+    EXPECT_EQ(0, memcmp(&u8[0], &back[0], u8.size()))
+            << name << " should round trip";
+
+    const double megabytes = iterations * u8.size() / (1024.0 * 1024.0);
+    printf("%s: UTF-8 to UTF-16 %.0f MB/s, UTF-16 to UTF-8 %.0f MB/s\n",
+            name, megabytes / toUtf16, megabytes / toUtf8);
+}
+
+TEST_F(UnicodeTest, ThroughputASCII) {
+    const char sample[] = "The quick brown fox jumps over the lazy dog. Caf\xC3\xA9 au lait.\n";
+    measureThroughput("ASCII", (const uint8_t*) sample, sizeof(sample) - 1);
+}
+
+TEST_F(UnicodeTest, ThroughputCJK) {
+    // Japanese text, a space and U+1F600
+    const char sample[] = "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE"
+            "\xE3\x83\x86\xE3\x82\xAD\xE3\x82\xB9\xE3\x83\x88"
+            "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E\xE3\x81\xAE "
+            "\xF0\x9F\x98\x80";
+    measureThroughput("CJK", (const uint8_t*) sample, sizeof(sample) - 1);
+}
+
 }
@@ -66,6 +66,7 @@ THE SOFTWARE.
 #include "CCConfiguration.h"
 
 #include <mindroid/os/Looper.h>
+#include <mindroid/os/Clock.h>
 
 /**
  Position of the FPS
@@ -1049,7 +1050,10 @@ void CCDisplayLinkDirector::startAnimation(void)
 
 void CCDisplayLinkDirector::mainLoop(void)
 {
-    mindroid::Looper::loop();
+    uint64_t frameStartTime = mindroid::Clock::monotonicTime();
+
+    // dispatch the messages that are due without waiting, the display link paces the loop
+    mindroid::Looper::pollOnce(0);
     
     if (m_bPurgeDirecotorInNextLoop)
     {
@@ -1062,6 +1066,9 @@ void CCDisplayLinkDirector::mainLoop(void)
 
          // release the objects
          CCPoolManager::sharedPoolManager()->pop();
+
+         // hand the rest of the frame budget to idle work (e.g. list row prefetching)
+         mindroid::Looper::idle(frameStartTime + (uint64_t) (m_dAnimationInterval * 1000000000.0));
      }
 }
 
@@ -16,12 +16,14 @@ LOCAL_SRC_FILES := \
 	mindroid/os/Handler.cpp \
 	mindroid/os/Clock.cpp \
 	mindroid/os/AsyncTask.cpp \
+	mindroid/os/Future.cpp \
 	mindroid/os/SerialExecutor.cpp \
 	mindroid/os/ThreadPoolExecutor.cpp \
 	mindroid/os/AtomicInteger.cpp.arm \
 	mindroid/os/Ref.cpp \
 	mindroid/os/Bundle.cpp \
 	mindroid/util/Buffer.cpp \
+	mindroid/util/AsyncLogger.cpp \
 	mindroid/util/Log.cpp \
 	mindroid/util/Logger.cpp \
 	mindroid/lang/StringM.cpp \
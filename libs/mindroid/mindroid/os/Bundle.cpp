@@ -14,448 +14,868 @@
  * limitations under the License.
  */
 
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <pthread.h>
 #include <mindroid/os/Bundle.h>
+#include <mindroid/os/Lock.h>
+#include <mindroid/util/Buffer.h>
 
 namespace mindroid {
 
-Bundle::Bundle() {
-	mKeyValuePairs = new List<KeyValuePair>();
+namespace {
+
+/*
+ * Interned keys live as long as the process. Bundle keys are (almost always)
+ * string literals out of a small fixed set, so the pool stays small and
+ * nearly every lookup finds its key. Lookups therefore only take the read
+ * lock, and the write lock is taken to add a key.
+ */
+struct KeyPool
+{
+	KeyPool() :
+			mKeys(NULL),
+			mHashes(NULL),
+			mCapacity(0),
+			mSize(0) {
+		pthread_rwlock_init(&mLock, NULL);
+	}
+
+	// Must be called with mLock held.
+	const char* find(const char* key, uint32_t hash) const {
+		if (mSize == 0) {
+			return NULL;
+		}
+		const uint32_t mask = mCapacity - 1;
+		uint32_t i = hash & mask;
+		while (mKeys[i] != NULL) {
+			if (mHashes[i] == hash && strcmp(mKeys[i], key) == 0) {
+				return mKeys[i];
+			}
+			i = (i + 1) & mask;
+		}
+		return NULL;
+	}
+
+	// Must be called with mLock held for writing.
+	const char* add(const char* key, uint32_t hash) {
+		if ((mSize + 1) * 4 > mCapacity * 3) {
+			uint32_t capacity = (mCapacity > 0) ? mCapacity * 2 : 64;
+			const char** keys = (const char**) calloc(capacity, sizeof(const char*));
+			uint32_t* hashes = (uint32_t*) calloc(capacity, sizeof(uint32_t));
+			assert(keys != NULL && hashes != NULL);
+			for (uint32_t i = 0; i < mCapacity; i++) {
+				if (mKeys[i] != NULL) {
+					uint32_t j = mHashes[i] & (capacity - 1);
+					while (keys[j] != NULL) {
+						j = (j + 1) & (capacity - 1);
+					}
+					keys[j] = mKeys[i];
+					hashes[j] = mHashes[i];
+				}
+			}
+			free(mKeys);
+			free(mHashes);
+			mKeys = keys;
+			mHashes = hashes;
+			mCapacity = capacity;
+		}
+
+		const uint32_t mask = mCapacity - 1;
+		uint32_t i = hash & mask;
+		while (mKeys[i] != NULL) {
+			i = (i + 1) & mask;
+		}
+		char* internedKey = strdup(key);
+		assert(internedKey != NULL);
+		mKeys[i] = internedKey;
+		mHashes[i] = hash;
+		mSize++;
+		return internedKey;
+	}
+
+	const char** mKeys;
+	uint32_t* mHashes;
+	uint32_t mCapacity;
+	uint32_t mSize;
+	pthread_rwlock_t mLock;
+};
+
+struct EntryPool
+{
+	static const uint32_t MAX_SIZE = 16;
+
+	EntryPool() :
+			mSize(0) {
+	}
+
+	void* mEntries[MAX_SIZE];
+	uint32_t mSize;
+	Lock mLock;
+};
+
+// The pools are never destroyed so that bundles released during static destruction stay safe.
+KeyPool& keyPool() {
+	static KeyPool* sKeyPool = new KeyPool();
+	return *sKeyPool;
 }
 
-Bundle::~Bundle() {
-	clear();
+EntryPool& entryPool() {
+	static EntryPool* sEntryPool = new EntryPool();
+	return *sEntryPool;
 }
 
-void Bundle::clear() {
-	mKeyValuePairs.clear();
+const uint32_t MAGIC = 0x444E424D; // "MBND"
+const uint8_t VERSION = 1;
+
+size_t varintSize(uint64_t value) {
+	size_t size = 1;
+	while (value >= 0x80) {
+		value >>= 7;
+		size++;
+	}
+	return size;
 }
 
-bool Bundle::containsKey(const char* key) {
-	List<KeyValuePair>::iterator itr = mKeyValuePairs->begin();
-	while (itr != mKeyValuePairs->end()) {
-		if (itr->key->equals(key)) {
+uint8_t* writeVarint(uint8_t* data, uint64_t value) {
+	while (value >= 0x80) {
+		*data++ = (uint8_t) (value | 0x80);
+		value >>= 7;
+	}
+	*data++ = (uint8_t) value;
+	return data;
+}
+
+bool readVarint(const uint8_t*& data, const uint8_t* end, uint64_t& value) {
+	value = 0;
+	for (uint32_t shift = 0; shift < 64; shift += 7) {
+		if (data >= end) {
+			return false;
+		}
+		uint8_t byte = *data++;
+		value |= (uint64_t) (byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0) {
 			return true;
 		}
-		++itr;
 	}
 	return false;
 }
 
+inline uint64_t zigZagEncode(int64_t value) {
+	return ((uint64_t) value << 1) ^ (uint64_t) (value >> 63);
+}
+
+inline int64_t zigZagDecode(uint64_t value) {
+	return (int64_t) (value >> 1) ^ -(int64_t) (value & 1);
+}
+
+uint8_t* writeFixed(uint8_t* data, uint64_t value, size_t size) {
+	for (size_t i = 0; i < size; i++) {
+		*data++ = (uint8_t) (value >> (i * 8));
+	}
+	return data;
+}
+
+bool readFixed(const uint8_t*& data, const uint8_t* end, uint64_t& value, size_t size) {
+	if ((size_t) (end - data) < size) {
+		return false;
+	}
+	value = 0;
+	for (size_t i = 0; i < size; i++) {
+		value |= (uint64_t) *data++ << (i * 8);
+	}
+	return true;
+}
+
+} /* anonymous namespace */
+
+Bundle::Bundle() :
+		mEntries(NULL),
+		mCapacity(0),
+		mSize(0) {
+}
+
+Bundle::~Bundle() {
+	clear();
+	if (mEntries != NULL) {
+		recycleEntries(mEntries, mCapacity);
+		mEntries = NULL;
+	}
+}
+
+void Bundle::clear() {
+	if (mSize == 0) {
+		return;
+	}
+	for (uint32_t i = 0; i < mCapacity; i++) {
+		if (mEntries[i].key != NULL) {
+			releaseValue(mEntries[i]);
+			mEntries[i].key = NULL;
+		}
+	}
+	mSize = 0;
+}
+
+bool Bundle::containsKey(const char* key) {
+	return indexOf(key) >= 0;
+}
+
 void Bundle::remove(const char* key) {
-	List<KeyValuePair>::iterator itr = mKeyValuePairs->begin();
-	while (itr != mKeyValuePairs->end()) {
-		if (itr->key->equals(key)) {
-			itr = mKeyValuePairs->erase(itr);
+	ssize_t index = indexOf(key);
+	if (index < 0) {
+		return;
+	}
+
+	releaseValue(mEntries[index]);
+	// Backward shift deletion keeps the probe sequences intact without tombstones.
+	const uint32_t mask = mCapacity - 1;
+	uint32_t i = (uint32_t) index;
+	uint32_t j = i;
+	while (true) {
+		j = (j + 1) & mask;
+		if (mEntries[j].key == NULL) {
 			break;
 		}
-		++itr;
+		uint32_t k = mEntries[j].hash & mask;
+		if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j)) {
+			continue;
+		}
+		mEntries[i] = mEntries[j];
+		i = j;
 	}
+	mEntries[i].key = NULL;
+	mSize--;
 }
 
 void Bundle::putBool(const char* key, bool value) {
-	KeyValuePair keyValuePair;
-	keyValuePair.key = new String(key);
-	keyValuePair.value = new Variant(value);
-	mKeyValuePairs->push_back(keyValuePair);
+	putEntry(key, Bool)->value.boolValue = value;
 }
 
 void Bundle::putByte(const char* key, uint8_t value) {
-	KeyValuePair keyValuePair;
-	keyValuePair.key = new String(key);
-	keyValuePair.value = new Variant(value);
-	mKeyValuePairs->push_back(keyValuePair);
+	putEntry(key, Byte)->value.byteValue = value;
 }
 
 void Bundle::putChar(const char* key, char value) {
-	KeyValuePair keyValuePair;
-	keyValuePair.key = new String(key);
-	keyValuePair.value = new Variant(value);
-	mKeyValuePairs->push_back(keyValuePair);
+	putEntry(key, Char)->value.charValue = value;
 }
 
 void Bundle::putInt16(const char* key, int16_t value) {
-	KeyValuePair keyValuePair;
-	keyValuePair.key = new String(key);
-	keyValuePair.value = new Variant(value);
-	mKeyValuePairs->push_back(keyValuePair);
+	putEntry(key, Int16)->value.int16Value = value;
 }
 
 void Bundle::putUInt16(const char* key, uint16_t value) {
-	KeyValuePair keyValuePair;
-	keyValuePair.key = new String(key);
-	keyValuePair.value = new Variant(value);
-	mKeyValuePairs->push_back(keyValuePair);
+	putEntry(key, UInt16)->value.uint16Value = value;
 }
 
 void Bundle::putInt32(const char* key, int32_t value) {
-	KeyValuePair keyValuePair;
-	keyValuePair.key = new String(key);
-	keyValuePair.value = new Variant(value);
-	mKeyValuePairs->push_back(keyValuePair);
+	putEntry(key, Int32)->value.int32Value = value;
 }
 
 void Bundle::putUInt32(const char* key, uint32_t value) {
-	KeyValuePair keyValuePair;
-	keyValuePair.key = new String(key);
-	keyValuePair.value = new Variant(value);
-	mKeyValuePairs->push_back(keyValuePair);
+	putEntry(key, UInt32)->value.uint32Value = value;
 }
 
 void Bundle::putInt64(const char* key, int64_t value) {
-	KeyValuePair keyValuePair;
-	keyValuePair.key = new String(key);
-	keyValuePair.value = new Variant(value);
-	mKeyValuePairs->push_back(keyValuePair);
+	putEntry(key, Int64)->value.int64Value = value;
 }
 
 void Bundle::putUInt64(const char* key, uint64_t value) {
-	KeyValuePair keyValuePair;
-	keyValuePair.key = new String(key);
-	keyValuePair.value = new Variant(value);
-	mKeyValuePairs->push_back(keyValuePair);
+	putEntry(key, UInt64)->value.uint64Value = value;
 }
 
 void Bundle::putFloat(const char* key, float value) {
-	KeyValuePair keyValuePair;
-	keyValuePair.key = new String(key);
-	keyValuePair.value = new Variant(value);
-	mKeyValuePairs->push_back(keyValuePair);
+	putEntry(key, Float)->value.floatValue = value;
 }
 
 void Bundle::putDouble(const char* key, double value) {
-	KeyValuePair keyValuePair;
-	keyValuePair.key = new String(key);
-	keyValuePair.value = new Variant(value);
-	mKeyValuePairs->push_back(keyValuePair);
+	putEntry(key, Double)->value.doubleValue = value;
 }
 
 void Bundle::putString(const char* key, const char* string) {
-	KeyValuePair keyValuePair;
-	keyValuePair.key = new String(key);
-	keyValuePair.value = new Variant(string);
-	mKeyValuePairs->push_back(keyValuePair);
+	if (string != NULL && *string != '\0') {
+		sp<String> object = new String(string);
+		putRef(key, CharString, object.getPointer());
+	} else {
+		putRef(key, CharString, String::EMPTY_STRING.getPointer());
+	}
 }
 
 void Bundle::putString(const char* key, const sp<String>& string) {
-	putString(key, (string != NULL) ? string->c_str() : NULL);
+	// Strings are immutable, so the object can be shared instead of copied.
+	putRef(key, CharString, (string != NULL) ? string.getPointer() : String::EMPTY_STRING.getPointer());
 }
 
 void Bundle::putObject(const char* key, const sp<Ref>& object) {
-	KeyValuePair keyValuePair;
-	keyValuePair.key = new String(key);
-	keyValuePair.value = new Variant(object);
-	mKeyValuePairs->push_back(keyValuePair);
+	putRef(key, Object, object.getPointer());
 }
 
 bool Bundle::getBool(const char* key, const bool defaultValue) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Bool) {
-			return itr->value->getBool();
-		} else {
-			return defaultValue;
-		}
-	}
-	return defaultValue;
+	const Entry* entry = findEntry(key, Bool);
+	return (entry != NULL) ? entry->value.boolValue : defaultValue;
 }
 
 uint8_t Bundle::getByte(const char* key, const uint8_t defaultValue) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Byte) {
-			return itr->value->getByte();
-		} else {
-			return defaultValue;
-		}
-	}
-	return defaultValue;
+	const Entry* entry = findEntry(key, Byte);
+	return (entry != NULL) ? entry->value.byteValue : defaultValue;
 }
 
 char Bundle::getChar(const char* key, const char defaultValue) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Char) {
-			return itr->value->getChar();
-		} else {
-			return defaultValue;
-		}
-	}
-	return defaultValue;
+	const Entry* entry = findEntry(key, Char);
+	return (entry != NULL) ? entry->value.charValue : defaultValue;
 }
 
 int16_t Bundle::getInt16(const char* key, const int16_t defaultValue) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Int16) {
-			return itr->value->getInt16();
-		} else {
-			return defaultValue;
-		}
-	}
-	return defaultValue;
+	const Entry* entry = findEntry(key, Int16);
+	return (entry != NULL) ? entry->value.int16Value : defaultValue;
 }
 
 uint16_t Bundle::getUInt16(const char* key, const uint16_t defaultValue) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::UInt16) {
-			return itr->value->getUInt16();
-		} else {
-			return defaultValue;
-		}
-	}
-	return defaultValue;
+	const Entry* entry = findEntry(key, UInt16);
+	return (entry != NULL) ? entry->value.uint16Value : defaultValue;
 }
 
 int32_t Bundle::getInt32(const char* key, const int32_t defaultValue) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Int32) {
-			return itr->value->getInt32();
-		} else {
-			return defaultValue;
-		}
-	}
-	return defaultValue;
+	const Entry* entry = findEntry(key, Int32);
+	return (entry != NULL) ? entry->value.int32Value : defaultValue;
 }
 
 uint32_t Bundle::getUInt32(const char* key, const uint32_t defaultValue) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::UInt32) {
-			return itr->value->getUInt32();
-		} else {
-			return defaultValue;
-		}
-	}
-	return defaultValue;
+	const Entry* entry = findEntry(key, UInt32);
+	return (entry != NULL) ? entry->value.uint32Value : defaultValue;
 }
 
 int64_t Bundle::getInt64(const char* key, const int64_t defaultValue) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Int64) {
-			return itr->value->getInt64();
-		} else {
-			return defaultValue;
-		}
-	}
-	return defaultValue;
+	const Entry* entry = findEntry(key, Int64);
+	return (entry != NULL) ? entry->value.int64Value : defaultValue;
 }
 
 uint64_t Bundle::getUInt64(const char* key, const uint64_t defaultValue) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::UInt64) {
-			return itr->value->getUInt64();
-		} else {
-			return defaultValue;
-		}
-	}
-	return defaultValue;
+	const Entry* entry = findEntry(key, UInt64);
+	return (entry != NULL) ? entry->value.uint64Value : defaultValue;
 }
 
 float Bundle::getFloat(const char* key, const float defaultValue) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Float) {
-			return itr->value->getFloat();
-		} else {
-			return defaultValue;
-		}
-	}
-	return defaultValue;
+	const Entry* entry = findEntry(key, Float);
+	return (entry != NULL) ? entry->value.floatValue : defaultValue;
 }
 
 double Bundle::getDouble(const char* key, const double defaultValue) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Double) {
-			return itr->value->getDouble();
-		} else {
-			return defaultValue;
-		}
-	}
-	return defaultValue;
+	const Entry* entry = findEntry(key, Double);
+	return (entry != NULL) ? entry->value.doubleValue : defaultValue;
 }
 
 sp<String> Bundle::getString(const char* key) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::CharString) {
-			return itr->value->getString();
-		} else {
-			return String::EMPTY_STRING;
-		}
-	}
-	return String::EMPTY_STRING;
+	const Entry* entry = findEntry(key, CharString);
+	return (entry != NULL) ? static_cast<String*>(entry->value.object) : String::EMPTY_STRING;
 }
 
 bool Bundle::fillBool(const char* key, bool& value) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Bool) {
-			value = itr->value->getBool();
-			return true;
-		} else {
-			return false;
-		}
+	const Entry* entry = findEntry(key, Bool);
+	if (entry != NULL) {
+		value = entry->value.boolValue;
+		return true;
 	}
 	return false;
 }
 
 bool Bundle::fillByte(const char* key, uint8_t& value) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Byte) {
-			value = itr->value->getByte();
-			return true;
-		} else {
-			return false;
-		}
+	const Entry* entry = findEntry(key, Byte);
+	if (entry != NULL) {
+		value = entry->value.byteValue;
+		return true;
 	}
 	return false;
 }
 
 bool Bundle::fillChar(const char* key, char& value) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Char) {
-			value = itr->value->getChar();
-			return true;
-		} else {
-			return false;
-		}
+	const Entry* entry = findEntry(key, Char);
+	if (entry != NULL) {
+		value = entry->value.charValue;
+		return true;
 	}
 	return false;
 }
 
 bool Bundle::fillInt16(const char* key, int16_t& value) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Int16) {
-			value = itr->value->getInt16();
-			return true;
-		} else {
-			return false;
-		}
+	const Entry* entry = findEntry(key, Int16);
+	if (entry != NULL) {
+		value = entry->value.int16Value;
+		return true;
 	}
 	return false;
 }
 
 bool Bundle::fillUInt16(const char* key, uint16_t& value) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::UInt16) {
-			value = itr->value->getUInt16();
-			return true;
-		} else {
-			return false;
-		}
+	const Entry* entry = findEntry(key, UInt16);
+	if (entry != NULL) {
+		value = entry->value.uint16Value;
+		return true;
 	}
 	return false;
 }
 
 bool Bundle::fillInt32(const char* key, int32_t& value) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Int32) {
-			value = itr->value->getInt32();
-			return true;
-		} else {
-			return false;
-		}
+	const Entry* entry = findEntry(key, Int32);
+	if (entry != NULL) {
+		value = entry->value.int32Value;
+		return true;
 	}
 	return false;
 }
 
 bool Bundle::fillUInt32(const char* key, uint32_t& value) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::UInt32) {
-			value = itr->value->getUInt32();
-			return true;
-		} else {
-			return false;
-		}
+	const Entry* entry = findEntry(key, UInt32);
+	if (entry != NULL) {
+		value = entry->value.uint32Value;
+		return true;
 	}
 	return false;
 }
 
 bool Bundle::fillInt64(const char* key, int64_t& value) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Int64) {
-			value = itr->value->getInt64();
-			return true;
-		} else {
-			return false;
-		}
+	const Entry* entry = findEntry(key, Int64);
+	if (entry != NULL) {
+		value = entry->value.int64Value;
+		return true;
 	}
 	return false;
 }
 
 bool Bundle::fillUInt64(const char* key, uint64_t& value) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::UInt64) {
-			value = itr->value->getUInt64();
-			return true;
-		} else {
-			return false;
-		}
+	const Entry* entry = findEntry(key, UInt64);
+	if (entry != NULL) {
+		value = entry->value.uint64Value;
+		return true;
 	}
 	return false;
 }
 
 bool Bundle::fillFloat(const char* key, float& value) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Float) {
-			value = itr->value->getFloat();
-			return true;
-		} else {
-			return false;
-		}
+	const Entry* entry = findEntry(key, Float);
+	if (entry != NULL) {
+		value = entry->value.floatValue;
+		return true;
 	}
 	return false;
 }
 
 bool Bundle::fillDouble(const char* key, double& value) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Double) {
-			value = itr->value->getFloat();
-			return true;
-		} else {
-			return false;
-		}
+	const Entry* entry = findEntry(key, Double);
+	if (entry != NULL) {
+		value = entry->value.doubleValue;
+		return true;
 	}
 	return false;
 }
 
 bool Bundle::fillString(const char* key, sp<String>& string) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::CharString) {
-			string = itr->value->getString();
-			return true;
-		} else {
-			return false;
-		}
+	const Entry* entry = findEntry(key, CharString);
+	if (entry != NULL) {
+		string = static_cast<String*>(entry->value.object);
+		return true;
 	}
 	return false;
 }
 
-List<Bundle::KeyValuePair>::const_iterator Bundle::findValue(const char* key) const {
-	List<KeyValuePair>::const_iterator itr = mKeyValuePairs.getConstPointer()->begin();
-	while (itr != mKeyValuePairs->end()) {
-		if (itr->key->equals(key)) {
-			return itr;
+size_t Bundle::getSerializedSize() const {
+	size_t size = sizeof(MAGIC) + sizeof(VERSION);
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < mCapacity; i++) {
+		const Entry& entry = mEntries[i];
+		if (entry.key == NULL || entry.type == Object) {
+			continue;
+		}
+		size_t keySize = strlen(entry.key);
+		size += 1 + varintSize(keySize) + keySize + 1;
+		switch (entry.type) {
+		case Bool:
+		case Byte:
+		case Char:
+			size += 1;
+			break;
+		case Int16:
+			size += varintSize(zigZagEncode(entry.value.int16Value));
+			break;
+		case Int32:
+			size += varintSize(zigZagEncode(entry.value.int32Value));
+			break;
+		case Int64:
+			size += varintSize(zigZagEncode(entry.value.int64Value));
+			break;
+		case UInt16:
+			size += varintSize(entry.value.uint16Value);
+			break;
+		case UInt32:
+			size += varintSize(entry.value.uint32Value);
+			break;
+		case UInt64:
+			size += varintSize(entry.value.uint64Value);
+			break;
+		case Float:
+			size += sizeof(float);
+			break;
+		case Double:
+			size += sizeof(double);
+			break;
+		case CharString: {
+			size_t stringSize = static_cast<String*>(entry.value.object)->size();
+			size += varintSize(stringSize) + stringSize;
+			break;
+		}
+		default:
+			break;
+		}
+		count++;
+	}
+	return size + varintSize(count);
+}
+
+size_t Bundle::serialize(uint8_t* data, size_t size) const {
+	size_t serializedSize = getSerializedSize();
+	if (data == NULL || size < serializedSize) {
+		return 0;
+	}
+
+	uint32_t count = 0;
+	for (uint32_t i = 0; i < mCapacity; i++) {
+		if (mEntries[i].key != NULL && mEntries[i].type != Object) {
+			count++;
+		}
+	}
+
+	uint8_t* ptr = writeFixed(data, MAGIC, sizeof(MAGIC));
+	*ptr++ = VERSION;
+	ptr = writeVarint(ptr, count);
+	for (uint32_t i = 0; i < mCapacity; i++) {
+		const Entry& entry = mEntries[i];
+		if (entry.key == NULL || entry.type == Object) {
+			continue;
+		}
+		*ptr++ = entry.type;
+		size_t keySize = strlen(entry.key);
+		ptr = writeVarint(ptr, keySize);
+		memcpy(ptr, entry.key, keySize + 1);
+		ptr += keySize + 1;
+		switch (entry.type) {
+		case Bool:
+			*ptr++ = entry.value.boolValue ? 1 : 0;
+			break;
+		case Byte:
+			*ptr++ = entry.value.byteValue;
+			break;
+		case Char:
+			*ptr++ = (uint8_t) entry.value.charValue;
+			break;
+		case Int16:
+			ptr = writeVarint(ptr, zigZagEncode(entry.value.int16Value));
+			break;
+		case Int32:
+			ptr = writeVarint(ptr, zigZagEncode(entry.value.int32Value));
+			break;
+		case Int64:
+			ptr = writeVarint(ptr, zigZagEncode(entry.value.int64Value));
+			break;
+		case UInt16:
+			ptr = writeVarint(ptr, entry.value.uint16Value);
+			break;
+		case UInt32:
+			ptr = writeVarint(ptr, entry.value.uint32Value);
+			break;
+		case UInt64:
+			ptr = writeVarint(ptr, entry.value.uint64Value);
+			break;
+		case Float: {
+			uint32_t bits;
+			memcpy(&bits, &entry.value.floatValue, sizeof(bits));
+			ptr = writeFixed(ptr, bits, sizeof(bits));
+			break;
+		}
+		case Double: {
+			uint64_t bits;
+			memcpy(&bits, &entry.value.doubleValue, sizeof(bits));
+			ptr = writeFixed(ptr, bits, sizeof(bits));
+			break;
+		}
+		case CharString: {
+			const String* string = static_cast<String*>(entry.value.object);
+			ptr = writeVarint(ptr, string->size());
+			memcpy(ptr, string->c_str(), string->size());
+			ptr += string->size();
+			break;
+		}
+		default:
+			break;
+		}
+	}
+
+	assert((size_t) (ptr - data) == serializedSize);
+	return serializedSize;
+}
+
+sp<Buffer> Bundle::serialize() const {
+	size_t size = getSerializedSize();
+	sp<Buffer> buffer = new Buffer(size);
+	serialize(buffer->data(), size);
+	return buffer;
+}
+
+sp<Bundle> Bundle::deserialize(const uint8_t* data, size_t size) {
+	if (data == NULL) {
+		return NULL;
+	}
+
+	const uint8_t* ptr = data;
+	const uint8_t* end = data + size;
+	uint64_t value;
+	if (!readFixed(ptr, end, value, sizeof(MAGIC)) || value != MAGIC) {
+		return NULL;
+	}
+	if (ptr >= end || *ptr++ != VERSION) {
+		return NULL;
+	}
+	uint64_t count;
+	if (!readVarint(ptr, end, count)) {
+		return NULL;
+	}
+
+	sp<Bundle> bundle = new Bundle();
+	for (uint64_t i = 0; i < count; i++) {
+		if (ptr >= end) {
+			return NULL;
+		}
+		uint8_t type = *ptr++;
+		uint64_t keySize;
+		if (!readVarint(ptr, end, keySize) || keySize >= (uint64_t) (end - ptr) || ptr[keySize] != '\0') {
+			return NULL;
+		}
+		const char* key = (const char*) ptr;
+		ptr += keySize + 1;
+
+		switch (type) {
+		case Bool:
+		case Byte:
+		case Char:
+			if (ptr >= end) {
+				return NULL;
+			}
+			if (type == Bool) {
+				bundle->putBool(key, *ptr != 0);
+			} else if (type == Byte) {
+				bundle->putByte(key, *ptr);
+			} else {
+				bundle->putChar(key, (char) *ptr);
+			}
+			ptr++;
+			break;
+		case Int16:
+		case Int32:
+		case Int64:
+			if (!readVarint(ptr, end, value)) {
+				return NULL;
+			}
+			if (type == Int16) {
+				bundle->putInt16(key, (int16_t) zigZagDecode(value));
+			} else if (type == Int32) {
+				bundle->putInt32(key, (int32_t) zigZagDecode(value));
+			} else {
+				bundle->putInt64(key, zigZagDecode(value));
+			}
+			break;
+		case UInt16:
+		case UInt32:
+		case UInt64:
+			if (!readVarint(ptr, end, value)) {
+				return NULL;
+			}
+			if (type == UInt16) {
+				bundle->putUInt16(key, (uint16_t) value);
+			} else if (type == UInt32) {
+				bundle->putUInt32(key, (uint32_t) value);
+			} else {
+				bundle->putUInt64(key, value);
+			}
+			break;
+		case Float: {
+			if (!readFixed(ptr, end, value, sizeof(uint32_t))) {
+				return NULL;
+			}
+			uint32_t bits = (uint32_t) value;
+			float floatValue;
+			memcpy(&floatValue, &bits, sizeof(floatValue));
+			bundle->putFloat(key, floatValue);
+			break;
+		}
+		case Double: {
+			if (!readFixed(ptr, end, value, sizeof(uint64_t))) {
+				return NULL;
+			}
+			double doubleValue;
+			memcpy(&doubleValue, &value, sizeof(doubleValue));
+			bundle->putDouble(key, doubleValue);
+			break;
+		}
+		case CharString: {
+			uint64_t stringSize;
+			if (!readVarint(ptr, end, stringSize) || stringSize > (uint64_t) (end - ptr)) {
+				return NULL;
+			}
+			if (stringSize > 0) {
+				sp<String> string = new String((const char*) ptr, (size_t) stringSize);
+				bundle->putString(key, string);
+			} else {
+				bundle->putString(key, String::EMPTY_STRING);
+			}
+			ptr += stringSize;
+			break;
+		}
+		default:
+			return NULL;
+		}
+	}
+	return bundle;
+}
+
+ssize_t Bundle::indexOf(const char* key) const {
+	if (mSize == 0 || key == NULL) {
+		return -1;
+	}
+	const uint32_t h = hash(key);
+	const uint32_t mask = mCapacity - 1;
+	uint32_t i = h & mask;
+	while (mEntries[i].key != NULL) {
+		if (mEntries[i].hash == h && (mEntries[i].key == key || strcmp(mEntries[i].key, key) == 0)) {
+			return i;
+		}
+		i = (i + 1) & mask;
+	}
+	return -1;
+}
+
+const Bundle::Entry* Bundle::findEntry(const char* key, uint8_t type) const {
+	ssize_t index = indexOf(key);
+	if (index >= 0 && mEntries[index].type == type) {
+		return &mEntries[index];
+	}
+	return NULL;
+}
+
+Bundle::Entry* Bundle::putEntry(const char* key, uint8_t type) {
+	assert(key != NULL);
+	if (mEntries == NULL) {
+		mEntries = obtainEntries(MIN_CAPACITY);
+		mCapacity = MIN_CAPACITY;
+	} else if ((mSize + 1) * 4 > mCapacity * 3) {
+		resize(mCapacity * 2);
+	}
+
+	const uint32_t h = hash(key);
+	const uint32_t mask = mCapacity - 1;
+	uint32_t i = h & mask;
+	while (mEntries[i].key != NULL) {
+		if (mEntries[i].hash == h && (mEntries[i].key == key || strcmp(mEntries[i].key, key) == 0)) {
+			releaseValue(mEntries[i]);
+			mEntries[i].type = type;
+			return &mEntries[i];
+		}
+		i = (i + 1) & mask;
+	}
+	mEntries[i].key = intern(key, h);
+	mEntries[i].hash = h;
+	mEntries[i].type = type;
+	mSize++;
+	return &mEntries[i];
+}
+
+void Bundle::putRef(const char* key, uint8_t type, Ref* object) {
+	// Take the new reference first, the entry may currently hold the same object.
+	if (object != NULL) {
+		object->incStrongRef(this);
+	}
+	putEntry(key, type)->value.object = object;
+}
+
+void Bundle::releaseValue(Entry& entry) {
+	if ((entry.type == CharString || entry.type == Object) && entry.value.object != NULL) {
+		Ref* object = entry.value.object;
+		entry.value.object = NULL;
+		entry.type = Null;
+		object->decStrongRef(this);
+	}
+}
+
+void Bundle::resize(uint32_t capacity) {
+	Entry* entries = obtainEntries(capacity);
+	const uint32_t mask = capacity - 1;
+	for (uint32_t i = 0; i < mCapacity; i++) {
+		if (mEntries[i].key != NULL) {
+			uint32_t j = mEntries[i].hash & mask;
+			while (entries[j].key != NULL) {
+				j = (j + 1) & mask;
+			}
+			entries[j] = mEntries[i];
+		}
+	}
+	recycleEntries(mEntries, mCapacity);
+	mEntries = entries;
+	mCapacity = capacity;
+}
+
+uint32_t Bundle::hash(const char* key) {
+	// FNV-1a
+	uint32_t hash = 2166136261U;
+	while (*key != '\0') {
+		hash ^= (uint8_t) *key++;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+const char* Bundle::intern(const char* key, uint32_t hash) {
+	KeyPool& pool = keyPool();
+
+	pthread_rwlock_rdlock(&pool.mLock);
+	const char* internedKey = pool.find(key, hash);
+	pthread_rwlock_unlock(&pool.mLock);
+	if (internedKey != NULL) {
+		return internedKey;
+	}
+
+	pthread_rwlock_wrlock(&pool.mLock);
+	// Another thread may have added the key in the meantime.
+	internedKey = pool.find(key, hash);
+	if (internedKey == NULL) {
+		internedKey = pool.add(key, hash);
+	}
+	pthread_rwlock_unlock(&pool.mLock);
+	return internedKey;
+}
+
+Bundle::Entry* Bundle::obtainEntries(uint32_t capacity) {
+	if (capacity == MIN_CAPACITY) {
+		EntryPool& pool = entryPool();
+		AutoLock autoLock(pool.mLock);
+		if (pool.mSize > 0) {
+			return (Entry*) pool.mEntries[--pool.mSize];
+		}
+	}
+	Entry* entries = (Entry*) calloc(capacity, sizeof(Entry));
+	assert(entries != NULL);
+	return entries;
+}
+
+void Bundle::recycleEntries(Entry* entries, uint32_t capacity) {
+	if (capacity == MIN_CAPACITY) {
+		// Pooled arrays are handed out zeroed.
+		memset(entries, 0, capacity * sizeof(Entry));
+		EntryPool& pool = entryPool();
+		AutoLock autoLock(pool.mLock);
+		if (pool.mSize < EntryPool::MAX_SIZE) {
+			pool.mEntries[pool.mSize++] = entries;
+			return;
 		}
-		++itr;
 	}
-	return mKeyValuePairs.getConstPointer()->end();
+	free(entries);
 }
 
 } /* namespace mindroid */
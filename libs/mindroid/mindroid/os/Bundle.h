@@ -20,11 +20,20 @@
 #include <stdint.h>
 #include <mindroid/util/Utils.h>
 #include <mindroid/os/Ref.h>
-#include <mindroid/util/List.h>
 #include <mindroid/lang/StringM.h>
 
 namespace mindroid {
 
+class Buffer;
+
+/**
+ * Bundle keeps its values in a flat open-addressed hash table. Keys are
+ * interned into a process wide pool, so putting a value never allocates a key,
+ * and scalar values are stored inline in the table entry. The entry arrays of
+ * small bundles are recycled through a pool, which makes Message::metaData()
+ * allocation free in the common case. Putting a key that already exists
+ * replaces its value.
+ */
 class Bundle :
 		public Ref
 {
@@ -32,8 +41,8 @@ public:
 	Bundle();
 	virtual ~Bundle();
 
-	size_t size() const { return mKeyValuePairs->size(); }
-	bool empty() const { return mKeyValuePairs->empty(); }
+	size_t size() const { return mSize; }
+	bool empty() const { return mSize == 0; }
 	void clear();
 	bool containsKey(const char* key);
 	void remove(const char* key);
@@ -83,182 +92,49 @@ public:
 	template<typename T>
 	bool fillObject(const char* key, sp<T>& object) const;
 
-private:
-	class Variant :
-			public Ref
-	{
-	public:
-		enum Type {
-			Null,
-			Bool,
-			Byte,
-			Char,
-			Int16,
-			UInt16,
-			Int32,
-			UInt32,
-			Int64,
-			UInt64,
-			Float,
-			Double,
-			CharString,
-			Object
-		};
-
-		inline Variant() : mType(Null) { }
-
-		inline Variant(bool value) :
-				mType(Bool) {
-			mVariant.boolValue = value;
-		}
-
-		inline Variant(uint8_t value) :
-				mType(Byte) {
-			mVariant.byteValue = value;
-		}
-
-		inline Variant(char value) :
-				mType(Char) {
-			mVariant.charValue = value;
-		}
-
-		inline Variant(int16_t value) :
-				mType(Int16) {
-			mVariant.int16Value = value;
-		}
-
-		inline Variant(uint16_t value) :
-				mType(UInt16) {
-			mVariant.uint16Value = value;
-		}
-
-		inline Variant(int32_t value) :
-				mType(Int32) {
-			mVariant.int32Value = value;
-		}
-
-		inline Variant(uint32_t value) :
-				mType(UInt32) {
-			mVariant.uint32Value = value;
-		}
-
-		inline Variant(int64_t value) :
-				mType(Int64) {
-			mVariant.int64Value = value;
-		}
-
-		inline Variant(uint64_t value) :
-				mType(UInt64) {
-			mVariant.uint64Value = value;
-		}
-
-		inline Variant(float value) :
-				mType(Float) {
-			mVariant.floatValue = value;
-		}
-
-		inline Variant(double value) :
-				mType(Double) {
-			mVariant.doubleValue = value;
-		}
-
-		inline Variant(const char* string) :
-				mType(CharString) {
-			const sp<String> object = new String(string);
-			if (object != NULL) {
-				object->incStrongRef(this);
-			}
-			mVariant.object = object.getPointer();
-		}
-
-		inline Variant(const sp<String>& string) :
-				mType(CharString) {
-			if (string != NULL) {
-				string->incStrongRef(this);
-			}
-			mVariant.object = string.getPointer();
-		}
-
-		inline Variant(const sp<Ref>& object) :
-				mType(Object) {
-			if (object != NULL) {
-				object->incStrongRef(this);
-			}
-			mVariant.object = object.getPointer();
-		}
-
-		inline ~Variant() {
-			switch (mType) {
-			case Variant::Object:
-			case Variant::CharString:
-				if (mVariant.object != NULL) {
-					mVariant.object->decStrongRef(this);
-				}
-				break;
-			default:
-				break;
-			}
-		}
+	/**
+	 * Returns the number of bytes serialize() writes. Object values cannot be
+	 * persisted and are left out.
+	 */
+	size_t getSerializedSize() const;
+
+	/**
+	 * Writes the bundle in a compact binary format (varint encoded integers,
+	 * little endian floating point values). Returns the number of bytes
+	 * written or 0 if size is too small.
+	 */
+	size_t serialize(uint8_t* data, size_t size) const;
+	sp<Buffer> serialize() const;
+
+	/**
+	 * Reads a bundle written by serialize(). Returns NULL if the data is
+	 * malformed.
+	 */
+	static sp<Bundle> deserialize(const uint8_t* data, size_t size);
 
-		inline Type getType() const {
-			return mType;
-		}
-
-		inline bool getBool() const {
-			return mVariant.boolValue;
-		}
-
-		inline uint8_t getByte() const {
-			return mVariant.byteValue;
-		}
-
-		inline char getChar() const {
-			return mVariant.charValue;
-		}
-
-		inline int16_t getInt16() const {
-			return mVariant.int16Value;
-		}
-
-		inline uint16_t getUInt16() const {
-			return mVariant.uint16Value;
-		}
-
-		inline int32_t getInt32() const {
-			return mVariant.int32Value;
-		}
-
-		inline uint32_t getUInt32() const {
-			return mVariant.uint32Value;
-		}
-
-		inline int64_t getInt64() const {
-			return mVariant.int64Value;
-		}
-
-		inline uint64_t getUInt64() const {
-			return mVariant.uint64Value;
-		}
-
-		inline float getFloat() const {
-			return mVariant.floatValue;
-		}
-
-		inline double getDouble() const {
-			return mVariant.doubleValue;
-		}
-
-		inline sp<String> getString() const {
-			return static_cast<String*>(mVariant.object);
-		}
-
-		template<typename T>
-		inline sp<T> getObject() const {
-			return static_cast<T*>(mVariant.object);
-		}
+private:
+	enum Type {
+		Null,
+		Bool,
+		Byte,
+		Char,
+		Int16,
+		UInt16,
+		Int32,
+		UInt32,
+		Int64,
+		UInt64,
+		Float,
+		Double,
+		CharString,
+		Object
+	};
 
-	private:
-		typedef union {
+	struct Entry {
+		const char* key;
+		uint32_t hash;
+		uint8_t type;
+		union {
 			bool boolValue;
 			uint8_t byteValue;
 			char charValue;
@@ -271,48 +147,45 @@ private:
 			float floatValue;
 			double doubleValue;
 			Ref* object;
-		} Value;
+		} value;
+	};
 
-		Type mType;
-		Value mVariant;
+	static const uint32_t MIN_CAPACITY = 8;
 
-		NO_COPY_CTOR_AND_ASSIGNMENT_OPERATOR(Variant)
-	};
+	ssize_t indexOf(const char* key) const;
+	const Entry* findEntry(const char* key, uint8_t type) const;
+	Entry* putEntry(const char* key, uint8_t type);
+	void putRef(const char* key, uint8_t type, Ref* object);
+	void releaseValue(Entry& entry);
+	void resize(uint32_t capacity);
 
-	struct KeyValuePair {
-		sp<String> key;
-		sp<Variant> value;
-	};
+	static uint32_t hash(const char* key);
+	static const char* intern(const char* key, uint32_t hash);
+	static Entry* obtainEntries(uint32_t capacity);
+	static void recycleEntries(Entry* entries, uint32_t capacity);
 
-	List<KeyValuePair>::const_iterator findValue(const char* key) const;
-	sp< List<KeyValuePair> > mKeyValuePairs;
+	Entry* mEntries;
+	uint32_t mCapacity;
+	uint32_t mSize;
 
 	NO_COPY_CTOR_AND_ASSIGNMENT_OPERATOR(Bundle)
 };
 
 template<typename T>
 sp<T> Bundle::getObject(const char* key) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Object) {
-			return itr->value->getObject<T>();
-		} else {
-			return NULL;
-		}
+	const Entry* entry = findEntry(key, Object);
+	if (entry != NULL) {
+		return static_cast<T*>(entry->value.object);
 	}
 	return NULL;
 }
 
 template<typename T>
 bool Bundle::fillObject(const char* key, sp<T>& object) const {
-	List<KeyValuePair>::const_iterator itr = findValue(key);
-	if (itr != mKeyValuePairs->end()) {
-		if (itr->value->getType() == Variant::Object) {
-			object = itr->value->getObject<T>();
-			return true;
-		} else {
-			return false;
-		}
+	const Entry* entry = findEntry(key, Object);
+	if (entry != NULL) {
+		object = static_cast<T*>(entry->value.object);
+		return true;
 	}
 	return false;
 }
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2014 Daniel Himmelein
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <mindroid/os/Future.h>
+
+namespace mindroid {
+
+CancellationToken::CancellationToken() :
+		mCancelled(false),
+		mNextListenerId(1) {
+}
+
+void CancellationToken::cancel() {
+	std::map< int32_t, std::function<void ()> > listeners;
+	{
+		AutoLock autoLock(mLock);
+		if (mCancelled) {
+			return;
+		}
+		mCancelled = true;
+		listeners.swap(mListeners);
+	}
+	std::map< int32_t, std::function<void ()> >::iterator itr;
+	for (itr = listeners.begin(); itr != listeners.end(); ++itr) {
+		itr->second();
+	}
+}
+
+bool CancellationToken::isCancelled() const {
+	AutoLock autoLock(mLock);
+	return mCancelled;
+}
+
+int32_t CancellationToken::addListener(std::function<void ()> listener) {
+	{
+		AutoLock autoLock(mLock);
+		if (!mCancelled) {
+			const int32_t id = mNextListenerId++;
+			mListeners[id] = listener;
+			return id;
+		}
+	}
+	listener();
+	return 0;
+}
+
+void CancellationToken::removeListener(int32_t id) {
+	AutoLock autoLock(mLock);
+	mListeners.erase(id);
+}
+
+void FutureBase::runOnLooper(Looper& looper, std::function<void ()> function) {
+	if (Looper::myLooper() == &looper) {
+		function();
+	} else {
+		sp<Handler> handler = new Handler(looper);
+		handler->post(function);
+	}
+}
+
+void FutureBase::runOnExecutor(Executor& executor, std::function<void ()> function) {
+	executor.execute(new FunctionRunnable(function));
+}
+
+} /* namespace mindroid */
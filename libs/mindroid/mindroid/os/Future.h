@@ -0,0 +1,442 @@
+/*
+ * Copyright (C) 2014 Daniel Himmelein
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDROID_FUTURE_H_
+#define MINDROID_FUTURE_H_
+
+#include <stdint.h>
+#include <functional>
+#include <map>
+#include <type_traits>
+#include <vector>
+#include <mindroid/util/Utils.h>
+#include <mindroid/os/Clock.h>
+#include <mindroid/os/Ref.h>
+#include <mindroid/os/Lock.h>
+#include <mindroid/os/CondVar.h>
+#include <mindroid/os/AtomicInteger.h>
+#include <mindroid/os/Runnable.h>
+#include <mindroid/os/Executor.h>
+#include <mindroid/os/Looper.h>
+#include <mindroid/os/Handler.h>
+
+namespace mindroid {
+
+class CancellationToken;
+template<typename T> class Future;
+template<typename T> class Promise;
+template<typename T> sp< Future< std::vector<T> > > whenAll(const std::vector< sp< Future<T> > >& futures,
+		const sp<CancellationToken>& token = NULL);
+
+/**
+ * A cancellation token is shared by all stages of a pipeline. Cancelling it
+ * cancels every future that was created with it and has not yet completed.
+ * Stages that have not started yet are skipped entirely.
+ */
+class CancellationToken :
+		public Ref
+{
+public:
+	CancellationToken();
+	virtual ~CancellationToken() { }
+
+	void cancel();
+	bool isCancelled() const;
+
+	/**
+	 * Registers a listener that is called once when the token is cancelled.
+	 * If the token is already cancelled the listener is called right away on
+	 * the calling thread.
+	 *
+	 * @return The id to pass to removeListener(), 0 if the listener was
+	 * called right away.
+	 */
+	int32_t addListener(std::function<void ()> listener);
+
+	/**
+	 * Unregisters a listener that is no longer needed. Does nothing if the
+	 * listener was already called.
+	 */
+	void removeListener(int32_t id);
+
+private:
+	mutable Lock mLock;
+	bool mCancelled;
+	int32_t mNextListenerId;
+	std::map< int32_t, std::function<void ()> > mListeners;
+
+	NO_COPY_CTOR_AND_ASSIGNMENT_OPERATOR(CancellationToken)
+};
+
+class FutureBase
+{
+public:
+	/**
+	 * Runs a continuation on the given looper. If the calling thread already
+	 * runs that looper the continuation is executed inline, otherwise it is
+	 * posted as a single message.
+	 */
+	static void runOnLooper(Looper& looper, std::function<void ()> function);
+
+	static void runOnExecutor(Executor& executor, std::function<void ()> function);
+
+protected:
+	enum {
+		STATE_PENDING = 0,
+		STATE_DONE = 1,
+		STATE_CANCELLED = 2
+	};
+
+	class FunctionRunnable :
+			public Runnable
+	{
+	public:
+		FunctionRunnable(std::function<void ()> function) :
+				mFunction(function) {
+		}
+
+		virtual void run() {
+			mFunction();
+		}
+
+	private:
+		std::function<void ()> mFunction;
+
+		NO_COPY_CTOR_AND_ASSIGNMENT_OPERATOR(FunctionRunnable)
+	};
+};
+
+/**
+ * The read side of an asynchronous result. A Future is completed exactly once,
+ * either with a value through its Promise or by cancellation.
+ *
+ * Continuations registered with then() run inline on the completing thread,
+ * on a given Looper (inline if that Looper belongs to the completing thread)
+ * or on an Executor. This allows decode, filter and layout stages to be
+ * chained and fanned out without an intermediate UI thread hop per stage.
+ *
+ * T must be default constructible and copyable.
+ */
+template<typename T>
+class Future :
+		public FutureBase,
+		public Ref
+{
+public:
+	virtual ~Future() {
+		if (mToken != NULL && mListenerId != 0) {
+			mToken->removeListener(mListenerId);
+		}
+	}
+
+	bool isDone() const {
+		AutoLock autoLock(mLock);
+		return mState != STATE_PENDING;
+	}
+
+	bool isCancelled() const {
+		AutoLock autoLock(mLock);
+		return mState == STATE_CANCELLED;
+	}
+
+	/**
+	 * Blocks until the future is completed. Returns a default constructed T
+	 * if the future was cancelled.
+	 */
+	T get() {
+		AutoLock autoLock(mLock);
+		while (mState == STATE_PENDING) {
+			mCondVar.wait();
+		}
+		return mValue;
+	}
+
+	/**
+	 * Waits at most timeout milliseconds for the result. Returns false if the
+	 * future did not complete with a value in time.
+	 */
+	bool get(T& result, uint32_t timeout) {
+		const uint64_t deadline = Clock::monotonicTime() + timeout * 1000000ULL;
+		AutoLock autoLock(mLock);
+		while (mState == STATE_PENDING) {
+			const uint64_t now = Clock::monotonicTime();
+			if (now >= deadline) {
+				break;
+			}
+			mCondVar.wait((uint32_t) ((deadline - now + 999999) / 1000000));
+		}
+		if (mState != STATE_DONE) {
+			return false;
+		}
+		result = mValue;
+		return true;
+	}
+
+	bool cancel() {
+		return complete(STATE_CANCELLED, T());
+	}
+
+	sp<CancellationToken> getCancellationToken() const {
+		return mToken;
+	}
+
+	/**
+	 * Runs function(value) on the thread that completes this future, or right
+	 * away if it is already completed.
+	 */
+	template<typename F>
+	sp< Future<typename std::result_of<F(T)>::type> > then(F function) {
+		typedef typename std::result_of<F(T)>::type R;
+		sp< Promise<R> > promise = new Promise<R>(mToken);
+		addContinuation([promise, function] (int32_t state, const T& value) {
+			runStage<R>(promise, function, state, value);
+		});
+		return promise->getFuture();
+	}
+
+	/**
+	 * Runs function(value) on the given looper.
+	 */
+	template<typename F>
+	sp< Future<typename std::result_of<F(T)>::type> > then(Looper& looper, F function) {
+		typedef typename std::result_of<F(T)>::type R;
+		sp< Promise<R> > promise = new Promise<R>(mToken);
+		Looper* target = &looper;
+		addContinuation([promise, function, target] (int32_t state, const T& value) {
+			if (state != STATE_DONE) {
+				promise->cancel();
+				return;
+			}
+			T argument(value);
+			runOnLooper(*target, [promise, function, argument] () {
+				runStage<R>(promise, function, STATE_DONE, argument);
+			});
+		});
+		return promise->getFuture();
+	}
+
+	/**
+	 * Runs function(value) on the given executor.
+	 */
+	template<typename F>
+	sp< Future<typename std::result_of<F(T)>::type> > then(Executor& executor, F function) {
+		typedef typename std::result_of<F(T)>::type R;
+		sp< Promise<R> > promise = new Promise<R>(mToken);
+		Executor* target = &executor;
+		addContinuation([promise, function, target] (int32_t state, const T& value) {
+			if (state != STATE_DONE) {
+				promise->cancel();
+				return;
+			}
+			T argument(value);
+			runOnExecutor(*target, [promise, function, argument] () {
+				runStage<R>(promise, function, STATE_DONE, argument);
+			});
+		});
+		return promise->getFuture();
+	}
+
+	/**
+	 * Runs function() on the given executor and completes the returned future
+	 * with its result. The function is skipped if token is cancelled before
+	 * it starts.
+	 */
+	template<typename F>
+	static sp< Future<T> > async(Executor& executor, F function, const sp<CancellationToken>& token = NULL) {
+		sp< Promise<T> > promise = new Promise<T>(token);
+		runOnExecutor(executor, [promise, function] () {
+			if (!promise->isCancelled()) {
+				promise->set(function());
+			}
+		});
+		return promise->getFuture();
+	}
+
+private:
+	typedef std::function<void (int32_t state, const T& value)> Continuation;
+
+	Future(const sp<CancellationToken>& token) :
+			mCondVar(mLock),
+			mState(STATE_PENDING),
+			mValue(),
+			mToken(token),
+			mListenerId(0) {
+	}
+
+	/**
+	 * Keeps the id of the listener that cancels this future with its token,
+	 * so that it is unregistered once the future completes.
+	 */
+	void setCancellationListener(int32_t id) {
+		{
+			AutoLock autoLock(mLock);
+			if (mState == STATE_PENDING) {
+				mListenerId = id;
+				return;
+			}
+		}
+		if (id != 0) {
+			mToken->removeListener(id);
+		}
+	}
+
+	template<typename R, typename F>
+	static void runStage(const sp< Promise<R> >& promise, const F& function, int32_t state, const T& value) {
+		if (state != STATE_DONE || promise->isCancelled()) {
+			promise->cancel();
+		} else {
+			promise->set(function(value));
+		}
+	}
+
+	void addContinuation(Continuation continuation) {
+		{
+			AutoLock autoLock(mLock);
+			if (mState == STATE_PENDING) {
+				mContinuations.push_back(continuation);
+				return;
+			}
+		}
+		continuation(mState, mValue);
+	}
+
+	bool complete(int32_t state, const T& value) {
+		std::vector<Continuation> continuations;
+		int32_t listenerId;
+		{
+			AutoLock autoLock(mLock);
+			if (mState != STATE_PENDING) {
+				return false;
+			}
+			mState = state;
+			mValue = value;
+			continuations.swap(mContinuations);
+			listenerId = mListenerId;
+			mListenerId = 0;
+			mCondVar.notifyAll();
+		}
+		if (listenerId != 0) {
+			mToken->removeListener(listenerId);
+		}
+		for (size_t i = 0; i < continuations.size(); i++) {
+			continuations[i](state, value);
+		}
+		return true;
+	}
+
+	mutable Lock mLock;
+	CondVar mCondVar;
+	int32_t mState;
+	T mValue;
+	std::vector<Continuation> mContinuations;
+	sp<CancellationToken> mToken;
+	int32_t mListenerId;
+
+	template<typename Y> friend class Future;
+	friend class Promise<T>;
+	friend sp< Future< std::vector<T> > > whenAll<T>(const std::vector< sp< Future<T> > >& futures,
+			const sp<CancellationToken>& token);
+
+	NO_COPY_CTOR_AND_ASSIGNMENT_OPERATOR(Future)
+};
+
+/**
+ * The write side of an asynchronous result.
+ */
+template<typename T>
+class Promise :
+		public Ref
+{
+public:
+	Promise(const sp<CancellationToken>& token = NULL) {
+		mFuture = new Future<T>(token);
+		if (token != NULL) {
+			wp< Future<T> > future = mFuture;
+			mFuture->setCancellationListener(token->addListener([future] () {
+				sp< Future<T> > strongFuture = future.toStrongRef();
+				if (strongFuture != NULL) {
+					strongFuture->cancel();
+				}
+			}));
+		}
+	}
+
+	virtual ~Promise() { }
+
+	sp< Future<T> > getFuture() const {
+		return mFuture;
+	}
+
+	bool set(const T& value) {
+		return mFuture->complete(Future<T>::STATE_DONE, value);
+	}
+
+	bool cancel() {
+		return mFuture->cancel();
+	}
+
+	bool isCancelled() const {
+		return mFuture->isCancelled();
+	}
+
+private:
+	sp< Future<T> > mFuture;
+
+	NO_COPY_CTOR_AND_ASSIGNMENT_OPERATOR(Promise)
+};
+
+/**
+ * Returns a future that completes with all results (in order) once every
+ * future in the list has completed. The returned future is cancelled as soon
+ * as one of the inputs is cancelled.
+ */
+template<typename T>
+sp< Future< std::vector<T> > > whenAll(const std::vector< sp< Future<T> > >& futures,
+		const sp<CancellationToken>& token) {
+	struct State :
+			public Ref
+	{
+		State(size_t size) : results(size), pending(size) { }
+
+		std::vector<T> results;
+		volatile int32_t pending;
+	};
+
+	sp< Promise< std::vector<T> > > promise = new Promise< std::vector<T> >(token);
+	if (futures.empty()) {
+		promise->set(std::vector<T>());
+		return promise->getFuture();
+	}
+
+	sp<State> state = new State(futures.size());
+	for (size_t i = 0; i < futures.size(); i++) {
+		futures[i]->addContinuation([promise, state, i] (int32_t status, const T& value) {
+			if (status != Future<T>::STATE_DONE) {
+				promise->cancel();
+				return;
+			}
+			state->results[i] = value;
+			if (AtomicInteger::decrementAndGet(&state->pending) == 1) {
+				promise->set(state->results);
+			}
+		});
+	}
+	return promise->getFuture();
+}
+
+} /* namespace mindroid */
+
+#endif /* MINDROID_FUTURE_H_ */
@@ -80,17 +80,33 @@ Looper* Looper::myLooper() {
 void Looper::loop() {
 	Looper* me = myLooper();
 	if (me != NULL) {
-        int count = 0;
 		sp<MessageQueue> mq = me->mMessageQueue;
-        sp<Message> message = mq->dequeueMessage();
-        while (message != NULL) {
+		while (true) {
+			sp<Message> message = mq->dequeueMessage(-1);
 			if (message->mHandler == NULL) {
 				return;
 			}
-            count++;
 			message->mHandler->dispatchMessage(message);
-            message = mq->dequeueMessage();
-        }
+		}
+	}
+}
+
+void Looper::pollOnce(int timeoutMillis) {
+	Looper* me = myLooper();
+	if (me != NULL) {
+		sp<MessageQueue> mq = me->mMessageQueue;
+		sp<Message> message = mq->dequeueMessage(timeoutMillis);
+		while (message != NULL && message->mHandler != NULL) {
+			message->mHandler->dispatchMessage(message);
+			message = mq->dequeueMessage(0);
+		}
+	}
+}
+
+void Looper::idle(uint64_t deadline) {
+	Looper* me = myLooper();
+	if (me != NULL) {
+		me->mMessageQueue->runIdleHandlers(deadline);
 	}
 }
 
@@ -32,7 +32,25 @@ public:
 	static bool prepare();
 	static bool prepare(const sp<Runnable>& onLooperReadyRunnable);
 	static Looper* myLooper();
+
+	/**
+	 * Dispatches the messages of the calling thread's message queue until quit() is called,
+	 * sleeping while none is due.
+	 */
 	static void loop();
+
+	/**
+	 * Dispatches the messages of the calling thread's message queue that are due, waiting up to
+	 * timeoutMillis for the first one (-1 waits until there is one, 0 does not wait). For threads
+	 * driven by something else, such as the display link of the UI thread.
+	 */
+	static void pollOnce(int timeoutMillis);
+
+	/**
+	 * Runs the idle handlers of the calling thread's message queue until the deadline
+	 * (Clock::monotonicTime() timebase) has passed.
+	 */
+	static void idle(uint64_t deadline);
 	void quit();
 	sp<MessageQueue> myMessageQueue() { return mMessageQueue; }
 
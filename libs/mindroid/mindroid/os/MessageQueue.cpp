@@ -15,6 +15,9 @@
  */
 
 #include <pthread.h>
+#include <limits.h>
+#include <limits>
+#include <utils/Looper.h>
 #include <mindroid/os/MessageQueue.h>
 #include <mindroid/os/Message.h>
 #include <mindroid/os/Clock.h>
@@ -24,17 +27,50 @@
 
 namespace mindroid {
 
+/*
+ * Runs a FdCallback for the native looper.
+ */
+class FdCallbackAdapter :
+		public android::LooperCallback
+{
+public:
+	FdCallbackAdapter(const sp<MessageQueue::FdCallback>& callback) :
+			mCallback(callback) {
+	}
+
+	virtual int handleEvent(int fd, int events, void* data) {
+		return mCallback->onFdEvent(fd, events) ? 1 : 0;
+	}
+
+private:
+	sp<MessageQueue::FdCallback> mCallback;
+};
+
+static inline android::Looper* nativeLooper(const sp<Ref>& looper) {
+	return static_cast<android::Looper*>(looper.getPointer());
+}
+
+static int toTimeoutMillis(uint64_t now, uint64_t timestamp) {
+	if (timestamp <= now) {
+		return 0;
+	}
+	// Rounded up so that the message is due when the looper wakes up
+	uint64_t timeoutMillis = (timestamp - now + 999999) / 1000000;
+	return timeoutMillis > INT_MAX ? INT_MAX : (int) timeoutMillis;
+}
+
 MessageQueue::MessageQueue() :
 		mHeadMessage(NULL),
-		mCondVar(mCondVarLock),
 		mLockMessageQueue(false),
         mNextBarrierToken(0) {
+	// Shared with native code looping on the same thread
+	mNativeLooper = android::Looper::prepare(0);
 }
 
 MessageQueue::~MessageQueue() { }
 
 bool MessageQueue::enqueueMessage(const sp<Message>& message, uint64_t execTimestamp) {
-	AutoLock autoLock(mCondVarLock);
+	AutoLock autoLock(mLock);
 	if (message->mExecTimestamp != 0) {
 		return false;
 	}
@@ -44,46 +80,71 @@ bool MessageQueue::enqueueMessage(const sp<Message>& message, uint64_t execTimes
 		mLockMessageQueue = true;
 	}
 	message->mExecTimestamp = execTimestamp;
-	sp<Message> curMessage = mHeadMessage;
+	// The queue keeps its messages alive while mLock is held, so walk it without touching reference counters.
+	Message* curMessage = mHeadMessage.getPointer();
 	if (curMessage == NULL || execTimestamp == 0 || execTimestamp < curMessage->mExecTimestamp) {
-		message->mNextMessage = curMessage;
+		message->mNextMessage = mHeadMessage;
 		mHeadMessage = message;
-		mCondVar.notify();
+		// The looper may be waiting for a later message, or for none
+		nativeLooper(mNativeLooper)->wake();
 	} else {
-		sp<Message> prevMessage = NULL;
+		Message* prevMessage = NULL;
 		while (curMessage != NULL && curMessage->mExecTimestamp <= execTimestamp) {
 			prevMessage = curMessage;
-			curMessage = curMessage->mNextMessage;
+			curMessage = curMessage->mNextMessage.getPointer();
 		}
 		message->mNextMessage = prevMessage->mNextMessage;
 		prevMessage->mNextMessage = message;
-		mCondVar.notify();
 	}
 	return true;
 }
 
-sp<Message> MessageQueue::dequeueMessage() {
+sp<Message> MessageQueue::dequeueMessage(int timeoutMillis) {
+	const uint64_t endTimestamp = (timeoutMillis > 0) ?
+			Clock::monotonicTime() + (uint64_t) timeoutMillis * 1000000 : 0;
+	bool polled = false;
+	bool idle = false;
+
 	while (true) {
-		AutoLock autoLock(mCondVarLock);
 		uint64_t now = Clock::monotonicTime();
-		sp<Message> message = getNextMessage(now);
-		if (message != NULL) {
-			message->mExecTimestamp = 0;
-			return message;
-		} else {
-            return NULL;
+		uint64_t nextTimestamp = 0;
+		{
+			AutoLock autoLock(mLock);
+			sp<Message> message = getNextMessage(now);
+			if (message != NULL) {
+				message->mExecTimestamp = 0;
+				return message;
+			}
+			if (mHeadMessage != NULL) {
+				nextTimestamp = mHeadMessage->mExecTimestamp;
+			}
 		}
 
-		if (mHeadMessage != NULL) {
-			if (mHeadMessage->mExecTimestamp - now > 0) {
-				timespec absExecTimestamp;
-				absExecTimestamp.tv_sec = mHeadMessage->mExecTimestamp / 1000000000LL;
-				absExecTimestamp.tv_nsec = mHeadMessage->mExecTimestamp % 1000000000LL;
-				mCondVar.wait(absExecTimestamp);
+		// Callbacks of the file descriptors run at least once, even without waiting
+		if (polled && (timeoutMillis == 0 || (timeoutMillis > 0 && now >= endTimestamp))) {
+			return NULL;
+		}
+
+		// Only once per call, the handlers get the whole wait as deadline
+		if (timeoutMillis != 0 && !idle) {
+			idle = true;
+			runIdleHandlers(nextTimestamp != 0 ? nextTimestamp : std::numeric_limits<uint64_t>::max());
+			continue;
+		}
+
+		int pollTimeoutMillis = timeoutMillis;
+		if (timeoutMillis > 0) {
+			pollTimeoutMillis = toTimeoutMillis(now, endTimestamp);
+		}
+		if (nextTimestamp != 0) {
+			int messageTimeoutMillis = toTimeoutMillis(now, nextTimestamp);
+			if (pollTimeoutMillis < 0 || messageTimeoutMillis < pollTimeoutMillis) {
+				pollTimeoutMillis = messageTimeoutMillis;
 			}
-		} else {
-			mCondVar.wait();
 		}
+
+		nativeLooper(mNativeLooper)->pollOnce(pollTimeoutMillis);
+		polled = true;
 	}
 }
 
@@ -105,7 +166,7 @@ bool MessageQueue::removeMessages(const sp<Handler>& handler, int32_t what) {
 
 	bool foundMessage = false;
 
-	mCondVarLock.lock();
+	mLock.lock();
 
 	sp<Message> curMessage = mHeadMessage;
 	// remove all matching messages at the front of the message queue.
@@ -131,7 +192,7 @@ bool MessageQueue::removeMessages(const sp<Handler>& handler, int32_t what) {
 		curMessage = nextMessage;
 	}
 
-	mCondVarLock.unlock();
+	mLock.unlock();
 
 	return foundMessage;
 }
@@ -143,7 +204,7 @@ bool MessageQueue::removeCallbacks(const sp<Handler>& handler, const sp<Runnable
 
 	bool foundRunnable = false;
 
-	mCondVarLock.lock();
+	mLock.lock();
 
 	sp<Message> curMessage = mHeadMessage;
 	// remove all matching messages at the front of the message queue.
@@ -169,7 +230,7 @@ bool MessageQueue::removeCallbacks(const sp<Handler>& handler, const sp<Runnable
 		curMessage = nextMessage;
 	}
 
-	mCondVarLock.unlock();
+	mLock.unlock();
 
 	return foundRunnable;
 }
@@ -181,7 +242,7 @@ bool MessageQueue::removeCallbacksAndMessages(const sp<Handler>& handler) {
 
 	bool foundSomething = false;
 
-	mCondVarLock.lock();
+	mLock.lock();
 
 	sp<Message> curMessage = mHeadMessage;
 	// remove all matching messages at the front of the message queue.
@@ -207,9 +268,64 @@ bool MessageQueue::removeCallbacksAndMessages(const sp<Handler>& handler) {
 		curMessage = nextMessage;
 	}
 
-	mCondVarLock.unlock();
+	mLock.unlock();
 
 	return foundSomething;
 }
 
+bool MessageQueue::addFd(int fd, int events, const sp<FdCallback>& callback) {
+	if (callback == NULL) {
+		return false;
+	}
+	return nativeLooper(mNativeLooper)->addFd(fd, ALOOPER_POLL_CALLBACK, events, new FdCallbackAdapter(callback), NULL) == 1;
+}
+
+bool MessageQueue::removeFd(int fd) {
+	return nativeLooper(mNativeLooper)->removeFd(fd) == 1;
+}
+
+void MessageQueue::addIdleHandler(const sp<IdleHandler>& idleHandler) {
+	if (idleHandler == NULL) {
+		return;
+	}
+	AutoLock autoLock(mLock);
+	for (size_t i = 0; i < mIdleHandlers.size(); i++) {
+		if (mIdleHandlers[i] == idleHandler) {
+			return;
+		}
+	}
+	mIdleHandlers.push_back(idleHandler);
+}
+
+void MessageQueue::removeIdleHandler(const sp<IdleHandler>& idleHandler) {
+	AutoLock autoLock(mLock);
+	for (size_t i = 0; i < mIdleHandlers.size(); i++) {
+		if (mIdleHandlers[i] == idleHandler) {
+			mIdleHandlers.erase(mIdleHandlers.begin() + i);
+			return;
+		}
+	}
+}
+
+void MessageQueue::runIdleHandlers(uint64_t deadline) {
+	std::vector< sp<IdleHandler> > idleHandlers;
+	{
+		AutoLock autoLock(mLock);
+		if (mIdleHandlers.empty() || (mHeadMessage != NULL && mHeadMessage->mExecTimestamp <= Clock::monotonicTime())) {
+			return;
+		}
+		idleHandlers = mIdleHandlers;
+	}
+
+	// Idle handlers run without the lock so that they may post messages or (un)register themselves.
+	for (size_t i = 0; i < idleHandlers.size(); i++) {
+		if (Clock::monotonicTime() >= deadline) {
+			break;
+		}
+		if (!idleHandlers[i]->queueIdle(deadline)) {
+			removeIdleHandler(idleHandlers[i]);
+		}
+	}
+}
+
 } /* namespace mindroid */
@@ -20,10 +20,10 @@
 #include <stdint.h>
 #include <pthread.h>
 #include <functional>
+#include <vector>
 #include <mindroid/util/Utils.h>
 #include <mindroid/os/Ref.h>
 #include <mindroid/os/Lock.h>
-#include <mindroid/os/CondVar.h>
 
 namespace mindroid {
 
@@ -39,18 +39,80 @@ public:
 	MessageQueue();
 	virtual ~MessageQueue();
 	bool enqueueMessage(const sp<Message>& message, uint64_t execTimestamp);
-	sp<Message> dequeueMessage();
+
+	/**
+	 * Returns the next message once it is due, waiting for it up to timeoutMillis (-1 waits
+	 * until there is one, 0 does not wait). Returns NULL if none is due by then. The thread
+	 * sleeps in the native looper meanwhile, which wakes up for new messages and runs the
+	 * callbacks of the watched file descriptors. Before sleeping with a timeout other than 0,
+	 * the idle handlers run with the time of the next message as deadline.
+	 */
+	sp<Message> dequeueMessage(int timeoutMillis);
 	bool removeMessages(const sp<Handler>& handler, int32_t what);
 	bool removeCallbacks(const sp<Handler>& handler, const sp<Runnable>& runnable);
 	bool removeCallbacksAndMessages(const sp<Handler>& handler);
 
+	/**
+	 * Callback for work that should only run when the queue has run dry. On the UI thread the
+	 * display link calls Looper::idle() after a frame has been drawn, with the end of the frame
+	 * as deadline (Clock::monotonicTime() timebase).
+	 */
+	class IdleHandler :
+			public Ref
+	{
+	public:
+		virtual ~IdleHandler() { }
+
+		/**
+		 * Returns true to keep the idle handler registered, false to remove it.
+		 */
+		virtual bool queueIdle(uint64_t deadline) = 0;
+	};
+
+	void addIdleHandler(const sp<IdleHandler>& idleHandler);
+	void removeIdleHandler(const sp<IdleHandler>& idleHandler);
+	void runIdleHandlers(uint64_t deadline);
+
+	// The values of the native looper's ALOOPER_EVENT_* bits
+	static const int EVENT_INPUT = 1 << 0;
+	static const int EVENT_OUTPUT = 1 << 1;
+	static const int EVENT_ERROR = 1 << 2;
+	static const int EVENT_HANGUP = 1 << 3;
+
+	/**
+	 * Callback for a file descriptor watched by the queue, run on the queue's thread when the
+	 * descriptor is ready, e.g. when an asynchronous read has completed.
+	 */
+	class FdCallback :
+			public Ref
+	{
+	public:
+		virtual ~FdCallback() { }
+
+		/**
+		 * Handles the EVENT_* bits set for the descriptor. Returns true to keep watching it,
+		 * false to remove it.
+		 */
+		virtual bool onFdEvent(int fd, int events) = 0;
+	};
+
+	/**
+	 * Watches a file descriptor for the EVENT_INPUT and/or EVENT_OUTPUT events, replacing the
+	 * callback if it is already watched. Errors and hangups are always reported. May be called
+	 * from any thread.
+	 */
+	bool addFd(int fd, int events, const sp<FdCallback>& callback);
+	bool removeFd(int fd);
+
 private:
 	sp<Message> getNextMessage(uint64_t now);
 
 	sp<Message> mHeadMessage;
-	Lock mCondVarLock;
-	CondVar mCondVar;
+	Lock mLock;
+	// The thread's android::Looper, held as a Ref so its name stays out of this header
+	sp<Ref> mNativeLooper;
 	bool mLockMessageQueue;
+	std::vector< sp<IdleHandler> > mIdleHandlers;
     int mNextBarrierToken;
 
 	NO_COPY_CTOR_AND_ASSIGNMENT_OPERATOR(MessageQueue)
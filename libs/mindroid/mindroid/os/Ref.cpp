@@ -30,9 +30,19 @@
 #define DEBUG_REFS_DO_REF_TRACKING 0
 #define DEBUG_REFS_MEMORIZE_REF_OPERATIONS_DURING_REF_TRACKING 0
 
+#if DEBUG_REFS && MINDROID_INTRUSIVE_REFS
+#error "Reference tracking requires MINDROID_INTRUSIVE_REFS to be 0"
+#endif
+
 namespace mindroid {
 
 #define INITIAL_STRONG_REF_VALUE (1<<28)
+#if MINDROID_INTRUSIVE_REFS
+// Set while the WeakRef control block is being created.
+#define REF_IMPL_LOCKED (1<<29)
+// Set once the strong reference counter has moved into the WeakRef control block.
+#define REF_IMPL_MIGRATED (1<<30)
+#endif
 
 Ref::Destroyer::~Destroyer() {
 }
@@ -46,15 +56,13 @@ public:
 	volatile int32_t mWeakRefCounter;
 	Ref* const mRef;
 	volatile int32_t mFlags;
-	Destroyer* mDestroyer;
 
 #if !DEBUG_REFS
 	WeakRefImpl(Ref* ref) :
 			mStrongRefCounter(INITIAL_STRONG_REF_VALUE),
 			mWeakRefCounter(0),
 			mRef(ref),
-			mFlags(0),
-			mDestroyer(NULL) {
+			mFlags(0) {
 	}
 
 	void addStrongRef(const void* id) { }
@@ -70,7 +78,6 @@ public:
 			mWeakRefCounter(0),
 			mRef(ref),
 			mFlags(0),
-			mDestroyer(NULL),
 			mStrongRefs(NULL),
 			mWeakRefs(NULL),
 			mDoRefTracking(!!DEBUG_REFS_DO_REF_TRACKING),
@@ -198,7 +205,24 @@ private:
 };
 
 void Ref::incStrongRef(const void* id) const {
-	WeakRefImpl* const refImpl = mRefImpl;
+#if MINDROID_INTRUSIVE_REFS
+	int32_t curRefCounter = mStrongRefCounter;
+	while ((curRefCounter & (REF_IMPL_LOCKED | REF_IMPL_MIGRATED)) == 0) {
+		ASSERT(curRefCounter > 0, "Ref::incStrongRef() called on %p with reference counter < 0", this);
+		const int32_t newRefCounter = (curRefCounter == INITIAL_STRONG_REF_VALUE) ? 1 : curRefCounter + 1;
+		if (AtomicInteger::compareAndSwap(curRefCounter, newRefCounter, &mStrongRefCounter) == 0) {
+#if PRINT_REFS
+			DEBUG_INFO("Ref::incStrongRef() of %p from %p: refCounter = %d\n", this, id, curRefCounter);
+#endif
+			if (curRefCounter == INITIAL_STRONG_REF_VALUE) {
+				const_cast<Ref*>(this)->onFirstRef();
+			}
+			return;
+		}
+		curRefCounter = mStrongRefCounter;
+	}
+#endif
+	WeakRefImpl* const refImpl = getRefImpl();
 	refImpl->incWeakRef(id);
 	refImpl->addStrongRef(id);
 	const int32_t oldRefCounter = AtomicInteger::incrementAndGet(&refImpl->mStrongRefCounter);
@@ -214,7 +238,29 @@ void Ref::incStrongRef(const void* id) const {
 }
 
 void Ref::decStrongRef(const void* id) const {
-	WeakRefImpl* const refImpl = mRefImpl;
+#if MINDROID_INTRUSIVE_REFS
+	int32_t curRefCounter = mStrongRefCounter;
+	while ((curRefCounter & (REF_IMPL_LOCKED | REF_IMPL_MIGRATED)) == 0) {
+		ASSERT(curRefCounter >= 1 && curRefCounter != INITIAL_STRONG_REF_VALUE, "Ref::decStrongRef() called on %p too many times", this);
+		if (AtomicInteger::compareAndSwap(curRefCounter, curRefCounter - 1, &mStrongRefCounter) == 0) {
+#if PRINT_REFS
+			DEBUG_INFO("Ref::decStrongRef() of %p from %p: refCounter = %d\n", this, id, curRefCounter);
+#endif
+			if (curRefCounter == 1) {
+				// No WeakRef control block exists, so nobody else can observe the object anymore.
+				const_cast<Ref*>(this)->onLastStrongRef(id);
+				if (mDestroyer) {
+					mDestroyer->destroy(const_cast<Ref*>(this));
+				} else {
+					delete this;
+				}
+			}
+			return;
+		}
+		curRefCounter = mStrongRefCounter;
+	}
+#endif
+	WeakRefImpl* const refImpl = getRefImpl();
 	refImpl->removeStrongRef(id);
 	const int32_t oldRefCounter = AtomicInteger::decrementAndGet(&refImpl->mStrongRefCounter);
 #if PRINT_REFS
@@ -224,8 +270,8 @@ void Ref::decStrongRef(const void* id) const {
 	if (oldRefCounter == 1) {
 		const_cast<Ref*>(this)->onLastStrongRef(id);
 		if ((refImpl->mFlags & OBJECT_WEAK_REF_LIFETIME) != OBJECT_WEAK_REF_LIFETIME) {
-			if (refImpl->mDestroyer) {
-				refImpl->mDestroyer->destroy(const_cast<Ref*>(this));
+			if (mDestroyer) {
+				mDestroyer->destroy(const_cast<Ref*>(this));
 			} else {
 				delete this;
 			}
@@ -235,11 +281,17 @@ void Ref::decStrongRef(const void* id) const {
 }
 
 int32_t Ref::getStrongRefCount() const {
-	return mRefImpl->mStrongRefCounter;
+#if MINDROID_INTRUSIVE_REFS
+	const int32_t curRefCounter = mStrongRefCounter;
+	if ((curRefCounter & (REF_IMPL_LOCKED | REF_IMPL_MIGRATED)) == 0) {
+		return curRefCounter;
+	}
+#endif
+	return getRefImpl()->mStrongRefCounter;
 }
 
 void Ref::setDestroyer(Ref::Destroyer* destroyer) {
-	mRefImpl->mDestroyer = destroyer;
+	mDestroyer = destroyer;
 }
 
 Ref* Ref::WeakRef::ref() const {
@@ -265,8 +317,8 @@ void Ref::WeakRef::decWeakRef(const void* id) {
 	if ((refImpl->mFlags & OBJECT_WEAK_REF_LIFETIME) != OBJECT_WEAK_REF_LIFETIME) {
 		if (refImpl->mStrongRefCounter == INITIAL_STRONG_REF_VALUE) {
 			if (refImpl->mRef) {
-				if (refImpl->mDestroyer) {
-					refImpl->mDestroyer->destroy(refImpl->mRef);
+				if (refImpl->mRef->mDestroyer) {
+					refImpl->mRef->mDestroyer->destroy(refImpl->mRef);
 				} else {
 					delete refImpl->mRef;
 				}
@@ -277,8 +329,8 @@ void Ref::WeakRef::decWeakRef(const void* id) {
 		refImpl->mRef->onLastWeakRef(id);
 		if ((refImpl->mFlags & OBJECT_INFINITE_LIFETIME) != OBJECT_INFINITE_LIFETIME) {
 			if (refImpl->mRef) {
-				if (refImpl->mDestroyer) {
-					refImpl->mDestroyer->destroy(refImpl->mRef);
+				if (refImpl->mRef->mDestroyer) {
+					refImpl->mRef->mDestroyer->destroy(refImpl->mRef);
 				} else {
 					delete refImpl->mRef;
 				}
@@ -377,15 +429,82 @@ void Ref::WeakRef::trackRef(bool doTracking, bool memorizeRefOperationsDuringRef
 }
 
 Ref::WeakRef* Ref::createWeakRef(const void* id) const {
-	mRefImpl->incWeakRef(id);
-	return mRefImpl;
+	WeakRefImpl* const refImpl = getRefImpl();
+	refImpl->incWeakRef(id);
+	return refImpl;
 }
 
 Ref::WeakRef* Ref::getWeakRef() const {
-	return mRefImpl;
+	return getRefImpl();
 }
 
-Ref::Ref() : mRefImpl(new WeakRefImpl(this)) { }
+#if MINDROID_INTRUSIVE_REFS
+Ref::Ref() :
+		mStrongRefCounter(INITIAL_STRONG_REF_VALUE),
+		mRefImpl(NULL),
+		mDestroyer(NULL) {
+}
+
+Ref::~Ref() {
+	WeakRefImpl* const refImpl = mRefImpl;
+	if (refImpl != NULL && refImpl->mWeakRefCounter == 0) {
+		// A control block that was created while the object was already dying is not owned by any reference.
+		if ((refImpl->mFlags & OBJECT_WEAK_REF_LIFETIME) == OBJECT_WEAK_REF_LIFETIME || refImpl->mStrongRefCounter == 0) {
+			delete refImpl;
+		}
+	}
+}
+
+Ref::WeakRefImpl* Ref::getRefImpl() const {
+	WeakRefImpl* const refImpl = mRefImpl;
+	if (refImpl != NULL) {
+		return refImpl;
+	}
+	return createRefImpl();
+}
+
+Ref::WeakRefImpl* Ref::createRefImpl() const {
+	WeakRefImpl* refImpl = new WeakRefImpl(const_cast<Ref*>(this));
+	int32_t curRefCounter;
+	while (true) {
+		curRefCounter = mStrongRefCounter;
+		if ((curRefCounter & (REF_IMPL_LOCKED | REF_IMPL_MIGRATED)) != 0) {
+			// Another thread creates the control block, wait until it is published.
+			delete refImpl;
+			while ((refImpl = mRefImpl) == NULL) {
+			}
+			return refImpl;
+		}
+		if (AtomicInteger::compareAndSwap(curRefCounter, curRefCounter | REF_IMPL_LOCKED, &mStrongRefCounter) == 0) {
+			break;
+		}
+	}
+
+	// The inline counter cannot change while REF_IMPL_LOCKED is set.
+	// Each strong reference also holds a weak reference.
+	refImpl->mStrongRefCounter = curRefCounter;
+	refImpl->mWeakRefCounter = (curRefCounter == INITIAL_STRONG_REF_VALUE) ? 0 : curRefCounter;
+	AtomicInteger::compareAndSwap(curRefCounter | REF_IMPL_LOCKED, curRefCounter | REF_IMPL_MIGRATED, &mStrongRefCounter);
+	mRefImpl = refImpl;
+	return refImpl;
+}
+
+bool Ref::reviveStrongRef(const void* id) {
+	// Called from Destroyer::destroy() after the last strong reference is gone.
+	// Without a control block the object can be revived in place.
+	if (AtomicInteger::compareAndSwap(0, 1, &mStrongRefCounter) == 0) {
+		return true;
+	}
+	adjustObjectLifetime(OBJECT_WEAK_REF_LIFETIME);
+	bool revived = getWeakRef()->tryIncStrongRef(id);
+	adjustObjectLifetime(0);
+	return revived;
+}
+#else
+Ref::Ref() :
+		mRefImpl(new WeakRefImpl(this)),
+		mDestroyer(NULL) {
+}
 
 Ref::~Ref() {
 	if ((mRefImpl->mFlags & OBJECT_WEAK_REF_LIFETIME) == OBJECT_WEAK_REF_LIFETIME) {
@@ -395,8 +514,20 @@ Ref::~Ref() {
 	}
 }
 
+Ref::WeakRefImpl* Ref::getRefImpl() const {
+	return mRefImpl;
+}
+
+bool Ref::reviveStrongRef(const void* id) {
+	adjustObjectLifetime(OBJECT_WEAK_REF_LIFETIME);
+	bool revived = getWeakRef()->tryIncStrongRef(id);
+	adjustObjectLifetime(0);
+	return revived;
+}
+#endif
+
 void Ref::adjustObjectLifetime(int32_t mode) const {
-	AtomicInteger::orAndGet(mode, &mRefImpl->mFlags);
+	AtomicInteger::orAndGet(mode, &getRefImpl()->mFlags);
 }
 
 void Ref::onFirstRef() {
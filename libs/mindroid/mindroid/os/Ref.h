@@ -29,6 +29,13 @@
 #define DEBUG_INFO(...) printf(__VA_ARGS__)
 #define ERROR_INFO(...) printf(__VA_ARGS__)
 
+// With intrusive reference counting the strong reference counter lives inside the object and the
+// WeakRef control block is only allocated when the first wp<> (or WeakRef) is taken. Objects that
+// are only ever referenced through sp<> then cost a single allocation.
+#ifndef MINDROID_INTRUSIVE_REFS
+#define MINDROID_INTRUSIVE_REFS 1
+#endif
+
 namespace mindroid {
 
 template<typename T> class sp;
@@ -134,7 +141,21 @@ protected:
 
 private:
 	class WeakRefImpl;
+
+	WeakRefImpl* getRefImpl() const;
+	bool reviveStrongRef(const void* id);
+
+#if MINDROID_INTRUSIVE_REFS
+	WeakRefImpl* createRefImpl() const;
+
+	// Holds the strong reference counter until the WeakRef control block is created.
+	// From then on REF_IMPL_MIGRATED is set and the counter lives in mRefImpl.
+	mutable volatile int32_t mStrongRefCounter;
+	mutable WeakRefImpl* volatile mRefImpl;
+#else
 	WeakRefImpl* const mRefImpl;
+#endif
+	Destroyer* mDestroyer;
 
 	friend class WeakRef;
 
@@ -584,11 +605,9 @@ template<typename T>
 sp<T> Ref::Destroyer::reviveObject(Ref* ref) {
 	sp<T> newRef;
 	if (ref != NULL) {
-		ref->adjustObjectLifetime(OBJECT_WEAK_REF_LIFETIME);
-		if (ref->getWeakRef()->tryIncStrongRef(&newRef)) {
+		if (ref->reviveStrongRef(&newRef)) {
 			newRef.setPointer(static_cast<T*>(ref));
 		}
-		ref->adjustObjectLifetime(0);
 	}
 	return newRef;
 }
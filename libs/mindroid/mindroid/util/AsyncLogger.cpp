@@ -0,0 +1,571 @@
+/*
+ * Copyright (C) 2014 Daniel Himmelein
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <mindroid/util/AsyncLogger.h>
+#include <mindroid/os/AtomicInteger.h>
+
+namespace mindroid {
+
+namespace {
+
+const uint8_t PADDING_RECORD = 0xFF;
+
+struct RecordHeader
+{
+	uint16_t size; // Total record size including this header, a multiple of 8.
+	uint8_t priority;
+	uint8_t bufferId;
+	const char* format;
+};
+
+struct FormatSpec
+{
+	const char* start;
+	const char* end;
+	char conversion;
+	char length;
+	int32_t stars;
+};
+
+// Length modifiers folded into a single character.
+const char LENGTH_NONE = 0;
+const char LENGTH_LONG = 'l';
+const char LENGTH_LONG_LONG = 'q';
+const char LENGTH_INTMAX = 'j';
+const char LENGTH_SIZE = 'z';
+const char LENGTH_PTRDIFF = 't';
+const char LENGTH_LONG_DOUBLE = 'L';
+
+inline uint32_t align8(uint32_t size) {
+	return (size + 7) & ~7u;
+}
+
+/**
+ * Parses the conversion specification starting at the '%' pointed to by p.
+ * Both the producer and the consumer walk the format string with this
+ * function so they always agree on the argument layout.
+ */
+const char* parseFormatSpec(const char* p, FormatSpec& spec) {
+	spec.start = p++;
+	spec.length = LENGTH_NONE;
+	spec.stars = 0;
+	while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' || *p == '\'') {
+		p++;
+	}
+	if (*p == '*') {
+		spec.stars++;
+		p++;
+	} else {
+		while (*p >= '0' && *p <= '9') {
+			p++;
+		}
+	}
+	if (*p == '.') {
+		p++;
+		if (*p == '*') {
+			spec.stars++;
+			p++;
+		} else {
+			while (*p >= '0' && *p <= '9') {
+				p++;
+			}
+		}
+	}
+	switch (*p) {
+	case 'h':
+		p += (p[1] == 'h') ? 2 : 1;
+		break;
+	case 'l':
+		if (p[1] == 'l') {
+			spec.length = LENGTH_LONG_LONG;
+			p += 2;
+		} else {
+			spec.length = LENGTH_LONG;
+			p++;
+		}
+		break;
+	case 'q':
+		spec.length = LENGTH_LONG_LONG;
+		p++;
+		break;
+	case 'j':
+	case 'z':
+	case 't':
+	case 'L':
+		spec.length = *p++;
+		break;
+	}
+	spec.conversion = *p;
+	if (*p != '\0') {
+		p++;
+	}
+	spec.end = p;
+	return p;
+}
+
+class RecordWriter
+{
+public:
+	RecordWriter(uint8_t* buffer, uint32_t capacity) :
+			mBuffer(buffer), mCapacity(capacity), mSize(0), mOverflow(false) {
+	}
+
+	template<typename T>
+	void put(T value) {
+		uint32_t size = align8(sizeof(T));
+		if (mSize + size > mCapacity) {
+			mOverflow = true;
+			return;
+		}
+		memcpy(mBuffer + mSize, &value, sizeof(T));
+		mSize += size;
+	}
+
+	void putString(const char* string, uint32_t maxSize) {
+		if (string == NULL) {
+			string = "(null)";
+		}
+		uint32_t length = strlen(string);
+		if (length > maxSize) {
+			length = maxSize;
+		}
+		if (mSize + sizeof(uint64_t) + length + 1 > mCapacity) {
+			length = (mSize + sizeof(uint64_t) + 1 < mCapacity) ? mCapacity - mSize - sizeof(uint64_t) - 1 : 0;
+			if (length == 0) {
+				mOverflow = true;
+				return;
+			}
+		}
+		put<uint64_t>(length);
+		memcpy(mBuffer + mSize, string, length);
+		mBuffer[mSize + length] = '\0';
+		mSize += align8(length + 1);
+	}
+
+	uint32_t size() const { return mSize; }
+	bool overflow() const { return mOverflow; }
+
+private:
+	uint8_t* mBuffer;
+	uint32_t mCapacity;
+	uint32_t mSize;
+	bool mOverflow;
+};
+
+class RecordReader
+{
+public:
+	RecordReader(const uint8_t* data) : mData(data) { }
+
+	template<typename T>
+	T get() {
+		T value;
+		memcpy(&value, mData, sizeof(T));
+		mData += align8(sizeof(T));
+		return value;
+	}
+
+	const char* getString() {
+		uint64_t length = get<uint64_t>();
+		const char* string = (const char*) mData;
+		mData += align8(length + 1);
+		return string;
+	}
+
+private:
+	const uint8_t* mData;
+};
+
+void packArguments(RecordWriter& writer, const char* format, va_list args) {
+	const char* p = format;
+	while (*p != '\0' && !writer.overflow()) {
+		if (*p != '%') {
+			p++;
+			continue;
+		}
+		FormatSpec spec;
+		p = parseFormatSpec(p, spec);
+		for (int32_t i = 0; i < spec.stars; i++) {
+			writer.put<int64_t>(va_arg(args, int));
+		}
+		switch (spec.conversion) {
+		case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+			switch (spec.length) {
+			case LENGTH_LONG: writer.put<int64_t>(va_arg(args, long)); break;
+			case LENGTH_LONG_LONG: writer.put<int64_t>(va_arg(args, long long)); break;
+			case LENGTH_INTMAX: writer.put<int64_t>(va_arg(args, intmax_t)); break;
+			case LENGTH_SIZE: writer.put<int64_t>(va_arg(args, size_t)); break;
+			case LENGTH_PTRDIFF: writer.put<int64_t>(va_arg(args, ptrdiff_t)); break;
+			default: writer.put<int64_t>(va_arg(args, int)); break;
+			}
+			break;
+		case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+			if (spec.length == LENGTH_LONG_DOUBLE) {
+				writer.put<long double>(va_arg(args, long double));
+			} else {
+				writer.put<double>(va_arg(args, double));
+			}
+			break;
+		case 's':
+			if (spec.length == LENGTH_LONG) {
+				va_arg(args, const wchar_t*);
+				writer.putString("(wide string)", AsyncLogger::MESSAGE_SIZE);
+			} else {
+				writer.putString(va_arg(args, const char*), AsyncLogger::MESSAGE_SIZE);
+			}
+			break;
+		case 'p':
+			writer.put<const void*>(va_arg(args, const void*));
+			break;
+		case 'n':
+			va_arg(args, void*);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+template<typename T>
+int formatValue(char* buffer, size_t size, const char* spec, const int* stars, int32_t numStars, T value) {
+	switch (numStars) {
+	case 0: return snprintf(buffer, size, spec, value);
+	case 1: return snprintf(buffer, size, spec, stars[0], value);
+	default: return snprintf(buffer, size, spec, stars[0], stars[1], value);
+	}
+}
+
+void skipArguments(const FormatSpec& spec, RecordReader& reader) {
+	for (int32_t i = 0; i < spec.stars; i++) {
+		reader.get<int64_t>();
+	}
+	switch (spec.conversion) {
+	case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+		reader.get<int64_t>();
+		break;
+	case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+		if (spec.length == LENGTH_LONG_DOUBLE) {
+			reader.get<long double>();
+		} else {
+			reader.get<double>();
+		}
+		break;
+	case 's':
+		reader.getString();
+		break;
+	case 'p':
+		reader.get<const void*>();
+		break;
+	default:
+		break;
+	}
+}
+
+void formatRecord(char* buffer, size_t size, const char* format, RecordReader& reader) {
+	char spec[64];
+	size_t offset = 0;
+	const char* p = format;
+	while (*p != '\0' && offset + 1 < size) {
+		if (*p != '%') {
+			buffer[offset++] = *p++;
+			continue;
+		}
+		FormatSpec formatSpec;
+		p = parseFormatSpec(p, formatSpec);
+		size_t specLength = formatSpec.end - formatSpec.start;
+		if (specLength >= sizeof(spec)) {
+			// Prints the spec as is and skips its arguments so that the next specs
+			// still read their own.
+			specLength = (specLength < size - offset - 1) ? specLength : size - offset - 1;
+			memcpy(buffer + offset, formatSpec.start, specLength);
+			offset += specLength;
+			skipArguments(formatSpec, reader);
+			continue;
+		}
+		memcpy(spec, formatSpec.start, specLength);
+		spec[specLength] = '\0';
+		int stars[2] = { 0, 0 };
+		for (int32_t i = 0; i < formatSpec.stars; i++) {
+			stars[i] = (int) reader.get<int64_t>();
+		}
+		char* out = buffer + offset;
+		size_t remaining = size - offset;
+		int written = 0;
+		switch (formatSpec.conversion) {
+		case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c': {
+			int64_t value = reader.get<int64_t>();
+			switch (formatSpec.length) {
+			case LENGTH_LONG: written = formatValue(out, remaining, spec, stars, formatSpec.stars, (long) value); break;
+			case LENGTH_LONG_LONG: written = formatValue(out, remaining, spec, stars, formatSpec.stars, (long long) value); break;
+			case LENGTH_INTMAX: written = formatValue(out, remaining, spec, stars, formatSpec.stars, (intmax_t) value); break;
+			case LENGTH_SIZE: written = formatValue(out, remaining, spec, stars, formatSpec.stars, (size_t) value); break;
+			case LENGTH_PTRDIFF: written = formatValue(out, remaining, spec, stars, formatSpec.stars, (ptrdiff_t) value); break;
+			default: written = formatValue(out, remaining, spec, stars, formatSpec.stars, (int) value); break;
+			}
+			break;
+		}
+		case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+			if (formatSpec.length == LENGTH_LONG_DOUBLE) {
+				written = formatValue(out, remaining, spec, stars, formatSpec.stars, reader.get<long double>());
+			} else {
+				written = formatValue(out, remaining, spec, stars, formatSpec.stars, reader.get<double>());
+			}
+			break;
+		case 's':
+			if (formatSpec.length == LENGTH_LONG) {
+				// The wide string was replaced by a narrow placeholder.
+				spec[specLength - 2] = 's';
+				spec[specLength - 1] = '\0';
+			}
+			written = formatValue(out, remaining, spec, stars, formatSpec.stars, reader.getString());
+			break;
+		case 'p':
+			written = formatValue(out, remaining, spec, stars, formatSpec.stars, reader.get<const void*>());
+			break;
+		case '%':
+			out[0] = '%';
+			written = 1;
+			break;
+		default:
+			break;
+		}
+		if (written > 0) {
+			offset += ((size_t) written < remaining) ? written : remaining - 1;
+		}
+	}
+	buffer[offset] = '\0';
+}
+
+} /* anonymous namespace */
+
+AsyncLogger::RingBuffer::RingBuffer() :
+		mNext(NULL),
+		mClosed(0),
+		mHead(0),
+		mTail(0) {
+	mData = (uint8_t*) malloc(RING_BUFFER_SIZE);
+}
+
+AsyncLogger::RingBuffer::~RingBuffer() {
+	free(mData);
+}
+
+bool AsyncLogger::RingBuffer::write(const uint8_t* record, uint32_t size) {
+	const uint32_t head = (uint32_t) mHead;
+	const uint32_t tail = (uint32_t) AtomicInteger::addAndGet(0, &mTail);
+	const uint32_t offset = head & (RING_BUFFER_SIZE - 1);
+	const uint32_t contiguous = RING_BUFFER_SIZE - offset;
+	const uint32_t required = (contiguous < size) ? contiguous + size : size;
+	if (RING_BUFFER_SIZE - (head - tail) < required) {
+		return false;
+	}
+	if (contiguous < size) {
+		RecordHeader* padding = (RecordHeader*) (mData + offset);
+		padding->size = contiguous;
+		padding->priority = PADDING_RECORD;
+		memcpy(mData, record, size);
+	} else {
+		memcpy(mData + offset, record, size);
+	}
+	// Publishes the record to the consumer (full memory barrier).
+	AtomicInteger::addAndGet(required, &mHead);
+	return true;
+}
+
+uint32_t AsyncLogger::RingBuffer::drain(AsyncLogger& logger) {
+	const uint32_t head = (uint32_t) AtomicInteger::addAndGet(0, &mHead);
+	uint32_t tail = (uint32_t) mTail;
+	uint32_t count = 0;
+	while (tail != head) {
+		const RecordHeader* header = (const RecordHeader*) (mData + (tail & (RING_BUFFER_SIZE - 1)));
+		if (header->priority != PADDING_RECORD) {
+			logger.print((const uint8_t*) header);
+			count++;
+		}
+		tail += header->size;
+	}
+	AtomicInteger::addAndGet(tail - (uint32_t) mTail, &mTail);
+	return count;
+}
+
+void AsyncLogger::FlushThread::run() {
+	while (!isInterrupted()) {
+		mLogger.flush();
+		AutoLock autoLock(mLogger.mCondVarLock);
+		if (!isInterrupted()) {
+			mLogger.mCondVar.wait(FLUSH_INTERVAL);
+		}
+	}
+	mLogger.flush();
+}
+
+AsyncLogger::AsyncLogger(Logger& logger) :
+		mLogger(logger),
+		mRingBuffers(NULL),
+		mCondVar(mCondVarLock),
+		mFlushThread(NULL),
+		mStarted(0),
+		mDroppedRecords(0) {
+	pthread_key_create(&mTlsKey, AsyncLogger::closeRingBuffer);
+}
+
+AsyncLogger::~AsyncLogger() {
+	stop();
+	pthread_key_delete(mTlsKey);
+	RingBuffer* ringBuffer = mRingBuffers;
+	while (ringBuffer != NULL) {
+		RingBuffer* next = ringBuffer->mNext;
+		delete ringBuffer;
+		ringBuffer = next;
+	}
+}
+
+bool AsyncLogger::start() {
+	AutoLock autoLock(mFlushThreadLock);
+	if (mFlushThread == NULL) {
+		mFlushThread = new FlushThread(*this);
+		if (!mFlushThread->start()) {
+			mFlushThread = NULL;
+			return false;
+		}
+		AtomicInteger::incrementAndGet(&mStarted);
+	}
+	return true;
+}
+
+void AsyncLogger::stop() {
+	AutoLock autoLock(mFlushThreadLock);
+	if (mFlushThread != NULL) {
+		// Log calls print synchronously again before the thread is gone.
+		AtomicInteger::decrementAndGet(&mStarted);
+		{
+			AutoLock autoLock(mCondVarLock);
+			mFlushThread->interrupt();
+			mCondVar.notify();
+		}
+		mFlushThread->join();
+		mFlushThread = NULL;
+	}
+}
+
+bool AsyncLogger::log(int bufferId, uint8_t priority, const char* tag, const char* format, va_list args) {
+	RingBuffer* ringBuffer = getRingBuffer();
+	if (ringBuffer == NULL) {
+		AtomicInteger::incrementAndGet(&mDroppedRecords);
+		return false;
+	}
+
+	uint64_t record[MAX_RECORD_SIZE / sizeof(uint64_t)];
+	RecordWriter writer((uint8_t*) record, MAX_RECORD_SIZE);
+	writer.put<RecordHeader>(RecordHeader());
+	writer.putString(tag, MAX_TAG_SIZE);
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	packArguments(writer, format, argsCopy);
+	va_end(argsCopy);
+
+	RecordHeader* header = (RecordHeader*) record;
+	header->size = writer.size();
+	header->priority = priority;
+	header->bufferId = bufferId;
+	header->format = format;
+	if (writer.overflow() || !ringBuffer->write((const uint8_t*) record, writer.size())) {
+		AtomicInteger::incrementAndGet(&mDroppedRecords);
+		return false;
+	}
+	return true;
+}
+
+void AsyncLogger::flush() {
+	AutoLock autoLock(mDrainLock);
+	RingBuffer* prevRingBuffer = NULL;
+	RingBuffer* ringBuffer;
+	{
+		AutoLock autoLock(mRingBuffersLock);
+		ringBuffer = mRingBuffers;
+	}
+	while (ringBuffer != NULL) {
+		// Ring buffers are only prepended to the list and only removed here, so the
+		// list can be walked without holding mRingBuffersLock.
+		const bool closed = AtomicInteger::addAndGet(0, &ringBuffer->mClosed) != 0;
+		ringBuffer->drain(*this);
+		RingBuffer* next = ringBuffer->mNext;
+		if (closed) {
+			AutoLock autoLock(mRingBuffersLock);
+			if (prevRingBuffer == NULL) {
+				if (mRingBuffers == ringBuffer) {
+					mRingBuffers = next;
+				} else {
+					RingBuffer* curRingBuffer = mRingBuffers;
+					while (curRingBuffer->mNext != ringBuffer) {
+						curRingBuffer = curRingBuffer->mNext;
+					}
+					curRingBuffer->mNext = next;
+				}
+			} else {
+				prevRingBuffer->mNext = next;
+			}
+			delete ringBuffer;
+		} else {
+			prevRingBuffer = ringBuffer;
+		}
+		ringBuffer = next;
+	}
+}
+
+bool AsyncLogger::isStarted() const {
+	// Read without a lock on every log call, mFlushThread is only touched by start() and stop().
+	return AtomicInteger::addAndGet(0, const_cast<volatile int32_t*>(&mStarted)) != 0;
+}
+
+uint32_t AsyncLogger::getDroppedRecordCount() const {
+	return (uint32_t) mDroppedRecords;
+}
+
+AsyncLogger::RingBuffer* AsyncLogger::getRingBuffer() {
+	RingBuffer* ringBuffer = (RingBuffer*) pthread_getspecific(mTlsKey);
+	if (ringBuffer == NULL) {
+		ringBuffer = new RingBuffer();
+		if (pthread_setspecific(mTlsKey, ringBuffer) != 0) {
+			delete ringBuffer;
+			return NULL;
+		}
+		AutoLock autoLock(mRingBuffersLock);
+		ringBuffer->mNext = mRingBuffers;
+		mRingBuffers = ringBuffer;
+	}
+	return ringBuffer;
+}
+
+void AsyncLogger::closeRingBuffer(void* ringBuffer) {
+	// The flush thread prints the remaining records and then frees the ring buffer.
+	AtomicInteger::incrementAndGet(&((RingBuffer*) ringBuffer)->mClosed);
+}
+
+void AsyncLogger::print(const uint8_t* record) {
+	const RecordHeader* header = (const RecordHeader*) record;
+	RecordReader reader(record + align8(sizeof(RecordHeader)));
+	const char* tag = reader.getString();
+	char msg[MESSAGE_SIZE];
+	formatRecord(msg, sizeof(msg), header->format, reader);
+	mLogger.println(header->bufferId, header->priority, tag, msg);
+}
+
+} /* namespace mindroid */
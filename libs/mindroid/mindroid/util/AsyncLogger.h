@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2014 Daniel Himmelein
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MINDROID_ASYNCLOGGER_H_
+#define MINDROID_ASYNCLOGGER_H_
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <pthread.h>
+#include <mindroid/util/Utils.h>
+#include <mindroid/util/Logger.h>
+#include <mindroid/os/Thread.h>
+#include <mindroid/os/Lock.h>
+#include <mindroid/os/CondVar.h>
+
+namespace mindroid {
+
+/**
+ * Binary logging backend. A log call only copies the format pointer and its
+ * packed arguments into a ring buffer owned by the calling thread. A background
+ * thread drains all rings, formats the records and hands them to the Logger.
+ *
+ * Each ring has a single producer (its thread) and a single consumer (the
+ * flush thread), so no locks are taken on the logging path. The memory used is
+ * bounded by RING_BUFFER_SIZE per logging thread. A record that does not fit
+ * is dropped and counted.
+ *
+ * The format string must outlive the record (string literals do). %s arguments
+ * and the tag are copied. %n is not supported.
+ */
+class AsyncLogger
+{
+public:
+	AsyncLogger(Logger& logger);
+	~AsyncLogger();
+
+	bool start();
+	void stop();
+	bool isStarted() const;
+
+	/**
+	 * Records a log message. Returns false if the record was dropped.
+	 */
+	bool log(int bufferId, uint8_t priority, const char* tag, const char* format, va_list args);
+
+	/**
+	 * Formats and prints all pending records on the calling thread.
+	 */
+	void flush();
+
+	uint32_t getDroppedRecordCount() const;
+
+	static const uint32_t RING_BUFFER_SIZE = 16 * 1024;
+	static const uint32_t MAX_RECORD_SIZE = 512;
+	static const uint32_t MAX_TAG_SIZE = 32;
+	static const uint32_t MESSAGE_SIZE = 256;
+	static const uint32_t FLUSH_INTERVAL = 20; // milliseconds
+
+private:
+	class RingBuffer
+	{
+	public:
+		RingBuffer();
+		~RingBuffer();
+
+		bool write(const uint8_t* record, uint32_t size);
+		uint32_t drain(AsyncLogger& logger);
+
+		RingBuffer* mNext;
+		volatile int32_t mClosed;
+
+	private:
+		uint8_t* mData;
+		volatile int32_t mHead;
+		volatile int32_t mTail;
+
+		NO_COPY_CTOR_AND_ASSIGNMENT_OPERATOR(RingBuffer)
+	};
+
+	class FlushThread :
+			public Thread
+	{
+	public:
+		FlushThread(AsyncLogger& logger) : mLogger(logger) { }
+		virtual void run();
+
+	private:
+		AsyncLogger& mLogger;
+	};
+
+	RingBuffer* getRingBuffer();
+	void print(const uint8_t* record);
+	static void closeRingBuffer(void* ringBuffer);
+
+	Logger& mLogger;
+	pthread_key_t mTlsKey;
+	Lock mRingBuffersLock;
+	RingBuffer* mRingBuffers;
+	Lock mDrainLock;
+	Lock mCondVarLock;
+	CondVar mCondVar;
+	Lock mFlushThreadLock;
+	sp<FlushThread> mFlushThread;
+	volatile int32_t mStarted;
+	volatile int32_t mDroppedRecords;
+
+	NO_COPY_CTOR_AND_ASSIGNMENT_OPERATOR(AsyncLogger)
+};
+
+} /* namespace mindroid */
+
+#endif /* MINDROID_ASYNCLOGGER_H_ */
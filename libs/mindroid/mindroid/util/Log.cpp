@@ -18,66 +18,111 @@
 
 namespace mindroid {
 
+// Debug builds keep the verbose and debug messages
+#ifdef NDEBUG
+uint8_t Log::sMinPriority = Log::INFO;
+#else
+uint8_t Log::sMinPriority = Log::VERBOSE;
+#endif
+volatile bool Log::sAutoStartAsyncLogging = true;
 Logger Log::sLogger;
+AsyncLogger Log::sAsyncLogger(Log::sLogger);
 
 int Log::v(const char* tag, const char* format, ...) {
-	char msg[LOG_RECORD_SIZE];
+	if (!isLoggable(VERBOSE)) {
+		return 0;
+	}
 	va_list args;
 	va_start(args, format);
-	vsnprintf(msg, LOG_RECORD_SIZE, format, args);
+	int result = println(VERBOSE, tag, format, args);
 	va_end(args);
-
-	return sLogger.println(DEFAULT_LOG_ID, VERBOSE, tag, msg);
+	return result;
 }
 
 int Log::d(const char* tag, const char* format, ...) {
-	char msg[LOG_RECORD_SIZE];
+	if (!isLoggable(DEBUG)) {
+		return 0;
+	}
 	va_list args;
 	va_start(args, format);
-	vsnprintf(msg, LOG_RECORD_SIZE, format, args);
+	int result = println(DEBUG, tag, format, args);
 	va_end(args);
-
-	return sLogger.println(DEFAULT_LOG_ID, DEBUG, tag, msg);
+	return result;
 }
 
 int Log::i(const char* tag, const char* format, ...) {
-	char msg[LOG_RECORD_SIZE];
+	if (!isLoggable(INFO)) {
+		return 0;
+	}
 	va_list args;
 	va_start(args, format);
-	vsnprintf(msg, LOG_RECORD_SIZE, format, args);
+	int result = println(INFO, tag, format, args);
 	va_end(args);
-
-	return sLogger.println(DEFAULT_LOG_ID, INFO, tag, msg);
+	return result;
 }
 
 int Log::w(const char* tag, const char* format, ...) {
-	char msg[LOG_RECORD_SIZE];
+	if (!isLoggable(WARN)) {
+		return 0;
+	}
 	va_list args;
 	va_start(args, format);
-	vsnprintf(msg, LOG_RECORD_SIZE, format, args);
+	int result = println(WARN, tag, format, args);
 	va_end(args);
-
-	return sLogger.println(DEFAULT_LOG_ID, WARN, tag, msg);
+	return result;
 }
 
 int Log::e(const char* tag, const char* format, ...) {
-	char msg[LOG_RECORD_SIZE];
+	if (!isLoggable(ERROR)) {
+		return 0;
+	}
 	va_list args;
 	va_start(args, format);
-	vsnprintf(msg, LOG_RECORD_SIZE, format, args);
+	int result = println(ERROR, tag, format, args);
 	va_end(args);
-
-	return sLogger.println(DEFAULT_LOG_ID, ERROR, tag, msg);
+	return result;
 }
 
 int Log::wtf(const char* tag, const char* format, ...) {
-	char msg[LOG_RECORD_SIZE];
+	if (!isLoggable(WTF)) {
+		return 0;
+	}
 	va_list args;
 	va_start(args, format);
-	vsnprintf(msg, LOG_RECORD_SIZE, format, args);
+	int result = println(WTF, tag, format, args);
 	va_end(args);
+	return result;
+}
+
+int Log::println(uint8_t priority, const char* tag, const char* format, va_list args) {
+	if (sAsyncLogger.isStarted() || (sAutoStartAsyncLogging && startAsyncLogging())) {
+		return sAsyncLogger.log(DEFAULT_LOG_ID, priority, tag, format, args) ? 0 : -1;
+	}
+
+	char msg[LOG_RECORD_SIZE];
+	vsnprintf(msg, LOG_RECORD_SIZE, format, args);
+	return sLogger.println(DEFAULT_LOG_ID, priority, tag, msg);
+}
+
+bool Log::startAsyncLogging() {
+	// Only tried once on its own, a flush thread that cannot be started is not
+	// retried on every log call
+	sAutoStartAsyncLogging = false;
+	return sAsyncLogger.start();
+}
+
+void Log::stopAsyncLogging() {
+	sAutoStartAsyncLogging = false;
+	sAsyncLogger.stop();
+	sAsyncLogger.flush();
+}
+
+void Log::flush() {
+	sAsyncLogger.flush();
+}
 
-	return sLogger.println(DEFAULT_LOG_ID, WTF, tag, msg);
+uint32_t Log::getDroppedRecordCount() {
+	return sAsyncLogger.getDroppedRecordCount();
 }
 
 } /* namespace mindroid */
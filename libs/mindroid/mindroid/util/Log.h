@@ -21,6 +21,7 @@
 #include <stdint.h>
 #include <stdarg.h>
 #include <mindroid/util/Logger.h>
+#include <mindroid/util/AsyncLogger.h>
 #include <mindroid/util/Utils.h>
 
 namespace mindroid {
@@ -28,6 +29,13 @@ namespace mindroid {
 class Log
 {
 public:
+	static const uint8_t VERBOSE = 0;
+	static const uint8_t DEBUG = 1;
+	static const uint8_t INFO = 2;
+	static const uint8_t WARN = 3;
+	static const uint8_t ERROR = 4;
+	static const uint8_t WTF = 5;
+
 	/**
 	 * Send a {@link #VERBOSE} log message.
 	 * @param tag Used to identify the source of a log message.  It usually identifies
@@ -79,18 +87,57 @@ public:
 	 */
 	static int wtf(const char* tag, const char* format, ...);
 
+	/**
+	 * Checks to see whether or not a log for the specified priority is loggable.
+	 * Messages below the minimum priority are dropped before any formatting.
+	 */
+	static bool isLoggable(uint8_t priority) {
+		return priority >= sMinPriority;
+	}
+
+	/**
+	 * Sets the lowest priority that is logged, VERBOSE by default in debug
+	 * builds and INFO when NDEBUG is defined.
+	 */
+	static void setMinPriority(uint8_t priority) {
+		sMinPriority = priority;
+	}
+
+	/**
+	 * Switches to the asynchronous binary backend. Log calls then only pack their
+	 * arguments into a per-thread ring buffer and a background thread formats
+	 * and prints them. The first loggable message switches to it on its own
+	 * unless stopAsyncLogging() was called before.
+	 */
+	static bool startAsyncLogging();
+
+	/**
+	 * Prints all pending records and switches back to synchronous logging for
+	 * good, until startAsyncLogging() is called again.
+	 */
+	static void stopAsyncLogging();
+
+	/**
+	 * Prints all pending records of the asynchronous backend on the calling thread.
+	 */
+	static void flush();
+
+	/**
+	 * Returns the number of records the asynchronous backend had to drop because
+	 * a ring buffer was full.
+	 */
+	static uint32_t getDroppedRecordCount();
+
 private:
-    static const uint8_t VERBOSE = 0;
-    static const uint8_t DEBUG = 1;
-    static const uint8_t INFO = 2;
-    static const uint8_t WARN = 3;
-    static const uint8_t ERROR = 4;
-    static const uint8_t WTF = 5;
+    static int println(uint8_t priority, const char* tag, const char* format, va_list args);
 
     static const int DEFAULT_LOG_ID = 0;
     static const int LOG_RECORD_SIZE = 64;
 
+    static uint8_t sMinPriority;
+    static volatile bool sAutoStartAsyncLogging;
     static Logger sLogger;
+    static AsyncLogger sAsyncLogger;
 
     NO_COPY_CTOR_AND_ASSIGNMENT_OPERATOR(Log)
 };
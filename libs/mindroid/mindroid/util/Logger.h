@@ -28,7 +28,13 @@ public:
 	Logger() {
 	}
 
-	int println(int bufferId, uint8_t priority, const char* tag, const char* msg);
+	virtual ~Logger() {
+	}
+
+	/**
+	 * Prints a formatted record, to stdout by default.
+	 */
+	virtual int println(int bufferId, uint8_t priority, const char* tag, const char* msg);
 	
 private:
 	static char mProrities[];
@@ -285,8 +285,9 @@ public:
     SkAutoGlyphCache(const SkDescriptor* desc) {
         fCache = SkGlyphCache::DetachCache(desc);
     }
-    SkAutoGlyphCache(const SkPaint& paint, const SkMatrix* matrix) {
-        fCache = paint.detachCache(matrix);
+    SkAutoGlyphCache(const SkPaint& paint, const SkMatrix* matrix,
+                     bool ignoreGamma = false) {
+        fCache = paint.detachCache(matrix, ignoreGamma);
     }
     ~SkAutoGlyphCache() {
         if (fCache) {
@@ -0,0 +1,325 @@
+#!/usr/bin/env python
+#
+#  Licensed under the Apache License, Version 2.0 (the "License");
+#  you may not use this file except in compliance with the License.
+#  You may obtain a copy of the License at
+#
+#       http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+#
+
+"""Compiles the values of a res directory into the table read by ResourceTable.
+
+usage: rescompile.py [-n namespace] <res directory> <table file> <R header>
+
+The strings, colors and dimensions of res/values/*.xml and the drawables of
+the res/drawable* directories get integer ids, written to an R header:
+
+    getResources()->getColor(R::color::gray1)
+
+The table holds their values already parsed, so that Resources finds them by
+index: colors as ARGB ints, dimensions as a value and a TypedValue unit and
+strings, unescaped and interned, as UTF-16. Names are sorted in the table,
+so that "@color/gray1" in a layout is found with a binary search.
+
+Write the table to res/resources.table, where Resources looks for it. Only
+the default values directory is compiled, qualified ones are ignored.
+"""
+
+import getopt
+import os
+import re
+import struct
+import sys
+import xml.etree.ElementTree as ElementTree
+
+# Must match ResourceTable.h
+MAGIC = 0x4C425452  # 'RTBL'
+VERSION = 1
+PACKAGE_ID = 0x7f
+
+TYPE_STRING = 1
+TYPE_COLOR = 2
+TYPE_DIMEN = 3
+TYPE_DRAWABLE = 4
+TYPES = [
+    (TYPE_STRING, 'string'),
+    (TYPE_COLOR, 'color'),
+    (TYPE_DIMEN, 'dimen'),
+    (TYPE_DRAWABLE, 'drawable'),
+]
+
+# TypedValue units
+UNITS = {
+    'px': 0,
+    'dp': 1,
+    'dip': 1,
+    'sp': 2,
+    'pt': 3,
+    'in': 4,
+    'mm': 5,
+}
+
+# As Color::parseColor
+WHITE = 0xFFFFFFFF
+COLOR_NAMES = {
+    'black': 0xFF000000,
+    'darkgray': 0xFF444444,
+    'gray': 0xFF888888,
+    'lightgray': 0xFFCCCCCC,
+    'white': 0xFFFFFFFF,
+    'red': 0xFFFF0000,
+    'green': 0xFF00FF00,
+    'blue': 0xFF0000FF,
+    'yellow': 0xFFFFFF00,
+    'cyan': 0xFF00FFFF,
+    'magenta': 0xFFFF00FF,
+    'aqua': 0x00FFFF,
+    'fuchsia': 0xFF00FF,
+    'darkgrey': 0xFF444444,
+    'grey': 0xFF888888,
+    'lightgrey': 0xFFCCCCCC,
+    'lime': 0x00FF00,
+    'maroon': 0x800000,
+    'navy': 0x000080,
+    'olive': 0x808000,
+    'purple': 0x800080,
+    'silver': 0xC0C0C0,
+    'teal': 0x008080,
+}
+
+HEADER_FORMAT = '<IIII'
+TYPE_FORMAT = '<III'
+
+
+def fail(message):
+    sys.exit('rescompile: ' + message)
+
+
+def parse_color(text):
+    if text.startswith('#'):
+        try:
+            color = int(text[1:], 16) & 0xFFFFFFFF
+        except ValueError:
+            fail('invalid color %s' % text)
+        if len(text) == 7:
+            return color | 0xFF000000
+        if len(text) != 9:
+            return WHITE
+        return color
+    return COLOR_NAMES.get(text.lower(), WHITE)
+
+
+def parse_dimen(text):
+    match = re.match(r'^\s*(-?[0-9]*\.?[0-9]+)\s*([a-z]+)\s*$', text)
+    if not match or match.group(2) not in UNITS:
+        fail('invalid dimension %s' % text)
+    return float(match.group(1)), UNITS[match.group(2)]
+
+
+def unescape(text):
+    out = []
+    i = 0
+    while i < len(text):
+        c = text[i]
+        if c == '\\' and i + 1 < len(text):
+            n = text[i + 1]
+            i += 2
+            if n == 'n':
+                out.append('\n')
+            elif n == 't':
+                out.append('\t')
+            elif n == 'r':
+                out.append('\r')
+            elif n == 'u' and i + 4 <= len(text):
+                out.append(chr(int(text[i:i + 4], 16)))
+                i += 4
+            else:
+                out.append(n)
+        else:
+            out.append(c)
+            i += 1
+    return ''.join(out)
+
+
+def load_values(resDir):
+    raw = {'string': {}, 'color': {}, 'dimen': {}}
+
+    valuesDir = os.path.join(resDir, 'values')
+    if os.path.isdir(valuesDir):
+        for name in sorted(os.listdir(valuesDir)):
+            if not name.endswith('.xml'):
+                continue
+            path = os.path.join(valuesDir, name)
+            try:
+                root = ElementTree.parse(path).getroot()
+            except ElementTree.ParseError as e:
+                fail('%s: %s' % (path, e))
+            for node in root:
+                if node.tag in raw and node.get('name'):
+                    # Only the text before the first child, as CCPullParser
+                    raw[node.tag][node.get('name')] = node.text or ''
+
+    def resolve(type, name, seen=()):
+        value = raw[type][name]
+        prefix = '@' + type + '/'
+        if value.strip().startswith(prefix):
+            target = value.strip()[len(prefix):]
+            if target not in raw[type] or target in seen:
+                fail('unresolved reference %s in %s/%s' % (value, type, name))
+            return resolve(type, target, seen + (name,))
+        return value
+
+    values = {}
+    values['string'] = dict((n, unescape(resolve('string', n))) for n in raw['string'])
+    values['color'] = dict((n, parse_color(resolve('color', n).strip())) for n in raw['color'])
+    values['dimen'] = dict((n, parse_dimen(resolve('dimen', n))) for n in raw['dimen'])
+
+    drawables = set()
+    for name in os.listdir(resDir):
+        path = os.path.join(resDir, name)
+        if name.split('-')[0] == 'drawable' and os.path.isdir(path):
+            for file in os.listdir(path):
+                if not file.startswith('.'):
+                    drawables.add(file.split('.')[0])
+    values['drawable'] = dict((n, None) for n in drawables)
+
+    return values
+
+
+def align(data, alignment):
+    data.extend(b'\0' * ((alignment - len(data) % alignment) % alignment))
+
+
+def write_table(values, path):
+    names = dict((t, sorted(values[n].keys())) for t, n in TYPES)
+    for t, n in TYPES:
+        if len(names[t]) > 0xFFFF:
+            fail('too many %s resources' % n)
+
+    # Intern the strings
+    pool = []
+    poolIndex = {}
+    for name in names[TYPE_STRING]:
+        value = values['string'][name]
+        if value not in poolIndex:
+            poolIndex[value] = len(pool)
+            pool.append(value)
+
+    headerSize = struct.calcsize(HEADER_FORMAT) + len(TYPES) * struct.calcsize(TYPE_FORMAT)
+    data = bytearray(headerSize)
+    typeEntries = []
+
+    for t, n in TYPES:
+        namesOffset = len(data)
+        data.extend(b'\0' * (4 * len(names[t])))
+        nameOffsets = []
+        for name in names[t]:
+            nameOffsets.append(len(data))
+            data.extend(name.encode('utf-8') + b'\0')
+        struct.pack_into('<%dI' % len(nameOffsets), data, namesOffset, *nameOffsets)
+        align(data, 4)
+
+        valuesOffset = len(data)
+        for name in names[t]:
+            if t == TYPE_STRING:
+                data.extend(struct.pack('<I', poolIndex[values[n][name]]))
+            elif t == TYPE_COLOR:
+                data.extend(struct.pack('<I', values[n][name]))
+            elif t == TYPE_DIMEN:
+                data.extend(struct.pack('<fI', *values[n][name]))
+        if t == TYPE_DRAWABLE:
+            valuesOffset = 0
+
+        typeEntries.append((len(names[t]), namesOffset, valuesOffset))
+
+    # Offset and length in UTF-16 units of every string, then the strings
+    poolOffset = len(data)
+    data.extend(b'\0' * (8 * len(pool)))
+    for i, value in enumerate(pool):
+        utf16 = value.encode('utf-16-le')
+        struct.pack_into('<II', data, poolOffset + 8 * i, len(data), len(utf16) // 2)
+        data.extend(utf16 + b'\0\0')
+    align(data, 4)
+
+    struct.pack_into(HEADER_FORMAT, data, 0, MAGIC, VERSION, poolOffset, len(pool))
+    offset = struct.calcsize(HEADER_FORMAT)
+    for entry in typeEntries:
+        struct.pack_into(TYPE_FORMAT, data, offset, *entry)
+        offset += struct.calcsize(TYPE_FORMAT)
+
+    with open(path, 'wb') as f:
+        f.write(data)
+
+    return names
+
+
+def identifier(name):
+    name = re.sub(r'[^A-Za-z0-9_]', '_', name)
+    return '_' + name if name[0].isdigit() else name
+
+
+def write_header(names, path, namespace, resDir):
+    guard = '__' + re.sub(r'[^A-Za-z0-9]', '_', os.path.basename(path)).upper() + '__'
+
+    lines = [
+        '//',
+        '//  %s' % os.path.basename(path),
+        '//',
+        '//  Generated by tools/rescompile.py from %s, do not edit.' % resDir,
+        '//',
+        '',
+        '#ifndef %s' % guard,
+        '#define %s' % guard,
+        '',
+    ]
+    if namespace:
+        lines += ['namespace %s {' % namespace, '']
+    lines += ['class R {', 'public:']
+
+    for t, n in TYPES:
+        lines += ['', '    class %s {' % n, '    public:']
+        for index, name in enumerate(names[t]):
+            id = (PACKAGE_ID << 24) | (t << 16) | index
+            lines.append('        static const int %s = 0x%08x;' % (identifier(name), id))
+        lines.append('    };')
+
+    lines += ['};']
+    if namespace:
+        lines += ['', '} // namespace %s' % namespace]
+    lines += ['', '#endif /* %s */' % guard, '']
+
+    with open(path, 'w') as f:
+        f.write('\n'.join(lines))
+
+
+def main(argv):
+    namespace = None
+
+    try:
+        opts, args = getopt.getopt(argv, 'n:')
+    except getopt.GetoptError as e:
+        sys.exit(str(e))
+
+    for opt, value in opts:
+        if opt == '-n':
+            namespace = value
+
+    if len(args) != 3:
+        sys.exit(__doc__)
+
+    resDir, tablePath, headerPath = args
+    values = load_values(resDir)
+    names = write_table(values, tablePath)
+    write_header(names, headerPath, namespace, resDir)
+
+    print('Compiled %s' % ', '.join('%d %ss' % (len(names[t]), n) for t, n in TYPES))
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
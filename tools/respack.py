@@ -0,0 +1,95 @@
+#!/usr/bin/env python
+#
+#  Licensed under the Apache License, Version 2.0 (the "License");
+#  you may not use this file except in compliance with the License.
+#  You may obtain a copy of the License at
+#
+#       http://www.apache.org/licenses/LICENSE-2.0
+#
+#  Unless required by applicable law or agreed to in writing, software
+#  distributed under the License is distributed on an "AS IS" BASIS,
+#  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#  See the License for the specific language governing permissions and
+#  limitations under the License.
+#
+
+"""Packs a res directory into the archive read by AssetPack.
+
+usage: respack.py [-a alignment] <res directory> <output file>
+
+The archive is a zip whose entries are stored uncompressed, sorted by name,
+and whose data starts on an alignment boundary (4 bytes by default, like
+zipalign), so that AssetPack hands out pointers into its mapping of the file.
+Entries are named "res/<path>", e.g. "res/drawable-hdpi/icon.png", as the
+resources are looked up by Resources.
+
+Copy the output next to the res directory of the application bundle as
+res.pack and the framework reads every resource from it.
+"""
+
+import getopt
+import os
+import struct
+import sys
+import zipfile
+
+# Size of the local file header before the name and extra field
+LOCAL_HEADER_SIZE = 30
+
+
+def collect(resDir):
+    files = []
+    for root, dirs, names in os.walk(resDir):
+        dirs.sort()
+        for name in names:
+            if name.startswith('.'):
+                continue
+            path = os.path.join(root, name)
+            arcname = 'res/' + os.path.relpath(path, resDir).replace(os.sep, '/')
+            files.append((arcname, path))
+    files.sort()
+    return files
+
+
+def pack(resDir, output, alignment):
+    files = collect(resDir)
+
+    with zipfile.ZipFile(output, 'w', zipfile.ZIP_STORED) as archive:
+        for arcname, path in files:
+            with open(path, 'rb') as f:
+                data = f.read()
+
+            info = zipfile.ZipInfo(arcname, date_time=(1980, 1, 1, 0, 0, 0))
+            info.compress_type = zipfile.ZIP_STORED
+            info.external_attr = 0o644 << 16
+
+            # Pad the extra field so the data is aligned, as zipalign does
+            offset = archive.fp.tell() + LOCAL_HEADER_SIZE + len(arcname.encode('utf-8'))
+            info.extra = b'\0' * ((alignment - offset % alignment) % alignment)
+
+            archive.writestr(info, data)
+
+    return len(files)
+
+
+def main(argv):
+    alignment = 4
+
+    try:
+        opts, args = getopt.getopt(argv, 'a:')
+    except getopt.GetoptError as e:
+        sys.exit(str(e))
+
+    for opt, value in opts:
+        if opt == '-a':
+            alignment = int(value)
+
+    if len(args) != 2 or alignment <= 0:
+        sys.exit(__doc__)
+
+    count = pack(args[0], args[1], alignment)
+    print('Packed %d resources in %s' % (count, args[1]))
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])